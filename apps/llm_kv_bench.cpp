@@ -0,0 +1,304 @@
+/**
+ * @file llm_kv_bench.cpp
+ * @brief Host-side decode KV writeback benchmark (no device needed)
+ *
+ * Replays the host work the runner does after every decode step, for all
+ * layers and heads of an LLMKVCacheManager cache:
+ * - copy:   V rows copied out of staging outputs + K column scatter (scalar loop)
+ * - direct: V output tensors rebound to cache row n_past + K column scatter (scalar loop)
+ * - kernel: direct V + KVWriteback K column scatter
+ * and the K writeback of one full prefill chunk (scalar loop vs KVWriteback).
+ *
+ * Reports mean host time per token (decode) and per chunk (prefill).
+ *
+ * --rearrange: prefill → decode rearrange_cache() for 512/1024/2048 contexts,
+ * full rows on one thread (original) vs occupied rows only, inline and parallel,
+ * plus the reverse (decode → prefill) direction.
+ */
+
+#include "llm_kv_cache_manager.h"
+#include "llm_kv_writeback.h"
+
+#include <QnnTypes.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace llm_test;
+
+namespace {
+
+struct BenchConfig {
+  int layers = 16;
+  int heads = 8;
+  int head_dim = 64;
+  int context_len = 512;
+  int ar_len = 32;    // Prefill chunk length
+  int tokens = 256;   // Decode steps per pass
+  int passes = 5;
+  int prompt = 128;   // Occupied positions for --rearrange
+  bool rearrange = false;
+};
+
+int64_t now_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void usage(const char* prog) {
+  std::cerr << "Usage: " << prog << "\n"
+            << "  [--layers N]       Transformer layers (default: 16)\n"
+            << "  [--heads N]        KV heads per layer (default: 8)\n"
+            << "  [--head_dim N]     Head dimension (default: 64)\n"
+            << "  [--context N]      Context length (default: 512)\n"
+            << "  [--ar_len N]       Prefill chunk length (default: 32)\n"
+            << "  [--tokens N]       Decode steps per pass (default: 256)\n"
+            << "  [--passes N]       Passes per mode, best is reported (default: 5)\n"
+            << "  [--rearrange]      Benchmark the prefill/decode rearrange for 512/1024/2048 contexts\n"
+            << "  [--prompt N]       Occupied positions for --rearrange (default: 128)\n";
+}
+
+enum class Mode { kCopy, kDirect, kKernel };
+
+// Mirrors LLMDecodeRunner's decode writeback (kv_ar_len = 1)
+class DecodeKVBench {
+ public:
+  DecodeKVBench(const BenchConfig& cfg, LLMKVCacheManager& kv)
+      : cfg_(cfg), kv_(kv), cache_len_(cfg.context_len - 1) {
+    // One V output tensor per (layer, head), bound to the staging buffer like a plan slot
+    v_outputs_.resize(static_cast<size_t>(cfg.layers) * cfg.heads);
+    for (int l = 0; l < cfg.layers; ++l) {
+      for (int h = 0; h < cfg.heads; ++h) {
+        Qnn_Tensor_t& t = v_outputs_[l * cfg.heads + h];
+        std::memset(&t, 0, sizeof(t));
+        t.v2.clientBuf.data = kv_.get_v_cache(l, h).output_buffer;
+        t.v2.clientBuf.dataSize = static_cast<uint32_t>(cfg.head_dim);
+      }
+    }
+  }
+
+  // Host work for one step; returns microseconds
+  int64_t step(int32_t n_past, Mode mode) {
+    int64_t start = now_us();
+    for (int l = 0; l < cfg_.layers; ++l) {
+      for (int h = 0; h < cfg_.heads; ++h) {
+        const auto& v = kv_.get_v_cache(l, h);
+        uint8_t* v_row = static_cast<uint8_t*>(v.input_buffer) + n_past * cfg_.head_dim;
+        if (mode != Mode::kCopy) {
+          v_outputs_[l * cfg_.heads + h].v2.clientBuf.data = v_row;
+        } else {
+          std::memcpy(v_row, v_outputs_[l * cfg_.heads + h].v2.clientBuf.data, cfg_.head_dim);
+        }
+
+        const auto& k = kv_.get_k_cache(l, h);
+        const uint8_t* src = static_cast<const uint8_t*>(k.output_buffer);
+        uint8_t* dst = static_cast<uint8_t*>(k.input_buffer) + n_past;
+        if (mode == Mode::kKernel) {
+          KVWriteback::write_k(dst, cache_len_, src, 1, cfg_.head_dim, 1);
+        } else {
+          KVWriteback::write_k_scalar(dst, cache_len_, src, 1, cfg_.head_dim, 1);
+        }
+      }
+    }
+    return now_us() - start;
+  }
+
+  // Best mean us/token over passes
+  double run(Mode mode) {
+    // Restore staging bindings so both modes start from the same state
+    for (int l = 0; l < cfg_.layers; ++l) {
+      for (int h = 0; h < cfg_.heads; ++h) {
+        v_outputs_[l * cfg_.heads + h].v2.clientBuf.data = kv_.get_v_cache(l, h).output_buffer;
+      }
+    }
+    double best = -1.0;
+    const int steps = std::min(cfg_.tokens, cache_len_);
+    for (int p = 0; p < cfg_.passes; ++p) {
+      int64_t total = 0;
+      for (int32_t n = 0; n < steps; ++n) total += step(n, mode);
+      double mean = static_cast<double>(total) / steps;
+      if (best < 0 || mean < best) best = mean;
+    }
+    return best;
+  }
+
+ private:
+  const BenchConfig& cfg_;
+  LLMKVCacheManager& kv_;
+  int cache_len_;
+  std::vector<Qnn_Tensor_t> v_outputs_;
+};
+
+// Mirrors the prefill K writeback of one full chunk (prefill_cache_len stride)
+class PrefillKVBench {
+ public:
+  PrefillKVBench(const BenchConfig& cfg, LLMKVCacheManager& kv)
+      : cfg_(cfg), kv_(kv), cache_len_(cfg.context_len - cfg.ar_len),
+        staging_(static_cast<size_t>(cfg.head_dim) * cfg.ar_len, 1) {}
+
+  // Best us/chunk over passes (chunks written at successive n_past)
+  double run(bool kernel) {
+    const int chunks = std::max(1, cache_len_ / cfg_.ar_len);
+    double best = -1.0;
+    for (int p = 0; p < cfg_.passes; ++p) {
+      int64_t start = now_us();
+      for (int c = 0; c < chunks; ++c) {
+        const int32_t n_past = c * cfg_.ar_len;
+        for (int l = 0; l < cfg_.layers; ++l) {
+          for (int h = 0; h < cfg_.heads; ++h) {
+            uint8_t* dst = static_cast<uint8_t*>(kv_.get_k_cache(l, h).input_buffer) + n_past;
+            if (kernel) {
+              KVWriteback::write_k(dst, cache_len_, staging_.data(), cfg_.ar_len,
+                                   cfg_.head_dim, cfg_.ar_len);
+            } else {
+              KVWriteback::write_k_scalar(dst, cache_len_, staging_.data(), cfg_.ar_len,
+                                          cfg_.head_dim, cfg_.ar_len);
+            }
+          }
+        }
+      }
+      double mean = static_cast<double>(now_us() - start) / chunks;
+      if (best < 0 || mean < best) best = mean;
+    }
+    return best;
+  }
+
+ private:
+  const BenchConfig& cfg_;
+  LLMKVCacheManager& kv_;
+  int cache_len_;
+  std::vector<uint8_t> staging_;
+};
+
+// Best ms over passes for one direction of rearrange_cache()
+double time_rearrange(LLMKVCacheManager& kv, int passes, int32_t from_ar, int32_t to_ar,
+                      int32_t n_past) {
+  double best = -1.0;
+  for (int p = 0; p < passes; ++p) {
+    int64_t start = now_us();
+    kv.rearrange_cache(from_ar, to_ar, n_past);
+    double ms = (now_us() - start) / 1000.0;
+    kv.rearrange_cache(to_ar, from_ar, n_past);  // Restore the source layout
+    if (best < 0 || ms < best) best = ms;
+  }
+  return best;
+}
+
+void run_rearrange_bench(const BenchConfig& cfg) {
+  std::cout << "[Rearrange Bench] " << cfg.layers << " layers x " << cfg.heads
+            << " heads, head_dim " << cfg.head_dim << ", ar " << cfg.ar_len << " -> 1, prompt "
+            << cfg.prompt << " tokens (ms)\n";
+  std::cout << "  context  full/1T  occupied/1T  occupied/MT  reverse/MT\n";
+  for (int context : {512, 1024, 2048}) {
+    if (cfg.ar_len >= context) continue;
+    LLMKVCacheManager::Metadata meta{context, cfg.head_dim, cfg.ar_len, context - 1,
+                                     cfg.heads, cfg.layers};
+    const int32_t n_past = std::min(cfg.prompt, context - cfg.ar_len);
+    double ms[4] = {0, 0, 0, 0};
+    for (int threads : {1, 0}) {
+      LLMKVCacheManager kv(meta);
+      LLMKVCacheManager::Options options;
+      options.rearrange_threads = threads;
+      kv.set_options(options);
+      if (!kv.allocate()) {
+        std::cerr << "Error: KV cache allocation failed\n";
+        return;
+      }
+      kv.prefault();
+      if (threads == 1) {
+        ms[0] = time_rearrange(kv, cfg.passes, cfg.ar_len, 1, -1);
+        ms[1] = time_rearrange(kv, cfg.passes, cfg.ar_len, 1, n_past);
+      } else {
+        ms[2] = time_rearrange(kv, cfg.passes, cfg.ar_len, 1, n_past);
+        ms[3] = time_rearrange(kv, cfg.passes, 1, cfg.ar_len, n_past);
+      }
+    }
+    std::cout << "  " << context << "     " << ms[0] << "  " << ms[1] << "  " << ms[2]
+              << "  " << ms[3] << "\n";
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  BenchConfig cfg;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--layers" && i + 1 < argc) {
+      cfg.layers = std::stoi(argv[++i]);
+    } else if (arg == "--heads" && i + 1 < argc) {
+      cfg.heads = std::stoi(argv[++i]);
+    } else if (arg == "--head_dim" && i + 1 < argc) {
+      cfg.head_dim = std::stoi(argv[++i]);
+    } else if (arg == "--context" && i + 1 < argc) {
+      cfg.context_len = std::stoi(argv[++i]);
+    } else if (arg == "--ar_len" && i + 1 < argc) {
+      cfg.ar_len = std::stoi(argv[++i]);
+    } else if (arg == "--tokens" && i + 1 < argc) {
+      cfg.tokens = std::stoi(argv[++i]);
+    } else if (arg == "--passes" && i + 1 < argc) {
+      cfg.passes = std::stoi(argv[++i]);
+    } else if (arg == "--prompt" && i + 1 < argc) {
+      cfg.prompt = std::stoi(argv[++i]);
+    } else if (arg == "--rearrange") {
+      cfg.rearrange = true;
+    } else if (arg == "--help" || arg == "-h") {
+      usage(argv[0]);
+      return 0;
+    } else {
+      std::cerr << "Unknown argument: " << arg << "\n";
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (cfg.layers <= 0 || cfg.heads <= 0 || cfg.head_dim <= 0 || cfg.context_len <= 1 ||
+      cfg.ar_len <= 0 || cfg.ar_len >= cfg.context_len || cfg.tokens <= 0 || cfg.passes <= 0) {
+    usage(argv[0]);
+    return 1;
+  }
+  if (cfg.rearrange) {
+    run_rearrange_bench(cfg);
+    return 0;
+  }
+
+  LLMKVCacheManager::Metadata meta{cfg.context_len, cfg.head_dim, cfg.ar_len, cfg.context_len - 1,
+                                   cfg.heads, cfg.layers};
+  LLMKVCacheManager kv(meta);
+  if (!kv.allocate()) {
+    std::cerr << "Error: KV cache allocation failed\n";
+    return 1;
+  }
+  kv.prefault();
+
+  DecodeKVBench bench(cfg, kv);
+  bench.run(Mode::kCopy);  // Warm caches / branch predictors
+  double copy_us = bench.run(Mode::kCopy);
+  double direct_us = bench.run(Mode::kDirect);
+  double kernel_us = bench.run(Mode::kKernel);
+
+  PrefillKVBench prefill(cfg, kv);
+  double prefill_scalar_us = prefill.run(false);
+  double prefill_kernel_us = prefill.run(true);
+
+  auto speedup = [](double base, double us) {
+    if (us > 0) std::cout << " (" << (base / us) << "x)";
+    std::cout << "\n";
+  };
+  std::cout << "[KV Bench] " << cfg.layers << " layers x " << cfg.heads << " heads, head_dim "
+            << cfg.head_dim << ", context " << cfg.context_len << ", kernels "
+            << KVWriteback::isa() << "\n";
+  std::cout << "  V copy + K scatter:   " << copy_us << " us/token\n";
+  std::cout << "  V direct + K scatter: " << direct_us << " us/token";
+  speedup(copy_us, direct_us);
+  std::cout << "  V direct + K kernel:  " << kernel_us << " us/token";
+  speedup(copy_us, kernel_us);
+  std::cout << "  Prefill K rows (ar " << cfg.ar_len << "): loop " << prefill_scalar_us
+            << " us/chunk, kernel " << prefill_kernel_us << " us/chunk";
+  speedup(prefill_scalar_us, prefill_kernel_us);
+  return 0;
+}
@@ -4,6 +4,7 @@
  */
 
 #include "llm_decode_runner.h"
+#include <algorithm>
 #include <iostream>
 #include <string>
 
@@ -21,6 +22,39 @@ static void usage(const char* prog) {
             << "  [--log_level N]        QNN log verbosity 1=ERROR, 2=WARN, 3=INFO, 4=VERBOSE, 5=DEBUG (default: 1)\n"
             << "  [--multi_context]      Enable multi-context (sharding) mode\n"
             << "  [--num_shards N]       Number of shards (0=auto-detect, default)\n"
+            << "  [--sync_exec]          Disable async graph execution (no host/accelerator overlap)\n"
+            << "  [--profile LEVEL]      QNN profiling: basic | detailed (per-op)\n"
+            << "  [--profile_out PREFIX] Profile output prefix (default: qnn_profile)\n"
+            << "                         writes PREFIX_summary.json and PREFIX_trace.json (Chrome trace)\n"
+            << "  [--load_threads N]     Shard loader threads (0=auto, default)\n"
+            << "  [--load_inflight_mb N] Max context binary MB in memory while loading (default: 2048, 0=unlimited)\n"
+            << "  [--no_list_async]      Do not use contextCreateFromBinaryListAsync for shard loading\n"
+            << "  [--no_mmap]            Read context binaries into heap buffers instead of mmap\n"
+            << "  [--warmup N]           Synthetic prefill+decode warm-up steps after init (default: 0)\n"
+            << "  [--warmup_async]       Run warm-up in the background (generate waits for it)\n"
+            << "  [--streaming_load]     Multi-context: start prefill while later shards are still loading\n"
+            << "  [--power_policy MODE]  HTP power: adaptive | burst | off (default: adaptive)\n"
+            << "  [--power_idle_ms N]    Adaptive: idle time before relaxing the power vote (default: 2000)\n"
+            << "  [--power_debounce_ms N] Adaptive: minimum hold time before a downgrade (default: 50)\n"
+            << "  [--log_sink SINK]      Async log output: stdout | logcat (default: stdout)\n"
+            << "  [--log_file PATH]      Write logs to PATH instead of stdout\n"
+            << "  [--log_ring N]         Async log ring size in records, 0 = synchronous (default: 4096)\n"
+            << "  [--no_io_arena]        Allocate graph I/O tensors one by one instead of one slab per graph\n"
+            << "  [--io_align N]         I/O tensor alignment in bytes, power of two (default: 64)\n"
+            << "  [--io_hugepages MODE]  I/O slab backing: none | thp | hugetlb (default: thp)\n"
+            << "  [--kv_hugepages MODE]  KV cache slab backing: none | thp | hugetlb (default: thp)\n"
+            << "  [--kv_mlock]           Lock the KV cache slab in RAM (mlock)\n"
+            << "  [--rearrange_threads N] Prefill->decode KV rearrange threads (0=auto, 1=inline)\n"
+            << "  [--no_io_plan]         One I/O slab per graph instead of the liveness-planned shared pool\n"
+            << "  [--copy_dataflow]      Copy hidden/ROPE/mask between shards instead of binding them in place\n"
+            << "  [--no_direct_v]        Copy decode V outputs into the cache instead of binding them in place\n"
+            << "  [--sync_kv_writeback]  Multi-context: write KV back on the calling thread (no worker)\n"
+            << "  [--no_zero_kv]         Always run the chunked prefill + rearrange, even for single-chunk prompts\n"
+            << "  [--no_context_shift]   Stop when the KV cache is full (and reject longer prompts) instead of shifting\n"
+            << "  [--sink_tokens N]      Context shift: leading positions always kept (default: 4)\n"
+            << "  [--shift_discard N]    Context shift: positions dropped per shift (0 = half the window, default)\n"
+            << "  [--prefix_cache_mb N]  Prefix KV cache cap shared across prompts, 0 = off (default: 0)\n"
+            << "  [--max_memory_mb N]    Host memory budget: pick I/O/load strategies to fit, fail init if it cannot (0=off)\n"
             << "\n"
             << "Example (single-context):\n"
             << "  " << prog << " \\\n"
@@ -71,6 +105,101 @@ int main(int argc, char** argv) {
       config.use_multi_context = true;
     } else if (arg == "--num_shards" && i + 1 < argc) {
       config.num_shards = std::stoi(argv[++i]);
+    } else if (arg == "--sync_exec") {
+      config.use_async_exec = false;
+    } else if (arg == "--profile" && i + 1 < argc) {
+      std::string level = argv[++i];
+      if (level == "basic") {
+        config.profile_level = 1;
+      } else if (level == "detailed") {
+        config.profile_level = 2;
+      } else {
+        std::cerr << "Unknown profile level: " << level << " (expected basic|detailed)\n";
+        return 1;
+      }
+    } else if (arg == "--profile_out" && i + 1 < argc) {
+      config.profile_out = argv[++i];
+    } else if (arg == "--load_threads" && i + 1 < argc) {
+      config.load_threads = std::stoi(argv[++i]);
+    } else if (arg == "--load_inflight_mb" && i + 1 < argc) {
+      config.load_inflight_mb = std::stoi(argv[++i]);
+    } else if (arg == "--no_list_async") {
+      config.use_list_async_load = false;
+    } else if (arg == "--no_mmap") {
+      config.use_mmap_load = false;
+    } else if (arg == "--warmup" && i + 1 < argc) {
+      config.warmup_iters = std::stoi(argv[++i]);
+    } else if (arg == "--warmup_async") {
+      config.warmup_async = true;
+    } else if (arg == "--streaming_load") {
+      config.streaming_load = true;
+    } else if (arg == "--power_policy" && i + 1 < argc) {
+      config.power_policy = argv[++i];
+      if (config.power_policy != "adaptive" && config.power_policy != "burst" &&
+          config.power_policy != "off") {
+        std::cerr << "Unknown power policy: " << config.power_policy
+                  << " (expected adaptive|burst|off)\n";
+        return 1;
+      }
+    } else if (arg == "--power_idle_ms" && i + 1 < argc) {
+      config.power_idle_ms = std::stoi(argv[++i]);
+    } else if (arg == "--power_debounce_ms" && i + 1 < argc) {
+      config.power_debounce_ms = std::stoi(argv[++i]);
+    } else if (arg == "--log_sink" && i + 1 < argc) {
+      config.log_sink = argv[++i];
+      if (config.log_sink != "stdout" && config.log_sink != "logcat") {
+        std::cerr << "Unknown log sink: " << config.log_sink << " (expected stdout|logcat)\n";
+        return 1;
+      }
+    } else if (arg == "--log_file" && i + 1 < argc) {
+      config.log_sink = "file";
+      config.log_file = argv[++i];
+    } else if (arg == "--log_ring" && i + 1 < argc) {
+      config.log_ring_records = std::stoi(argv[++i]);
+    } else if (arg == "--no_io_arena") {
+      config.io_arena = false;
+    } else if (arg == "--no_io_plan") {
+      config.io_plan = false;
+    } else if (arg == "--copy_dataflow") {
+      config.zero_copy_dataflow = false;
+    } else if (arg == "--no_direct_v") {
+      config.direct_v_binding = false;
+    } else if (arg == "--sync_kv_writeback") {
+      config.async_kv_writeback = false;
+    } else if (arg == "--no_zero_kv") {
+      config.zero_kv_prefill = false;
+    } else if (arg == "--no_context_shift") {
+      config.context_shift = false;
+    } else if (arg == "--sink_tokens" && i + 1 < argc) {
+      config.shift_sink_tokens = std::max(0, std::stoi(argv[++i]));
+    } else if (arg == "--shift_discard" && i + 1 < argc) {
+      config.shift_discard = std::max(0, std::stoi(argv[++i]));
+    } else if (arg == "--prefix_cache_mb" && i + 1 < argc) {
+      config.prefix_cache_mb = std::max(0, std::stoi(argv[++i]));
+    } else if (arg == "--max_memory_mb" && i + 1 < argc) {
+      config.max_memory_bytes = static_cast<uint64_t>(std::max(0LL, std::stoll(argv[++i]))) << 20;
+    } else if (arg == "--io_align" && i + 1 < argc) {
+      config.io_alignment = std::stoi(argv[++i]);
+    } else if (arg == "--io_hugepages" && i + 1 < argc) {
+      config.io_huge_pages = argv[++i];
+      if (config.io_huge_pages != "none" && config.io_huge_pages != "thp" &&
+          config.io_huge_pages != "hugetlb") {
+        std::cerr << "Unknown huge page mode: " << config.io_huge_pages
+                  << " (expected none|thp|hugetlb)\n";
+        return 1;
+      }
+    } else if (arg == "--kv_hugepages" && i + 1 < argc) {
+      config.kv_huge_pages = argv[++i];
+      if (config.kv_huge_pages != "none" && config.kv_huge_pages != "thp" &&
+          config.kv_huge_pages != "hugetlb") {
+        std::cerr << "Unknown huge page mode: " << config.kv_huge_pages
+                  << " (expected none|thp|hugetlb)\n";
+        return 1;
+      }
+    } else if (arg == "--kv_mlock") {
+      config.kv_mlock = true;
+    } else if (arg == "--rearrange_threads" && i + 1 < argc) {
+      config.kv_rearrange_threads = std::stoi(argv[++i]);
     } else if (arg == "--help" || arg == "-h") {
       usage(argv[0]);
       return 0;
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace llm_test {
+
+// 로그 레벨(QnnLog_Level_t 값과 동일: ERROR=1 ... DEBUG=5)
+enum class LogLevel : int { kError = 1, kWarn = 2, kInfo = 3, kVerbose = 4, kDebug = 5 };
+
+enum class LogSink { kStdout, kFile, kLogcat };
+
+// 비차단 비동기 로거(프로세스 단일 인스턴스)
+// - 호출 스레드: 레벨 확인 → 고정 크기 레코드 슬롯 예약(lock-free CAS) → 슬롯에 직접 포맷 → 게시
+//   I/O, fflush, mutex 없음. 링이 가득 차면 기다리지 않고 버리고 drop 카운터만 올린다
+// - drain 스레드: 게시된 레코드를 순서대로 stdout / 파일 / logcat으로 내보낸다
+// - start() 전이나 stop() 후에는 호출 스레드에서 stdout으로 바로 쓴다(기존 동작)
+// - 레코드는 가공되지 않은 바이트 조각이다. 긴 메시지는 여러 레코드로 나뉘어 이어 붙는다
+class AsyncLogger {
+public:
+  static constexpr size_t kRecordBytes = 240;  // 레코드당 본문 바이트(헤더 포함 256B 셀)
+
+  struct Options {
+    LogSink sink {LogSink::kStdout};
+    std::string file_path;           // kFile일 때 출력 파일
+    size_t capacity {4096};          // 레코드 수(2의 거듭제곱으로 올림). 최초 start()에서만 반영
+    LogLevel level {LogLevel::kInfo};
+  };
+
+  static AsyncLogger& instance();
+
+  // drain 스레드 시작(이미 실행 중이면 sink/level만 갱신하지 않고 true)
+  bool start(const Options& options);
+  // 남은 레코드를 모두 내보내고 drain 스레드 종료(멱등)
+  void stop();
+  // 지금까지 게시된 레코드가 sink로 나갈 때까지 대기
+  void flush();
+
+  bool running() const { return running_.load(std::memory_order_acquire); }
+  bool enabled(LogLevel level) const {
+    return static_cast<int>(level) <= level_.load(std::memory_order_relaxed);
+  }
+  void set_level(LogLevel level) { level_.store(static_cast<int>(level), std::memory_order_relaxed); }
+
+  // printf 형식. 줄바꿈을 붙이지 않는다
+  void log(LogLevel level, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+  // 레벨 확인 후 슬롯에 직접 vsnprintf. append_newline이면 끝에 '\n'
+  void vlog(LogLevel level, const char* fmt, va_list args, bool append_newline = false);
+  // 이미 만들어진 텍스트(레벨 확인은 호출자 책임)
+  void write(LogLevel level, const char* text, size_t len);
+
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+  uint64_t records() const { return published_.load(std::memory_order_relaxed); }
+
+  ~AsyncLogger();
+
+private:
+  struct alignas(64) Cell {
+    std::atomic<uint64_t> seq {0};
+    uint8_t level {0};
+    uint16_t len {0};
+    char text[kRecordBytes];
+  };
+
+  AsyncLogger() = default;
+  AsyncLogger(const AsyncLogger&) = delete;
+  AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+  // 슬롯 예약/게시(생산자). 가득 차면 nullptr
+  Cell* reserve(uint64_t& pos);
+  void publish(Cell* cell, uint64_t pos);
+  void write_sync(const char* text, size_t len);
+
+  // 소비자(drain 스레드 전용)
+  bool drain_once();
+  void emit(const Cell& cell);
+  void drain_loop();
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_ {0};
+  alignas(64) std::atomic<uint64_t> enqueue_pos_ {0};
+  alignas(64) uint64_t dequeue_pos_ {0};
+  std::atomic<uint64_t> drained_pos_ {0};
+
+  std::atomic<bool> running_ {false};
+  std::atomic<bool> stop_ {false};
+  std::atomic<bool> sleeping_ {false};
+  std::atomic<int> level_ {static_cast<int>(LogLevel::kInfo)};
+  std::atomic<uint64_t> dropped_ {0};
+  std::atomic<uint64_t> published_ {0};
+
+  std::mutex mu_;                  // start/stop 직렬화 + drain 스레드 대기용
+  std::condition_variable cv_;
+  std::thread drain_;
+  LogSink sink_ {LogSink::kStdout};
+  FILE* out_ {nullptr};
+  std::string logcat_line_;        // logcat은 줄 단위로 내보낸다
+};
+
+// 스트림 형식 로그 한 줄: LogLine() << "[Decode] step " << n << "\n";
+// - 스레드별 고정 버퍼에 포맷(힙 할당 없음), 소멸 시 AsyncLogger에 레코드로 게시
+// - 레벨이 꺼져 있으면 operator<<는 아무것도 포맷하지 않는다
+class LogLine {
+public:
+  explicit LogLine(LogLevel level = LogLevel::kInfo);
+  ~LogLine();
+  LogLine(const LogLine&) = delete;
+  LogLine& operator=(const LogLine&) = delete;
+
+  template <typename T>
+  LogLine& operator<<(const T& value) {
+    if (os_) *os_ << value;
+    return *this;
+  }
+  LogLine& operator<<(std::ostream& (*manip)(std::ostream&)) {
+    if (os_) manip(*os_);
+    return *this;
+  }
+
+private:
+  std::ostream* os_ {nullptr};
+};
+
+} // namespace llm_test
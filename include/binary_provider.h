@@ -17,6 +17,36 @@ public:
   ~MappingOwner();
 };
 
+// 파일을 읽기 전용으로 mmap(MAP_SHARED). 실패 시 false
+bool map_file_readonly(const std::string& path, std::unique_ptr<MappingOwner>& owner);
+
+// 파일 크기(바이트). 열 수 없으면 0
+uint64_t file_size_of(const std::string& path);
+
+// 컨텍스트 바이너리 1개(.bin)의 메모리 표현
+// - mmap 모드: 파일을 매핑해 페이지 캐시를 그대로 넘김(힙 복사/memcpy 없음)
+// - read 모드(폴백): 힙 버퍼로 전체 읽기
+// - 컨텍스트 생성 후 release()로 즉시 unmap/해제해 다음 샤드와 메모리가 겹치지 않게 한다
+class ContextBinary {
+public:
+  // use_mmap=true면 mmap을 먼저 시도하고 실패 시 read로 폴백
+  bool open(const std::string& path, bool use_mmap);
+  const void* data() const;
+  size_t size() const;
+  bool mapped() const { return map_ != nullptr; }
+
+  // 순차 접근 힌트(MADV_SEQUENTIAL): 커널 readahead 창을 키움
+  void advise_sequential();
+  // 미리 읽기(MADV_WILLNEED): 다음 샤드의 페이지 캐시 적재를 비동기로 시작
+  void prefetch();
+  // 매핑 해제/버퍼 반환(MADV_DONTNEED 후 munmap). 멱등
+  void release();
+
+private:
+  std::unique_ptr<MappingOwner> map_;
+  std::vector<char> heap_;
+};
+
 // 컨텍스트 바이너리(.bin) 샤드 파일을 디렉터리에서 검색/적재하여
 // QnnContext_Params_t 리스트로 만들어 주는 유틸리티
 class FileShardProvider {
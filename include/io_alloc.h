@@ -5,30 +5,90 @@
 #include <cstddef>
 #include <cstdint>
 #include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 namespace llm_test {
 
 // ExecuTorch 흐름을 최대한 그대로 모사한 I/O 텐서 할당기(간소화 버전)
 // - 현재 단계에서는 mutable buffer(id)가 모두 -1이므로, 텐서별(per-tensor) 할당만 수행
 // - 추후 MethodMeta 기반 mutable buffer 플랜을 받으면 동일 인터페이스에서 확장 가능
+// - arena 모드(기본): 그래프의 모든 I/O 텐서를 페이지 정렬된 slab 하나에 정렬 오프셋으로 배치
+//   (수백 개의 흩어진 할당 대신 연속 영역 1개 → 페이지 폴트/TLB 압력 감소, 풋프린트 예측 가능)
 class QNNIOAllocator {
 public:
+  static constexpr std::size_t kDefaultAlignment = 64;
+
+  enum class HugePages {
+    kNone,        // 일반 4KB 페이지
+    kTransparent, // madvise(MADV_HUGEPAGE): THP가 켜져 있으면 2MB 페이지로 승격
+    kHugeTLB,     // MAP_HUGETLB(사전 예약 필요). 실패 시 kTransparent로 폴백
+  };
+
+  struct Options {
+    bool arena {true};                        // false면 텐서별 posix_memalign(레거시)
+    std::size_t alignment {kDefaultAlignment}; // 텐서 시작 정렬(2의 거듭제곱, 아니면 기본값)
+    HugePages huge_pages {HugePages::kTransparent};
+  };
+
+  QNNIOAllocator() = default;
+  ~QNNIOAllocator() { release(); }
+  QNNIOAllocator(const QNNIOAllocator&) = delete;
+  QNNIOAllocator& operator=(const QNNIOAllocator&) = delete;
+
+  void set_options(const Options& options) { options_ = options; }
+  const Options& options() const { return options_; }
+
   // 그래프 I/O 메타(이 단계에서는 QNN SDK JSON에서 파싱한 결과)를 입력으로 받아
-  // 내부 상태(텐서명 -> nbytes)를 구성한다.
+  // 내부 상태(텐서명 -> nbytes)를 구성한다. 인덱스 순서 = inputs 다음 outputs(JSON 순서, 중복 이름 제외)
   void build_from_qnnjson(const QnnJsonGraphDesc& desc);
 
   // 실제 메모리 할당을 수행한다.
-  // - alignment는 2의 거듭제곱 권장(64 등)
+  // - alignment는 2의 거듭제곱(64 등). 0이거나 2의 거듭제곱이 아니면 options().alignment 사용
   // - 이미 할당된 메모리가 있으면 release() 후 새로 할당
-  // - 반환값은 총 할당 바이트
-  std::uint64_t allocate(std::size_t alignment);
+  // - 반환값은 총 할당 바이트(텐서 nbytes 합)
+  std::uint64_t allocate(std::size_t alignment = 0);
 
   // 텐서명 -> 할당된 버퍼 주소 바인딩(그래프 바인딩 시 clientBuf.data로 사용)
   const std::map<std::string, void*>& bindings() const { return name_to_ptr_; }
 
+  // 인덱스 기반 조회(이름 문자열 비교 없이 접근)
+  int index_of(const std::string& name) const;
+  std::size_t num_tensors() const { return entries_.size(); }
+  void* data(std::size_t index) const { return index < entries_.size() ? entries_[index].ptr : nullptr; }
+  std::uint64_t nbytes(std::size_t index) const { return index < entries_.size() ? entries_[index].nbytes : 0; }
+  // arena 모드에서 slab 시작 기준 오프셋(텐서별 모드에서는 0)
+  std::uint64_t offset(std::size_t index) const { return index < entries_.size() ? entries_[index].offset : 0; }
+
   // 총 할당 바이트(마지막 allocate 기준)
   std::uint64_t total_allocated_bytes() const { return total_allocated_bytes_; }
+  // 실제로 매핑/할당된 바이트(정렬 패딩과 페이지 반올림 포함)
+  std::uint64_t mapped_bytes() const { return mapped_bytes_; }
+  // 할당 호출 수(arena: 1, 텐서별: 텐서 수)
+  std::size_t num_regions() const { return num_regions_; }
+  bool uses_hugetlb() const { return arena_hugetlb_; }
+
+  // 외부 바인딩 텐서 지정(allocate() 전에 호출): KV cache 입력처럼 다른 버퍼(LLMKVCacheManager)에
+  // 바인딩될 텐서는 메모리를 잡지 않고 bindings()에서도 빠진다(인덱스는 유지, data(i) == nullptr)
+  // - 반환값은 이번 호출로 새로 제외된 바이트. 지정은 누적된다(build_from_qnnjson()에서 초기화)
+  std::uint64_t set_external(const std::set<std::string>& names);
+  bool is_external(std::size_t index) const { return index < entries_.size() && entries_[index].external; }
+  std::size_t num_external() const;
+  std::uint64_t external_bytes() const;
+
+  // 입력/출력 구분(입력과 출력에 같은 이름이 있으면 출력으로 본다)
+  bool is_output(std::size_t index) const { return index < entries_.size() && entries_[index].is_output; }
+
+  // 외부 배치: 메모리를 직접 할당하지 않고 텐서별 주소를 받아 바인딩만 구성(QNNIOPlanner 풀)
+  // - ptrs.size()는 num_tensors()와 같아야 하며, 메모리 소유권은 호출자에게 있다
+  // - 이후 release()는 주소만 비우고 해제하지 않는다
+  bool adopt(const std::vector<void*>& ptrs);
+  bool adopted() const { return adopted_; }
+
+  // 모든 버퍼를 0으로 채워 첫 접근 페이지 폴트를 미리 발생시킨다(워밍업용)
+  // - 반환값은 터치한 총 바이트(adopt()된 경우 0: 풀 소유자가 터치)
+  std::uint64_t prefault();
 
   // 보유 중인 모든 버퍼 해제(멱등)
   void release();
@@ -36,11 +96,48 @@ public:
 private:
   static bool is_pow2(std::size_t v) { return v && ((v & (v - 1)) == 0); }
 
-  std::map<std::string, std::uint64_t> name_to_nbytes_;
+  struct Entry {
+    std::string name;
+    std::uint64_t nbytes {0};
+    std::uint64_t offset {0};
+    void* ptr {nullptr};
+    bool is_output {false};
+    bool external {false};   // 다른 버퍼에 바인딩됨(할당하지 않음)
+  };
+
+  std::uint64_t allocate_arena(std::size_t alignment);
+  std::uint64_t allocate_per_tensor(std::size_t alignment);
+
+  Options options_;
+  std::vector<Entry> entries_;
+  std::map<std::string, int> name_to_index_;
   std::map<std::string, void*> name_to_ptr_;
   std::uint64_t total_allocated_bytes_ {0};
-};
+  std::uint64_t mapped_bytes_ {0};
+  std::size_t num_regions_ {0};
 
-} // namespace llm_test
+  // arena slab
+  void* arena_ {nullptr};
+  std::size_t arena_bytes_ {0};
+  bool arena_hugetlb_ {false};
+  bool adopted_ {false};
+};
 
+// 익명 mmap slab(arena와 QNNIOPlanner 풀이 공유)
+// - kHugeTLB: MAP_HUGETLB 시도 후 실패하면 THP로 폴백
+// - kTransparent: 2MB 이상이면 2MB 단위로 반올림 후 madvise(MADV_HUGEPAGE)
+struct IOSlab {
+  void* base {nullptr};
+  std::size_t bytes {0};   // 매핑된 바이트(페이지/huge page 반올림 포함)
+  bool hugetlb {false};
+};
+bool map_io_slab(std::uint64_t bytes, QNNIOAllocator::HugePages huge_pages, IOSlab& slab);
+// map_io_slab()이 매핑할 바이트(페이지/THP 반올림, kHugeTLB는 2MB 반올림). 메모리 예산 추정용
+std::uint64_t io_slab_bytes(std::uint64_t bytes, QNNIOAllocator::HugePages huge_pages);
+void unmap_io_slab(IOSlab& slab);
+// 읽기 전용 0 slab(PROT_READ 익명 매핑): 쓰지 않으므로 모든 페이지가 커널의 0 페이지 하나를 공유
+// - 수백 개의 텐서가 같은 주소를 입력으로 바인딩해도 실제 RSS는 거의 늘지 않는다
+// - 해제는 unmap_io_slab()
+bool map_zero_slab(std::uint64_t bytes, IOSlab& slab);
 
+} // namespace llm_test
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "io_alloc.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace llm_test {
+
+// 수명(liveness) 기반 I/O 메모리 플래너
+// - 그래프마다 slab을 따로 두는 대신, 여러 QNNIOAllocator의 텐서를 공유 풀 하나에 배치한다
+// - 각 그래프는 "실행 스텝" 하나를 가진다. 입력은 그 스텝에만, 출력은 output_hold 스텝 뒤까지 살아 있다
+//   (예: shard i의 KV 출력은 shard i+1 실행 중 writeback 되므로 hold=1)
+// - 수명 구간이 겹치지 않는 텐서끼리만 같은 주소 범위를 공유한다
+//   (prefill ↔ decode 그래프, 인접하지 않은 shard끼리)
+// - 배치는 크기 내림차순 greedy(겹치는 구간을 가진 텐서 사이의 가장 작은 빈틈에 배치)
+// - 스텝 사이에 값이 유지되어야 하는 텐서(ROPE/hidden 전달 버퍼, KV cache)는 플래너 밖에서 관리한다
+//   · 입력은 매 실행 직전에 다시 채워진다고 가정(shared buffer memcpy / 토큰·위치·마스크 재작성)
+class QNNIOPlanner {
+public:
+  explicit QNNIOPlanner(const QNNIOAllocator::Options& options = QNNIOAllocator::Options());
+  ~QNNIOPlanner() { release(); }
+  QNNIOPlanner(const QNNIOPlanner&) = delete;
+  QNNIOPlanner& operator=(const QNNIOPlanner&) = delete;
+
+  // build_from_qnnjson()까지 끝난 allocator 등록(메모리는 allocate()에서 배치)
+  // - exec_step: 그래프가 실행되는 스텝(단계가 다르면 스텝 범위가 겹치지 않게 부여)
+  // - output_hold: 출력이 실행 후 몇 스텝 더 읽히는지
+  void add_graph(QNNIOAllocator* alloc, int exec_step, int output_hold = 1);
+
+  // 수명 계산 → 오프셋 배정 → slab 매핑 → 각 allocator에 adopt(). 실패 시 false
+  bool allocate();
+
+  // 수명 계산 + 오프셋 배정만 수행(매핑 없음): 메모리 예산 추정용. 반환값은 pool_bytes()
+  std::uint64_t plan();
+
+  // 풀 크기(배정된 최대 끝 오프셋)
+  std::uint64_t pool_bytes() const { return pool_bytes_; }
+  // 그래프별 arena로 따로 할당했을 때의 바이트 합(같은 정렬 + 페이지 반올림, THP 반올림 제외)
+  std::uint64_t separate_bytes() const { return separate_bytes_; }
+  // 실제 매핑된 바이트(페이지/huge page 반올림 포함)
+  std::uint64_t mapped_bytes() const { return slab_.bytes; }
+  std::size_t num_graphs() const { return graphs_.size(); }
+  std::size_t num_buffers() const { return buffers_.size(); }
+  bool uses_hugetlb() const { return slab_.hugetlb; }
+
+  // 풀 전체를 0으로 채워 페이지 폴트를 미리 발생(워밍업용). 반환값은 터치한 바이트
+  std::uint64_t prefault();
+
+  // 풀 해제(멱등). adopt()된 allocator의 주소가 무효가 되므로 이후 그래프를 실행하면 안 된다
+  void release();
+
+private:
+  struct Graph {
+    QNNIOAllocator* alloc {nullptr};
+    int exec_step {0};
+    int output_hold {1};
+  };
+
+  struct Buffer {
+    std::size_t graph {0};
+    std::size_t index {0};  // allocator 내부 텐서 인덱스
+    std::uint64_t nbytes {0};
+    int first {0};          // 살아 있는 스텝 구간 [first, last]
+    int last {0};
+    std::uint64_t offset {0};
+  };
+
+  std::size_t alignment() const;
+
+  QNNIOAllocator::Options options_;
+  std::vector<Graph> graphs_;
+  std::vector<Buffer> buffers_;
+  IOSlab slab_;
+  std::uint64_t pool_bytes_ {0};
+  std::uint64_t separate_bytes_ {0};
+};
+
+} // namespace llm_test
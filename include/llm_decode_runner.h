@@ -1,17 +1,29 @@
 #pragma once
 
 #include "qnn_loader.h"
+#include "qnn_power_policy.h"
+#include "qnn_profiler.h"
 #include "qnn_qnnjson.h"
 #include "qnn_tensor_util.h"
 #include "io_alloc.h"
+#include "io_planner.h"
+#include "llm_execution_plan.h"
 #include "llm_kv_cache_manager.h"
 #include "llm_kv_cache_mapper.h"
+#include "llm_memory_budget.h"
+#include "llm_prefix_cache.h"
 #include "llm_stats.h"
 #include "llm_output_processor.h"
 #include "tokenizer_llama.h"
 #include "model_params.h"
+#include "thread_pool.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <memory>
 
@@ -30,6 +42,49 @@ struct LLMDecodeConfig {
   int log_level = 0;            // 0=quiet, 1=info, 2=debug
   bool use_multi_context = false; // Enable multi-context (sharding) mode
   int num_shards = 0;           // Number of context shards (0=auto-detect, default)
+  bool use_async_exec = true;   // Overlap host work with graphExecuteAsync (falls back to sync)
+  int profile_level = 0;        // QNN profiling: 0=off, 1=basic, 2=detailed (per-op)
+  std::string profile_out = "qnn_profile"; // Output prefix: <prefix>_summary.json, <prefix>_trace.json
+  int load_threads = 0;         // Shard loader threads (0=auto, min(4, cores))
+  int load_inflight_mb = 2048;  // Max context binary MB held in memory while loading (0=unlimited)
+  bool use_list_async_load = true; // Use contextCreateFromBinaryListAsync when all shards fit the budget
+  bool use_mmap_load = true;    // mmap context binaries (false = read into heap buffers)
+  int warmup_iters = 0;         // Synthetic prefill+decode steps after initialize (0=off)
+  bool warmup_async = false;    // Run warm-up on a background thread (generate() waits for it)
+  bool streaming_load = false;  // Multi-context: create shard contexts in the background;
+                                // prefill runs shard k as soon as it is loaded
+  std::string power_policy = "adaptive"; // HTP power: adaptive (burst/sustained/relaxed per phase),
+                                         // burst (single permanent vote), off
+  int power_idle_ms = 2000;     // Adaptive: idle time before relaxing the vote
+  int power_debounce_ms = 50;   // Adaptive: minimum hold time before a downgrade
+  std::string log_sink = "stdout"; // Async log sink: stdout | file | logcat
+  std::string log_file;         // Output path when log_sink == "file"
+  int log_ring_records = 4096;  // Async log ring size in records (0 = synchronous stdout)
+  bool io_arena = true;         // Graph I/O tensors in one page-aligned slab per graph
+  int io_alignment = 64;        // Per-tensor alignment inside the slab (power of two)
+  std::string io_huge_pages = "thp"; // Slab backing: none | thp (madvise) | hugetlb (MAP_HUGETLB)
+  bool io_plan = true;          // Liveness planner: graphs that never run concurrently
+                                // (prefill vs decode, non-adjacent shards) share one I/O pool
+  std::string kv_huge_pages = "thp"; // KV cache slab backing: none | thp | hugetlb
+  bool kv_mlock = false;        // mlock the KV cache slab (needs RLIMIT_MEMLOCK headroom)
+  int kv_rearrange_threads = 0; // Prefill → decode rearrange workers (0 = auto, min(4, cores); 1 = inline)
+  bool direct_v_binding = true; // Decode: bind V outputs at their cache row each step (no V copy)
+  bool zero_copy_dataflow = true; // Multi-context: bind hidden state (ping-pong), ROPE and mask
+                                  // buffers across shards instead of copying through shared buffers
+  bool async_kv_writeback = true; // Multi-context: shard N's KV writeback runs on a worker thread
+                                  // while shard N+1 executes (synced before the next inputs are set)
+  bool zero_kv_prefill = true;  // Prompts of at most one prefill chunk: KV inputs read one shared
+                                // zero slab, K is written at decode stride and rearrange is skipped
+  bool context_shift = true;    // KV cache full: keep sink + recent positions (StreamingLLM) and
+                                // re-rotate shifted K instead of failing; false = stop generating
+                                // (also the behavior without params.json or per-tensor K encodings)
+  int shift_sink_tokens = 4;    // Leading positions every shift keeps (attention sinks)
+  int shift_discard = 0;        // Positions dropped per shift (0 = half of the non-sink window)
+  int prefix_cache_mb = 0;      // Prefix KV cache cap: full prefill chunks shared by prompts with a
+                                // common prefix are restored instead of re-prefilled (0 = off);
+                                // counted in max_memory_bytes
+  uint64_t max_memory_bytes = 0; // Host memory budget (0 = unlimited): picks the I/O pool, mmap
+                                 // and load concurrency to fit; initialize() fails if it cannot
 };
 
 /**
@@ -38,7 +93,9 @@ struct LLMDecodeConfig {
  * Manages:
  * - QNN context loading and graph execution
  * - KV cache allocation and mapping
- * - Prefill → Decode transition (rearrange_cache)
+ * - Prefill → Decode transition (rearrange_cache, skipped for single-chunk prompts)
+ * - Context shifting when prompt + generation exceed the KV capacity
+ * - Prefix KV cache across generate() calls (shared system prompt / template)
  * - Token generation loop
  */
 class LLMDecodeRunner {
@@ -60,6 +117,28 @@ class LLMDecodeRunner {
    */
   bool generate(const std::string& prompt, std::string& output_text);
   
+  /**
+   * @brief Absorb cold-start costs before the first real request
+   *
+   * Pre-faults every buffer owned by QNNIOAllocator and LLMKVCacheManager,
+   * then runs synthetic prefill and decode executions through every shard.
+   * KV cache contents are left untouched. Must not run concurrently with
+   * generate(); initialize() calls it automatically when warmup_iters > 0.
+   * @param iterations Synthetic steps per graph (<= 0: config warmup_iters, at least 1)
+   * @return true on success
+   */
+  bool warmup(int iterations = 0);
+  
+  /**
+   * @brief Readiness flag for servers: true once initialize() and any warm-up finished
+   */
+  bool is_ready() const { return ready_.load(std::memory_order_acquire); }
+  
+  /**
+   * @brief Block until a background warm-up or streaming load has finished
+   */
+  void wait_until_ready();
+  
   /**
    * @brief Get last error message
    */
@@ -71,12 +150,18 @@ class LLMDecodeRunner {
   const LLMStats& get_stats() const { return stats_; }
   
  private:
+  // Host tests (tests/) drive the prefill/decode steps directly
+  friend struct LLMDecodeRunnerTestAccess;
+
   // Configuration
   LLMDecodeConfig config_;
   std::string error_msg_;
   
   // QNN components
   std::unique_ptr<QnnLoader> loader_;
+  std::unique_ptr<QnnProfiler> profiler_;  // Declared after loader_: released before the backend
+  HtpPowerPolicy* power_policy_ = nullptr;  // Owned by the shared backend session
+  int power_voter_ = 0;
   
   // Single-context mode
   std::map<std::string, QnnJsonGraphDesc> graphs_;
@@ -93,16 +178,29 @@ class LLMDecodeRunner {
     std::unique_ptr<QNNIOAllocator> prefill_alloc;
     std::unique_ptr<QNNIOAllocator> kv_alloc;
     
-    // Tensor holders for zero-copy binding
-    std::vector<std::unique_ptr<QnnTensorHolder>> prefill_input_holders;
-    std::vector<std::unique_ptr<QnnTensorHolder>> prefill_output_holders;
-    std::vector<std::unique_ptr<QnnTensorHolder>> kv_input_holders;
-    std::vector<std::unique_ptr<QnnTensorHolder>> kv_output_holders;
+    // Zero-copy dataflow: tensor name -> shared buffer it is bound to (empty = copy path)
+    std::map<std::string, void*> prefill_dataflow;
+    std::map<std::string, void*> kv_dataflow;
+    
+    // Pre-bound execution plans (built once in initialize)
+    ExecutionPlan prefill_plan;
+    ExecutionPlan kv_plan;
   };
   std::vector<ShardInfo> shards_;
   
   // Shared buffers across shards
-  std::map<std::string, void*> shared_buffer_views_; // hidden_state, rope_cos, rope_sin, attention_mask
+  struct SharedBuffers {
+    void* hidden_state = nullptr;
+    void* hidden_state_alt = nullptr;  // Second ping-pong buffer (zero-copy dataflow only)
+    void* rope_cos = nullptr;
+    void* rope_sin = nullptr;
+    void* attention_mask = nullptr;
+    size_t hidden_bytes = 0;           // Capacity of each buffer above
+    size_t rope_bytes = 0;
+    size_t mask_bytes = 0;
+  };
+  SharedBuffers shared_buffers_;
+  bool dataflow_ = false;  // Shard hidden/ROPE/mask tensors are bound to shared_buffers_
   
   // Model metadata
   ModelParams model_params_;    // Parsed from params.json
@@ -120,18 +218,27 @@ class LLMDecodeRunner {
   std::unique_ptr<LLMKVCacheManager> kv_manager_;
   std::vector<KVCacheTensorInfo> prefill_kv_mapping_;
   std::vector<KVCacheTensorInfo> kv_kv_mapping_;
-  std::map<std::string, void*> prefill_kv_override_;
-  std::map<std::string, void*> kv_kv_override_;
   
   // I/O allocators (single-context only)
   std::unique_ptr<QNNIOAllocator> prefill_alloc_;
   std::unique_ptr<QNNIOAllocator> kv_alloc_;
   
-  // Pre-built QNN tensors (single-context only, reused across executions)
-  std::vector<std::unique_ptr<QnnTensorHolder>> prefill_input_holders_;
-  std::vector<std::unique_ptr<QnnTensorHolder>> prefill_output_holders_;
-  std::vector<std::unique_ptr<QnnTensorHolder>> kv_input_holders_;
-  std::vector<std::unique_ptr<QnnTensorHolder>> kv_output_holders_;
+  // Liveness-planned pool backing every allocator above (config_.io_plan)
+  std::unique_ptr<QNNIOPlanner> io_planner_;
+  
+  // Prefix KV cache (config_.prefix_cache_mb), created after the KV cache
+  std::unique_ptr<LLMPrefixCache> prefix_cache_;
+  
+  // Zero-KV prefill (config_.zero_kv_prefill): read-only zero slab for every prefill KV input
+  IOSlab zero_kv_;
+  bool prefill_zero_kv_ = false;  // Current prefill uses zero_kv_ and writes K at kv_cache_len_ stride
+  
+  // Estimated footprint chosen by apply_memory_budget() (load bytes reused by the final check)
+  LLMMemoryBudget::Footprint memory_estimate_;
+  
+  // Pre-bound execution plans (single-context only, reused across executions)
+  ExecutionPlan prefill_plan_;
+  ExecutionPlan kv_plan_;
   
   // Tokenizer
   std::unique_ptr<LlamaTokenizer> tokenizer_;
@@ -139,27 +246,54 @@ class LLMDecodeRunner {
   // Performance statistics
   LLMStats stats_;
   
+  // Readiness / background warm-up
+  std::atomic<bool> ready_{false};
+  std::thread warmup_thread_;
+  
+  // Streaming start-up (multi-context): shards [0, shards_loaded_) have contexts + plans
+  std::vector<std::string> shard_context_files_;
+  std::thread stream_thread_;
+  std::mutex stream_mu_;
+  std::condition_variable stream_cv_;
+  std::atomic<int> shards_loaded_{0};
+  std::atomic<bool> stream_cancel_{false};
+  bool stream_failed_ = false;
+  std::string stream_error_;
+  
   // Helper methods (single-context)
   bool load_graphs();
+  bool load_graph_context();
   bool extract_metadata();
   bool setup_kv_cache();
   bool setup_io_allocators();
   
   // Helper methods (multi-context)
   bool load_multi_context_graphs();
+  bool load_multi_context_binaries();
+  bool load_shard_contexts(const std::vector<std::string>& context_files);
   bool extract_multi_context_metadata();
   bool setup_multi_context_kv_cache();
   bool setup_multi_context_io_allocators();
   bool allocate_shared_buffers();
+  bool plan_shard_dataflow();
+  bool build_multi_context_plans();
+  bool build_shard_plans(int shard_idx, std::string& error);
+  
+  // Streaming start-up: background loader in shard order + per-shard readiness wait
+  bool start_streaming_load();
+  void stream_load_shards();
+  bool wait_shard_ready(int shard_idx);
   
   // Single-context execution
   bool run_prefill(const std::vector<int32_t>& tokens, 
                    int32_t& next_token,
                    int32_t& n_update);
   
+  // host_work (optional) runs on the host while the accelerator executes
   bool run_decode_step(int32_t token_in,
                        int32_t n_past,
-                       int32_t& token_out);
+                       int32_t& token_out,
+                       const std::function<void()>* host_work = nullptr);
   
   // Multi-context execution
   bool run_multi_context_prefill(const std::vector<int32_t>& tokens,
@@ -168,16 +302,107 @@ class LLMDecodeRunner {
   
   bool run_multi_context_decode_step(int32_t token_in,
                                       int32_t n_past,
-                                      int32_t& token_out);
+                                      int32_t& token_out,
+                                      const std::function<void()>* host_work = nullptr);
   
   // Shard execution helpers
+  // writeback_shard: previous shard whose KV outputs are written back while this shard executes (-1 = none)
   bool run_shard_prefill(int shard_idx,
                          const std::vector<int32_t>& tokens,
                          int32_t n_past,
-                         int32_t n_update);
+                         int32_t n_update,
+                         int writeback_shard = -1);
   
   bool run_shard_decode(int shard_idx,
-                        int32_t n_past);
+                        int32_t n_past,
+                        int writeback_shard = -1,
+                        const std::function<void()>* host_work = nullptr);
+  
+  // KV cache writeback from a shard's outputs into LLMKVCacheManager
+  void writeback_shard_prefill_kv(int shard_idx, int32_t n_past, int32_t chunk_size);
+  void writeback_shard_decode_kv(int shard_idx, int32_t n_past);
+  // KV writeback of one shard, on kv_worker_ (async_kv_writeback) or inline
+  struct KVWritebackJob {
+    int shard = -1;
+    int32_t n_past = 0;
+    int32_t n_update = 0;   // Prefill chunk size, 0 = decode step
+  };
+  std::unique_ptr<SerialWorker<KVWritebackJob>> kv_worker_;
+  int64_t kv_writeback_us_[2] = {0, 0};  // [prefill, decode] writeback time (worker-owned until synced)
+  int64_t kv_blocked_us_[2] = {0, 0};    // [prefill, decode] time the caller waited on the worker
+  void submit_kv_writeback(const KVWritebackJob& job);
+  void run_kv_writeback(const KVWritebackJob& job);
+  void sync_kv_writeback(bool decode);
+  void flush_kv_writeback_stats();
+  
+  // Direct V binding: point a decode plan's V outputs at cache row n_past
+  void bind_decode_v_outputs(ExecutionPlan& plan, int32_t n_past);
+  
+  // Zero-KV prefill: map zero_kv_ after the KV cache, choose the path per prompt,
+  // bind a prefill plan's KV inputs to zero_kv_ or back to the cache
+  bool setup_zero_kv();
+  void begin_prefill(int32_t num_tokens);
+  void bind_prefill_kv_inputs(ExecutionPlan& plan);
+  // Row stride of prefill K writeback: kv_cache_len_ on the zero-KV path
+  int32_t prefill_k_stride() const { return prefill_zero_kv_ ? kv_cache_len_ : prefill_cache_len_; }
+  // Prefill → decode KV layout for n_past occupied positions (rearrange or zero-KV no-op)
+  void finish_prefill_layout(int32_t n_past);
+  
+  // Prefix cache: cap from config (and the memory budget headroom); restore the longest cached
+  // chunk-aligned prefix before prefill (returns positions restored, always < tokens.size());
+  // store the full chunks of positions [0, n_positions) that still hold tokens[0, n_positions)
+  void setup_prefix_cache();
+  int32_t restore_prefix(const std::vector<int32_t>& tokens);
+  void store_prefix(const std::vector<int32_t>& tokens, int32_t n_positions);
+  
+  // Context shift: make room for `incoming` positions in the current layout (prefill or
+  // decode capacity) by dropping the oldest non-sink positions; n_past is updated
+  bool shift_context(int32_t& n_past, int32_t incoming, bool decode);
+  // K quantization encodings + RoPE frequencies for the re-rotation (first shift only)
+  void setup_context_shift();
+  // config_.context_shift and every K head can be re-rotated; otherwise a full cache stops
+  // decode and an over-long prompt fails, as with context_shift = false
+  bool context_shift_usable();
+  bool context_shift_ready_ = false;
+  bool context_shift_usable_ = false;
+  
+  // One synthetic execution of a plan (token 0, positions from 0, causal mask)
+  bool warmup_execute(ExecutionPlan& plan, int32_t ar_len);
+  
+  // I/O allocator options from config + footprint accounting
+  QNNIOAllocator::Options io_alloc_options() const;
+  LLMKVCacheManager::Options kv_cache_options() const;
+  void record_io_alloc(const QNNIOAllocator& alloc);
+  void record_io_graph(const std::string& label, const QnnJsonGraphDesc& graph,
+                       const QNNIOAllocator& alloc);
+  // KV cache inputs are bound to LLMKVCacheManager by the plans: keep them out of the allocator
+  void exclude_kv_inputs(QNNIOAllocator& alloc, const QnnJsonGraphDesc& graph,
+                         const ExecutionPlan::Layout& layout,
+                         const std::vector<KVCacheTensorInfo>* kv_mapping,
+                         const std::string& label);
+  // Places every registered allocator (planner) or gives each its own slab
+  bool allocate_io(const std::vector<std::pair<QNNIOAllocator*, int>>& graphs);
+  
+  // Memory budget (max_memory_bytes): estimate from graph metadata, adjust config_ strategies
+  // before anything large is allocated, then verify the allocated footprint
+  LLMMemoryBudget::Estimate estimate_memory() const;
+  bool apply_memory_budget();
+  bool check_memory_budget();
+  // Shared buffer sizes (multi-context): hidden state, each ROPE table, attention mask
+  void shared_buffer_sizes(size_t& hidden, size_t& rope, size_t& mask) const;
+  uint64_t shared_buffer_bytes() const;
+  
+  // Power policy helpers (no-ops unless power_policy == "adaptive")
+  bool setup_power_policy();
+  void set_power_phase(RunnerPhase phase);
+  void update_power_stats();
+  
+  // Profiling helpers (no-ops when profiling is off)
+  Qnn_ProfileHandle_t create_profile(const std::string& scope, int shard, const std::string& graph);
+  void collect_profile(Qnn_ProfileHandle_t profile, int64_t start_us);
+  void attach_plan_profiles(ExecutionPlan& prefill_plan, ExecutionPlan& kv_plan,
+                            int shard, const std::string& prefix);
+  void write_profile_report();
 };
 
 } // namespace llm_test
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "qnn_loader.h"
+#include "qnn_qnnjson.h"
+#include "qnn_tensor_util.h"
+#include "llm_kv_cache_mapper.h"
+
+#include <QnnTypes.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace llm_test {
+
+/**
+ * @brief Precompiled execution plan for one (context, graph) pair
+ *
+ * Built once in initialize(). Holds the cached Qnn_GraphHandle_t, fixed
+ * contiguous input/output Qnn_Tensor_t arrays with client buffers already
+ * bound, and integer slots for every tensor the runner touches per step.
+ * The hot path only writes values into slot buffers and calls execute():
+ * no graphRetrieve, no name lookups, no per-step vector construction.
+ *
+ * The graph descriptor passed to build() must outlive the plan.
+ */
+class ExecutionPlan {
+ public:
+  /**
+   * @brief Shape information needed to classify KV cache tensors
+   */
+  struct Layout {
+    int layer_base = 0;   // First global layer served by this graph (shard offset)
+    int num_layers = 0;   // Total model layers (KV tensors beyond this stay unbound to the cache)
+    int num_heads = 0;
+    int head_dim = 0;
+    int ar_len = 0;       // Tokens per execution (prefill_ar_len or kv_ar_len)
+  };
+
+  /**
+   * @brief KV cache tensor slot with its global (layer, head)
+   */
+  struct KVSlot {
+    int slot;
+    int layer;
+    int head;
+    bool is_v;
+  };
+
+  /**
+   * @brief What the runner uses a tensor for (slot classification in build())
+   */
+  enum class Role { kOther, kKV, kToken, kPos, kMask, kHidden, kRopeCos, kRopeSin, kLogits };
+
+  /// Returns the host buffer for a non-KV tensor (nullptr = tensor is skipped)
+  using BufferResolver = std::function<void*(const QnnJsonTensorDesc&)>;
+  /// Returns the KV cache input buffer for (global layer, head)
+  using KVResolver = std::function<void*(int layer, int head, bool is_v)>;
+
+  ExecutionPlan() = default;
+  ExecutionPlan(const ExecutionPlan&) = delete;
+  ExecutionPlan& operator=(const ExecutionPlan&) = delete;
+  ExecutionPlan(ExecutionPlan&&) = default;
+  ExecutionPlan& operator=(ExecutionPlan&&) = default;
+
+  /**
+   * @brief Retrieve the graph handle and bind every I/O tensor once
+   * @param loader Loader owning the context
+   * @param ctx_index Context index in the loader
+   * @param graph Graph descriptor parsed from QNN JSON
+   * @param layout KV cache shape information
+   * @param resolve Buffer lookup for non-KV tensors
+   * @param kv_resolve Buffer lookup for KV cache inputs
+   * @param kv_mapping Optional name-based KV mapping (single-context);
+   *        when null, KV inputs are assigned by order of appearance (multi-context)
+   * @return true on success
+   */
+  bool build(QnnLoader& loader,
+             size_t ctx_index,
+             const QnnJsonGraphDesc& graph,
+             const Layout& layout,
+             const BufferResolver& resolve,
+             const KVResolver& kv_resolve,
+             const std::vector<KVCacheTensorInfo>* kv_mapping = nullptr);
+
+  /**
+   * @brief Names of the inputs build() binds to the KV cache instead of resolve()
+   *
+   * Same classification as build(), so allocators can skip these tensors
+   * (QNNIOAllocator::set_external) before allocate().
+   */
+  static std::set<std::string> kv_input_names(const QnnJsonGraphDesc& graph,
+                                              const Layout& layout,
+                                              const std::vector<KVCacheTensorInfo>* kv_mapping = nullptr);
+
+  /**
+   * @brief Role of a non-KV input, by the same name rules as build()
+   */
+  static Role input_role(const QnnJsonTensorDesc& t);
+
+  /**
+   * @brief Role of an output, by the same rules as build()
+   *
+   * kLogits is returned for name matches only; build() additionally falls
+   * back to the largest unclassified output. When several outputs share a
+   * role, build() keeps the last one (logits: the first).
+   */
+  static Role output_role(const QnnJsonTensorDesc& t, const Layout& layout);
+
+  /**
+   * @brief Execute the graph with the pre-bound tensors
+   */
+  bool execute(QnnLoader& loader);
+
+  /**
+   * @brief Submit the graph asynchronously (falls back to sync inside the loader)
+   * @return Completion token; slot buffers must not be touched until wait() returns
+   */
+  QnnExecFuture execute_async(QnnLoader& loader);
+
+  bool valid() const { return graph_ != nullptr; }
+  Qnn_GraphHandle_t graph_handle() const { return graph_; }
+  size_t num_inputs() const { return inputs_.size(); }
+  size_t num_outputs() const { return outputs_.size(); }
+
+  void* input_data(int slot) const { return inputs_[slot].v2.clientBuf.data; }
+  void* output_data(int slot) const { return outputs_[slot].v2.clientBuf.data; }
+  const QnnJsonTensorDesc& input_desc(int slot) const { return *input_descs_[slot]; }
+  const QnnJsonTensorDesc& output_desc(int slot) const { return *output_descs_[slot]; }
+  uint64_t input_bytes(int slot) const { return input_descs_[slot]->nbytes; }
+  uint64_t output_bytes(int slot) const { return output_descs_[slot]->nbytes; }
+
+  /// Attach a QNN profile handle to every execution (nullptr = profiling off)
+  void set_profile(Qnn_ProfileHandle_t profile) { profile_ = profile; }
+  Qnn_ProfileHandle_t profile() const { return profile_; }
+
+  /// Rebind a slot to a different host buffer (no allocation)
+  void bind_input(int slot, void* data) { inputs_[slot].v2.clientBuf.data = data; }
+  void bind_output(int slot, void* data) { outputs_[slot].v2.clientBuf.data = data; }
+
+  // Input slots (-1 = not present in this graph)
+  int token_in = -1;
+  int pos_in = -1;
+  int mask_in = -1;
+  int hidden_in = -1;
+  int rope_cos_in = -1;
+  int rope_sin_in = -1;
+
+  // Output slots (-1 = not present in this graph)
+  int hidden_out = -1;
+  int rope_cos_out = -1;
+  int rope_sin_out = -1;
+  int logits_out = -1;
+
+  // KV cache slots in graph order (layer-major, head-minor)
+  std::vector<KVSlot> kv_in;
+  std::vector<KVSlot> v_out;
+  std::vector<KVSlot> k_out;
+
+ private:
+  void reset();
+
+  Qnn_GraphHandle_t graph_ {nullptr};
+  size_t ctx_index_ {0};
+  Qnn_ProfileHandle_t profile_ {nullptr};
+  std::vector<std::unique_ptr<QnnTensorHolder>> holders_;   // own names/dims referenced by tensors
+  std::vector<const QnnJsonTensorDesc*> input_descs_;
+  std::vector<const QnnJsonTensorDesc*> output_descs_;
+  std::vector<Qnn_Tensor_t> inputs_;
+  std::vector<Qnn_Tensor_t> outputs_;
+};
+
+} // namespace llm_test
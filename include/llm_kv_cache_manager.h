@@ -1,5 +1,8 @@
 #pragma once
 
+#include "io_alloc.h"
+#include "thread_pool.h"
+
 #include <cstdint>
 #include <vector>
 #include <memory>
@@ -18,9 +21,18 @@ namespace llm_test {
  * - Update cache: copy output → input after each step
  * - Update attention mask for each iteration
  * - Provide memory pointers for graph binding
+ *
+ * Storage: one page-aligned slab, layer-major, every buffer at a kAlignment offset
+ *   [cache region]   layer 0: head 0 K in, head 0 V in, head 1 K in, ... | layer 1: ...
+ *   [staging region] layer 0: head 0 K out, head 0 V out, head 1 K out, ... | layer 1: ...
+ * get_k_cache()/get_v_cache() return views into it. The cache region (all persistent
+ * K/V) is contiguous, so clear/snapshot/copy of the whole cache is a single memset/memcpy.
  */
 class LLMKVCacheManager {
 public:
+  static constexpr size_t kAlignment = 64;  // Offset alignment of every buffer in the slab
+  
+
   struct Metadata {
     int32_t context_len;      // Total context length (e.g., 256)
     int32_t head_dim;         // Attention head dimension (e.g., 64)
@@ -40,15 +52,50 @@ public:
     size_t output_bytes;
   };
 
+  /**
+   * @brief Slab placement
+   */
+  struct Options {
+    QNNIOAllocator::HugePages huge_pages = QNNIOAllocator::HugePages::kTransparent;
+    bool lock = false;    // mlock the slab (falls back to unlocked if RLIMIT_MEMLOCK is too low)
+    int rearrange_threads = 0;  // rearrange_cache() workers: 0 = auto (min(4, cores)), 1 = caller only
+  };
+
   LLMKVCacheManager(const Metadata& metadata);
   ~LLMKVCacheManager();
+  LLMKVCacheManager(const LLMKVCacheManager&) = delete;
+  LLMKVCacheManager& operator=(const LLMKVCacheManager&) = delete;
+
+  /**
+   * @brief Bytes allocate() will need for a metadata (input + output buffers, aligned)
+   */
+  static size_t required_bytes(const Metadata& metadata);
 
   /**
-   * @brief Allocate all KV cache memory
+   * @brief Slab placement used by the next allocate()
+   */
+  void set_options(const Options& options) { options_ = options; }
+  const Options& options() const { return options_; }
+
+  /**
+   * @brief Map the slab (zero-filled) and set up the per-head views
    * @return true if successful
    */
   bool allocate();
 
+  /**
+   * @brief Zero every persistent K/V buffer (one memset over the cache region)
+   */
+  void clear();
+
+  /**
+   * @brief Persistent K/V buffers of all layers/heads as one contiguous region
+   *
+   * Staging (output) buffers are not included. Use for whole-cache snapshot/copy.
+   */
+  void* cache_data() const { return slab_.base; }
+  size_t cache_bytes() const { return cache_bytes_; }
+
   /**
    * @brief Update KV cache: copy output → input
    * @param n_past Number of past tokens already in cache
@@ -94,11 +141,27 @@ public:
     return v_cache_[layer][head];
   }
 
+  /**
+   * @brief Touch every page of every KV buffer (contents preserved)
+   *
+   * Forces first-touch page faults up front so the first prefill does not
+   * pay them. Safe to call at any time; the cache contents are unchanged.
+   * @return Number of bytes covered
+   */
+  size_t prefault();
+
   /**
    * @brief Get total allocated memory size
    */
   size_t total_cache_size() const { return total_cache_size_; }
 
+  /**
+   * @brief Bytes actually mapped (page / huge page rounding included)
+   */
+  size_t mapped_bytes() const { return slab_.bytes; }
+  bool uses_hugetlb() const { return slab_.hugetlb; }
+  bool locked() const { return locked_; }
+
   /**
    * @brief Get metadata
    */
@@ -111,12 +174,57 @@ public:
    * - Prefill (AR=32): cache_len = context_len - 32 = 480
    * - Decode (AR=1):   cache_len = context_len - 1  = 511
    * 
-   * Prefill→Decode 전환 시 480→511로 메모리 재배치 필요
+   * Prefill→Decode 전환 시 480→511로 메모리 재배치 필요. 반대 방향(511→480, 멀티턴에서
+   * decode 뒤 다시 prefill)도 지원한다.
+   * 
+   * 점유 인식: K의 각 행에서 앞쪽 n_past 바이트만 옮긴다. 위치 >= n_past는 두 레이아웃 모두
+   * attention mask로 가려지므로 0으로 채우지 않는다(다음 그래프가 읽는 값은 [0, n_past)뿐).
+   * 옮길 바이트가 충분히 크면 layer 단위로 작업 스레드에 나눈다(Options::rearrange_threads).
    * 
    * @param src_ar_len Source AR length (e.g., 32 for prefill)
    * @param dst_ar_len Destination AR length (e.g., 1 for decode)
+   * @param n_past Occupied positions (< 0: every position of the smaller layout)
+   */
+  void rearrange_cache(int32_t src_ar_len, int32_t dst_ar_len, int32_t n_past = -1);
+  
+  /**
+   * @brief Mark the cache as already laid out for ar_len (no data movement)
+   *
+   * prefill이 K를 decode stride로 직접 기록한 경우(zero-KV prefill) rearrange_cache() 대신 호출
+   */
+  void set_layout_ar_len(int32_t ar_len) { cur_ar_len_ = ar_len; }
+  
+  /**
+   * @brief K 캐시 양자화 인코딩(per-tensor, uint8): real = (q + offset) * scale
+   *
+   * shift_cache()의 RoPE 재회전에 사용. 설정하지 않은(scale == 0) head는 행 이동만 한다.
+   */
+  void set_key_encoding(int32_t layer, int32_t head, float scale, int32_t offset);
+  
+  /**
+   * @brief RoPE 역주파수(head_dim / 2개). 비어 있으면 shift_cache()는 재회전하지 않는다
+   *
+   * 회전 쌍은 (i, i + head_dim / 2) — QNN static llama의 split-half RoPE와 같은 배치.
    */
-  void rearrange_cache(int32_t src_ar_len, int32_t dst_ar_len);
+  void set_rope_frequencies(const std::vector<float>& inv_freq) { rope_inv_freq_ = inv_freq; }
+  bool rotates_keys() const { return !rope_inv_freq_.empty(); }
+  
+  /**
+   * @brief Context shift (StreamingLLM): 위치 [n_keep, n_keep + n_discard)를 버리고
+   *        [n_keep + n_discard, n_past)를 n_keep 자리로 당긴다
+   * 
+   * 현재 레이아웃(rearrange_cache()/set_layout_ar_len() 기준 stride)에서 in-place로 동작.
+   * 캐시에 저장된 K는 RoPE가 적용된 값이므로, 당겨진 K를 -n_discard 위치만큼 재회전해
+   * 새 슬롯 번호(= 이후 position id)와 맞춘다. V는 위치 정보가 없어 행 이동만 한다.
+   * 비워진 [n_past - n_discard, n_past)는 0으로 채우지 않는다(attention mask로 가려짐).
+   * 옮길 바이트가 크면 rearrange_cache()와 같은 작업 스레드에 layer 단위로 나눈다.
+   * 
+   * @param n_keep 앞에서 유지할 위치 수(attention sink)
+   * @param n_discard 버릴 위치 수
+   * @param n_past 현재 점유 위치 수(<= 현재 레이아웃의 cache_len)
+   * @return 이동 후 점유 위치 수(n_past - n_discard). 인자가 잘못되면 n_past 그대로
+   */
+  int32_t shift_cache(int32_t n_keep, int32_t n_discard, int32_t n_past);
   
   /**
    * @brief Get current cache length for given AR length
@@ -128,6 +236,10 @@ public:
 private:
   Metadata metadata_;
   size_t total_cache_size_;
+  Options options_;
+  IOSlab slab_;
+  size_t cache_bytes_ = 0;   // Cache region size (staging region follows it)
+  bool locked_ = false;
 
   // KV cache storage: [num_layers][num_heads]
   std::vector<std::vector<KVCacheBuffer>> k_cache_;
@@ -148,14 +260,37 @@ private:
   void rearrange_key(
       KVCacheBuffer& cache,
       int32_t src_cache_len,
-      int32_t dst_cache_len);
+      int32_t dst_cache_len,
+      int32_t n_past);
   
   void rearrange_value(
       KVCacheBuffer& cache,
       int32_t src_cache_len,
       int32_t dst_cache_len);
   
+  // shift_cache() helper: K 행 이동 + 재회전(cos/sin이 nullptr이면 이동만)
+  void shift_key(
+      KVCacheBuffer& cache,
+      int32_t cache_len,
+      int32_t n_keep,
+      int32_t n_discard,
+      int32_t n_moved,
+      float scale,
+      int32_t offset,
+      const float* cos,
+      const float* sin);
+  
+  // Runs fn(layer) for every layer, on rearrange_pool_ when at least moved bytes justify it
+  template <typename Fn>
+  void for_each_layer(size_t moved, Fn&& fn);
+  
+  // shift_cache() RoPE 재회전: [layer * num_heads + head] K 인코딩, 역주파수
+  std::vector<float> key_scale_;
+  std::vector<int32_t> key_offset_;
+  std::vector<float> rope_inv_freq_;
+  
   int32_t cur_ar_len_;  // Current AR length (for rearrange tracking)
+  std::unique_ptr<ThreadPool> rearrange_pool_;  // Created by allocate() when rearrange_threads != 1
 };
 
 } // namespace llm_test
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace llm_test {
+
+/**
+ * @brief KV cache writeback kernels (SMART_MASK layout, uint8 KV)
+ *
+ * K cache is transposed [head_dim, cache_len]: writing n new tokens copies n
+ * bytes into each of head_dim rows. For decode (n == 1) that is a column
+ * scatter of head_dim single bytes, the hot loop after every decode step.
+ *
+ * head_dim 64 and 128 are specialized (fully unrolled); the column scatter
+ * loads the outputs with AVX2 or NEON and stores lanes directly. Other
+ * head_dim values and targets without those ISAs use the scalar loops.
+ * The x86 path needs the library built with AVX2 enabled (e.g. -mavx2).
+ */
+class KVWriteback {
+public:
+  /**
+   * @brief Write n tokens of K outputs into the transposed cache
+   * @param dst Cache buffer at column n_past ([head_dim, dst_stride])
+   * @param dst_stride Cache row length (cache_len of the target layout)
+   * @param src Output buffer [head_dim, src_stride]
+   * @param src_stride Output row length (ar_len of the graph)
+   * @param head_dim Rows to write
+   * @param n Tokens (columns) to write per row
+   */
+  static void write_k(uint8_t* dst, int32_t dst_stride,
+                      const uint8_t* src, int32_t src_stride,
+                      int32_t head_dim, int32_t n);
+
+  /**
+   * @brief Write n tokens of V outputs ([n, head_dim] rows, contiguous in the cache)
+   * @param dst Cache buffer at row n_past
+   */
+  static void write_v(uint8_t* dst, const uint8_t* src, int32_t head_dim, int32_t n) {
+    std::memcpy(dst, src, static_cast<size_t>(n) * head_dim);
+  }
+
+  /**
+   * @brief Reference loops (what the runner did before the kernels), for benchmarks
+   */
+  static void write_k_scalar(uint8_t* dst, int32_t dst_stride,
+                             const uint8_t* src, int32_t src_stride,
+                             int32_t head_dim, int32_t n);
+
+  /**
+   * @brief Vector ISA compiled in: "avx2", "neon" or "scalar"
+   */
+  static const char* isa();
+};
+
+} // namespace llm_test
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace llm_test {
+
+/**
+ * @brief Host memory budget planning for LLMDecodeRunner (max_memory_bytes)
+ *
+ * The runner's footprint is estimated from graph metadata before anything
+ * large is allocated. plan() then turns on the cheapest strategies that bring
+ * the estimate under the budget, in this order:
+ * 1. Liveness-planned I/O pool: prefill-only staging buffers are overlaid by
+ *    the decode buffers instead of being held next to them
+ * 2. mmap context binaries: clean page cache instead of heap copies
+ * 3. Shard loading capped to the remaining headroom (in-flight bytes, threads)
+ *
+ * Load bytes are counted on top of the resident set, which is exact for
+ * streaming start-up and conservative otherwise. The prefix cache only grows
+ * after start-up, so its full cap is reserved next to the resident set.
+ */
+class LLMMemoryBudget {
+ public:
+  /**
+   * @brief Footprint components in bytes
+   */
+  struct Footprint {
+    uint64_t kv_cache = 0;  // LLMKVCacheManager buffers
+    uint64_t io = 0;        // Graph I/O buffers (pool or per-graph slabs)
+    uint64_t shared = 0;    // Multi-context shard hand-off buffers
+    uint64_t prefix_cache = 0;  // LLMPrefixCache cap (reserved, filled by later prompts)
+    uint64_t load = 0;      // Context binary bytes held on the heap while loading
+
+    uint64_t resident() const { return kv_cache + io + shared; }
+    uint64_t reserved() const { return resident() + prefix_cache; }
+    uint64_t total() const { return reserved() + load; }
+    /** "kv 64.0 + io 12.5 + shared 0.3 + prefix 0.0 + load 0.0 = 76.8 MiB" */
+    std::string breakdown() const;
+  };
+
+  /**
+   * @brief Inputs estimated by the runner from graph metadata
+   */
+  struct Estimate {
+    uint64_t kv_cache = 0;
+    uint64_t io_separate = 0;           // One slab per graph
+    uint64_t io_pooled = 0;             // QNNIOPlanner::plan() pool
+    uint64_t shared = 0;
+    uint64_t prefix_cache = 0;          // prefix_cache_mb cap
+    std::vector<uint64_t> binaries;     // Context binary sizes in load order
+    bool serial_load = false;           // One binary at a time (single context, streaming)
+  };
+
+  /**
+   * @brief Strategy knobs (mirrors the LLMDecodeConfig fields they override)
+   */
+  struct Strategy {
+    bool io_pool = true;                // io_plan (+ io_arena)
+    bool mmap_load = true;              // use_mmap_load
+    int load_threads = 0;               // 0 = auto (min(4, cores))
+    uint64_t load_inflight_bytes = 0;   // load_inflight_mb, 0 = unlimited
+  };
+
+  explicit LLMMemoryBudget(uint64_t budget_bytes) : budget_bytes_(budget_bytes) {}
+
+  /**
+   * @brief Choose strategies for an estimate
+   * @param estimate Footprint inputs
+   * @param strategy In: configured preference. Out: strategy to use
+   * @return true if the resulting footprint fits the budget
+   */
+  bool plan(const Estimate& estimate, Strategy& strategy);
+
+  uint64_t budget_bytes() const { return budget_bytes_; }
+  const Footprint& footprint() const { return footprint_; }
+  /** Human-readable strategy changes made by the last plan() */
+  const std::vector<std::string>& changes() const { return changes_; }
+
+  /**
+   * @brief Heap bytes held by context binaries while loading with a strategy
+   */
+  static uint64_t load_bytes(const Estimate& estimate, const Strategy& strategy);
+
+ private:
+  uint64_t budget_bytes_;
+  Footprint footprint_;
+  std::vector<std::string> changes_;
+};
+
+} // namespace llm_test
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "llm_kv_cache_manager.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace llm_test {
+
+/**
+ * @brief Prefix KV cache: KV of completed prefill chunks, shared across requests
+ *
+ * A radix tree over token ids whose edges are whole prefill chunks (chunk_len
+ * tokens). Children are keyed by the hash of their chunk's tokens, and the
+ * tokens are compared on a hit. A node stores only the K/V its own chunk
+ * produced (positions [depth * chunk_len, (depth + 1) * chunk_len)). Causal
+ * attention makes that data a function of the path from the root, so prompts
+ * sharing a prefix share its nodes.
+ *
+ * Chunk boundaries matter because a prefill chunk is one graph execution.
+ * Restored positions are exactly what the same chunked prefill would have
+ * produced, and the suffix continues at a chunk-aligned n_past.
+ *
+ * Node data per layer/head: K rows [head_dim, chunk_len], then V rows
+ * [chunk_len, head_dim]. restore()/insert() copy them to/from the cache in
+ * the prefill layout (K row stride k_stride).
+ *
+ * Memory is capped at max_bytes: least recently used leaves are evicted first,
+ * so every cached node always has its full prefix cached too.
+ */
+class LLMPrefixCache {
+ public:
+  struct Stats {
+    int64_t hits = 0;             // restore() calls that reused at least one chunk
+    int64_t misses = 0;           // restore() calls that reused nothing
+    int64_t tokens_reused = 0;    // Prompt tokens restored instead of prefilled
+    uint64_t bytes_restored = 0;  // KV bytes copied in by restore()
+    int64_t evictions = 0;        // Nodes dropped by the LRU cap
+  };
+
+  LLMPrefixCache(const LLMKVCacheManager::Metadata& metadata, int32_t chunk_len,
+                 uint64_t max_bytes);
+  ~LLMPrefixCache();
+  LLMPrefixCache(const LLMPrefixCache&) = delete;
+  LLMPrefixCache& operator=(const LLMPrefixCache&) = delete;
+
+  /**
+   * @brief Copy the longest cached prefix of tokens into the cache
+   * @param tokens Prompt tokens
+   * @param max_tokens Upper bound on restored tokens (callers leave at least one token to prefill)
+   * @param kv Destination cache, prefill layout
+   * @param k_stride K row stride of that layout (prefill cache_len)
+   * @return Restored positions, a multiple of chunk_len (0 on a miss)
+   */
+  int32_t restore(const std::vector<int32_t>& tokens, int32_t max_tokens,
+                  const LLMKVCacheManager& kv, int32_t k_stride);
+
+  /**
+   * @brief Cache the full chunks of tokens[0, n_tokens) that are not cached yet
+   * @param kv Source cache holding those positions in the prefill layout
+   * @param k_stride K row stride of that layout
+   * @return Bytes added (after evictions made room)
+   */
+  uint64_t insert(const std::vector<int32_t>& tokens, int32_t n_tokens,
+                  const LLMKVCacheManager& kv, int32_t k_stride);
+
+  /**
+   * @brief Drop every node
+   */
+  void clear();
+
+  int32_t chunk_len() const { return chunk_len_; }
+  uint64_t bytes() const { return bytes_; }
+  uint64_t max_bytes() const { return max_bytes_; }
+  size_t num_nodes() const { return num_nodes_; }
+  /** KV bytes one chunk node holds */
+  uint64_t chunk_bytes() const { return chunk_bytes_; }
+  static uint64_t chunk_bytes(const LLMKVCacheManager::Metadata& metadata, int32_t chunk_len) {
+    return 2ull * metadata.num_layers * metadata.num_heads * metadata.head_dim *
+           static_cast<uint64_t>(chunk_len);
+  }
+  const Stats& stats() const { return stats_; }
+
+ private:
+  struct Node {
+    Node* parent = nullptr;
+    std::vector<int32_t> tokens;      // This chunk's tokens (empty at the root)
+    std::vector<uint8_t> data;        // This chunk's K/V (see class comment)
+    std::unordered_map<uint64_t, std::unique_ptr<Node>> children;
+    uint64_t hash = 0;                // Key in parent->children
+    uint64_t last_used = 0;
+  };
+
+  static uint64_t hash_chunk(const int32_t* tokens, int32_t n);
+  Node* find_child(Node* node, const int32_t* tokens) const;
+  void copy_in(const Node& node, int32_t start, const LLMKVCacheManager& kv, int32_t k_stride) const;
+  void copy_out(Node& node, int32_t start, const LLMKVCacheManager& kv, int32_t k_stride) const;
+  // Evicts LRU leaves (never the nodes on keep's path) until bytes_ + incoming fits
+  bool make_room(uint64_t incoming, const Node* keep);
+
+  LLMKVCacheManager::Metadata metadata_;
+  int32_t chunk_len_;
+  uint64_t max_bytes_;
+  uint64_t chunk_bytes_;
+  Node root_;
+  uint64_t bytes_ = 0;
+  size_t num_nodes_ = 0;
+  uint64_t clock_ = 0;
+  Stats stats_;
+};
+
+} // namespace llm_test
@@ -10,7 +10,11 @@
 #include <string>
 #include <sstream>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <vector>
 
 namespace llm_test {
 
@@ -23,6 +27,68 @@ inline long time_in_ms() {
       .count();
 }
 
+/**
+ * @brief Get current time in microseconds
+ */
+inline int64_t time_in_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * @brief Read a "<key>:  <n> kB" field from /proc/self/status (0 if unavailable)
+ */
+inline long read_proc_status_kb(const char* key) {
+  std::ifstream ifs("/proc/self/status");
+  std::string line;
+  const size_t key_len = std::strlen(key);
+  while (std::getline(ifs, line)) {
+    if (line.compare(0, key_len, key) == 0 && line.size() > key_len && line[key_len] == ':') {
+      return std::strtol(line.c_str() + key_len + 1, nullptr, 10);
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Current resident set size in KB
+ */
+inline long read_rss_kb() { return read_proc_status_kb("VmRSS"); }
+
+/**
+ * @brief Peak resident set size (high-water mark) in KB
+ */
+inline long read_peak_rss_kb() { return read_proc_status_kb("VmHWM"); }
+
+/**
+ * @brief Load timing for one context binary (shard)
+ */
+struct ShardLoadStat {
+  int shard = 0;
+  uint64_t bytes = 0;      // Context binary size
+  double read_ms = 0.0;    // File I/O
+  double create_ms = 0.0;  // contextCreateFromBinary (or shared ListAsync call)
+};
+
+/**
+ * @brief I/O buffer footprint of one graph allocator
+ */
+struct IOGraphStat {
+  std::string label;            // "<ctx0|shardN>/<graph name>"
+  uint64_t tensor_bytes = 0;    // Allocated tensor bytes (slices of the shared pool when planned)
+  uint64_t external_bytes = 0;  // Bound to the KV cache or shared buffers instead
+};
+
+/**
+ * @brief Process memory sampled at a phase boundary
+ */
+struct MemorySample {
+  std::string phase;
+  long rss_kb = 0;
+  long peak_rss_kb = 0;
+};
+
 /**
  * @brief Performance statistics for LLM inference
  * 
@@ -49,6 +115,133 @@ struct LLMStats {
   int64_t num_prompt_tokens = 0;
   int64_t num_generated_tokens = 0;
   
+  // Per-shard context load times (in shard index order)
+  std::vector<ShardLoadStat> shard_loads;
+  uint64_t load_peak_inflight_bytes = 0;  // Peak context binary bytes held in memory
+  
+  // Context load memory/time (mmap vs read)
+  bool load_used_mmap = false;
+  long load_rss_before_kb = 0;     // VmRSS before context creation
+  long load_rss_after_kb = 0;      // VmRSS after all contexts are created
+  long load_peak_rss_kb = 0;       // VmHWM after context creation
+  double context_load_ms = 0.0;    // Wall time for all context binaries
+  
+  // Graph I/O buffers (all QNNIOAllocators)
+  uint64_t io_tensor_bytes = 0;    // Sum of tensor nbytes
+  uint64_t io_mapped_bytes = 0;    // Allocated bytes incl. alignment/page padding
+  uint64_t io_regions = 0;         // Separate allocations (1 per slab in arena mode)
+  uint64_t io_external_bytes = 0;  // KV cache inputs bound to the cache manager, not allocated
+  uint64_t io_plan_pool_bytes = 0;     // Liveness-planned shared pool size (0 = planner off)
+  uint64_t io_plan_separate_bytes = 0; // Same tensors with one slab per graph (page-rounded)
+  
+  // Memory by category (context binaries: shard_loads, I/O: io_* above)
+  std::vector<IOGraphStat> io_graphs;  // Per shard and graph
+  uint64_t kv_cache_bytes = 0;         // LLMKVCacheManager slab (mapped, input + output buffers)
+  uint64_t shared_buffer_bytes = 0;    // Multi-context hidden/ROPE/mask hand-off buffers
+  long tokenizer_rss_kb = 0;           // RSS growth across tokenizer load (vocab-only model)
+  std::vector<MemorySample> memory_samples;  // RSS at phase boundaries (latest per phase)
+  
+  // Host memory budget (max_memory_bytes): estimate before allocation, allocated footprint after
+  uint64_t memory_budget_bytes = 0;    // 0 = unlimited
+  uint64_t memory_estimate_bytes = 0;  // KV + I/O + shared + load estimate
+  uint64_t memory_resident_bytes = 0;  // KV + I/O + shared as allocated
+  
+  // Backend session attach (dlopen + backend/device, or reuse of a live session)
+  double backend_session_ms = 0.0;
+  bool backend_session_reused = false;
+  
+  // Streaming start-up (multi-context)
+  bool streaming_load = false;
+  double stream_load_ms = 0.0;     // Background loader wall time (all shards)
+  double stream_blocked_ms = 0.0;  // Time requests spent waiting for shards
+  
+  /**
+   * @brief Total context binary bytes mapped or read (all shards)
+   */
+  uint64_t context_binary_bytes() const {
+    uint64_t bytes = 0;
+    for (const auto& s : shard_loads) bytes += s.bytes;
+    return bytes;
+  }
+  
+  /**
+   * @brief Record VmRSS/VmHWM for a phase (replaces an earlier sample of the same phase)
+   */
+  void sample_memory(const char* phase) {
+    MemorySample sample;
+    sample.phase = phase;
+    sample.rss_kb = read_rss_kb();
+    sample.peak_rss_kb = read_peak_rss_kb();
+    for (auto& m : memory_samples) {
+      if (m.phase == sample.phase) {
+        m = sample;
+        return;
+      }
+    }
+    memory_samples.push_back(sample);
+  }
+  
+  /**
+   * @brief Load time hidden behind initialize() returning early and the first prefill
+   */
+  double stream_overlapped_ms() const {
+    return stream_load_ms > stream_blocked_ms ? stream_load_ms - stream_blocked_ms : 0.0;
+  }
+  
+  // Warm-up (synthetic executions through every shard)
+  double warmup_ms = 0.0;
+  uint64_t warmup_prefault_bytes = 0;
+  double cold_prefill_step_ms = 0.0;   // First prefill step (all shards)
+  double warm_prefill_step_ms = 0.0;   // Mean of later warm-up prefill steps
+  double cold_decode_step_ms = 0.0;    // First decode step (all shards)
+  double warm_decode_step_ms = 0.0;    // Mean of later warm-up decode steps
+  
+  // Prefill → decode KV layout: zero-KV single-chunk path, or rearrange_cache time
+  bool prefill_zero_kv = false;
+  double rearrange_ms = 0.0;
+  
+  // Prefix KV cache (cumulative over generate() calls) and this request's restore
+  bool prefix_cache = false;
+  int64_t prefix_hits = 0;
+  int64_t prefix_misses = 0;
+  int64_t prefix_tokens_reused = 0;
+  uint64_t prefix_bytes_saved = 0;     // KV bytes restored instead of recomputed
+  uint64_t prefix_cache_bytes = 0;     // Current cache size
+  uint64_t prefix_cache_cap_bytes = 0;
+  int32_t prefix_restored_tokens = 0;  // This request
+  double prefix_restore_ms = 0.0;
+  double prefix_store_ms = 0.0;
+  
+  // Context shifts (KV cache full): count, positions dropped, host time, K re-rotated
+  int64_t context_shifts = 0;
+  int64_t context_shift_evicted = 0;
+  double context_shift_ms = 0.0;
+  bool context_shift_rotated = false;
+  
+  // Decode step latency during generate(): first step vs the rest
+  double first_decode_step_ms = 0.0;
+  double steady_decode_step_ms = 0.0;
+  
+  // Decode-time host KV work (V rebinding/copies + K scatter), summed over steps
+  double decode_kv_host_ms = 0.0;
+  int64_t decode_kv_steps = 0;
+  bool direct_v_binding = false;
+  // Multi-context KV writeback on a worker thread: host time hidden behind shard execution
+  bool async_kv_writeback = false;
+  double prefill_kv_hidden_ms = 0.0;
+  double decode_kv_hidden_ms = 0.0;
+  
+  // Adaptive HTP power policy: time spent in each profile (cumulative since initialize)
+  double power_burst_ms = 0.0;
+  double power_sustained_ms = 0.0;
+  double power_relaxed_ms = 0.0;
+  uint32_t power_switches = 0;     // setPowerConfig votes issued
+  uint32_t power_debounced = 0;    // Downgrades held back by the debounce window
+  
+  // Async logger (process-wide counters)
+  uint64_t log_records = 0;        // Records published to the ring
+  uint64_t log_dropped = 0;        // Records dropped because the ring was full
+  
   void reset() {
     model_load_start_ms = 0;
     model_load_end_ms = 0;
@@ -58,6 +251,115 @@ struct LLMStats {
     inference_end_ms = 0;
     num_prompt_tokens = 0;
     num_generated_tokens = 0;
+    shard_loads.clear();
+    load_peak_inflight_bytes = 0;
+    load_used_mmap = false;
+    load_rss_before_kb = 0;
+    load_rss_after_kb = 0;
+    load_peak_rss_kb = 0;
+    context_load_ms = 0.0;
+    io_tensor_bytes = 0;
+    io_mapped_bytes = 0;
+    io_regions = 0;
+    io_external_bytes = 0;
+    io_plan_pool_bytes = 0;
+    io_plan_separate_bytes = 0;
+    io_graphs.clear();
+    kv_cache_bytes = 0;
+    shared_buffer_bytes = 0;
+    tokenizer_rss_kb = 0;
+    memory_samples.clear();
+    memory_budget_bytes = 0;
+    memory_estimate_bytes = 0;
+    memory_resident_bytes = 0;
+    backend_session_ms = 0.0;
+    backend_session_reused = false;
+    streaming_load = false;
+    stream_load_ms = 0.0;
+    stream_blocked_ms = 0.0;
+    warmup_ms = 0.0;
+    warmup_prefault_bytes = 0;
+    cold_prefill_step_ms = 0.0;
+    warm_prefill_step_ms = 0.0;
+    cold_decode_step_ms = 0.0;
+    warm_decode_step_ms = 0.0;
+    prefill_zero_kv = false;
+    rearrange_ms = 0.0;
+    prefix_cache = false;
+    prefix_hits = 0;
+    prefix_misses = 0;
+    prefix_tokens_reused = 0;
+    prefix_bytes_saved = 0;
+    prefix_cache_bytes = 0;
+    prefix_cache_cap_bytes = 0;
+    prefix_restored_tokens = 0;
+    prefix_restore_ms = 0.0;
+    prefix_store_ms = 0.0;
+    context_shifts = 0;
+    context_shift_evicted = 0;
+    context_shift_ms = 0.0;
+    context_shift_rotated = false;
+    first_decode_step_ms = 0.0;
+    steady_decode_step_ms = 0.0;
+    decode_kv_host_ms = 0.0;
+    decode_kv_steps = 0;
+    direct_v_binding = false;
+    async_kv_writeback = false;
+    prefill_kv_hidden_ms = 0.0;
+    decode_kv_hidden_ms = 0.0;
+    power_burst_ms = 0.0;
+    power_sustained_ms = 0.0;
+    power_relaxed_ms = 0.0;
+    power_switches = 0;
+    power_debounced = 0;
+    log_records = 0;
+    log_dropped = 0;
+  }
+  
+  /**
+   * @brief Print the memory section of the report (one line per category)
+   */
+  void print_memory_report() const {
+    std::cout << "  Memory:\n";
+    if (!shard_loads.empty()) {
+      std::cout << "    Context binaries: " << (context_binary_bytes() >> 20) << " MB "
+                << (load_used_mmap ? "mapped" : "read") << " (" << shard_loads.size()
+                << " file(s), peak in flight " << (load_peak_inflight_bytes >> 20) << " MB)\n";
+    }
+    if (io_regions > 0) {
+      std::cout << "    I/O buffers: " << (io_tensor_bytes >> 10) << " KiB in " << io_regions
+                << " allocation(s), " << (io_mapped_bytes >> 10) << " KiB mapped";
+      if (io_external_bytes > 0) {
+        std::cout << " (" << (io_external_bytes >> 10) << " KiB of KV inputs bound to the cache)";
+      }
+      std::cout << "\n";
+      for (const auto& g : io_graphs) {
+        std::cout << "      " << g.label << ": " << (g.tensor_bytes >> 10) << " KiB";
+        if (g.external_bytes > 0) std::cout << " (+" << (g.external_bytes >> 10) << " KiB bound)";
+        std::cout << "\n";
+      }
+    }
+    if (io_plan_pool_bytes > 0) {
+      uint64_t saved = io_plan_separate_bytes > io_plan_pool_bytes
+                     ? io_plan_separate_bytes - io_plan_pool_bytes : 0;
+      std::cout << "    I/O plan: " << (io_plan_pool_bytes >> 10) << " KiB pool vs "
+                << (io_plan_separate_bytes >> 10) << " KiB per-graph (saved "
+                << (saved >> 10) << " KiB)\n";
+    }
+    std::cout << "    KV cache: " << (kv_cache_bytes >> 10) << " KiB\n";
+    if (shared_buffer_bytes > 0) {
+      std::cout << "    Shared buffers: " << (shared_buffer_bytes >> 10) << " KiB\n";
+    }
+    std::cout << "    Tokenizer: " << tokenizer_rss_kb << " KiB (RSS growth at load)\n";
+    if (memory_budget_bytes > 0) {
+      std::cout << "    Budget: " << (memory_resident_bytes >> 20) << " MB resident (estimate "
+                << (memory_estimate_bytes >> 20) << " MB incl. load) of "
+                << (memory_budget_bytes >> 20) << " MB\n";
+    }
+    for (const auto& m : memory_samples) {
+      std::cout << "    RSS @" << m.phase << ": " << (m.rss_kb >> 10) << " MB (peak "
+                << (m.peak_rss_kb >> 10) << " MB)\n";
+    }
   }
   
   /**
@@ -72,6 +374,35 @@ struct LLMStats {
     // Model load time
     double model_load_time_s = (double)(model_load_end_ms - model_load_start_ms) / SCALING_FACTOR;
     std::cout << "  Model Load Time: " << model_load_time_s << " seconds\n";
+    for (const auto& s : shard_loads) {
+      std::cout << "    Shard " << s.shard << ": " << (s.bytes >> 20) << " MB, read "
+                << s.read_ms << " ms, create " << s.create_ms << " ms\n";
+    }
+    if (load_peak_inflight_bytes > 0) {
+      std::cout << "    Peak in-flight binaries: " << (load_peak_inflight_bytes >> 20) << " MB\n";
+    }
+    if (context_load_ms > 0) {
+      std::cout << "    Context load (" << (load_used_mmap ? "mmap" : "read") << "): "
+                << context_load_ms << " ms, RSS " << (load_rss_before_kb >> 10) << " -> "
+                << (load_rss_after_kb >> 10) << " MB (peak " << (load_peak_rss_kb >> 10) << " MB)\n";
+    }
+    if (backend_session_ms > 0) {
+      std::cout << "    Backend session: " << backend_session_ms << " ms ("
+                << (backend_session_reused ? "reused" : "created") << ")\n";
+    }
+    if (streaming_load) {
+      std::cout << "  Streaming Load: " << stream_load_ms << " ms in background, blocked "
+                << stream_blocked_ms << " ms, overlapped " << stream_overlapped_ms() << " ms\n";
+    }
+    print_memory_report();
+    if (warmup_ms > 0) {
+      std::cout << "  Warm-up: " << warmup_ms << " ms (prefaulted "
+                << (warmup_prefault_bytes >> 20) << " MB)\n";
+      std::cout << "    Prefill step: cold " << cold_prefill_step_ms << " ms, warm "
+                << warm_prefill_step_ms << " ms\n";
+      std::cout << "    Decode step:  cold " << cold_decode_step_ms << " ms, warm "
+                << warm_decode_step_ms << " ms\n";
+    }
     std::cout << "\n";
     
     // Time to first token (TTFT) - prefill time
@@ -82,6 +413,24 @@ struct LLMStats {
       std::cout << " (" << prefill_tps << " tokens/second)";
     }
     std::cout << "\n";
+    if (prefill_zero_kv) {
+      std::cout << "  KV Layout: zero-KV single chunk (rearrange skipped)\n";
+    } else if (rearrange_ms > 0) {
+      std::cout << "  KV Layout: rearrange " << rearrange_ms << " ms\n";
+    }
+    if (prefix_cache) {
+      std::cout << "  Prefix Cache: " << prefix_restored_tokens << " tokens restored ("
+                << prefix_restore_ms << " ms, store " << prefix_store_ms << " ms), "
+                << prefix_hits << " hits / " << prefix_misses << " misses, "
+                << (prefix_bytes_saved / 1024.0 / 1024.0) << " MiB saved, "
+                << (prefix_cache_bytes / 1024.0 / 1024.0) << " / "
+                << (prefix_cache_cap_bytes / 1024.0 / 1024.0) << " MiB cached\n";
+    }
+    if (context_shifts > 0) {
+      std::cout << "  Context Shift: " << context_shifts << " shifts, " << context_shift_evicted
+                << " positions dropped, " << context_shift_ms << " ms"
+                << (context_shift_rotated ? " (K re-rotated)" : " (K not re-rotated)") << "\n";
+    }
     
     // Time between tokens (TBT) - decode time
     double decode_time_s = (double)(inference_end_ms - prompt_eval_end_ms) / SCALING_FACTOR;
@@ -95,6 +444,28 @@ struct LLMStats {
       std::cout << " [" << avg_tbt_ms << " ms/token]";
     }
     std::cout << "\n";
+    if (first_decode_step_ms > 0) {
+      std::cout << "  Decode Step: first " << first_decode_step_ms << " ms, steady "
+                << steady_decode_step_ms << " ms\n";
+    }
+    if (decode_kv_steps > 0) {
+      std::cout << "  Decode KV host work: " << (decode_kv_host_ms * 1000.0 / decode_kv_steps)
+                << " us/token (V " << (direct_v_binding ? "bound in place" : "copied") << ")\n";
+      if (async_kv_writeback) {
+        std::cout << "    Hidden on writeback thread: "
+                  << (decode_kv_hidden_ms * 1000.0 / decode_kv_steps) << " us/token, prefill "
+                  << prefill_kv_hidden_ms << " ms\n";
+      }
+    }
+    if (power_switches > 0) {
+      std::cout << "  HTP Power: burst " << power_burst_ms << " ms, sustained "
+                << power_sustained_ms << " ms, relaxed " << power_relaxed_ms << " ms ("
+                << power_switches << " switches, " << power_debounced << " debounced)\n";
+    }
+    if (log_dropped > 0) {
+      std::cout << "  Log: " << log_dropped << " of " << (log_records + log_dropped)
+                << " records dropped (ring full)\n";
+    }
     
     // Total inference time
     double total_time_s = (double)(inference_end_ms - inference_start_ms) / SCALING_FACTOR;
@@ -121,6 +492,88 @@ struct LLMStats {
        << "\"prompt_eval_end_ms\":" << prompt_eval_end_ms << ","
        << "\"first_token_ms\":" << first_token_ms << ","
        << "\"inference_end_ms\":" << inference_end_ms << ","
+       << "\"shard_loads\":[";
+    for (size_t i = 0; i < shard_loads.size(); ++i) {
+      const auto& s = shard_loads[i];
+      ss << (i ? "," : "") << "{\"shard\":" << s.shard << ",\"bytes\":" << s.bytes
+         << ",\"read_ms\":" << s.read_ms << ",\"create_ms\":" << s.create_ms << "}";
+    }
+    ss << "],"
+       << "\"load_peak_inflight_bytes\":" << load_peak_inflight_bytes << ","
+       << "\"load_used_mmap\":" << (load_used_mmap ? "true" : "false") << ","
+       << "\"load_rss_before_kb\":" << load_rss_before_kb << ","
+       << "\"load_rss_after_kb\":" << load_rss_after_kb << ","
+       << "\"load_peak_rss_kb\":" << load_peak_rss_kb << ","
+       << "\"context_load_ms\":" << context_load_ms << ","
+       << "\"io_tensor_bytes\":" << io_tensor_bytes << ","
+       << "\"io_mapped_bytes\":" << io_mapped_bytes << ","
+       << "\"io_regions\":" << io_regions << ","
+       << "\"io_external_bytes\":" << io_external_bytes << ","
+       << "\"io_plan_pool_bytes\":" << io_plan_pool_bytes << ","
+       << "\"io_plan_separate_bytes\":" << io_plan_separate_bytes << ","
+       << "\"context_binary_bytes\":" << context_binary_bytes() << ","
+       << "\"io_graphs\":[";
+    for (size_t i = 0; i < io_graphs.size(); ++i) {
+      const auto& g = io_graphs[i];
+      ss << (i ? "," : "") << "{\"label\":\"" << g.label << "\",\"tensor_bytes\":" << g.tensor_bytes
+         << ",\"external_bytes\":" << g.external_bytes << "}";
+    }
+    ss << "],"
+       << "\"kv_cache_bytes\":" << kv_cache_bytes << ","
+       << "\"shared_buffer_bytes\":" << shared_buffer_bytes << ","
+       << "\"tokenizer_rss_kb\":" << tokenizer_rss_kb << ","
+       << "\"memory_samples\":[";
+    for (size_t i = 0; i < memory_samples.size(); ++i) {
+      const auto& m = memory_samples[i];
+      ss << (i ? "," : "") << "{\"phase\":\"" << m.phase << "\",\"rss_kb\":" << m.rss_kb
+         << ",\"peak_rss_kb\":" << m.peak_rss_kb << "}";
+    }
+    ss << "],"
+       << "\"memory_budget_bytes\":" << memory_budget_bytes << ","
+       << "\"memory_estimate_bytes\":" << memory_estimate_bytes << ","
+       << "\"memory_resident_bytes\":" << memory_resident_bytes << ","
+       << "\"backend_session_ms\":" << backend_session_ms << ","
+       << "\"backend_session_reused\":" << (backend_session_reused ? "true" : "false") << ","
+       << "\"streaming_load\":" << (streaming_load ? "true" : "false") << ","
+       << "\"stream_load_ms\":" << stream_load_ms << ","
+       << "\"stream_blocked_ms\":" << stream_blocked_ms << ","
+       << "\"stream_overlapped_ms\":" << stream_overlapped_ms() << ","
+       << "\"warmup_ms\":" << warmup_ms << ","
+       << "\"warmup_prefault_bytes\":" << warmup_prefault_bytes << ","
+       << "\"cold_prefill_step_ms\":" << cold_prefill_step_ms << ","
+       << "\"warm_prefill_step_ms\":" << warm_prefill_step_ms << ","
+       << "\"cold_decode_step_ms\":" << cold_decode_step_ms << ","
+       << "\"warm_decode_step_ms\":" << warm_decode_step_ms << ","
+       << "\"prefill_zero_kv\":" << (prefill_zero_kv ? "true" : "false") << ","
+       << "\"rearrange_ms\":" << rearrange_ms << ","
+       << "\"prefix_cache\":" << (prefix_cache ? "true" : "false") << ","
+       << "\"prefix_hits\":" << prefix_hits << ","
+       << "\"prefix_misses\":" << prefix_misses << ","
+       << "\"prefix_tokens_reused\":" << prefix_tokens_reused << ","
+       << "\"prefix_bytes_saved\":" << prefix_bytes_saved << ","
+       << "\"prefix_cache_bytes\":" << prefix_cache_bytes << ","
+       << "\"prefix_restored_tokens\":" << prefix_restored_tokens << ","
+       << "\"prefix_restore_ms\":" << prefix_restore_ms << ","
+       << "\"prefix_store_ms\":" << prefix_store_ms << ","
+       << "\"context_shifts\":" << context_shifts << ","
+       << "\"context_shift_evicted\":" << context_shift_evicted << ","
+       << "\"context_shift_ms\":" << context_shift_ms << ","
+       << "\"context_shift_rotated\":" << (context_shift_rotated ? "true" : "false") << ","
+       << "\"first_decode_step_ms\":" << first_decode_step_ms << ","
+       << "\"steady_decode_step_ms\":" << steady_decode_step_ms << ","
+       << "\"decode_kv_host_ms\":" << decode_kv_host_ms << ","
+       << "\"decode_kv_steps\":" << decode_kv_steps << ","
+       << "\"direct_v_binding\":" << (direct_v_binding ? "true" : "false") << ","
+       << "\"async_kv_writeback\":" << (async_kv_writeback ? "true" : "false") << ","
+       << "\"prefill_kv_hidden_ms\":" << prefill_kv_hidden_ms << ","
+       << "\"decode_kv_hidden_ms\":" << decode_kv_hidden_ms << ","
+       << "\"power_burst_ms\":" << power_burst_ms << ","
+       << "\"power_sustained_ms\":" << power_sustained_ms << ","
+       << "\"power_relaxed_ms\":" << power_relaxed_ms << ","
+       << "\"power_switches\":" << power_switches << ","
+       << "\"power_debounced\":" << power_debounced << ","
+       << "\"log_records\":" << log_records << ","
+       << "\"log_dropped\":" << log_dropped << ","
        << "\"SCALING_FACTOR\":" << SCALING_FACTOR
        << "}";
     return ss.str();
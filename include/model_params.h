@@ -2,6 +2,7 @@
 
 #include <string>
 #include <cstdint>
+#include <vector>
 
 namespace llm_test {
 
@@ -19,6 +20,7 @@ struct ModelParams {
   float norm_eps = 1e-5f;             // Normalization epsilon
   float rope_theta = 10000.0f;        // RoPE theta base
   bool use_scaled_rope = false;       // Use scaled RoPE
+  float rope_scale_factor = 8.0f;     // Llama 3 RoPE scaling factor (use_scaled_rope only)
   
   // Derived values (computed from above)
   int32_t head_dim = 0;               // dim / n_heads
@@ -44,6 +46,14 @@ struct ModelParams {
   }
 };
 
+/**
+ * @brief RoPE inverse frequencies (head_dim / 2 values) the exported graph rotates Q/K with
+ *
+ * theta^(-2i / head_dim), with Llama 3 frequency scaling when use_scaled_rope is set
+ * (low/high frequency factors 1 and 4, original context 8192).
+ */
+std::vector<float> rope_inv_frequencies(const ModelParams& params, int32_t head_dim);
+
 /**
  * @brief Parse params.json file
  * @param path Path to params.json
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "qnn_power_policy.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// dlopen으로 연 QNN 공유 라이브러리 핸들 쌍을 보관
+struct DlHandlePair { void* backend_so_handle; void* system_so_handle; };
+
+namespace llm_test {
+
+// 프로세스 전역 QNN 백엔드 세션(참조 카운트 공유)
+// - dlopen(backend/system so) → provider 조회 → logCreate → backendCreate → deviceCreate를 1회만 수행
+// - 같은 (backend_so, system_so) 조합으로 acquire()하면 살아 있는 세션을 그대로 공유한다
+//   (draft/main 모델 등 여러 러너가 한 프로세스에서 백엔드 상태를 중복 생성하지 않음)
+// - 마지막 shared_ptr이 해제될 때 power client → device → backend → logger → dlclose 순으로 정리
+// - 컨텍스트/그래프는 세션이 아니라 모델별 QnnLoader가 소유한다(세션보다 먼저 해제되어야 함)
+class QnnBackendSession {
+public:
+  // 세션 획득(없으면 생성). log_level은 세션을 처음 만드는 호출에서만 반영된다
+  // 실패 시 nullptr, error에 원인. reused: 기존 세션을 공유했으면 true
+  static std::shared_ptr<QnnBackendSession> acquire(const std::string& backend_so_path,
+                                                    const std::string& system_so_path,
+                                                    int log_level,
+                                                    std::string* error = nullptr,
+                                                    bool* reused = nullptr);
+
+  // 현재 살아 있는 세션 수(진단용)
+  static size_t live_sessions();
+
+  ~QnnBackendSession();
+  QnnBackendSession(const QnnBackendSession&) = delete;
+  QnnBackendSession& operator=(const QnnBackendSession&) = delete;
+
+  const void* interface() const { return interface_provider_; }
+  const DlHandlePair& handles() const { return handles_; }
+  void* backend_handle() const { return backend_; }
+  void* device_handle() const { return device_; }
+  double open_ms() const { return open_ms_; }  // 세션 생성(dlopen~deviceCreate)에 걸린 시간
+
+  // HTP perf infrastructure 함수 테이블(QnnHtpDevice_PerfInfrastructure_t*). 미지원 시 nullptr
+  const void* htp_perf_infrastructure() const;
+
+  // HTP 성능 모드 활성화 (Burst 고정 투표, 레거시). 세션당 power client 1개를 공유
+  bool enable_htp_performance_mode();
+
+  // 세션 공유 적응형 전력 정책(처음 호출 시 options로 생성). 미지원 시 nullptr
+  // - 러너별로 add_voter()를 받아 단계를 통지하면 가장 높은 요구 프로파일이 적용된다
+  HtpPowerPolicy* power_policy(const HtpPowerPolicy::Options& options);
+
+private:
+  QnnBackendSession() = default;
+
+  bool open(const std::string& backend_so_path, const std::string& system_so_path,
+            int log_level, std::string& error);
+  void close();
+
+  DlHandlePair handles_ {nullptr, nullptr};
+  void* get_providers_fn_ {nullptr};
+  const void* interface_provider_ {nullptr};
+  void* logger_ {nullptr};
+  void* backend_ {nullptr};
+  void* device_ {nullptr};
+  double open_ms_ {0.0};
+
+  std::mutex power_mu_;
+  uint32_t power_config_client_id_ {0}; // 레거시 burst 투표용 client
+  std::unique_ptr<HtpPowerPolicy> power_policy_;
+  bool power_policy_failed_ {false};
+};
+
+} // namespace llm_test
@@ -1,44 +1,80 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 #include <QnnTensor.h>
 
-// dlopen으로 연 QNN 공유 라이브러리 핸들 쌍을 보관
-struct DlHandlePair { void* backend_so_handle; void* system_so_handle; };
+#include "qnn_backend_session.h"
 
 namespace llm_test {
 
-// Executorch 구현 흐름을 그대로 따르는 QNN 초기화/컨텍스트 복원 헬퍼
-// - QnnInterface_getProviders로 provider를 받아 함수 테이블을 획득
-// - backendCreate → deviceCreate 순으로 생성
+struct QnnAsyncQueue; // 컨텍스트별 in-flight 슬롯 링(정의는 qnn_loader.cpp)
+
+// graphExecuteAsync 제출 1건에 대한 완료 토큰(move-only, 힙 할당 없음)
+// - wait(): 완료 통지(notify 콜백)까지 대기하고 성공 여부를 반환, error()로 QNN 에러 코드 확인
+// - 소멸 시 아직 기다리지 않은 제출이 있으면 대기한다(바인딩된 버퍼 수명 보호)
+// - 동기 폴백으로 실행된 경우 생성 시점에 이미 완료 상태
+class QnnExecFuture {
+public:
+  QnnExecFuture() = default;
+  ~QnnExecFuture();
+  QnnExecFuture(QnnExecFuture&& other) noexcept;
+  QnnExecFuture& operator=(QnnExecFuture&& other) noexcept;
+  QnnExecFuture(const QnnExecFuture&) = delete;
+  QnnExecFuture& operator=(const QnnExecFuture&) = delete;
+
+  bool pending() const { return queue_ != nullptr; }
+  bool wait();
+  Qnn_ErrorHandle_t error() const { return error_; }
+
+private:
+  friend class QnnLoader;
+  QnnAsyncQueue* queue_ {nullptr};
+  uint32_t slot_ {0};
+  Qnn_ErrorHandle_t error_ {QNN_SUCCESS};
+};
+
+// 모델별 QNN 컨텍스트 집합(Executorch 구현 흐름을 그대로 따르는 컨텍스트 복원/실행 헬퍼)
+// - 백엔드/디바이스/로거/power client는 프로세스 공유 QnnBackendSession이 소유하고 여기서는 참조만 한다
 // - contextCreateFromBinaryListAsync(우선) / contextCreateFromBinary(폴백)로 복원
+// - 소멸 시 이 로더의 컨텍스트만 해제하고 세션 참조를 놓는다(마지막 참조면 세션도 정리)
 class QnnLoader {
 public:
   QnnLoader() = default;
   ~QnnLoader();
 
-  // QNN 백엔드/시스템 so를 로드하고, QnnInterface_getProviders 심볼을 확인한다.
-  // - backend_so_path: 보통 libQnnHtp.so (Android에선 /vendor/lib64/libQnnHtp.so)
-  // - system_so_path:  보통 libQnnSystem.so
-  bool load(const std::string& backend_so_path, const std::string& system_so_path);
+  // 공유 백엔드 세션에 연결(컨텍스트 생성 전에 1회)
+  bool attach(std::shared_ptr<QnnBackendSession> session);
+  const std::shared_ptr<QnnBackendSession>& session() const { return session_; }
 
-  // provider 목록을 질의해 원하는 provider 하나를 선택한다(기본 첫 번째).
-  const void* get_interface_provider(const char* provider_name = nullptr);
   const void* interface() const { return interface_provider_; }
-  const DlHandlePair& handles() const { return handles_; }
+  void* backend_handle() const { return backend_; }
 
-  // 로그 레벨 설정 (1=ERROR,2=WARN,3=INFO,4=VERBOSE,5=DEBUG)
-  void set_log_level(int level) { log_level_ = level; }
+  // 병렬 로딩용: 컨텍스트 슬롯 n개를 미리 확보하고 첫 슬롯 인덱스를 반환
+  // - 슬롯 인덱스 = 샤드 순서(생성 완료 순서와 무관하게 contexts_ 순서 보장)
+  // - 확보된 슬롯은 create_context_at / create_contexts_list_async로 채운다
+  size_t reserve_context_slots(size_t n);
 
-  // Executorch와 동일: logCreate → backendCreate → deviceCreate 순으로 핸들을 생성한다.
-  bool create_backend_and_device();
+  // 확보된 슬롯에 컨텍스트 1개 복원. 서로 다른 슬롯이면 여러 스레드에서 동시 호출 가능
+  bool create_context_at(size_t slot, const void* binary, size_t binary_size,
+                         Qnn_ProfileHandle_t profile = nullptr);
 
-  // 멀티 샤드 컨텍스트 바이너리를 한 번에 복원 (Executorch의 멀티그래프 바이너리 대응)
-  // (비사용) ListAsync 경로는 제거
+  // 백엔드가 contextCreateFromBinaryListAsync를 제공하는지
+  bool supports_list_async() const;
+
+  // 멀티 샤드 컨텍스트 바이너리를 한 번에 복원(백엔드 내부 병렬 역직렬화)
+  // - binaries[i]는 slot first_slot+i에 들어간다. profiles는 비어 있거나 binaries와 같은 길이
+  // - 실패 시 이번 호출에서 생성된 컨텍스트를 해제하고 슬롯을 비워 둔다(동기 경로로 재시도 가능)
+  bool create_contexts_list_async(size_t first_slot,
+                                  const std::vector<std::pair<const void*, size_t>>& binaries,
+                                  const std::vector<Qnn_ProfileHandle_t>& profiles);
 
   // Executorch와 동일 경로: 단일 바이너리 버퍼로 컨텍스트 1개 복원
-  bool create_context_from_binary(const void* binary, size_t binary_size);
+  // - profile: 컨텍스트 역직렬화 시간을 수집할 QNN profile 핸들(옵션)
+  bool create_context_from_binary(const void* binary, size_t binary_size,
+                                  Qnn_ProfileHandle_t profile = nullptr);
   
   // Multi-context: 여러 바이너리로 컨텍스트를 순차적으로 생성
   bool create_contexts_from_binaries(const std::vector<std::pair<const void*, size_t>>& binaries);
@@ -48,12 +84,39 @@ public:
   bool retrieve_graph(size_t ctx_index, const std::string& graph_name);
   size_t num_graphs() const { return graphs_.size(); }
 
+  // 그래프 핸들을 조회해 반환(실행 계획이 1회 캐시해 두고 재사용). 실패 시 nullptr
+  Qnn_GraphHandle_t get_graph_handle(size_t ctx_index, const std::string& graph_name);
+
   // 그래프 실행: 입력/출력 텐서를 전달하여 graphExecute 호출
   bool execute_graph(size_t ctx_index,
                      const std::string& graph_name,
                      const std::vector<Qnn_Tensor_t>& inputs,
                      std::vector<Qnn_Tensor_t>& outputs);
 
+  // 캐시된 그래프 핸들로 실행(핫패스용): graphRetrieve/벡터 구성 없이 graphExecute만 호출
+  bool execute_graph(Qnn_GraphHandle_t graph,
+                     const Qnn_Tensor_t* inputs, uint32_t num_inputs,
+                     Qnn_Tensor_t* outputs, uint32_t num_outputs,
+                     Qnn_ProfileHandle_t profile = nullptr);
+
+  // 비동기 실행: graphExecuteAsync로 제출하고 완료 토큰을 반환
+  // - 컨텍스트별 in-flight 제출 수는 async_queue_depth로 제한(가득 차면 슬롯이 빌 때까지 대기)
+  // - graphExecuteAsync 미지원(함수 포인터 없음/UNSUPPORTED_FEATURE)/비활성 시 동기 graphExecute로 폴백
+  //   (완료된 토큰 반환). 그 밖의 제출 실패는 재실행하지 않고 토큰의 error()로 보고한다
+  // - 입력/출력 텐서 배열과 버퍼는 wait()가 끝날 때까지 유지되어야 한다
+  QnnExecFuture execute_graph_async(size_t ctx_index,
+                                    Qnn_GraphHandle_t graph,
+                                    const Qnn_Tensor_t* inputs, uint32_t num_inputs,
+                                    Qnn_Tensor_t* outputs, uint32_t num_outputs,
+                                    Qnn_ProfileHandle_t profile = nullptr);
+
+  // 비동기 실행 사용 여부(false면 execute_graph_async가 항상 동기 실행)
+  void set_async_enabled(bool enabled) { async_enabled_ = enabled; }
+  bool async_enabled() const { return async_enabled_; }
+
+  // 컨텍스트별 최대 in-flight 제출 수(이후 생성되는 컨텍스트에 적용, 기본 2)
+  void set_async_queue_depth(uint32_t depth) { async_queue_depth_ = depth ? depth : 1; }
+
   // 그래프 등록 IO 텐서 조회(Executorch 흐름: 등록된 텐서 ID 사용)
   bool get_graph_io(size_t ctx_index,
                     const std::string& graph_name,
@@ -65,27 +128,35 @@ public:
                             const std::string& graph_name,
                             const std::vector<Qnn_Tensor_t>& tensors);
 
-  // 생성/복원한 리소스를 역순으로 정리 (context → device → backend → logger → dlclose)
+  // 이 로더의 컨텍스트를 해제하고 세션 참조를 놓는다
   void cleanup();
 
-  // HTP 성능 모드 활성화 (Burst/HighPerformance)
-  bool enable_htp_performance_mode();
-
 private:
-  void* get_providers_fn_ {nullptr};
+  std::shared_ptr<QnnBackendSession> session_;
+  // session_에서 복사해 둔 핸들(핫패스에서 간접 참조를 줄이기 위함, 수명은 session_이 보장)
   const void* interface_provider_ {nullptr};
-  DlHandlePair handles_ {nullptr, nullptr};
-  void* logger_ {nullptr};
   void* backend_ {nullptr};
   void* device_ {nullptr};
   std::vector<void*> contexts_;
   std::vector<void*> graphs_;
+  std::vector<std::shared_ptr<QnnAsyncQueue>> async_queues_; // contexts_와 같은 인덱스
+
+  bool async_enabled_ {true};
+  uint32_t async_queue_depth_ {2};
+
+  // 생성된 컨텍스트 등록(비동기 큐 포함)
+  void add_context(void* ctx);
+  // contextCreateFromBinary 호출 결과 코드를 그대로 반환(contexts_는 건드리지 않음)
+  Qnn_ErrorHandle_t context_create(const void* binary, size_t binary_size,
+                                   Qnn_ProfileHandle_t profile, void** out_ctx);
+  // 모든 in-flight 제출이 끝날 때까지 대기(컨텍스트 해제 전)
+  void drain_async_queues();
+  // graphExecute 호출 결과 코드를 그대로 반환
+  Qnn_ErrorHandle_t graph_execute(Qnn_GraphHandle_t graph,
+                                  const Qnn_Tensor_t* inputs, uint32_t num_inputs,
+                                  Qnn_Tensor_t* outputs, uint32_t num_outputs,
+                                  Qnn_ProfileHandle_t profile);
 
-  uint32_t power_config_client_id_ {0}; // HTP Power Config Client ID
-
-  int log_level_ {5};
-
-  // 로깅 콜백은 SDK 버전별 시그니처 차이가 커서 생략
 };
 
 } // namespace llm_test
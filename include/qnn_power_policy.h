@@ -0,0 +1,116 @@
+#pragma once
+
+#include "HTP/QnnHtpPerfInfrastructure.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace llm_test {
+
+// HTP perf infrastructure 함수 테이블(주입 가능)
+// - 실제 장치: from_infra()로 QnnHtpDevice_PerfInfrastructure_t를 감싼다
+// - Linux 호스트 검증: 호출을 기록하는 스텁 람다를 넣으면 하드웨어 없이 정책 로직을 확인할 수 있다
+struct HtpPerfOps {
+  std::function<Qnn_ErrorHandle_t(uint32_t device_id, uint32_t core_id, uint32_t* client_id)> create_power_config_id;
+  std::function<Qnn_ErrorHandle_t(uint32_t client_id)> destroy_power_config_id;
+  std::function<Qnn_ErrorHandle_t(uint32_t client_id, const QnnHtpPerfInfrastructure_PowerConfig_t** configs)> set_power_config;
+
+  static HtpPerfOps from_infra(const QnnHtpDevice_PerfInfrastructure_t& infra);
+  bool valid() const { return create_power_config_id && destroy_power_config_id && set_power_config; }
+};
+
+// 전력 프로파일(높을수록 성능 우선)
+enum class HtpPowerProfile { kNone = 0, kRelaxed = 1, kSustained = 2, kBurst = 3 };
+
+// 러너 단계: 단계 전환마다 프로파일을 고른다
+// - kPrefill → burst, kDecode → sustained, kIdle → idle_timeout 이후 relaxed
+enum class RunnerPhase { kPrefill, kDecode, kIdle };
+
+const char* power_profile_name(HtpPowerProfile profile);
+
+// 적응형 HTP 전력 정책
+// - 성능을 올리는 전환(relaxed→sustained→burst)은 즉시 적용
+// - 성능을 내리는 전환은 현재 프로파일을 debounce_ms 이상 유지한 뒤에만 적용(짧은 단계 전환에 따른 투표 폭주 방지)
+//   보류된 전환은 다음 on_phase()/tick()에서 다시 평가
+// - kIdle 이후 idle_timeout_ms가 지나면 relaxed로 내린다(tick() 또는 내부 idle 타이머 스레드)
+// - 프로파일별 누적 시간/전환 횟수를 기록
+class HtpPowerPolicy {
+public:
+  struct Options {
+    int debounce_ms {50};
+    int idle_timeout_ms {2000};
+    bool idle_timer_thread {true}; // false면 tick()을 직접 호출(테스트용)
+  };
+
+  struct Stats {
+    double burst_ms {0.0};
+    double sustained_ms {0.0};
+    double relaxed_ms {0.0};
+    uint32_t switches {0};     // 실제 setPowerConfig 호출 수
+    uint32_t debounced {0};    // debounce로 보류된 전환 요청 수
+    uint32_t failures {0};     // setPowerConfig 실패 수
+  };
+
+  using Clock = std::function<int64_t()>; // 단조 증가 마이크로초
+
+  HtpPowerPolicy() = default;
+  ~HtpPowerPolicy();
+  HtpPowerPolicy(const HtpPowerPolicy&) = delete;
+  HtpPowerPolicy& operator=(const HtpPowerPolicy&) = delete;
+
+  // power config client 생성. clock을 비우면 steady_clock 사용
+  bool init(HtpPerfOps ops, const Options& options, Clock clock = nullptr);
+
+  // 투표자 등록/해제: 세션을 공유하는 러너마다 하나씩. 해제하면 idle로 간주
+  int add_voter();
+  void remove_voter(int voter);
+
+  // 단계 전환 통지(runner가 prefill/decode 시작, 요청 종료 시 호출)
+  // - 투표자들 중 가장 높은 단계(prefill > decode > idle)가 적용된다
+  void on_phase(RunnerPhase phase, int voter = 0);
+
+  // 보류된 전환/idle 타임아웃 평가(타이머 스레드가 다음 deadline에 호출)
+  void tick();
+
+  HtpPowerProfile current() const;
+  Stats stats() const;
+
+  // 타이머 정지 + client 해제(멱등). 백엔드 해제 전에 호출되어야 한다
+  void shutdown();
+
+private:
+  // mu_ 보유 상태에서 호출
+  void request_locked(HtpPowerProfile target, int64_t now);
+  bool apply_locked(HtpPowerProfile profile, int64_t now);
+  void account_locked(int64_t now);
+  void update_phase_locked(int64_t now);
+  int64_t next_deadline_locked() const;
+  void timer_loop();
+
+  HtpPerfOps ops_;
+  Options options_;
+  Clock clock_;
+  uint32_t client_id_ {0};
+  bool initialized_ {false};
+
+  mutable std::mutex mu_;
+  HtpPowerProfile current_ {HtpPowerProfile::kNone};
+  HtpPowerProfile pending_ {HtpPowerProfile::kNone};
+  RunnerPhase phase_ {RunnerPhase::kIdle};          // 투표자 단계의 최댓값
+  std::map<int, RunnerPhase> voters_;
+  int next_voter_ {1};
+  int64_t applied_at_us_ {0};   // 현재 프로파일 적용 시각
+  int64_t accounted_us_ {0};    // 통계 누적 기준 시각
+  int64_t idle_since_us_ {0};
+  Stats stats_;
+
+  std::thread timer_;
+  std::condition_variable timer_cv_;
+  bool stop_timer_ {false};
+};
+
+} // namespace llm_test
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <QnnCommon.h>
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace llm_test {
+
+// QNN 프로파일 수집기(opt-in)
+// - scope(샤드 × 그래프, 컨텍스트 생성 등)마다 QNN profile 핸들을 하나씩 만든다
+// - 실행/생성 직후 collect()로 새 이벤트만 읽어 scope별로 누적한다
+// - JSON 요약과 Chrome trace(chrome://tracing, Perfetto) 파일로 내보낸다
+class QnnProfiler {
+public:
+  enum class Level { kOff = 0, kBasic = 1, kDetailed = 2 };
+
+  QnnProfiler() = default;
+  ~QnnProfiler();
+  QnnProfiler(const QnnProfiler&) = delete;
+  QnnProfiler& operator=(const QnnProfiler&) = delete;
+
+  // QnnLoader::interface()/backend_handle()로 초기화. level=kOff면 아무 것도 하지 않음
+  bool init(const void* qnn_interface, void* backend, Level level);
+  bool enabled() const { return level_ != Level::kOff && backend_ != nullptr; }
+  Level level() const { return level_; }
+
+  // scope용 profile 핸들 생성(shard: 샤드 인덱스, -1=해당 없음). 실패/비활성 시 nullptr
+  Qnn_ProfileHandle_t create_handle(const std::string& scope, int shard, const std::string& graph);
+
+  // 실행 1회가 끝난 뒤 호출: 핸들의 새 이벤트를 읽어 누적(host 구간은 trace 배치에 사용)
+  void collect(Qnn_ProfileHandle_t handle, int64_t host_start_us, int64_t host_end_us);
+
+  // 요약 JSON / Chrome trace 내보내기
+  bool write_summary_json(const std::string& path) const;
+  bool write_chrome_trace(const std::string& path) const;
+
+  // scope별 평균 실행 시간을 표준출력으로 출력
+  void print_summary() const;
+
+  // 모든 profile 핸들 해제(멱등)
+  void release();
+
+private:
+  struct EventStat {
+    uint32_t unit {0};
+    uint64_t total {0};
+    uint64_t count {0};
+  };
+
+  struct TraceEvent {
+    std::string name;
+    uint64_t value {0};   // unit 그대로(마이크로초/사이클 등)
+    uint32_t unit {0};
+    bool is_node {false}; // detailed 모드의 하위(op) 이벤트
+  };
+
+  struct Invocation {
+    int64_t host_start_us {0};
+    int64_t host_end_us {0};
+    std::vector<TraceEvent> events;
+  };
+
+  struct Scope {
+    std::string name;
+    int shard {-1};
+    std::string graph;
+    uint32_t consumed {0};       // 이미 읽은 top-level 이벤트 수
+    uint64_t host_total_us {0};
+    std::map<std::string, EventStat> events;
+    std::vector<Invocation> invocations;
+  };
+
+  void read_event(uint64_t event_id, bool is_node, Scope& scope, Invocation& inv);
+
+  const void* interface_ {nullptr};
+  void* backend_ {nullptr};
+  Level level_ {Level::kOff};
+
+  mutable std::mutex mu_;
+  std::map<Qnn_ProfileHandle_t, Scope> scopes_;
+  std::vector<Qnn_ProfileHandle_t> order_; // 생성 순서 유지(출력용)
+};
+
+} // namespace llm_test
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace llm_test {
+
+// 고정 크기 작업 스레드 풀
+// - submit()한 작업은 FIFO 순서로 꺼내 실행한다
+// - wait_idle()은 큐가 비고 실행 중인 작업이 모두 끝날 때까지 대기
+// - 소멸 시 남은 작업을 모두 처리한 뒤 스레드를 join한다
+class ThreadPool {
+public:
+  // num_threads=0이면 hardware_concurrency 사용(최소 1)
+  explicit ThreadPool(size_t num_threads = 0);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  void submit(std::function<void()> task);
+  void wait_idle();
+  size_t size() const { return workers_.size(); }
+
+private:
+  void worker_loop();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mu_;
+  std::condition_variable cv_task_;
+  std::condition_variable cv_idle_;
+  size_t active_ {0};
+  bool stop_ {false};
+};
+
+// 단일 작업 스레드 + 고정 용량 작업 링(디코드 스텝 핫패스용)
+// - Job은 값으로 링에 복사되므로 submit()은 힙을 쓰지 않는다(std::function 큐 대신)
+// - 작업은 제출 순서대로 handler(job)로 실행. 링이 가득 차면 submit()은 빈 칸이 생길 때까지 대기
+// - wait_idle(): 제출된 작업이 모두 끝날 때까지 대기(배리어)
+// - 소멸 시 남은 작업을 모두 처리한 뒤 join
+template <typename Job>
+class SerialWorker {
+public:
+  SerialWorker(size_t capacity, std::function<void(const Job&)> handler)
+      : handler_(std::move(handler)), ring_(capacity > 0 ? capacity : 1) {
+    thread_ = std::thread([this] { worker_loop(); });
+  }
+  ~SerialWorker() {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      stop_ = true;
+    }
+    cv_task_.notify_all();
+    if (thread_.joinable()) thread_.join();
+  }
+  SerialWorker(const SerialWorker&) = delete;
+  SerialWorker& operator=(const SerialWorker&) = delete;
+
+  void submit(const Job& job) {
+    {
+      std::unique_lock<std::mutex> lk(mu_);
+      cv_idle_.wait(lk, [&] { return count_ < ring_.size(); });
+      ring_[(head_ + count_) % ring_.size()] = job;
+      ++count_;
+    }
+    cv_task_.notify_one();
+  }
+
+  void wait_idle() {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_idle_.wait(lk, [&] { return count_ == 0 && !active_; });
+  }
+
+private:
+  void worker_loop() {
+    for (;;) {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lk(mu_);
+        cv_task_.wait(lk, [&] { return stop_ || count_ > 0; });
+        if (count_ == 0) return;
+        job = ring_[head_];
+        head_ = (head_ + 1) % ring_.size();
+        --count_;
+        active_ = true;
+      }
+      cv_idle_.notify_all();   // 링에 빈 칸이 생김
+      handler_(job);
+      {
+        std::lock_guard<std::mutex> lk(mu_);
+        active_ = false;
+      }
+      cv_idle_.notify_all();
+    }
+  }
+
+  std::function<void(const Job&)> handler_;
+  std::vector<Job> ring_;
+  size_t head_ {0};
+  size_t count_ {0};
+  bool active_ {false};
+  bool stop_ {false};
+  std::mutex mu_;
+  std::condition_variable cv_task_;
+  std::condition_variable cv_idle_;   // 빈 칸 생김 / 유휴
+  std::thread thread_;
+};
+
+// 동시에 점유 중인 바이트 수 상한(예: 메모리에 올라와 있는 컨텍스트 바이너리 총량)
+// - acquire(n): 점유량 + n이 상한을 넘으면 release될 때까지 대기
+// - 단일 요청이 상한보다 크면 다른 점유가 없을 때 단독으로 허용(교착 방지)
+// - limit=0이면 제한 없음
+class ByteBudget {
+public:
+  explicit ByteBudget(uint64_t limit) : limit_(limit) {}
+
+  void acquire(uint64_t bytes);
+  void release(uint64_t bytes);
+  uint64_t in_use() const;
+  uint64_t peak() const;
+
+private:
+  uint64_t limit_;
+  uint64_t in_use_ {0};
+  uint64_t peak_ {0};
+  mutable std::mutex mu_;
+  std::condition_variable cv_;
+};
+
+} // namespace llm_test
@@ -17,6 +17,9 @@ public:
   // Llama 3.2 템플릿을 적용한 후 encode 호출 권장
   std::vector<int32_t> encode(const std::string& text, bool add_special = true, bool parse_special = true);
   std::string decode(const std::vector<int32_t>& tokens, bool special = true);
+  // 토큰 하나의 piece를 out 뒤에 이어 붙인다(임시 vector/string 없음, 반환값은 추가된 바이트)
+  // - out의 capacity가 충분하면 힙 할당이 없으므로 decode 루프에서 사용
+  size_t decode_token(int32_t token, std::string& out, bool special = true);
 
 private:
   void* model_;
@@ -0,0 +1,310 @@
+#include "async_logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <streambuf>
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#endif
+
+namespace llm_test {
+
+namespace {
+
+size_t round_up_pow2(size_t n) {
+  size_t p = 64;
+  while (p < n) p <<= 1;
+  return p;
+}
+
+#ifdef __ANDROID__
+int android_priority(LogLevel level) {
+  switch (level) {
+    case LogLevel::kError: return ANDROID_LOG_ERROR;
+    case LogLevel::kWarn: return ANDROID_LOG_WARN;
+    case LogLevel::kInfo: return ANDROID_LOG_INFO;
+    case LogLevel::kVerbose: return ANDROID_LOG_VERBOSE;
+    default: return ANDROID_LOG_DEBUG;
+  }
+}
+#endif
+
+// LogLine용 스레드별 고정 버퍼. 가득 차면 그때까지의 조각을 레코드로 게시하고 이어서 쓴다
+class LineBuffer : public std::streambuf {
+public:
+  LineBuffer() : os(this) {
+    setp(buf_, buf_ + sizeof(buf_));
+    default_flags_ = os.flags();
+  }
+
+  void begin(LogLevel level) {
+    level_ = level;
+    setp(buf_, buf_ + sizeof(buf_));
+    os.clear();
+    os.flags(default_flags_);
+    os.precision(6);
+    os.width(0);
+  }
+
+  void commit() {
+    size_t n = static_cast<size_t>(pptr() - pbase());
+    if (n > 0) AsyncLogger::instance().write(level_, pbase(), n);
+    setp(buf_, buf_ + sizeof(buf_));
+  }
+
+  std::ostream os;
+
+protected:
+  int_type overflow(int_type ch) override {
+    commit();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(ch);
+      pbump(1);
+    }
+    return traits_type::not_eof(ch);
+  }
+
+private:
+  char buf_[AsyncLogger::kRecordBytes];
+  LogLevel level_ {LogLevel::kInfo};
+  std::ios_base::fmtflags default_flags_;
+};
+
+LineBuffer& thread_line_buffer() {
+  thread_local LineBuffer line;
+  return line;
+}
+
+} // namespace
+
+AsyncLogger& AsyncLogger::instance() {
+  static AsyncLogger logger;
+  return logger;
+}
+
+AsyncLogger::~AsyncLogger() { stop(); }
+
+bool AsyncLogger::start(const Options& options) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (running_.load(std::memory_order_acquire)) return true;
+
+  sink_ = options.sink;
+  out_ = stdout;
+  if (sink_ == LogSink::kFile) {
+    out_ = options.file_path.empty() ? nullptr : std::fopen(options.file_path.c_str(), "w");
+    if (!out_) {
+      std::cerr << "[Log] Failed to open log file: " << options.file_path << ", using stdout\n";
+      sink_ = LogSink::kStdout;
+      out_ = stdout;
+    }
+  }
+#ifndef __ANDROID__
+  if (sink_ == LogSink::kLogcat) {
+    std::cerr << "[Log] logcat is only available on Android, using stdout\n";
+    sink_ = LogSink::kStdout;
+  }
+#endif
+
+  // 셀 배열은 최초 1회만 할당(재시작해도 크기 유지: 생산자가 항상 같은 배열을 본다)
+  if (!cells_) {
+    size_t capacity = round_up_pow2(std::max<size_t>(options.capacity, 1));
+    cells_.reset(new Cell[capacity]);
+    for (size_t i = 0; i < capacity; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    mask_ = capacity - 1;
+    enqueue_pos_.store(0, std::memory_order_relaxed);
+    dequeue_pos_ = 0;
+    drained_pos_.store(0, std::memory_order_relaxed);
+  }
+  set_level(options.level);
+  stop_.store(false, std::memory_order_relaxed);
+  drain_ = std::thread([this] { drain_loop(); });
+  running_.store(true, std::memory_order_release);
+  return true;
+}
+
+void AsyncLogger::stop() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (!running_.load(std::memory_order_acquire)) return;
+    // 이후 로그는 호출 스레드에서 직접 출력
+    running_.store(false, std::memory_order_release);
+    stop_.store(true, std::memory_order_release);
+  }
+  cv_.notify_all();
+  if (drain_.joinable()) drain_.join();
+
+  std::lock_guard<std::mutex> lk(mu_);
+  if (out_ && out_ != stdout) std::fclose(out_);
+  out_ = nullptr;
+  sink_ = LogSink::kStdout;
+}
+
+void AsyncLogger::flush() {
+  if (!running()) {
+    std::fflush(stdout);
+    return;
+  }
+  const uint64_t target = enqueue_pos_.load(std::memory_order_acquire);
+  while (running() && drained_pos_.load(std::memory_order_acquire) < target) {
+    cv_.notify_one();
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+}
+
+AsyncLogger::Cell* AsyncLogger::reserve(uint64_t& pos) {
+  uint64_t p = enqueue_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    Cell& cell = cells_[p & mask_];
+    uint64_t seq = cell.seq.load(std::memory_order_acquire);
+    int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(p);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(p, p + 1, std::memory_order_relaxed)) {
+        pos = p;
+        return &cell;
+      }
+    } else if (diff < 0) {
+      // 링이 가득 참: 기다리지 않고 버린다
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    } else {
+      p = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void AsyncLogger::publish(Cell* cell, uint64_t pos) {
+  cell->seq.store(pos + 1, std::memory_order_release);
+  published_.fetch_add(1, std::memory_order_relaxed);
+  // drain 스레드가 잠들어 있을 때만 깨운다(놓친 신호는 대기 타임아웃으로 회수)
+  if (sleeping_.load(std::memory_order_relaxed)) cv_.notify_one();
+}
+
+void AsyncLogger::write_sync(const char* text, size_t len) {
+  std::fwrite(text, 1, len, stdout);
+  std::fflush(stdout);
+}
+
+void AsyncLogger::log(LogLevel level, const char* fmt, ...) {
+  if (!enabled(level)) return;
+  va_list args;
+  va_start(args, fmt);
+  vlog(level, fmt, args);
+  va_end(args);
+}
+
+void AsyncLogger::vlog(LogLevel level, const char* fmt, va_list args, bool append_newline) {
+  if (!enabled(level)) return;
+  if (!running()) {
+    char buf[kRecordBytes];
+    int n = std::vsnprintf(buf, sizeof(buf), fmt, args);
+    if (n < 0) return;
+    write_sync(buf, std::min<size_t>(static_cast<size_t>(n), sizeof(buf) - 1));
+    if (append_newline) write_sync("\n", 1);
+    return;
+  }
+
+  uint64_t pos = 0;
+  Cell* cell = reserve(pos);
+  if (!cell) return;
+  // 슬롯에 직접 포맷(넘치면 잘린다)
+  int n = std::vsnprintf(cell->text, kRecordBytes, fmt, args);
+  size_t len = n < 0 ? 0 : std::min<size_t>(static_cast<size_t>(n), kRecordBytes - 1);
+  if (append_newline) {
+    if (len == kRecordBytes - 1) --len;
+    cell->text[len++] = '\n';
+  }
+  cell->level = static_cast<uint8_t>(level);
+  cell->len = static_cast<uint16_t>(len);
+  publish(cell, pos);
+}
+
+void AsyncLogger::write(LogLevel level, const char* text, size_t len) {
+  if (!running()) {
+    write_sync(text, len);
+    return;
+  }
+  while (len > 0) {
+    size_t chunk = std::min(len, kRecordBytes);
+    uint64_t pos = 0;
+    Cell* cell = reserve(pos);
+    if (!cell) return;
+    std::memcpy(cell->text, text, chunk);
+    cell->level = static_cast<uint8_t>(level);
+    cell->len = static_cast<uint16_t>(chunk);
+    publish(cell, pos);
+    text += chunk;
+    len -= chunk;
+  }
+}
+
+// 다음 레코드가 게시되어 있으면 하나를 내보낸다
+bool AsyncLogger::drain_once() {
+  Cell& cell = cells_[dequeue_pos_ & mask_];
+  if (cell.seq.load(std::memory_order_acquire) != dequeue_pos_ + 1) return false;
+  emit(cell);
+  cell.seq.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+  ++dequeue_pos_;
+  drained_pos_.store(dequeue_pos_, std::memory_order_release);
+  return true;
+}
+
+void AsyncLogger::emit(const Cell& cell) {
+#ifdef __ANDROID__
+  if (sink_ == LogSink::kLogcat) {
+    logcat_line_.append(cell.text, cell.len);
+    size_t nl;
+    while ((nl = logcat_line_.find('\n')) != std::string::npos) {
+      std::string line = logcat_line_.substr(0, nl);
+      if (!line.empty()) {
+        __android_log_write(android_priority(static_cast<LogLevel>(cell.level)), "QNN_LLM", line.c_str());
+      }
+      logcat_line_.erase(0, nl + 1);
+    }
+    return;
+  }
+#endif
+  std::fwrite(cell.text, 1, cell.len, out_);
+}
+
+// 모아서 쓰고, 링이 비었을 때만 fflush
+void AsyncLogger::drain_loop() {
+  for (;;) {
+    bool any = false;
+    while (drain_once()) any = true;
+    if (any && sink_ != LogSink::kLogcat) std::fflush(out_);
+    if (stop_.load(std::memory_order_acquire)) {
+      if (drain_once()) continue;
+      break;
+    }
+    std::unique_lock<std::mutex> lk(mu_);
+    sleeping_.store(true, std::memory_order_relaxed);
+    const Cell& next = cells_[dequeue_pos_ & mask_];
+    if (next.seq.load(std::memory_order_acquire) != dequeue_pos_ + 1 &&
+        !stop_.load(std::memory_order_acquire)) {
+      cv_.wait_for(lk, std::chrono::milliseconds(10));
+    }
+    sleeping_.store(false, std::memory_order_relaxed);
+  }
+#ifdef __ANDROID__
+  if (sink_ == LogSink::kLogcat && !logcat_line_.empty()) {
+    __android_log_write(ANDROID_LOG_INFO, "QNN_LLM", logcat_line_.c_str());
+    logcat_line_.clear();
+  }
+#endif
+}
+
+LogLine::LogLine(LogLevel level) {
+  if (!AsyncLogger::instance().enabled(level)) return;
+  LineBuffer& line = thread_line_buffer();
+  line.begin(level);
+  os_ = &line.os;
+}
+
+LogLine::~LogLine() {
+  if (os_) thread_line_buffer().commit();
+}
+
+} // namespace llm_test
@@ -15,9 +15,8 @@ namespace fs = std::filesystem;
 
 namespace llm_test {
 
-namespace {
-static bool mmap_file(const std::string& path, std::unique_ptr<MappingOwner>& owner) {
-  int fd = open(path.c_str(), O_RDONLY);
+bool map_file_readonly(const std::string& path, std::unique_ptr<MappingOwner>& owner) {
+  int fd = ::open(path.c_str(), O_RDONLY);
   if (fd < 0) return false;
   struct stat st{};
   if (fstat(fd, &st) != 0) { close(fd); return false; }
@@ -29,12 +28,56 @@ static bool mmap_file(const std::string& path, std::unique_ptr<MappingOwner>& ow
   owner->fd = fd;
   return true;
 }
+
+uint64_t file_size_of(const std::string& path) {
+  struct stat st{};
+  if (::stat(path.c_str(), &st) != 0) return 0;
+  return static_cast<uint64_t>(st.st_size);
 }
+
 MappingOwner::~MappingOwner() {
   if (addr && size) munmap(addr, size);
   if (fd >= 0) close(fd);
 }
 
+bool ContextBinary::open(const std::string& path, bool use_mmap) {
+  release();
+  if (use_mmap && map_file_readonly(path, map_)) return true;
+
+  std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+  if (!ifs) return false;
+  size_t sz = static_cast<size_t>(ifs.tellg());
+  ifs.seekg(0, std::ios::beg);
+  heap_.resize(sz);
+  if (!ifs.read(heap_.data(), sz)) {
+    std::vector<char>().swap(heap_);
+    return false;
+  }
+  return true;
+}
+
+const void* ContextBinary::data() const {
+  return map_ ? map_->addr : static_cast<const void*>(heap_.data());
+}
+
+size_t ContextBinary::size() const {
+  return map_ ? map_->size : heap_.size();
+}
+
+void ContextBinary::advise_sequential() {
+  if (map_ && map_->addr) madvise(map_->addr, map_->size, MADV_SEQUENTIAL);
+}
+
+void ContextBinary::prefetch() {
+  if (map_ && map_->addr) madvise(map_->addr, map_->size, MADV_WILLNEED);
+}
+
+void ContextBinary::release() {
+  if (map_ && map_->addr) madvise(map_->addr, map_->size, MADV_DONTNEED);
+  map_.reset();
+  std::vector<char>().swap(heap_);
+}
+
 
 // ctx_out 디렉터리 경로 보관
 FileShardProvider::FileShardProvider(const std::string& ctx_dir) : dir_(ctx_dir) {}
@@ -74,7 +117,7 @@ bool FileShardProvider::build_params(std::vector<void*>& out_params,
 
   for (const auto& s : shards_) {
     std::unique_ptr<MappingOwner> map_owner;
-    if (!mmap_file(s.path, map_owner)) {
+    if (!map_file_readonly(s.path, map_owner)) {
       std::cerr << "Failed to mmap shard: " << s.path << "\n";
       return false;
     }
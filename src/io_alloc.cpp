@@ -1,6 +1,9 @@
 #include "io_alloc.h"
 
 #include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace llm_test {
 
@@ -8,55 +11,229 @@ namespace llm_test {
 // - ExecuTorch의 QnnManager::AllocateTensor 흐름을 참고하되,
 //   현재 단계에서는 mutable buffer 공유가 없으므로 텐서별(per‑tensor) 할당만 수행한다.
 // - 추후 MethodMeta 기반 플랜을 적용하면 동일 인터페이스에서 공유 버퍼로 확장 가능.
+// - arena 모드에서는 텐서별 크기를 정렬 오프셋으로 누적한 뒤 익명 mmap slab 하나로 할당한다.
+
+namespace {
+
+constexpr std::size_t kHugePageBytes = 2u << 20;
+
+std::uint64_t align_up(std::uint64_t v, std::uint64_t a) { return (v + a - 1) & ~(a - 1); }
+
+} // namespace
 
 void QNNIOAllocator::build_from_qnnjson(const QnnJsonGraphDesc& desc) {
-  name_to_nbytes_.clear();
-  name_to_ptr_.clear();
-  total_allocated_bytes_ = 0;
+  release();
+  entries_.clear();
+  name_to_index_.clear();
+
+  // 입력 텐서 → 출력 텐서 순서. 같은 이름은 버퍼 하나를 공유
+  auto add = [&](const QnnJsonTensorDesc& t, bool is_output) {
+    auto it = name_to_index_.find(t.name);
+    if (it != name_to_index_.end()) {
+      entries_[it->second].is_output |= is_output;
+      return;
+    }
+    name_to_index_[t.name] = static_cast<int>(entries_.size());
+    Entry e;
+    e.name = t.name;
+    e.nbytes = t.nbytes;
+    e.is_output = is_output;
+    entries_.push_back(std::move(e));
+  };
+  for (const auto& t : desc.inputs) add(t, false);
+  for (const auto& t : desc.outputs) add(t, true);
+}
 
-  // 입력 텐서
-  for (const auto& t : desc.inputs) {
-    name_to_nbytes_[t.name] = t.nbytes;
+bool map_io_slab(std::uint64_t bytes, QNNIOAllocator::HugePages huge_pages, IOSlab& slab) {
+  slab = IOSlab();
+  if (bytes == 0) return false;
+  const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  void* base = MAP_FAILED;
+  std::size_t mapped = 0;
+#ifdef MAP_HUGETLB
+  if (huge_pages == QNNIOAllocator::HugePages::kHugeTLB) {
+    mapped = align_up(bytes, kHugePageBytes);
+    base = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    slab.hugetlb = base != MAP_FAILED;
+  }
+#endif
+  if (base == MAP_FAILED) {
+    // THP 승격이 가능하도록 slab이 2MB 이상이면 2MB 단위로 반올림
+    bool thp = huge_pages != QNNIOAllocator::HugePages::kNone && bytes >= kHugePageBytes;
+    mapped = align_up(bytes, thp ? kHugePageBytes : page);
+    base = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return false;
+#ifdef MADV_HUGEPAGE
+    if (thp) madvise(base, mapped, MADV_HUGEPAGE);
+#endif
   }
-  // 출력 텐서
-  for (const auto& t : desc.outputs) {
-    name_to_nbytes_[t.name] = t.nbytes;
+  slab.base = base;
+  slab.bytes = mapped;
+  return true;
+}
+
+std::uint64_t io_slab_bytes(std::uint64_t bytes, QNNIOAllocator::HugePages huge_pages) {
+  if (bytes == 0) return 0;
+  const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  bool huge = huge_pages == QNNIOAllocator::HugePages::kHugeTLB ||
+              (huge_pages != QNNIOAllocator::HugePages::kNone && bytes >= kHugePageBytes);
+  return align_up(bytes, huge ? kHugePageBytes : page);
+}
+
+bool map_zero_slab(std::uint64_t bytes, IOSlab& slab) {
+  slab = IOSlab();
+  if (bytes == 0) return false;
+  const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const std::size_t mapped = align_up(bytes, page);
+  // huge page 없이 매핑: 읽기 폴트가 0 페이지를 공유하도록 4KB 단위 유지
+  void* base = mmap(nullptr, mapped, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) return false;
+  slab.base = base;
+  slab.bytes = mapped;
+  return true;
+}
+
+void unmap_io_slab(IOSlab& slab) {
+  if (slab.base) munmap(slab.base, slab.bytes);
+  slab = IOSlab();
+}
+
+std::uint64_t QNNIOAllocator::set_external(const std::set<std::string>& names) {
+  std::uint64_t bytes = 0;
+  for (auto& e : entries_) {
+    if (e.external || !names.count(e.name)) continue;
+    e.external = true;
+    bytes += e.nbytes;
   }
+  return bytes;
+}
+
+std::size_t QNNIOAllocator::num_external() const {
+  std::size_t n = 0;
+  for (const auto& e : entries_) n += e.external ? 1 : 0;
+  return n;
+}
+
+std::uint64_t QNNIOAllocator::external_bytes() const {
+  std::uint64_t bytes = 0;
+  for (const auto& e : entries_) bytes += e.external ? e.nbytes : 0;
+  return bytes;
+}
+
+int QNNIOAllocator::index_of(const std::string& name) const {
+  auto it = name_to_index_.find(name);
+  return it != name_to_index_.end() ? it->second : -1;
 }
 
 std::uint64_t QNNIOAllocator::allocate(std::size_t alignment) {
   // 기존 버퍼 해제 후 새로 할당
   release();
+  if (!is_pow2(alignment)) alignment = options_.alignment;
+  if (!is_pow2(alignment)) alignment = kDefaultAlignment;
+  // posix_memalign은 sizeof(void*)의 배수를 요구
+  if (alignment < sizeof(void*)) alignment = sizeof(void*);
+
+  std::uint64_t total = options_.arena ? allocate_arena(alignment) : allocate_per_tensor(alignment);
+  for (const auto& e : entries_) {
+    if (!e.external) name_to_ptr_[e.name] = e.ptr;
+  }
+  return total;
+}
+
+std::uint64_t QNNIOAllocator::allocate_arena(std::size_t alignment) {
+  std::uint64_t cursor = 0;
+  for (auto& e : entries_) {
+    if (e.nbytes == 0 || e.external) continue;
+    cursor = align_up(cursor, alignment);
+    e.offset = cursor;
+    cursor += e.nbytes;
+  }
+  if (cursor == 0) return 0;
+
+  IOSlab slab;
+  if (!map_io_slab(cursor, options_.huge_pages, slab)) return 0;
+  void* base = slab.base;
+  arena_ = base;
+  arena_bytes_ = slab.bytes;
+  arena_hugetlb_ = slab.hugetlb;
+  mapped_bytes_ = slab.bytes;
+  num_regions_ = 1;
   total_allocated_bytes_ = 0;
+  for (auto& e : entries_) {
+    if (e.nbytes == 0 || e.external) continue;
+    e.ptr = static_cast<char*>(base) + e.offset;
+    total_allocated_bytes_ += e.nbytes;
+  }
+  return total_allocated_bytes_;
+}
 
-  for (const auto& kv : name_to_nbytes_) {
-    const std::string& name = kv.first;
-    std::size_t sz = static_cast<std::size_t>(kv.second);
-    if (sz == 0) {
-      name_to_ptr_[name] = nullptr;
-      continue;
-    }
+std::uint64_t QNNIOAllocator::allocate_per_tensor(std::size_t alignment) {
+  total_allocated_bytes_ = 0;
+  for (auto& e : entries_) {
+    e.offset = 0;
+    if (e.nbytes == 0 || e.external) continue;
     void* p = nullptr;
-    if (is_pow2(alignment)) {
-      if (posix_memalign(&p, alignment, sz) != 0) p = nullptr;
-    } else {
-      p = std::malloc(sz);
+    if (posix_memalign(&p, alignment, static_cast<std::size_t>(e.nbytes)) != 0) p = nullptr;
+    e.ptr = p;
+    if (p) {
+      total_allocated_bytes_ += e.nbytes;
+      mapped_bytes_ += align_up(e.nbytes, alignment);
+      ++num_regions_;
     }
-    name_to_ptr_[name] = p;
-    if (p) total_allocated_bytes_ += kv.second;
   }
   return total_allocated_bytes_;
 }
 
+bool QNNIOAllocator::adopt(const std::vector<void*>& ptrs) {
+  if (ptrs.size() != entries_.size()) return false;
+  release();
+  adopted_ = true;
+  for (std::size_t i = 0; i < entries_.size(); ++i) {
+    Entry& e = entries_[i];
+    if (e.external) continue;
+    e.ptr = e.nbytes ? ptrs[i] : nullptr;
+    e.offset = 0;
+    if (e.ptr) total_allocated_bytes_ += e.nbytes;
+    name_to_ptr_[e.name] = e.ptr;
+  }
+  return true;
+}
+
+std::uint64_t QNNIOAllocator::prefault() {
+  if (adopted_) return 0;
+  if (arena_) {
+    std::memset(arena_, 0, arena_bytes_);
+    return arena_bytes_;
+  }
+  std::uint64_t touched = 0;
+  for (const auto& e : entries_) {
+    if (!e.ptr) continue;
+    std::memset(e.ptr, 0, static_cast<std::size_t>(e.nbytes));
+    touched += e.nbytes;
+  }
+  return touched;
+}
+
 void QNNIOAllocator::release() {
-  for (auto& kv : name_to_ptr_) {
-    if (kv.second) std::free(kv.second);
-    kv.second = nullptr;
+  if (adopted_) {
+    // 외부 풀 소유: 주소만 비운다
+  } else if (arena_) {
+    munmap(arena_, arena_bytes_);
+  } else {
+    for (auto& e : entries_) {
+      if (e.ptr) std::free(e.ptr);
+    }
   }
+  for (auto& e : entries_) e.ptr = nullptr;
+  arena_ = nullptr;
+  arena_bytes_ = 0;
+  arena_hugetlb_ = false;
+  adopted_ = false;
   name_to_ptr_.clear();
   total_allocated_bytes_ = 0;
+  mapped_bytes_ = 0;
+  num_regions_ = 0;
 }
 
 } // namespace llm_test
-
-
@@ -0,0 +1,133 @@
+#include "io_planner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+
+namespace llm_test {
+
+// [설명]
+// - 버퍼 수가 수백~수천 개 수준이므로 O(n^2) greedy로 충분하다(초기화 시 1회)
+// - 크기가 큰 텐서부터 배치해야 단편화가 적다(TFLite의 greedy-by-size 방식과 동일한 발상)
+
+namespace {
+
+std::uint64_t align_up(std::uint64_t v, std::uint64_t a) { return (v + a - 1) & ~(a - 1); }
+
+bool is_pow2(std::size_t v) { return v && ((v & (v - 1)) == 0); }
+
+} // namespace
+
+QNNIOPlanner::QNNIOPlanner(const QNNIOAllocator::Options& options) : options_(options) {}
+
+void QNNIOPlanner::add_graph(QNNIOAllocator* alloc, int exec_step, int output_hold) {
+  if (!alloc) return;
+  Graph g;
+  g.alloc = alloc;
+  g.exec_step = exec_step;
+  g.output_hold = std::max(0, output_hold);
+  graphs_.push_back(g);
+}
+
+std::size_t QNNIOPlanner::alignment() const {
+  std::size_t a = is_pow2(options_.alignment) ? options_.alignment : QNNIOAllocator::kDefaultAlignment;
+  return std::max(a, sizeof(void*));
+}
+
+bool QNNIOPlanner::allocate() {
+  if (plan() == 0) return true;
+
+  // 3. 풀 매핑 후 allocator별 주소 배정
+  if (!map_io_slab(pool_bytes_, options_.huge_pages, slab_)) return false;
+  std::vector<std::vector<void*>> ptrs(graphs_.size());
+  for (std::size_t g = 0; g < graphs_.size(); ++g) {
+    ptrs[g].assign(graphs_[g].alloc->num_tensors(), nullptr);
+  }
+  for (const Buffer& b : buffers_) {
+    ptrs[b.graph][b.index] = static_cast<char*>(slab_.base) + b.offset;
+  }
+  for (std::size_t g = 0; g < graphs_.size(); ++g) {
+    if (!graphs_[g].alloc->adopt(ptrs[g])) {
+      release();
+      return false;
+    }
+  }
+  return true;
+}
+
+std::uint64_t QNNIOPlanner::plan() {
+  release();
+  const std::uint64_t align = alignment();
+  const std::uint64_t page = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+
+  // 1. 텐서별 수명 구간 + 그래프별로 따로 할당했을 때의 크기
+  buffers_.clear();
+  separate_bytes_ = 0;
+  for (std::size_t g = 0; g < graphs_.size(); ++g) {
+    const Graph& graph = graphs_[g];
+    std::uint64_t cursor = 0;
+    for (std::size_t i = 0; i < graph.alloc->num_tensors(); ++i) {
+      std::uint64_t nbytes = graph.alloc->nbytes(i);
+      if (nbytes == 0 || graph.alloc->is_external(i)) continue;
+      cursor = align_up(cursor, align) + nbytes;
+      Buffer b;
+      b.graph = g;
+      b.index = i;
+      b.nbytes = nbytes;
+      b.first = graph.exec_step;
+      b.last = graph.exec_step + (graph.alloc->is_output(i) ? graph.output_hold : 0);
+      buffers_.push_back(b);
+    }
+    if (cursor > 0) separate_bytes_ += align_up(cursor, page);
+  }
+
+  // 2. 크기 내림차순으로 배치: 이미 배치된 것 중 수명이 겹치는 버퍼들 사이의 가장 작은 빈틈
+  std::vector<std::size_t> order(buffers_.size());
+  for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+    return buffers_[a].nbytes > buffers_[b].nbytes;
+  });
+
+  std::vector<std::size_t> placed;
+  std::vector<const Buffer*> live;
+  pool_bytes_ = 0;
+  for (std::size_t idx : order) {
+    Buffer& b = buffers_[idx];
+    live.clear();
+    for (std::size_t p : placed) {
+      const Buffer& o = buffers_[p];
+      if (o.first <= b.last && b.first <= o.last) live.push_back(&o);
+    }
+    std::sort(live.begin(), live.end(), [](const Buffer* x, const Buffer* y) {
+      return x->offset < y->offset;
+    });
+
+    std::uint64_t best = UINT64_MAX;
+    std::uint64_t best_gap = UINT64_MAX;
+    std::uint64_t cursor = 0;
+    for (const Buffer* o : live) {
+      if (o->offset >= cursor + b.nbytes && o->offset - cursor < best_gap) {
+        best = cursor;
+        best_gap = o->offset - cursor;
+      }
+      cursor = std::max(cursor, align_up(o->offset + o->nbytes, align));
+    }
+    b.offset = best != UINT64_MAX ? best : cursor;
+    pool_bytes_ = std::max(pool_bytes_, b.offset + b.nbytes);
+    placed.push_back(idx);
+  }
+  return pool_bytes_;
+}
+
+std::uint64_t QNNIOPlanner::prefault() {
+  if (!slab_.base) return 0;
+  std::memset(slab_.base, 0, slab_.bytes);
+  return slab_.bytes;
+}
+
+void QNNIOPlanner::release() {
+  unmap_io_slab(slab_);
+  pool_bytes_ = 0;
+}
+
+} // namespace llm_test
@@ -1,6 +1,9 @@
 #include "llm_decode_runner.h"
 #include "llm_input_preparer.h"
+#include "llm_kv_writeback.h"
 #include "qnn_tensor_util.h"
+#include "binary_provider.h"
+#include "async_logger.h"
 
 #include <iostream>
 #include <fstream>
@@ -10,6 +13,19 @@
 
 namespace llm_test {
 
+namespace {
+
+// Output text reserved per generated token (Llama 3 pieces average a few bytes)
+constexpr size_t kReservedBytesPerToken = 16;
+
+QNNIOAllocator::HugePages parse_huge_pages(const std::string& mode) {
+  if (mode == "none") return QNNIOAllocator::HugePages::kNone;
+  if (mode == "hugetlb") return QNNIOAllocator::HugePages::kHugeTLB;
+  return QNNIOAllocator::HugePages::kTransparent;
+}
+
+} // namespace
+
 LLMDecodeRunner::LLMDecodeRunner(const LLMDecodeConfig& config)
     : config_(config),
       prefill_graph_(nullptr),
@@ -25,35 +41,78 @@ LLMDecodeRunner::LLMDecodeRunner(const LLMDecodeConfig& config)
       layers_per_shard_(0) {
 }
 
-LLMDecodeRunner::~LLMDecodeRunner() = default;
+LLMDecodeRunner::~LLMDecodeRunner() {
+  // Background warm-up / streaming load still use the loader and buffers
+  stream_cancel_.store(true);
+  wait_until_ready();
+  kv_worker_.reset();  // Drains pending writebacks while the cache and plans still exist
+  if (power_policy_) power_policy_->remove_voter(power_voter_);
+  unmap_io_slab(zero_kv_);
+  AsyncLogger::instance().flush();
+}
 
 bool LLMDecodeRunner::initialize() {
   // Track model load time
   stats_.model_load_start_ms = time_in_ms();
+  stats_.sample_memory("start");
+  
+  // 0. Asynchronous log sink for QNN callbacks and hot-path runner logs
+  //    (log_ring_records == 0 keeps the synchronous stdout path)
+  if (config_.log_ring_records > 0) {
+    AsyncLogger::Options log_opts;
+    log_opts.capacity = static_cast<size_t>(config_.log_ring_records);
+    log_opts.level = config_.log_level >= 1 ? LogLevel::kDebug : LogLevel::kError;
+    if (config_.log_sink == "logcat") {
+      log_opts.sink = LogSink::kLogcat;
+    } else if (config_.log_sink == "file") {
+      log_opts.sink = LogSink::kFile;
+      log_opts.file_path = config_.log_file;
+    }
+    AsyncLogger::instance().start(log_opts);
+  }
   
-  // 1. Load QNN backend
+  // 1. Attach to the process-wide QNN backend session
+  //    (dlopen + backend/device are shared with other runners using the same libraries)
   loader_.reset(new QnnLoader());
-  
-  // Set QNN log level (1=ERROR, 2=WARN, 3=INFO, 4=VERBOSE, 5=DEBUG)
-  loader_->set_log_level(config_.log_level);
-  
-  if (!loader_->load(config_.backend_so, config_.system_so)) {
-    error_msg_ = "Failed to load QNN backend";
+  loader_->set_async_enabled(config_.use_async_exec);
+  
+  int64_t session_start_us = time_in_us();
+  std::string session_error;
+  bool session_reused = false;
+  // QNN log level (1=ERROR, 2=WARN, 3=INFO, 4=VERBOSE, 5=DEBUG), applied by the first runner
+  auto session = QnnBackendSession::acquire(config_.backend_so, config_.system_so,
+                                            config_.log_level, &session_error, &session_reused);
+  if (!session) {
+    error_msg_ = "Failed to open QNN backend session: " + session_error;
     return false;
   }
-  
-  if (!loader_->get_interface_provider()) {
-    error_msg_ = "Failed to get QNN interface provider";
+  if (!loader_->attach(session)) {
+    error_msg_ = "Failed to attach to QNN backend session";
     return false;
   }
+  stats_.backend_session_ms = (time_in_us() - session_start_us) / 1000.0;
+  stats_.backend_session_reused = session_reused;
+  if (config_.log_level >= 1) {
+    std::cout << "[Init] QNN backend session " << (session_reused ? "reused" : "created")
+              << " in " << stats_.backend_session_ms << " ms\n";
+  }
   
-  if (!loader_->create_backend_and_device()) {
-    error_msg_ = "Failed to create QNN backend and device";
-    return false;
+  // Optional QNN profiling (must exist before contexts are created)
+  if (config_.profile_level > 0) {
+    profiler_.reset(new QnnProfiler());
+    auto level = config_.profile_level >= 2 ? QnnProfiler::Level::kDetailed
+                                            : QnnProfiler::Level::kBasic;
+    if (!profiler_->init(loader_->interface(), loader_->backend_handle(), level)) {
+      std::cerr << "[Init] Warning: QNN profiling unavailable, continuing without it\n";
+      profiler_.reset();
+    } else if (config_.log_level >= 1) {
+      std::cout << "[Init] QNN profiling enabled ("
+                << (level == QnnProfiler::Level::kDetailed ? "detailed" : "basic") << ")\n";
+    }
   }
   
-  // Enable HTP Performance Mode (Burst)
-  if (!loader_->enable_htp_performance_mode()) {
+  // HTP power: adaptive per-phase policy, or the legacy permanent burst vote
+  if (!setup_power_policy()) {
     if (config_.log_level >= 2) {
       std::cerr << "[Init] Warning: Failed to enable HTP performance mode\n";
     }
@@ -104,23 +163,49 @@ bool LLMDecodeRunner::initialize() {
     // Multi-context mode (sharding)
     if (!load_multi_context_graphs()) return false;
     if (!extract_multi_context_metadata()) return false;
+    if (!apply_memory_budget()) return false;
+    if (!load_multi_context_binaries()) return false;
     if (!setup_multi_context_kv_cache()) return false;
-    if (!setup_multi_context_io_allocators()) return false;
+    if (!setup_zero_kv()) return false;
     if (!allocate_shared_buffers()) return false;
+    if (!setup_multi_context_io_allocators()) return false;
+    if (!check_memory_budget()) return false;
+    setup_prefix_cache();
+    stats_.sample_memory("allocated");
+    if (config_.async_kv_writeback) {
+      // At most one job is in flight (synced before the next shard), one slot per shard is ample
+      kv_worker_.reset(new SerialWorker<KVWritebackJob>(
+          config_.num_shards, [this](const KVWritebackJob& job) { run_kv_writeback(job); }));
+    }
+    if (config_.streaming_load) {
+      // Contexts + plans are built in the background; prefill waits per shard
+      if (!start_streaming_load()) return false;
+    } else {
+      if (!build_multi_context_plans()) return false;
+    }
   } else {
     // Single-context mode
     if (!load_graphs()) return false;
     if (!extract_metadata()) return false;
+    if (!apply_memory_budget()) return false;
+    if (!load_graph_context()) return false;
     if (!setup_kv_cache()) return false;
+    if (!setup_zero_kv()) return false;
     if (!setup_io_allocators()) return false;
+    if (!check_memory_budget()) return false;
+    setup_prefix_cache();
+    stats_.sample_memory("allocated");
   }
   
   // 6. Load tokenizer
+  long tokenizer_rss_before_kb = read_rss_kb();
   tokenizer_.reset(new LlamaTokenizer());
   if (!tokenizer_->init(config_.tokenizer_path.c_str())) {
     error_msg_ = "Failed to load tokenizer";
     return false;
   }
+  stats_.tokenizer_rss_kb = std::max(0L, read_rss_kb() - tokenizer_rss_before_kb);
+  stats_.sample_memory("initialized");
   
   // Track model load end time
   stats_.model_load_end_ms = time_in_ms();
@@ -131,6 +216,146 @@ bool LLMDecodeRunner::initialize() {
     std::cout << "[Init] Model load time: " << load_time_s << " seconds\n";
   }
   
+  // Streaming start-up: readiness is published by the background loader.
+  // Warm-up would race with the first request, so it is skipped.
+  if (config_.use_multi_context && config_.streaming_load) {
+    if (config_.warmup_iters > 0 && config_.log_level >= 1) {
+      std::cout << "[Warmup] Skipped in streaming load mode\n";
+    }
+    return true;
+  }
+  
+  // 7. Optional warm-up (foreground or background)
+  if (config_.warmup_iters > 0) {
+    if (config_.warmup_async) {
+      warmup_thread_ = std::thread([this]() {
+        if (!warmup(config_.warmup_iters)) {
+          std::cerr << "[Warmup] Warning: " << error_msg_ << "\n";
+        }
+        ready_.store(true, std::memory_order_release);
+      });
+      return true;
+    }
+    if (!warmup(config_.warmup_iters)) {
+      std::cerr << "[Warmup] Warning: " << error_msg_ << "\n";
+    }
+  }
+  ready_.store(true, std::memory_order_release);
+  
+  return true;
+}
+
+void LLMDecodeRunner::wait_until_ready() {
+  if (warmup_thread_.joinable()) {
+    warmup_thread_.join();
+  }
+  if (stream_thread_.joinable()) {
+    stream_thread_.join();
+  }
+}
+
+bool LLMDecodeRunner::warmup(int iterations) {
+  if (iterations <= 0) iterations = std::max(1, config_.warmup_iters);
+  int64_t start_us = time_in_us();
+  set_power_phase(RunnerPhase::kPrefill);
+  
+  // 1. Pre-fault host buffers (first-touch page faults)
+  uint64_t prefault_bytes = 0;
+  if (kv_manager_) prefault_bytes += kv_manager_->prefault();
+  if (io_planner_) prefault_bytes += io_planner_->prefault();
+  std::vector<ExecutionPlan*> prefill_plans;
+  std::vector<ExecutionPlan*> kv_plans;
+  // Decode V outputs may still point at cache row n_past from the last generate()
+  // (bind_decode_v_outputs); synthetic steps write to the allocator buffers instead
+  auto unbind_v_outputs = [](ExecutionPlan& plan, const QNNIOAllocator* alloc) {
+    if (!alloc) return;
+    for (const auto& kv : plan.v_out) {
+      int index = alloc->index_of(plan.output_desc(kv.slot).name);
+      if (index >= 0) plan.bind_output(kv.slot, alloc->data(index));
+    }
+  };
+  if (config_.use_multi_context) {
+    for (int i = 0; i < config_.num_shards; ++i) {
+      if (!wait_shard_ready(i)) return false;
+    }
+    for (auto& shard : shards_) {
+      if (shard.prefill_alloc) prefault_bytes += shard.prefill_alloc->prefault();
+      if (shard.kv_alloc) prefault_bytes += shard.kv_alloc->prefault();
+      unbind_v_outputs(shard.kv_plan, shard.kv_alloc.get());
+      prefill_plans.push_back(&shard.prefill_plan);
+      kv_plans.push_back(&shard.kv_plan);
+    }
+  } else {
+    if (prefill_alloc_) prefault_bytes += prefill_alloc_->prefault();
+    if (kv_alloc_) prefault_bytes += kv_alloc_->prefault();
+    unbind_v_outputs(kv_plan_, kv_alloc_.get());
+    prefill_plans.push_back(&prefill_plan_);
+    kv_plans.push_back(&kv_plan_);
+  }
+  
+  // 2. Synthetic executions: the first step is cold, the rest are warm
+  double prefill_warm_sum = 0.0;
+  double decode_warm_sum = 0.0;
+  for (int it = 0; it < iterations; ++it) {
+    int64_t t0 = time_in_us();
+    for (ExecutionPlan* plan : prefill_plans) {
+      if (!warmup_execute(*plan, prefill_ar_len_)) return false;
+    }
+    double prefill_ms = (time_in_us() - t0) / 1000.0;
+    
+    int64_t t1 = time_in_us();
+    for (ExecutionPlan* plan : kv_plans) {
+      if (!warmup_execute(*plan, kv_ar_len_)) return false;
+    }
+    double decode_ms = (time_in_us() - t1) / 1000.0;
+    
+    if (it == 0) {
+      stats_.cold_prefill_step_ms = prefill_ms;
+      stats_.cold_decode_step_ms = decode_ms;
+    } else {
+      prefill_warm_sum += prefill_ms;
+      decode_warm_sum += decode_ms;
+    }
+  }
+  if (iterations > 1) {
+    stats_.warm_prefill_step_ms = prefill_warm_sum / (iterations - 1);
+    stats_.warm_decode_step_ms = decode_warm_sum / (iterations - 1);
+  }
+  stats_.warmup_prefault_bytes = prefault_bytes;
+  stats_.warmup_ms = (time_in_us() - start_us) / 1000.0;
+  stats_.sample_memory("warmup");
+  set_power_phase(RunnerPhase::kIdle);
+  
+  if (config_.log_level >= 1) {
+    std::cout << "[Warmup] " << iterations << " iteration(s) in " << stats_.warmup_ms
+              << " ms (prefill cold " << stats_.cold_prefill_step_ms << " ms / warm "
+              << stats_.warm_prefill_step_ms << " ms, decode cold "
+              << stats_.cold_decode_step_ms << " ms / warm "
+              << stats_.warm_decode_step_ms << " ms)\n";
+  }
+  return true;
+}
+
+bool LLMDecodeRunner::warmup_execute(ExecutionPlan& plan, int32_t ar_len) {
+  if (!plan.valid()) return true;
+  
+  if (plan.token_in >= 0) {
+    std::vector<int32_t> tokens(ar_len, 0);
+    InputPreparer::fill_tokens(plan.input_data(plan.token_in), plan.input_desc(plan.token_in), tokens);
+  }
+  if (plan.pos_in >= 0) {
+    InputPreparer::fill_positions(plan.input_data(plan.pos_in), plan.input_desc(plan.pos_in), ar_len, 0);
+  }
+  if (plan.mask_in >= 0) {
+    InputPreparer::fill_attention_mask(plan.input_data(plan.mask_in), plan.input_desc(plan.mask_in), ar_len);
+  }
+  
+  int64_t exec_start_us = time_in_us();
+  if (!plan.execute(*loader_)) {
+    error_msg_ = "Warm-up execution failed";
+    return false;
+  }
+  collect_profile(plan.profile(), exec_start_us);
   return true;
 }
 
@@ -155,29 +380,43 @@ bool LLMDecodeRunner::load_graphs() {
     std::cout << "[Graphs] Loaded prefill_forward and kv_forward\n";
   }
   
+  return true;
+}
+
+bool LLMDecodeRunner::load_graph_context() {
   // Load context binary
   std::string ctx_bin = config_.ctx_dir + "/forward_0.bin";
   
-  // Read binary file
-  std::ifstream ifs(ctx_bin, std::ios::binary | std::ios::ate);
-  if (!ifs) {
+  // Map (or read) the binary; released right after the context is created
+  int64_t load_start_us = time_in_us();
+  stats_.load_rss_before_kb = read_rss_kb();
+  ContextBinary binary;
+  if (!binary.open(ctx_bin, config_.use_mmap_load)) {
     error_msg_ = "Failed to open context binary: " + ctx_bin;
     return false;
   }
+  binary.advise_sequential();
+  binary.prefetch();
+  stats_.load_used_mmap = binary.mapped();
   
-  size_t size = ifs.tellg();
-  ifs.seekg(0, std::ios::beg);
-  std::vector<char> buffer(size);
-  if (!ifs.read(buffer.data(), size)) {
-    error_msg_ = "Failed to read context binary: " + ctx_bin;
-    return false;
-  }
-  ifs.close();
-  
-  if (!loader_->create_context_from_binary(buffer.data(), size)) {
+  Qnn_ProfileHandle_t ctx_profile = create_profile("ctx0/context_create", 0, "");
+  int64_t create_start_us = time_in_us();
+  if (!loader_->create_context_from_binary(binary.data(), binary.size(), ctx_profile)) {
     error_msg_ = "Failed to create context from binary: " + ctx_bin;
     return false;
   }
+  collect_profile(ctx_profile, create_start_us);
+  
+  ShardLoadStat load_stat;
+  load_stat.bytes = binary.size();
+  load_stat.read_ms = (create_start_us - load_start_us) / 1000.0;
+  load_stat.create_ms = (time_in_us() - create_start_us) / 1000.0;
+  stats_.shard_loads.assign(1, load_stat);
+  binary.release();
+  stats_.context_load_ms = (time_in_us() - load_start_us) / 1000.0;
+  stats_.load_rss_after_kb = read_rss_kb();
+  stats_.load_peak_rss_kb = read_peak_rss_kb();
+  stats_.sample_memory("contexts");
   
   // Retrieve graphs
   if (!loader_->retrieve_graph(0, "prefill_forward") ||
@@ -291,10 +530,12 @@ bool LLMDecodeRunner::setup_kv_cache() {
   };
   
   kv_manager_.reset(new LLMKVCacheManager(kv_meta));
+  kv_manager_->set_options(kv_cache_options());
   if (!kv_manager_->allocate()) {
     error_msg_ = "Failed to allocate KV cache memory";
     return false;
   }
+  stats_.kv_cache_bytes = kv_manager_->mapped_bytes();
   
   if (config_.log_level >= 1) {
     std::cout << "[KV Cache] Allocated "
@@ -308,11 +549,6 @@ bool LLMDecodeRunner::setup_kv_cache() {
   kv_kv_mapping_ = LLMKVCacheMapper::build_mapping(
       *kv_graph_, num_heads_, head_dim_);
   
-  prefill_kv_override_ = LLMKVCacheMapper::create_buffer_override(
-      prefill_kv_mapping_, *kv_manager_);
-  kv_kv_override_ = LLMKVCacheMapper::create_buffer_override(
-      kv_kv_mapping_, *kv_manager_);
-  
   if (config_.log_level >= 1) {
     std::cout << "[KV Binding] Prefill: " << prefill_kv_mapping_.size()
               << " tensors, Decode: " << kv_kv_mapping_.size() << " tensors\n";
@@ -323,63 +559,83 @@ bool LLMDecodeRunner::setup_kv_cache() {
 
 bool LLMDecodeRunner::setup_io_allocators() {
   // 1. Allocate I/O buffers
+  ExecutionPlan::Layout prefill_layout{0, num_layers_, num_heads_, head_dim_, prefill_ar_len_};
+  ExecutionPlan::Layout kv_layout{0, num_layers_, num_heads_, head_dim_, kv_ar_len_};
+  
   prefill_alloc_.reset(new QNNIOAllocator());
+  prefill_alloc_->set_options(io_alloc_options());
   prefill_alloc_->build_from_qnnjson(*prefill_graph_);
-  auto prefill_bytes = prefill_alloc_->allocate(64);
+  exclude_kv_inputs(*prefill_alloc_, *prefill_graph_, prefill_layout, &prefill_kv_mapping_, "ctx0");
   
   kv_alloc_.reset(new QNNIOAllocator());
+  kv_alloc_->set_options(io_alloc_options());
   kv_alloc_->build_from_qnnjson(*kv_graph_);
-  auto kv_bytes = kv_alloc_->allocate(64);
-  
-  // 2. Pre-build QNN tensor holders (one-time setup)
-  prefill_input_holders_.clear();
-  prefill_output_holders_.clear();
-  kv_input_holders_.clear();
-  kv_output_holders_.clear();
-  
-  // Prefill input holders
-  for (const auto& t : prefill_graph_->inputs) {
-    auto h = std::make_unique<QnnTensorHolder>();
-    // Initialize with nullptr, will update pointer before execution
-    h->init_from_json(t, nullptr, t.nbytes, true);
-    prefill_input_holders_.push_back(std::move(h));
-  }
+  exclude_kv_inputs(*kv_alloc_, *kv_graph_, kv_layout, &kv_kv_mapping_, "ctx0");
+  
+  // Prefill finishes (logits read, cache rearranged) before the first decode step
+  if (!allocate_io({{prefill_alloc_.get(), 0}, {kv_alloc_.get(), 2}})) return false;
+  record_io_graph("ctx0", *prefill_graph_, *prefill_alloc_);
+  record_io_graph("ctx0", *kv_graph_, *kv_alloc_);
+  auto prefill_bytes = prefill_alloc_->total_allocated_bytes();
+  auto kv_bytes = kv_alloc_->total_allocated_bytes();
+  
+  // 2. Build execution plans (one-time setup): graph handle + pre-bound tensors
+  auto kv_resolve = [this](int layer, int head, bool is_v) -> void* {
+    return is_v ? kv_manager_->get_v_cache(layer, head).input_buffer
+                : kv_manager_->get_k_cache(layer, head).input_buffer;
+  };
+  auto alloc_resolve = [](QNNIOAllocator& alloc) {
+    return [&alloc](const QnnJsonTensorDesc& t) -> void* {
+      auto it = alloc.bindings().find(t.name);
+      return (it != alloc.bindings().end()) ? it->second : nullptr;
+    };
+  };
   
-  // Prefill output holders
-  for (const auto& t : prefill_graph_->outputs) {
-    auto h = std::make_unique<QnnTensorHolder>();
-    h->init_from_json(t, nullptr, t.nbytes, false);
-    prefill_output_holders_.push_back(std::move(h));
+  if (!prefill_plan_.build(*loader_, 0, *prefill_graph_, prefill_layout,
+                           alloc_resolve(*prefill_alloc_), kv_resolve, &prefill_kv_mapping_)) {
+    error_msg_ = "Failed to build prefill execution plan";
+    return false;
   }
   
-  // KV input holders
-  for (const auto& t : kv_graph_->inputs) {
-    auto h = std::make_unique<QnnTensorHolder>();
-    h->init_from_json(t, nullptr, t.nbytes, true);
-    kv_input_holders_.push_back(std::move(h));
+  if (!kv_plan_.build(*loader_, 0, *kv_graph_, kv_layout,
+                      alloc_resolve(*kv_alloc_), kv_resolve, &kv_kv_mapping_)) {
+    error_msg_ = "Failed to build decode execution plan";
+    return false;
   }
   
-  // KV output holders
-  for (const auto& t : kv_graph_->outputs) {
-    auto h = std::make_unique<QnnTensorHolder>();
-    h->init_from_json(t, nullptr, t.nbytes, false);
-    kv_output_holders_.push_back(std::move(h));
+  if (prefill_plan_.logits_out < 0 || kv_plan_.logits_out < 0) {
+    error_msg_ = "Logits output not found";
+    return false;
   }
+  attach_plan_profiles(prefill_plan_, kv_plan_, 0, "ctx0");
   
   if (config_.log_level >= 1) {
     std::cout << "[I/O] Prefill: " << (prefill_bytes / 1024.0)
               << " KiB, Decode: " << (kv_bytes / 1024.0) << " KiB\n";
-    std::cout << "[I/O] Pre-built tensors - Prefill: " 
-              << prefill_input_holders_.size() << " in, "
-              << prefill_output_holders_.size() << " out / Decode: "
-              << kv_input_holders_.size() << " in, "
-              << kv_output_holders_.size() << " out\n";
+    std::cout << "[I/O] Execution plans - Prefill: " 
+              << prefill_plan_.num_inputs() << " in, "
+              << prefill_plan_.num_outputs() << " out / Decode: "
+              << kv_plan_.num_inputs() << " in, "
+              << kv_plan_.num_outputs() << " out\n";
   }
   
   return true;
 }
 
 bool LLMDecodeRunner::generate(const std::string& prompt, std::string& output_text) {
+  // A background warm-up must finish before the plans are reused
+  // (a streaming load is not joined: prefill waits per shard instead)
+  if (warmup_thread_.joinable()) {
+    warmup_thread_.join();
+  }
+  
+  // Power: burst for prefill; back to idle on every exit path
+  struct IdleOnExit {
+    LLMDecodeRunner* runner;
+    ~IdleOnExit() { runner->set_power_phase(RunnerPhase::kIdle); }
+  } idle_on_exit{this};
+  set_power_phase(RunnerPhase::kPrefill);
+  
   // Start inference timing
   stats_.inference_start_ms = time_in_ms();
   
@@ -393,8 +649,8 @@ bool LLMDecodeRunner::generate(const std::string& prompt, std::string& output_te
   stats_.num_prompt_tokens = tokens.size();
   
   if (config_.log_level >= 1) {
-    std::cout << "\n[Generate] Prompt: \"" << prompt << "\"\n";
-    std::cout << "[Generate] Tokens: " << tokens.size() << "\n";
+    LogLine() << "\n[Generate] Prompt: \"" << prompt << "\"\n";
+    LogLine() << "[Generate] Tokens: " << tokens.size() << "\n";
   }
   
   // 3. Run prefill (choose single vs multi-context)
@@ -413,16 +669,25 @@ bool LLMDecodeRunner::generate(const std::string& prompt, std::string& output_te
   // Mark prefill end (TTFT)
   stats_.prompt_eval_end_ms = time_in_ms();
   stats_.first_token_ms = stats_.prompt_eval_end_ms;
+  stats_.sample_memory("prefill");
+  set_power_phase(RunnerPhase::kDecode);
   
   // 4. Decode first token
-  std::string decoded = tokenizer_->decode({next_token});
-  output_text = decoded;
+  // Containers touched per token are sized up front so warm decode steps
+  // (including the overlapped detokenize) do not hit the heap
+  tokens.reserve(tokens.size() + config_.max_gen_tokens);
+  output_text.clear();
+  output_text.reserve(static_cast<size_t>(config_.max_gen_tokens) * kReservedBytesPerToken);
+  std::string decoded;
+  decoded.reserve(kReservedBytesPerToken);
+  tokenizer_->decode_token(next_token, decoded);
+  output_text += decoded;
   
   if (config_.log_level >= 1) {
-    std::cout << "[Prefill] Next token: " << next_token
+    LogLine() << "[Prefill] Next token: " << next_token
               << " → \"" << decoded << "\"\n";
     double ttft_s = (stats_.first_token_ms - stats_.inference_start_ms) / 1000.0;
-    std::cout << "[Prefill] TTFT: " << ttft_s << " seconds\n";
+    LogLine() << "[Prefill] TTFT: " << ttft_s << " seconds\n";
   }
   
   tokens.push_back(next_token);
@@ -430,73 +695,118 @@ bool LLMDecodeRunner::generate(const std::string& prompt, std::string& output_te
   
   // 4. Rearrange cache for decode (single-context only, multi-context does it internally)
   if (!config_.use_multi_context) {
-    if (config_.log_level >= 1) {
-      std::cout << "\n[Rearrange] Expanding KV cache: "
+    if (config_.log_level >= 1 && !prefill_zero_kv_) {
+      LogLine() << "\n[Rearrange] Expanding KV cache: "
                 << prefill_cache_len_ << " → " << kv_cache_len_ << "\n";
     }
-    kv_manager_->rearrange_cache(prefill_ar_len_, kv_ar_len_);
+    finish_prefill_layout(n_update);
   }
   
   // 5. Decode loop
   if (config_.log_level >= 1) {
-    std::cout << "\n[Decode] Generating up to " << config_.max_gen_tokens
+    LogLine() << "\n[Decode] Generating up to " << config_.max_gen_tokens
               << " tokens...\n";
-    std::cout << "[Decode] Starting from position: " << n_update
+    LogLine() << "[Decode] Starting from position: " << n_update
               << " (total prefill tokens: " << tokens.size() << ")\n";
-    std::cout << "[Output] " << decoded;
-    std::cout.flush();
+    LogLine() << "[Output] " << decoded;
   }
   
-  int32_t initial_tokens = n_update;
+  int32_t initial_tokens = n_update;  // Occupied positions (fewer than the prompt after shifts)
+  stats_.direct_v_binding = config_.direct_v_binding;
+  
+  // Detokenize/print of the previous token is deferred into the next decode
+  // step so it overlaps with accelerator execution
+  int32_t pending_token = -1;
+  std::function<void()> emit_pending = [&]() {
+    if (pending_token < 0) return;
+    decoded.clear();
+    tokenizer_->decode_token(pending_token, decoded);
+    output_text += decoded;
+    if (config_.log_level >= 1) {
+      LogLine() << decoded;
+    }
+    pending_token = -1;
+  };
   
-  for (int gen_idx = 0; gen_idx < config_.max_gen_tokens - 1; ++gen_idx) {
-    int32_t n_past = initial_tokens + gen_idx;
+  double steady_step_sum_ms = 0.0;
+  int steady_steps = 0;
+  int32_t n_past = initial_tokens;
+  for (int gen_idx = 0; gen_idx < config_.max_gen_tokens - 1; ++gen_idx, ++n_past) {
     int32_t token_out = 0;
     
+    // KV cache full: shift (positions restart from the compacted length) or stop
+    if (n_past >= kv_cache_len_) {
+      if (!context_shift_usable()) {
+        if (config_.log_level >= 1) {
+          LogLine() << "\n[Decode] KV cache full (" << kv_cache_len_ << " positions), stopping\n";
+        }
+        break;
+      }
+      if (!shift_context(n_past, kv_ar_len_, true)) {
+        return false;
+      }
+    }
+    int64_t step_start_us = time_in_us();
+    
     // Run decode step (choose single vs multi-context)
     if (config_.use_multi_context) {
-      if (!run_multi_context_decode_step(next_token, n_past, token_out)) {
+      if (!run_multi_context_decode_step(next_token, n_past, token_out, &emit_pending)) {
         return false;
       }
     } else {
-      if (!run_decode_step(next_token, n_past, token_out)) {
+      if (!run_decode_step(next_token, n_past, token_out, &emit_pending)) {
         return false;
       }
     }
+    double step_ms = (time_in_us() - step_start_us) / 1000.0;
+    if (gen_idx == 0) {
+      stats_.first_decode_step_ms = step_ms;
+    } else {
+      steady_step_sum_ms += step_ms;
+      ++steady_steps;
+    }
     
     // Check EOS
     if (token_out == 128001) {
       if (config_.log_level >= 1) {
-        std::cout << "\n[Decode] EOS token detected\n";
+        LogLine() << "\n[Decode] EOS token detected\n";
       }
       break;
     }
     
-    // Decode and append
-    decoded = tokenizer_->decode({token_out});
-    output_text += decoded;
-    
-    if (config_.log_level >= 1) {
-      std::cout << decoded;
-      std::cout.flush();
-    }
+    // Decode and append (emitted during the next step, or after the loop)
+    pending_token = token_out;
     
     next_token = token_out;
     tokens.push_back(token_out);
     stats_.num_generated_tokens++;
   }
+  emit_pending();
+  flush_kv_writeback_stats();
+  if (steady_steps > 0) {
+    stats_.steady_decode_step_ms = steady_step_sum_ms / steady_steps;
+  }
   
   // Mark inference end
   stats_.inference_end_ms = time_in_ms();
+  stats_.sample_memory("decode");
+  update_power_stats();
   
   if (config_.log_level >= 1) {
-    std::cout << "\n\n[Generate] Complete. Total tokens: " << tokens.size() << "\n";
+    LogLine() << "\n\n[Generate] Complete. Total tokens: " << tokens.size() << "\n";
   }
   
+  // Drain queued log records before the synchronous report
+  AsyncLogger& logger = AsyncLogger::instance();
+  logger.flush();
+  stats_.log_records = logger.records();
+  stats_.log_dropped = logger.dropped();
+  
   // Print performance report
   if (config_.log_level >= 1) {
     stats_.print_report();
   }
+  write_profile_report();
   
   return true;
 }
@@ -505,34 +815,38 @@ bool LLMDecodeRunner::run_prefill(const std::vector<int32_t>& tokens,
                                    int32_t& next_token,
                                    int32_t& n_update) {
   if (config_.log_level >= 1) {
-    std::cout << "[Single-Context Prefill] Starting with " << tokens.size() << " tokens\n";
+    LogLine() << "[Single-Context Prefill] Starting with " << tokens.size() << " tokens\n";
   }
   
-  int32_t n_past = 0;
+  auto& plan = prefill_plan_;
+  int32_t n_past = 0;     // Occupied cache positions (= position id of the next token)
+  int32_t consumed = 0;   // Prompt tokens ingested (ahead of n_past after a context shift)
   int32_t num_tokens = tokens.size();
+  begin_prefill(num_tokens);
+  bind_prefill_kv_inputs(plan);
+  const int32_t k_stride = prefill_k_stride();
   
-  auto get_prefill_buffer = [&](const std::string& name) -> void* {
-    auto it = prefill_kv_override_.find(name);
-    if (it != prefill_kv_override_.end()) return it->second;
-    
-    auto& bindings = prefill_alloc_->bindings();
-    auto bit = bindings.find(name);
-    return (bit != bindings.end()) ? bit->second : nullptr;
-  };
+  // Shared prefix: cached chunks are copied in, prefill resumes at the first uncached chunk
+  n_past = consumed = restore_prefix(tokens);
   
   // Multiple iteration prefill: 토큰을 prefill_ar_len 크기로 나누어 처리
-  while (n_past < num_tokens) {
-    int32_t chunk_size = std::min(prefill_ar_len_, num_tokens - n_past);
+  while (consumed < num_tokens) {
+    int32_t chunk_size = std::min(prefill_ar_len_, num_tokens - consumed);
+    
+    // Prompt longer than the prefill cache: shift before the chunk is written
+    if (!shift_context(n_past, chunk_size, false)) {
+      return false;
+    }
     
     if (config_.log_level >= 1) {
-      std::cout << "[Single-Context Prefill] Iteration: n_past=" << n_past 
+      LogLine() << "[Single-Context Prefill] Iteration: n_past=" << n_past 
                 << ", chunk_size=" << chunk_size << "\n";
     }
     
     // Extract current chunk of tokens
     std::vector<int32_t> chunk_tokens(
-      tokens.begin() + n_past,
-      tokens.begin() + n_past + chunk_size
+      tokens.begin() + consumed,
+      tokens.begin() + consumed + chunk_size
     );
     
     // Pad chunk to prefill_ar_len if needed
@@ -542,147 +856,71 @@ bool LLMDecodeRunner::run_prefill(const std::vector<int32_t>& tokens,
     
     // Prepare inputs for this chunk
     // Note: For single-context, attention mask is auto-filled (no manual management)
-    if (!InputPreparer::auto_fill_inputs(*prefill_graph_, get_prefill_buffer, chunk_tokens, 
-                                          n_past, false, config_.log_level >= 2)) {
-      error_msg_ = "Failed to prepare prefill inputs";
-      return false;
+    if (plan.token_in >= 0) {
+      InputPreparer::fill_tokens(plan.input_data(plan.token_in),
+                                 plan.input_desc(plan.token_in), chunk_tokens);
     }
-  
-    // Update pre-built tensors with current buffer pointers (zero allocation)
-    std::vector<Qnn_Tensor_t> inputs, outputs;
-    
-    for (size_t i = 0; i < prefill_graph_->inputs.size() && i < prefill_input_holders_.size(); ++i) {
-      const auto& t = prefill_graph_->inputs[i];
-      void* buf = get_prefill_buffer(t.name);
-      if (!buf) {
-        if (config_.log_level >= 2) {
-          std::cerr << "[Prefill] Warning: No buffer for input " << t.name << "\n";
-        }
-        continue;
-      }
-      
-      // Update buffer pointer only (no allocation)
-      prefill_input_holders_[i]->update_buffer(buf, t.nbytes);
-      inputs.push_back(prefill_input_holders_[i]->tensor());
+    if (plan.pos_in >= 0) {
+      InputPreparer::fill_positions(plan.input_data(plan.pos_in),
+                                    plan.input_desc(plan.pos_in), chunk_tokens.size(), n_past);
     }
-    
-    for (size_t i = 0; i < prefill_graph_->outputs.size() && i < prefill_output_holders_.size(); ++i) {
-      const auto& t = prefill_graph_->outputs[i];
-      auto& bindings = prefill_alloc_->bindings();
-      auto it = bindings.find(t.name);
-      if (it == bindings.end()) {
-        if (config_.log_level >= 2) {
-          std::cerr << "[Prefill] Warning: No buffer for output " << t.name << "\n";
-        }
-        continue;
+    if (plan.mask_in >= 0) {
+      uint16_t* mask = reinterpret_cast<uint16_t*>(plan.input_data(plan.mask_in));
+      InputPreparer::fill_attention_mask(mask, plan.input_desc(plan.mask_in), chunk_tokens.size());
+      // Later chunks also attend to the cached positions [0, n_past)
+      for (int32_t i = 0; i < chunk_size && n_past > 0; ++i) {
+        std::fill_n(mask + static_cast<size_t>(i) * context_len_, n_past, 65535);
       }
-      
-      // Update buffer pointer only (no allocation)
-      prefill_output_holders_[i]->update_buffer(it->second, t.nbytes);
-      outputs.push_back(prefill_output_holders_[i]->tensor());
     }
     
-    if (config_.log_level >= 2) {
-      std::cout << "[Prefill] Prepared " << inputs.size() << " inputs, "
-                << outputs.size() << " outputs\n";
-    }
-    
-    // Execute
-    if (!loader_->execute_graph(0, "prefill_forward", inputs, outputs)) {
+    // Execute (tensors are pre-bound in the plan)
+    int64_t exec_start_us = time_in_us();
+    if (!plan.execute(*loader_)) {
       error_msg_ = "Prefill execution failed";
       return false;
     }
+    collect_profile(plan.profile(), exec_start_us);
     
     // Update KV cache from prefill outputs for this iteration
-    auto& bindings = prefill_alloc_->bindings();
+    for (const auto& kv : plan.v_out) {
+      const auto& v_buf = kv_manager_->get_v_cache(kv.layer, kv.head);
+      uint8_t* src = reinterpret_cast<uint8_t*>(plan.output_data(kv.slot));
+      uint8_t* dst = reinterpret_cast<uint8_t*>(v_buf.input_buffer) + n_past * head_dim_;
+      KVWriteback::write_v(dst, src, head_dim_, chunk_size);
+    }
     
-    int v_idx = 0, k_idx = 0;
-    for (const auto& t : prefill_graph_->outputs) {
-      std::string n = t.name;
-      
-      bool is_v = (n.find("view_copy") != std::string::npos &&
-                   t.dims.size() == 3 && t.dims[1] == prefill_ar_len_ && t.dims[2] == head_dim_);
-      bool is_k = (n.find("permute_copy") != std::string::npos &&
-                   t.dims.size() == 3 && t.dims[1] == head_dim_ && t.dims[2] == prefill_ar_len_);
-      
-      if (!is_v && !is_k) continue;
-      
-      auto bit = bindings.find(t.name);
-      if (bit == bindings.end()) continue;
-      
-      if (is_v) {
-        int layer = v_idx / num_heads_;
-        int head = v_idx % num_heads_;
-        v_idx++;
-        
-        if (layer >= num_layers_ || head >= num_heads_) continue;
-        
-        const auto& v_buf = kv_manager_->get_v_cache(layer, head);
-        uint8_t* src = reinterpret_cast<uint8_t*>(bit->second);
-        uint8_t* dst = reinterpret_cast<uint8_t*>(v_buf.input_buffer) + n_past * head_dim_;
-        std::memcpy(dst, src, chunk_size * head_dim_);
-        
-      } else if (is_k) {
-        int layer = k_idx / num_heads_;
-        int head = k_idx % num_heads_;
-        k_idx++;
-        
-        if (layer >= num_layers_ || head >= num_heads_) continue;
-        
-        const auto& k_buf = kv_manager_->get_k_cache(layer, head);
-        uint8_t* src = reinterpret_cast<uint8_t*>(bit->second);
-        uint8_t* dst = reinterpret_cast<uint8_t*>(k_buf.input_buffer) + n_past;
-        
-        for (int32_t dim = 0; dim < head_dim_; ++dim) {
-          std::memcpy(dst, src, chunk_size);
-          src += prefill_ar_len_;
-          dst += prefill_cache_len_;
-        }
-      }
+    for (const auto& kv : plan.k_out) {
+      const auto& k_buf = kv_manager_->get_k_cache(kv.layer, kv.head);
+      uint8_t* src = reinterpret_cast<uint8_t*>(plan.output_data(kv.slot));
+      uint8_t* dst = reinterpret_cast<uint8_t*>(k_buf.input_buffer) + n_past;
+      KVWriteback::write_k(dst, k_stride, src, prefill_ar_len_, head_dim_, chunk_size);
     }
     
     // Advance n_past for next iteration
     n_past += chunk_size;
+    consumed += chunk_size;
   }  // End of while loop
   
   if (config_.log_level >= 1) {
-    std::cout << "[Single-Context Prefill] All iterations completed. Total tokens: " << n_past << "\n";
+    LogLine() << "[Single-Context Prefill] All iterations completed. Total tokens: " << consumed << "\n";
   }
   
   // Extract logits from last iteration
-  const QnnJsonTensorDesc* logits_desc = nullptr;
-  for (const auto& t : prefill_graph_->outputs) {
-    if (t.name.find("squeeze") != std::string::npos ||
-        t.name.find("logit") != std::string::npos) {
-      logits_desc = &t;
-      break;
-    }
-  }
-  
-  if (!logits_desc) {
-    error_msg_ = "Logits output not found";
-    return false;
-  }
-  
-  auto& bindings = prefill_alloc_->bindings();
-  auto it = bindings.find(logits_desc->name);
-  if (it == bindings.end()) {
-    error_msg_ = "Logits buffer not found";
-    return false;
-  }
-  
-  const uint16_t* logits = reinterpret_cast<const uint16_t*>(it->second);
+  const uint16_t* logits = reinterpret_cast<const uint16_t*>(plan.output_data(plan.logits_out));
   int32_t vocab_size = 128256;
   
   // Calculate offset for last token in last iteration
   int32_t last_chunk_size = ((num_tokens - 1) % prefill_ar_len_) + 1;
   int32_t last_token_offset = (last_chunk_size - 1) * vocab_size;
   
-  // Calculate n_update: total tokens processed (not just last chunk)
-  n_update = num_tokens;
+  // Calculate n_update: occupied cache positions (all prompt tokens unless shifted)
+  n_update = n_past;
+  if (n_past == consumed) {
+    store_prefix(tokens, n_past);
+  }
   
   if (config_.log_level >= 1) {
-    std::cout << "[Single-Context Prefill] Argmax: total_tokens=" << num_tokens
+    LogLine() << "[Single-Context Prefill] Argmax: total_tokens=" << num_tokens
               << ", last_chunk_size=" << last_chunk_size
               << ", offset=" << last_token_offset << "\n";
   }
@@ -701,168 +939,548 @@ bool LLMDecodeRunner::run_prefill(const std::vector<int32_t>& tokens,
 
 bool LLMDecodeRunner::run_decode_step(int32_t token_in,
                                        int32_t n_past,
-                                       int32_t& token_out) {
-  // Prepare inputs
-  auto get_kv_buffer = [&](const std::string& name) -> void* {
-    auto it = kv_kv_override_.find(name);
-    if (it != kv_kv_override_.end()) return it->second;
-    
-    auto& bindings = kv_alloc_->bindings();
-    auto bit = bindings.find(name);
-    return (bit != bindings.end()) ? bit->second : nullptr;
-  };
+                                       int32_t& token_out,
+                                       const std::function<void()>* host_work) {
+  auto& plan = kv_plan_;
+  
+  // V outputs land directly in their cache row
+  int64_t kv_host_us = 0;
+  if (config_.direct_v_binding) {
+    int64_t bind_start_us = time_in_us();
+    bind_decode_v_outputs(plan, n_past);
+    kv_host_us += time_in_us() - bind_start_us;
+  }
   
-  // Fill inputs
-  for (const auto& t : kv_graph_->inputs) {
-    std::string n = t.name;
-    for (auto& c : n) c = (char)tolower(c);
-    
-    void* buf = get_kv_buffer(t.name);
-    if (!buf) continue;
+  // Fill inputs through pre-resolved slots
+  if (plan.token_in >= 0) {
+    std::memcpy(plan.input_data(plan.token_in), &token_in, sizeof(int32_t));
+  }
+  if (plan.pos_in >= 0) {
+    std::memcpy(plan.input_data(plan.pos_in), &n_past, sizeof(int32_t));
+  }
+  if (plan.mask_in >= 0) {
+    uint16_t* mask = reinterpret_cast<uint16_t*>(plan.input_data(plan.mask_in));
+    std::memset(mask, 0, plan.input_bytes(plan.mask_in));
     
-    // Token
-    if (n.find("token") != std::string::npos && n.find("input") != std::string::npos) {
-      std::memcpy(buf, &token_in, sizeof(int32_t));
-    }
-    // Position
-    else if (n.find("pos") != std::string::npos && t.data_type.find("INT_32") != std::string::npos) {
-      std::memcpy(buf, &n_past, sizeof(int32_t));
-    }
-    // Attention mask
-    else if (n.find("atten_mask") != std::string::npos) {
-      uint16_t* mask = reinterpret_cast<uint16_t*>(buf);
-      std::memset(mask, 0, t.nbytes);
-      
-      // Attend to past tokens [0..n_past-1]
-      for (int32_t i = 0; i < n_past; ++i) {
-        mask[i] = 65535;
-      }
-      // Attend to current token (last position)
-      mask[context_len_ - 1] = 65535;
+    // Attend to past tokens [0..n_past-1]
+    for (int32_t i = 0; i < n_past; ++i) {
+      mask[i] = 65535;
     }
+    // Attend to current token (last position)
+    mask[context_len_ - 1] = 65535;
   }
   
-  // Update pre-built tensors with current buffer pointers (zero allocation)
-  std::vector<Qnn_Tensor_t> inputs, outputs;
+  // Execute (host work overlaps with the accelerator)
+  int64_t exec_start_us = time_in_us();
+  QnnExecFuture exec = plan.execute_async(*loader_);
+  if (host_work) (*host_work)();
+  if (!exec.wait()) {
+    error_msg_ = "Decode execution failed (QNN error " + std::to_string(exec.error()) + ")";
+    return false;
+  }
+  collect_profile(plan.profile(), exec_start_us);
   
-  for (size_t i = 0; i < kv_graph_->inputs.size() && i < kv_input_holders_.size(); ++i) {
-    const auto& t = kv_graph_->inputs[i];
-    void* buf = get_kv_buffer(t.name);
-    if (!buf) {
-      if (config_.log_level >= 2) {
-        std::cerr << "[Decode] Warning: No buffer for input " << t.name << "\n";
-      }
-      continue;
+  // Extract logits
+  const uint16_t* logits = reinterpret_cast<const uint16_t*>(plan.output_data(plan.logits_out));
+  int32_t vocab_size = 128256;
+  
+  uint16_t max_val = logits[0];
+  token_out = 0;
+  for (int32_t i = 1; i < vocab_size; ++i) {
+    if (logits[i] > max_val) {
+      max_val = logits[i];
+      token_out = i;
     }
-    
-    // Update buffer pointer only (no allocation)
-    kv_input_holders_[i]->update_buffer(buf, t.nbytes);
-    inputs.push_back(kv_input_holders_[i]->tensor());
-  }
-  
-  for (size_t i = 0; i < kv_graph_->outputs.size() && i < kv_output_holders_.size(); ++i) {
-    const auto& t = kv_graph_->outputs[i];
-    auto& bindings = kv_alloc_->bindings();
-    auto it = bindings.find(t.name);
-    if (it == bindings.end()) {
-      if (config_.log_level >= 2) {
-        std::cerr << "[Decode] Warning: No buffer for output " << t.name << "\n";
-      }
-      continue;
+  }
+  
+  // Update KV cache from decode outputs (V is already in place with direct binding)
+  int64_t writeback_start_us = time_in_us();
+  if (!config_.direct_v_binding) {
+    for (const auto& kv : plan.v_out) {
+      const auto& v_buf = kv_manager_->get_v_cache(kv.layer, kv.head);
+      uint8_t* src = reinterpret_cast<uint8_t*>(plan.output_data(kv.slot));
+      uint8_t* dst = reinterpret_cast<uint8_t*>(v_buf.input_buffer) + n_past * head_dim_;
+      KVWriteback::write_v(dst, src, head_dim_, kv_ar_len_);
     }
-    
-    // Update buffer pointer only (no allocation)
-    kv_output_holders_[i]->update_buffer(it->second, t.nbytes);
-    outputs.push_back(kv_output_holders_[i]->tensor());
   }
   
-  // Execute
-  if (!loader_->execute_graph(0, "kv_forward", inputs, outputs)) {
-    error_msg_ = "Decode execution failed";
-    return false;
+  for (const auto& kv : plan.k_out) {
+    const auto& k_buf = kv_manager_->get_k_cache(kv.layer, kv.head);
+    uint8_t* src = reinterpret_cast<uint8_t*>(plan.output_data(kv.slot));
+    uint8_t* dst = reinterpret_cast<uint8_t*>(k_buf.input_buffer) + n_past;
+    KVWriteback::write_k(dst, kv_cache_len_, src, kv_ar_len_, head_dim_, kv_ar_len_);
   }
+  kv_host_us += time_in_us() - writeback_start_us;
+  stats_.decode_kv_host_ms += kv_host_us / 1000.0;
+  stats_.decode_kv_steps++;
   
-  // Extract logits
-  const QnnJsonTensorDesc* logits_desc = nullptr;
-  for (const auto& t : kv_graph_->outputs) {
-    if (t.name.find("squeeze") != std::string::npos ||
-        t.name.find("logit") != std::string::npos) {
-      logits_desc = &t;
-      break;
+  return true;
+}
+
+// V outputs are [ar_len, head_dim] rows, contiguous like the cache rows at n_past, so the
+// graph can write them in place. The row is masked out for this step's attention, so the
+// V input of the same graph never depends on it. K stays staged (transposed scatter).
+void LLMDecodeRunner::bind_decode_v_outputs(ExecutionPlan& plan, int32_t n_past) {
+  const size_t row_offset = static_cast<size_t>(n_past) * head_dim_;
+  for (const auto& kv : plan.v_out) {
+    const auto& v_buf = kv_manager_->get_v_cache(kv.layer, kv.head);
+    plan.bind_output(kv.slot, reinterpret_cast<uint8_t*>(v_buf.input_buffer) + row_offset);
+  }
+}
+
+// Prompts that fit one prefill chunk attend to nothing in the cache: every KV input is all
+// zeros, so one read-only zero slab stands in for all of them (reads share the kernel zero
+// page). With no later chunk reading the prefill layout, K is scattered at decode stride.
+bool LLMDecodeRunner::setup_zero_kv() {
+  if (!config_.zero_kv_prefill) return true;
+  const auto& k = kv_manager_->get_k_cache(0, 0);
+  const auto& v = kv_manager_->get_v_cache(0, 0);
+  if (!map_zero_slab(std::max(k.input_bytes, v.input_bytes), zero_kv_)) {
+    // Not fatal: prompts take the chunked path
+    std::cerr << "[Zero-KV] Warning: zero slab mapping failed, fast path disabled\n";
+    return true;
+  }
+  if (config_.log_level >= 1) {
+    std::cout << "[Zero-KV] Single-chunk prefill fast path enabled ("
+              << (zero_kv_.bytes / 1024.0) << " KiB zero slab)\n";
+  }
+  return true;
+}
+
+void LLMDecodeRunner::setup_prefix_cache() {
+  uint64_t cap = static_cast<uint64_t>(std::max(0, config_.prefix_cache_mb)) << 20;
+  // The budget reserved the cap up front (Footprint::prefix_cache); clamp in case the
+  // allocated footprint came out above the estimate
+  if (config_.max_memory_bytes > 0) {
+    const uint64_t used = stats_.memory_resident_bytes + memory_estimate_.load;
+    cap = std::min(cap, config_.max_memory_bytes > used ? config_.max_memory_bytes - used : 0);
+  }
+  const LLMKVCacheManager::Metadata& meta = kv_manager_->metadata();
+  if (cap < LLMPrefixCache::chunk_bytes(meta, prefill_ar_len_)) {
+    if (config_.log_level >= 1 && config_.prefix_cache_mb > 0) {
+      std::cout << "[Prefix Cache] Disabled (cap " << (cap >> 20) << " MiB is below one chunk)\n";
     }
+    return;
   }
-  
-  if (!logits_desc) {
-    error_msg_ = "Logits output not found";
+  prefix_cache_.reset(new LLMPrefixCache(meta, prefill_ar_len_, cap));
+  stats_.prefix_cache = true;
+  stats_.prefix_cache_cap_bytes = cap;
+  if (config_.log_level >= 1) {
+    std::cout << "[Prefix Cache] Enabled: " << (cap >> 20) << " MiB cap, "
+              << (prefix_cache_->chunk_bytes() / 1024.0) << " KiB per " << prefill_ar_len_
+              << "-token chunk\n";
+  }
+}
+
+int32_t LLMDecodeRunner::restore_prefix(const std::vector<int32_t>& tokens) {
+  stats_.prefix_restored_tokens = 0;
+  stats_.prefix_restore_ms = 0.0;
+  // Zero-KV prompts fit one chunk: nothing before the last token to restore
+  if (!prefix_cache_ || prefill_zero_kv_) return 0;
+  
+  // The last prompt token is always prefilled (its logits pick the first token)
+  const int32_t max_tokens = std::min<int32_t>(static_cast<int32_t>(tokens.size()) - 1,
+                                               prefill_cache_len_);
+  int64_t start_us = time_in_us();
+  int32_t restored = prefix_cache_->restore(tokens, max_tokens, *kv_manager_, prefill_cache_len_);
+  stats_.prefix_restore_ms = (time_in_us() - start_us) / 1000.0;
+  stats_.prefix_restored_tokens = restored;
+  
+  const LLMPrefixCache::Stats& cache_stats = prefix_cache_->stats();
+  stats_.prefix_hits = cache_stats.hits;
+  stats_.prefix_misses = cache_stats.misses;
+  stats_.prefix_tokens_reused = cache_stats.tokens_reused;
+  stats_.prefix_bytes_saved = cache_stats.bytes_restored;
+  if (config_.log_level >= 1 && restored > 0) {
+    LogLine() << "[Prefix Cache] Restored " << restored << " of " << tokens.size()
+              << " prompt tokens (" << stats_.prefix_restore_ms << " ms)\n";
+  }
+  return restored;
+}
+
+void LLMDecodeRunner::store_prefix(const std::vector<int32_t>& tokens, int32_t n_positions) {
+  stats_.prefix_store_ms = 0.0;
+  if (!prefix_cache_) return;
+  int64_t start_us = time_in_us();
+  prefix_cache_->insert(tokens, n_positions, *kv_manager_, prefill_k_stride());
+  stats_.prefix_store_ms = (time_in_us() - start_us) / 1000.0;
+  stats_.prefix_cache_bytes = prefix_cache_->bytes();
+}
+
+void LLMDecodeRunner::begin_prefill(int32_t num_tokens) {
+  prefill_zero_kv_ = zero_kv_.base != nullptr && num_tokens <= prefill_ar_len_;
+  stats_.prefill_zero_kv = prefill_zero_kv_;
+  // The prompt is written from position 0 in the prefill layout (the stride shift_cache() uses)
+  kv_manager_->set_layout_ar_len(prefill_zero_kv_ ? kv_ar_len_ : prefill_ar_len_);
+}
+
+// Rebound on every prefill: the previous prompt may have taken the other path
+void LLMDecodeRunner::bind_prefill_kv_inputs(ExecutionPlan& plan) {
+  for (const auto& kv : plan.kv_in) {
+    void* data = zero_kv_.base;
+    if (!prefill_zero_kv_) {
+      data = kv.is_v ? kv_manager_->get_v_cache(kv.layer, kv.head).input_buffer
+                     : kv_manager_->get_k_cache(kv.layer, kv.head).input_buffer;
+    }
+    plan.bind_input(kv.slot, data);
+  }
+}
+
+void LLMDecodeRunner::finish_prefill_layout(int32_t n_past) {
+  if (prefill_zero_kv_) {
+    kv_manager_->set_layout_ar_len(kv_ar_len_);
+    stats_.rearrange_ms = 0.0;
+    return;
+  }
+  int64_t start_us = time_in_us();
+  kv_manager_->rearrange_cache(prefill_ar_len_, kv_ar_len_, n_past);
+  stats_.rearrange_ms = (time_in_us() - start_us) / 1000.0;
+}
+
+// StreamingLLM: the first sink positions absorb attention mass and are always kept, the
+// oldest positions after them are dropped. Position ids are cache slots, so after the move
+// the shifted K is re-rotated by -n_discard and masks/positions built from n_past stay valid.
+bool LLMDecodeRunner::shift_context(int32_t& n_past, int32_t incoming, bool decode) {
+  const int32_t capacity = decode ? kv_cache_len_ : prefill_cache_len_;
+  if (n_past + incoming <= capacity) return true;
+  if (!context_shift_usable()) {
+    error_msg_ = "Prompt exceeds the KV cache (" + std::to_string(capacity) + " positions) and " +
+                 (config_.context_shift ? "shifted keys cannot be re-rotated"
+                                        : "context shifting is disabled");
     return false;
   }
   
-  auto& bindings = kv_alloc_->bindings();
-  auto it = bindings.find(logits_desc->name);
-  if (it == bindings.end()) {
-    error_msg_ = "Logits buffer not found";
+  const int32_t n_sink = std::max(0, std::min(config_.shift_sink_tokens, n_past));
+  const int32_t window = n_past - n_sink;
+  int32_t n_discard = config_.shift_discard > 0 ? config_.shift_discard : window / 2;
+  n_discard = std::min(window, std::max(n_discard, n_past + incoming - capacity));
+  if (n_discard <= 0 || n_past - n_discard + incoming > capacity) {
+    error_msg_ = "Context shift cannot make room for " + std::to_string(incoming) +
+                 " positions (sink_tokens=" + std::to_string(n_sink) + ", capacity=" +
+                 std::to_string(capacity) + ")";
     return false;
   }
   
-  const uint16_t* logits = reinterpret_cast<const uint16_t*>(it->second);
-  int32_t vocab_size = 128256;
+  // Multi-context: queued writebacks target the old positions
+  sync_kv_writeback(decode);
+  int64_t start_us = time_in_us();
+  int32_t shifted = kv_manager_->shift_cache(n_sink, n_discard, n_past);
+  double ms = (time_in_us() - start_us) / 1000.0;
   
-  uint16_t max_val = logits[0];
-  token_out = 0;
-  for (int32_t i = 1; i < vocab_size; ++i) {
-    if (logits[i] > max_val) {
-      max_val = logits[i];
-      token_out = i;
+  stats_.context_shifts++;
+  stats_.context_shift_rotated = true;
+  stats_.context_shift_evicted += n_past - shifted;
+  stats_.context_shift_ms += ms;
+  if (config_.log_level >= 1) {
+    LogLine() << "\n[Context Shift] " << (decode ? "Decode" : "Prefill") << ": kept " << n_sink
+              << " sink + " << (shifted - n_sink) << " recent, dropped " << (n_past - shifted)
+              << " (" << ms << " ms)\n";
+  }
+  n_past = shifted;
+  return true;
+}
+
+void LLMDecodeRunner::setup_context_shift() {
+  if (context_shift_ready_) return;
+  context_shift_ready_ = true;
+  
+  // Every K cache input of the decode graph(s); V needs no re-rotation
+  int keys = 0;
+  int encoded = 0;
+  auto add_encodings = [&](const ExecutionPlan& plan) {
+    for (const auto& kv : plan.kv_in) {
+      if (kv.is_v) continue;
+      ++keys;
+      // Per-axis encodings are not supported: such a head could not be re-rotated
+      const QnnJsonTensorDesc& desc = plan.input_desc(kv.slot);
+      if (desc.quant_scale <= 0.0f || !desc.quant_scales.empty()) continue;
+      kv_manager_->set_key_encoding(kv.layer, kv.head, desc.quant_scale, desc.quant_offset);
+      ++encoded;
     }
+  };
+  if (config_.use_multi_context) {
+    for (const auto& shard : shards_) add_encodings(shard.kv_plan);
+  } else {
+    add_encodings(kv_plan_);
   }
   
-  // Update KV cache from decode outputs
-  int v_idx = 0, k_idx = 0;
-  for (const auto& t : kv_graph_->outputs) {
-    std::string n = t.name;
-    
-    bool is_v = (n.find("view_copy") != std::string::npos &&
-                 t.dims.size() == 3 && t.dims[1] == kv_ar_len_ && t.dims[2] == head_dim_);
-    bool is_k = (n.find("permute_copy") != std::string::npos &&
-                 t.dims.size() == 3 && t.dims[1] == head_dim_ && t.dims[2] == kv_ar_len_);
-    
-    if (!is_v && !is_k) continue;
-    
-    auto bit = bindings.find(t.name);
-    if (bit == bindings.end()) continue;
-    
-    if (is_v) {
-      int layer = v_idx / num_heads_;
-      int head = v_idx % num_heads_;
-      v_idx++;
-      
-      if (layer >= num_layers_ || head >= num_heads_) continue;
-      
-      const auto& v_buf = kv_manager_->get_v_cache(layer, head);
-      uint8_t* src = reinterpret_cast<uint8_t*>(bit->second);
-      uint8_t* dst = reinterpret_cast<uint8_t*>(v_buf.input_buffer) + n_past * head_dim_;
-      std::memcpy(dst, src, kv_ar_len_ * head_dim_);
-      
-    } else if (is_k) {
-      int layer = k_idx / num_heads_;
-      int head = k_idx % num_heads_;
-      k_idx++;
-      
-      if (layer >= num_layers_ || head >= num_heads_) continue;
-      
-      const auto& k_buf = kv_manager_->get_k_cache(layer, head);
-      uint8_t* src = reinterpret_cast<uint8_t*>(bit->second);
-      uint8_t* dst = reinterpret_cast<uint8_t*>(k_buf.input_buffer) + n_past;
-      
-      for (int32_t dim = 0; dim < head_dim_; ++dim) {
-        std::memcpy(dst, src, kv_ar_len_);
-        src += kv_ar_len_;
-        dst += kv_cache_len_;
+  // RoPE theta/scaling come from params.json only
+  if (model_params_.is_valid()) {
+    kv_manager_->set_rope_frequencies(rope_inv_frequencies(model_params_, head_dim_));
+  }
+  // Moving a key without re-rotating it leaves the RoPE phase of its old slot, so a shift
+  // that cannot rotate every K head is not used at all
+  context_shift_usable_ = kv_manager_->rotates_keys() && encoded > 0 && encoded == keys;
+  if (!context_shift_usable_) {
+    std::cerr << "[Context Shift] Disabled: shifted keys cannot be re-rotated (needs params.json "
+              << "and a per-tensor quantization encoding on every K input, " << encoded << " of "
+              << keys << " encoded)\n";
+  }
+}
+
+bool LLMDecodeRunner::context_shift_usable() {
+  if (!config_.context_shift) return false;
+  setup_context_shift();
+  return context_shift_usable_;
+}
+
+QNNIOAllocator::Options LLMDecodeRunner::io_alloc_options() const {
+  QNNIOAllocator::Options options;
+  options.arena = config_.io_arena;
+  options.alignment = config_.io_alignment > 0 ? static_cast<size_t>(config_.io_alignment)
+                                               : QNNIOAllocator::kDefaultAlignment;
+  options.huge_pages = parse_huge_pages(config_.io_huge_pages);
+  return options;
+}
+
+LLMKVCacheManager::Options LLMDecodeRunner::kv_cache_options() const {
+  LLMKVCacheManager::Options options;
+  options.huge_pages = parse_huge_pages(config_.kv_huge_pages);
+  options.lock = config_.kv_mlock;
+  options.rearrange_threads = config_.kv_rearrange_threads;
+  return options;
+}
+
+void LLMDecodeRunner::record_io_graph(const std::string& label, const QnnJsonGraphDesc& graph,
+                                      const QNNIOAllocator& alloc) {
+  IOGraphStat stat;
+  stat.label = label + "/" + graph.graph_name;
+  stat.tensor_bytes = alloc.total_allocated_bytes();
+  stat.external_bytes = alloc.external_bytes();
+  stats_.io_graphs.push_back(stat);
+}
+
+void LLMDecodeRunner::record_io_alloc(const QNNIOAllocator& alloc) {
+  stats_.io_tensor_bytes += alloc.total_allocated_bytes();
+  stats_.io_mapped_bytes += alloc.mapped_bytes();
+  stats_.io_regions += alloc.num_regions();
+}
+
+void LLMDecodeRunner::exclude_kv_inputs(QNNIOAllocator& alloc, const QnnJsonGraphDesc& graph,
+                                        const ExecutionPlan::Layout& layout,
+                                        const std::vector<KVCacheTensorInfo>* kv_mapping,
+                                        const std::string& label) {
+  uint64_t bytes = alloc.set_external(ExecutionPlan::kv_input_names(graph, layout, kv_mapping));
+  stats_.io_external_bytes += bytes;
+  if (config_.log_level >= 1 && bytes > 0) {
+    std::cout << "[I/O] " << label << "/" << graph.graph_name << ": " << alloc.num_external()
+              << " KV inputs bound to the cache, " << (bytes / 1024.0) << " KiB not allocated\n";
+  }
+}
+
+// graphs: (allocator, execution step). Inputs live for their step, outputs one step longer
+// (read back while the next shard runs), so steps must not overlap across phases.
+bool LLMDecodeRunner::allocate_io(const std::vector<std::pair<QNNIOAllocator*, int>>& graphs) {
+  if (!config_.io_plan || !config_.io_arena) {
+    for (const auto& g : graphs) {
+      QNNIOAllocator& alloc = *g.first;
+      uint64_t required = 0;
+      for (size_t i = 0; i < alloc.num_tensors(); ++i) required += alloc.nbytes(i);
+      required -= alloc.external_bytes();
+      // Arena mapping failure returns 0; per-tensor mode leaves the failed tensors unbound
+      uint64_t allocated = alloc.allocate();
+      if (allocated < required) {
+        error_msg_ = "Failed to allocate I/O buffers (" + std::to_string(allocated) + " of " +
+                     std::to_string(required) + " bytes)";
+        return false;
       }
+      record_io_alloc(alloc);
     }
+    return true;
+  }
+  
+  io_planner_.reset(new QNNIOPlanner(io_alloc_options()));
+  for (const auto& g : graphs) io_planner_->add_graph(g.first, g.second);
+  if (!io_planner_->allocate()) {
+    error_msg_ = "Failed to allocate planned I/O pool";
+    return false;
   }
+  for (const auto& g : graphs) record_io_alloc(*g.first);
+  stats_.io_mapped_bytes += io_planner_->mapped_bytes();
+  if (io_planner_->mapped_bytes() > 0) stats_.io_regions += 1;
+  stats_.io_plan_pool_bytes = io_planner_->pool_bytes();
+  stats_.io_plan_separate_bytes = io_planner_->separate_bytes();
   
+  if (config_.log_level >= 1) {
+    std::cout << "[I/O] Liveness plan: " << io_planner_->num_buffers() << " buffers from "
+              << io_planner_->num_graphs() << " graphs in " << (io_planner_->pool_bytes() / 1024.0)
+              << " KiB (per-graph slabs: " << (io_planner_->separate_bytes() / 1024.0) << " KiB)\n";
+  }
   return true;
 }
 
+// Same allocators and liveness steps as setup_*_io_allocators(), laid out without mapping.
+// Tensors later bound to shared buffers (zero-copy dataflow) are still counted.
+LLMMemoryBudget::Estimate LLMDecodeRunner::estimate_memory() const {
+  LLMMemoryBudget::Estimate estimate;
+  LLMKVCacheManager::Metadata kv_meta{
+      context_len_, head_dim_, prefill_ar_len_, kv_cache_len_, num_heads_, num_layers_};
+  estimate.kv_cache = io_slab_bytes(LLMKVCacheManager::required_bytes(kv_meta),
+                                    kv_cache_options().huge_pages);
+  estimate.shared = shared_buffer_bytes();
+  estimate.prefix_cache = static_cast<uint64_t>(std::max(0, config_.prefix_cache_mb)) << 20;
+  
+  const QNNIOAllocator::Options options = io_alloc_options();
+  std::vector<std::unique_ptr<QNNIOAllocator>> allocs;
+  QNNIOPlanner planner(options);
+  auto add = [&](const QnnJsonGraphDesc& graph, const ExecutionPlan::Layout& layout,
+                 const std::vector<KVCacheTensorInfo>* kv_mapping, int step) {
+    allocs.emplace_back(new QNNIOAllocator());
+    allocs.back()->set_options(options);
+    allocs.back()->build_from_qnnjson(graph);
+    allocs.back()->set_external(ExecutionPlan::kv_input_names(graph, layout, kv_mapping));
+    planner.add_graph(allocs.back().get(), step);
+  };
+  
+  if (config_.use_multi_context) {
+    const int num_shards = config_.num_shards;
+    for (int i = 0; i < num_shards; ++i) {
+      int layer_base = i * layers_per_shard_;
+      add(*shards_[i].prefill_graph,
+          {layer_base, num_layers_, num_heads_, head_dim_, prefill_ar_len_}, nullptr, i);
+      add(*shards_[i].kv_graph,
+          {layer_base, num_layers_, num_heads_, head_dim_, kv_ar_len_}, nullptr, num_shards + 1 + i);
+      estimate.binaries.push_back(file_size_of(shard_context_files_[i]));
+    }
+    estimate.serial_load = config_.streaming_load;
+  } else {
+    auto prefill_mapping = LLMKVCacheMapper::build_mapping(*prefill_graph_, num_heads_, head_dim_);
+    auto kv_mapping = LLMKVCacheMapper::build_mapping(*kv_graph_, num_heads_, head_dim_);
+    add(*prefill_graph_, {0, num_layers_, num_heads_, head_dim_, prefill_ar_len_}, &prefill_mapping, 0);
+    add(*kv_graph_, {0, num_layers_, num_heads_, head_dim_, kv_ar_len_}, &kv_mapping, 2);
+    estimate.binaries.push_back(file_size_of(config_.ctx_dir + "/forward_0.bin"));
+    estimate.serial_load = true;
+  }
+  estimate.io_pooled = io_slab_bytes(planner.plan(), options.huge_pages);
+  estimate.io_separate = planner.separate_bytes();
+  return estimate;
+}
+
+bool LLMDecodeRunner::apply_memory_budget() {
+  stats_.memory_budget_bytes = config_.max_memory_bytes;
+  if (config_.max_memory_bytes == 0) return true;
+  
+  LLMMemoryBudget::Strategy strategy;
+  strategy.io_pool = config_.io_plan && config_.io_arena;
+  strategy.mmap_load = config_.use_mmap_load;
+  strategy.load_threads = config_.load_threads;
+  strategy.load_inflight_bytes = static_cast<uint64_t>(std::max(0, config_.load_inflight_mb)) << 20;
+  
+  LLMMemoryBudget budget(config_.max_memory_bytes);
+  bool fits = budget.plan(estimate_memory(), strategy);
+  memory_estimate_ = budget.footprint();
+  stats_.memory_estimate_bytes = memory_estimate_.total();
+  
+  std::string changes;
+  for (const auto& c : budget.changes()) changes += (changes.empty() ? "" : ", ") + c;
+  if (!fits) {
+    error_msg_ = "Memory budget of " + std::to_string(config_.max_memory_bytes >> 20) +
+                 " MB cannot be met: " + memory_estimate_.breakdown();
+    if (!changes.empty()) error_msg_ += " (with " + changes + ")";
+    return false;
+  }
+  
+  if (strategy.io_pool) {
+    config_.io_plan = true;
+    config_.io_arena = true;
+  }
+  config_.use_mmap_load = strategy.mmap_load;
+  config_.load_threads = strategy.load_threads;
+  config_.load_inflight_mb = strategy.load_inflight_bytes == 0
+      ? 0 : static_cast<int>(std::max<uint64_t>(1, strategy.load_inflight_bytes >> 20));
+  
+  if (config_.log_level >= 1) {
+    std::cout << "[Memory] Budget " << (config_.max_memory_bytes >> 20) << " MB, estimate "
+              << memory_estimate_.breakdown() << "\n";
+    if (!changes.empty()) std::cout << "[Memory] Strategies: " << changes << "\n";
+  }
+  return true;
+}
+
+bool LLMDecodeRunner::check_memory_budget() {
+  LLMMemoryBudget::Footprint actual;
+  actual.kv_cache = kv_manager_ ? kv_manager_->mapped_bytes() : 0;
+  actual.io = stats_.io_mapped_bytes;
+  actual.shared = shared_buffer_bytes();
+  actual.prefix_cache = memory_estimate_.prefix_cache;
+  actual.load = memory_estimate_.load;
+  stats_.memory_resident_bytes = actual.resident();
+  if (config_.max_memory_bytes == 0 || actual.total() <= config_.max_memory_bytes) return true;
+  
+  error_msg_ = "Memory budget of " + std::to_string(config_.max_memory_bytes >> 20) +
+               " MB exceeded after allocation: " + actual.breakdown();
+  return false;
+}
+
+bool LLMDecodeRunner::setup_power_policy() {
+  if (config_.power_policy == "off") return true;
+  QnnBackendSession& session = *loader_->session();
+  if (config_.power_policy == "adaptive") {
+    // One policy per backend session; the first runner's options win
+    HtpPowerPolicy::Options options;
+    options.debounce_ms = config_.power_debounce_ms;
+    options.idle_timeout_ms = config_.power_idle_ms;
+    power_policy_ = session.power_policy(options);
+    if (power_policy_) {
+      power_voter_ = power_policy_->add_voter();
+      if (config_.log_level >= 1) {
+        std::cout << "[Init] Adaptive HTP power policy (idle " << options.idle_timeout_ms
+                  << " ms, debounce " << options.debounce_ms << " ms)\n";
+      }
+      return true;
+    }
+    std::cerr << "[Init] Warning: Adaptive power policy unavailable, using fixed burst vote\n";
+  }
+  return session.enable_htp_performance_mode();
+}
+
+void LLMDecodeRunner::set_power_phase(RunnerPhase phase) {
+  if (power_policy_) power_policy_->on_phase(phase, power_voter_);
+}
+
+// Profile times are per backend session (shared with other runners)
+void LLMDecodeRunner::update_power_stats() {
+  if (!power_policy_) return;
+  HtpPowerPolicy::Stats s = power_policy_->stats();
+  stats_.power_burst_ms = s.burst_ms;
+  stats_.power_sustained_ms = s.sustained_ms;
+  stats_.power_relaxed_ms = s.relaxed_ms;
+  stats_.power_switches = s.switches;
+  stats_.power_debounced = s.debounced;
+}
+
+Qnn_ProfileHandle_t LLMDecodeRunner::create_profile(const std::string& scope,
+                                                     int shard,
+                                                     const std::string& graph) {
+  return profiler_ ? profiler_->create_handle(scope, shard, graph) : nullptr;
+}
+
+void LLMDecodeRunner::collect_profile(Qnn_ProfileHandle_t profile, int64_t start_us) {
+  if (profiler_ && profile) {
+    profiler_->collect(profile, start_us, time_in_us());
+  }
+}
+
+void LLMDecodeRunner::attach_plan_profiles(ExecutionPlan& prefill_plan,
+                                           ExecutionPlan& kv_plan,
+                                           int shard,
+                                           const std::string& prefix) {
+  if (!profiler_) return;
+  prefill_plan.set_profile(create_profile(prefix + "/prefill_forward", shard, "prefill_forward"));
+  kv_plan.set_profile(create_profile(prefix + "/kv_forward", shard, "kv_forward"));
+}
+
+void LLMDecodeRunner::write_profile_report() {
+  if (!profiler_) return;
+  std::string summary_path = config_.profile_out + "_summary.json";
+  std::string trace_path = config_.profile_out + "_trace.json";
+  bool ok_summary = profiler_->write_summary_json(summary_path);
+  bool ok_trace = profiler_->write_chrome_trace(trace_path);
+  if (config_.log_level >= 1) {
+    profiler_->print_summary();
+    std::cout << "[Profile] Summary: " << (ok_summary ? summary_path : "(write failed)")
+              << ", Chrome trace: " << (ok_trace ? trace_path : "(write failed)") << "\n";
+  }
+}
+
 } // namespace llm_test
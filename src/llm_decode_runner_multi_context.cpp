@@ -16,20 +16,40 @@
  * - ROPE (cos/sin): Shared from Shard 0 output across all shards
  * - Hidden state: Chained between shards (Shard N output → Shard N+1 input)
  * - Attention mask: Shared buffer broadcasted to all shards
+ * 
+ * With zero_copy_dataflow (default) the hidden state, ROPE and mask tensors are bound
+ * directly to the shared buffers at plan build time (hidden state ping-pongs between
+ * two buffers), so no per-shard copies remain. --copy_dataflow keeps the memcpy path.
  */
 
 #include "llm_decode_runner.h"
 #include "llm_input_preparer.h"
+#include "llm_kv_writeback.h"
 #include "qnn_tensor_util.h"
 #include "binary_provider.h"
+#include "async_logger.h"
+
+#include "thread_pool.h"
 
 #include <iostream>
 #include <fstream>
+#include <set>
 #include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 namespace llm_test {
 
+namespace {
+
+double elapsed_ms(int64_t start_us) {
+  return (time_in_us() - start_us) / 1000.0;
+}
+
+} // namespace
+
 bool LLMDecodeRunner::load_multi_context_graphs() { // [spagetti] blob 고려 / et에서 cache가 뭔지 왜 필요한지 확인해봐야함
   // Auto-detect or use specified num_shards
   std::vector<std::string> context_files;
@@ -99,47 +119,7 @@ bool LLMDecodeRunner::load_multi_context_graphs() { // [spagetti] blob 고려 /
     std::cout << "[Multi-Context] Found " << config_.num_shards << " shards\n";
   }
   
-  // Load each shard ONE BY ONE (메모리 절약: 읽기→생성→해제 반복)
-  for (int i = 0; i < config_.num_shards; ++i) {
-    if (config_.log_level >= 1) {
-      std::cout << "[Graphs] Shard " << i << ": loading...\n";
-    }
-    
-    // Read binary file (한 번에 하나만)
-    std::ifstream ifs(context_files[i], std::ios::binary | std::ios::ate);
-    if (!ifs) {
-      error_msg_ = "Failed to open context binary: " + context_files[i];
-      return false;
-    }
-    
-    size_t size = ifs.tellg();
-    ifs.seekg(0, std::ios::beg);
-    std::vector<char> buffer(size);
-    
-    if (!ifs.read(buffer.data(), size)) {
-      error_msg_ = "Failed to read context binary: " + context_files[i];
-      return false;
-    }
-    ifs.close();
-    
-    // Create context from binary (하나만 생성)
-    if (!loader_->create_context_from_binary(buffer.data(), size)) {
-      error_msg_ = "Failed to create context from binary: " + context_files[i];
-      return false;
-    }
-    
-    if (config_.log_level >= 1) {
-      std::cout << "[Graphs] Shard " << i << ": context created\n";
-    }
-    
-    // buffer는 스코프를 벗어나면서 자동으로 메모리 해제됨
-  }
-  
-  if (config_.log_level >= 1) {
-    std::cout << "[Multi-Context] All " << loader_->num_contexts() << " contexts created\n";
-  }
-  
-  // Parse JSON and retrieve graphs for each shard
+  // Parse JSON for every shard first (metadata, allocators and shared buffers only need JSON)
   shards_.resize(config_.num_shards);
   
   for (int i = 0; i < config_.num_shards; ++i) {
@@ -157,13 +137,6 @@ bool LLMDecodeRunner::load_multi_context_graphs() { // [spagetti] blob 고려 /
     shards_[i].prefill_graph = &shards_[i].graphs["prefill_forward"];
     shards_[i].kv_graph = &shards_[i].graphs["kv_forward"];
     
-    // Retrieve graphs
-    if (!loader_->retrieve_graph(i, "prefill_forward") ||
-        !loader_->retrieve_graph(i, "kv_forward")) {
-      error_msg_ = "Failed to retrieve graphs for shard " + std::to_string(i);
-      return false;
-    }
-    
     if (config_.log_level >= 2) {
       std::cout << "[Shard " << i << "] prefill_forward: "
                 << shards_[i].prefill_graph->inputs.size() << " inputs, "
@@ -174,6 +147,34 @@ bool LLMDecodeRunner::load_multi_context_graphs() { // [spagetti] blob 고려 /
     }
   }
   
+  // Contexts are created once the memory budget has picked the load strategy
+  shard_context_files_ = context_files;
+  return true;
+}
+
+bool LLMDecodeRunner::load_multi_context_binaries() {
+  // Streaming start-up: contexts are created later by the background loader
+  if (config_.streaming_load) return true;
+  
+  // Load shards concurrently (contexts keep shard index order, bounded bytes in flight)
+  if (!load_shard_contexts(shard_context_files_)) {
+    return false;
+  }
+  
+  if (config_.log_level >= 1) {
+    std::cout << "[Multi-Context] All " << loader_->num_contexts() << " contexts created\n";
+  }
+  stats_.sample_memory("contexts");
+  
+  // Retrieve graphs
+  for (int i = 0; i < config_.num_shards; ++i) {
+    if (!loader_->retrieve_graph(i, "prefill_forward") ||
+        !loader_->retrieve_graph(i, "kv_forward")) {
+      error_msg_ = "Failed to retrieve graphs for shard " + std::to_string(i);
+      return false;
+    }
+  }
+  
   return true;
 }
 
@@ -279,10 +280,12 @@ bool LLMDecodeRunner::setup_multi_context_kv_cache() {
   };
   
   kv_manager_.reset(new LLMKVCacheManager(kv_meta));
+  kv_manager_->set_options(kv_cache_options());
   if (!kv_manager_->allocate()) {
     error_msg_ = "Failed to allocate KV cache memory";
     return false;
   }
+  stats_.kv_cache_bytes = kv_manager_->mapped_bytes();
   
   if (config_.log_level >= 1) {
     std::cout << "[KV Cache] Allocated "
@@ -294,81 +297,115 @@ bool LLMDecodeRunner::setup_multi_context_kv_cache() {
 }
 
 bool LLMDecodeRunner::setup_multi_context_io_allocators() { // [spagetti] 이거 문제가 많다 전체 재설계 해야할 수도 있음
-  for (int i = 0; i < config_.num_shards; ++i) {
+  // Execution steps for the liveness planner: prefill shards run at [0, N),
+  // decode shards at [N + 1, 2N + 1). Shard hand-off tensors either live in shared_buffers_
+  // (zero-copy dataflow) or are refilled from them before every run, so only adjacent
+  // shards (writeback overlap) need distinct memory.
+  std::vector<std::pair<QNNIOAllocator*, int>> graphs;
+  const int num_shards = config_.num_shards;
+  dataflow_ = config_.zero_copy_dataflow && plan_shard_dataflow();
+  
+  // Tensors bound to shared buffers by the dataflow plan need no allocator memory
+  uint64_t dataflow_bytes = 0;
+  auto exclude_dataflow = [&dataflow_bytes](QNNIOAllocator& alloc,
+                                            const std::map<std::string, void*>& bound) {
+    std::set<std::string> names;
+    for (const auto& b : bound) names.insert(b.first);
+    dataflow_bytes += alloc.set_external(names);
+  };
+  
+  for (int i = 0; i < num_shards; ++i) {
     auto& shard = shards_[i];
+    int layer_base = i * layers_per_shard_;
+    std::string label = "shard" + std::to_string(i);
     
-    // Prefill allocator
+    // Prefill allocator (KV inputs are bound to the cache manager, same classification as the plan)
+    ExecutionPlan::Layout prefill_layout{layer_base, num_layers_, num_heads_, head_dim_, prefill_ar_len_};
     shard.prefill_alloc.reset(new QNNIOAllocator());
+    shard.prefill_alloc->set_options(io_alloc_options());
     shard.prefill_alloc->build_from_qnnjson(*shard.prefill_graph);
-    auto prefill_bytes = shard.prefill_alloc->allocate(0); // [spagetti] 이거 지금 말안됨 근거 없는 코드임 내가 돌아가게만 만든 코드
+    exclude_kv_inputs(*shard.prefill_alloc, *shard.prefill_graph, prefill_layout, nullptr, label);
+    exclude_dataflow(*shard.prefill_alloc, shard.prefill_dataflow);
+    graphs.push_back({shard.prefill_alloc.get(), i});
     
-    // // KV allocator
+    // KV allocator (separate graph: prefill and decode plans bind different buffers)
+    ExecutionPlan::Layout kv_layout{layer_base, num_layers_, num_heads_, head_dim_, kv_ar_len_};
     shard.kv_alloc.reset(new QNNIOAllocator());
+    shard.kv_alloc->set_options(io_alloc_options());
     shard.kv_alloc->build_from_qnnjson(*shard.kv_graph);
-    auto kv_bytes = shard.kv_alloc->allocate(64); // [spagetti] 이거 왜 두번 할당함? 그럼 실제로는 뭘씀? 
-
-    // Create tensor holders for prefill graph
-    shard.prefill_input_holders.clear();
-    for (const auto& t : shard.prefill_graph->inputs) { // [spagetti] 모든 인풋에 대해서 이렇게 만드는게 맞나? 확인
-      auto h = std::make_unique<QnnTensorHolder>();
-      h->init_from_json(t, nullptr, t.nbytes, true);
-      shard.prefill_input_holders.push_back(std::move(h));
-    }
-    
-    shard.prefill_output_holders.clear();
-    for (const auto& t : shard.prefill_graph->outputs) {
-      auto h = std::make_unique<QnnTensorHolder>();
-      h->init_from_json(t, nullptr, t.nbytes, false);
-      shard.prefill_output_holders.push_back(std::move(h));
-    }
-    
-    // Create tensor holders for kv graph
-    shard.kv_input_holders.clear();
-    for (const auto& t : shard.kv_graph->inputs) {
-      auto h = std::make_unique<QnnTensorHolder>();
-      h->init_from_json(t, nullptr, t.nbytes, true);
-      shard.kv_input_holders.push_back(std::move(h));
-    }
-    
-    shard.kv_output_holders.clear();
-    for (const auto& t : shard.kv_graph->outputs) {
-      auto h = std::make_unique<QnnTensorHolder>();
-      h->init_from_json(t, nullptr, t.nbytes, false);
-      shard.kv_output_holders.push_back(std::move(h));
-    }
-    
-    if (config_.log_level >= 2) {
-      std::cout << "[Shard " << i << " I/O] Prefill: " << (prefill_bytes / 1024.0)
-                << " KiB, Decode: " << (kv_bytes / 1024.0) << " KiB\n";
-      std::cout << "[Shard " << i << " Holders] Prefill I/O: "
-                << shard.prefill_input_holders.size() << "/"
-                << shard.prefill_output_holders.size() << ", KV I/O: "
-                << shard.kv_input_holders.size() << "/"
-                << shard.kv_output_holders.size() << "\n";
+    exclude_kv_inputs(*shard.kv_alloc, *shard.kv_graph, kv_layout, nullptr, label);
+    exclude_dataflow(*shard.kv_alloc, shard.kv_dataflow);
+    graphs.push_back({shard.kv_alloc.get(), num_shards + 1 + i});
+  }
+  if (!allocate_io(graphs)) return false;
+  for (int i = 0; i < num_shards; ++i) {
+    std::string label = "shard" + std::to_string(i);
+    record_io_graph(label, *shards_[i].prefill_graph, *shards_[i].prefill_alloc);
+    record_io_graph(label, *shards_[i].kv_graph, *shards_[i].kv_alloc);
+  }
+  
+  if (dataflow_ && config_.log_level >= 1) {
+    std::cout << "[Dataflow] Zero-copy shard hand-off: " << (dataflow_bytes / 1024.0)
+              << " KiB of hidden/ROPE/mask tensors bound to shared buffers\n";
+  }
+  if (config_.log_level >= 2) {
+    for (int i = 0; i < num_shards; ++i) {
+      std::cout << "[Shard " << i << " I/O] Prefill: "
+                << (shards_[i].prefill_alloc->total_allocated_bytes() / 1024.0)
+                << " KiB, Decode: " << (shards_[i].kv_alloc->total_allocated_bytes() / 1024.0)
+                << " KiB\n";
     }
   }
   
   return true;
 }
 
+void LLMDecodeRunner::shared_buffer_sizes(size_t& hidden, size_t& rope, size_t& mask) const {
+  // Hidden state: [1, ar_len, dim] for prefill, [1, 1, dim] for decode
+  // Use prefill_ar_len for max size (e.g., [1, 32, 2048])
+  int hidden_dim = model_params_.is_valid() ? model_params_.dim : 2048;
+  hidden = prefill_ar_len_ * hidden_dim * sizeof(uint16_t);  // UFIXED_16
+  // ROPE cos/sin: [max_seq_len, head_dim/2] - typically from shard 0 output
+  // Size depends on context_len, allocate generously
+  rope = context_len_ * head_dim_ * sizeof(uint16_t);
+  // Attention mask: [ar_len, context_len]
+  mask = prefill_ar_len_ * context_len_ * sizeof(uint16_t);
+}
+
+uint64_t LLMDecodeRunner::shared_buffer_bytes() const {
+  if (!config_.use_multi_context) return 0;
+  size_t hidden = 0, rope = 0, mask = 0;
+  shared_buffer_sizes(hidden, rope, mask);
+  return hidden * (config_.zero_copy_dataflow ? 2 : 1) + 2 * rope + mask;
+}
+
 bool LLMDecodeRunner::allocate_shared_buffers() {
   // Allocate shared buffers for data that needs to be passed between shards
+  size_t hidden_state_size = 0, rope_size = 0, attn_mask_size = 0;
+  shared_buffer_sizes(hidden_state_size, rope_size, attn_mask_size);
   
-  // 1. Hidden state: [1, ar_len, dim] for prefill, [1, 1, dim] for decode
-  // Use prefill_ar_len for max size (e.g., [1, 32, 2048])
-  int hidden_dim = model_params_.is_valid() ? model_params_.dim : 2048;
-  size_t hidden_state_size = prefill_ar_len_ * hidden_dim * sizeof(uint16_t);  // UFIXED_16
+  // 1. Hidden state (largest shape over prefill and decode)
   void* hidden_state_buf = aligned_alloc(64, hidden_state_size);
   if (!hidden_state_buf) {
     error_msg_ = "Failed to allocate hidden state buffer";
     return false;
   }
   std::memset(hidden_state_buf, 0, hidden_state_size);
-  shared_buffer_views_["hidden_state"] = hidden_state_buf;
+  shared_buffers_.hidden_state = hidden_state_buf;
+  shared_buffers_.hidden_bytes = hidden_state_size;
+  
+  // Zero-copy dataflow ping-pongs the hidden state between two buffers
+  if (config_.zero_copy_dataflow) {
+    void* hidden_alt_buf = aligned_alloc(64, hidden_state_size);
+    if (!hidden_alt_buf) {
+      error_msg_ = "Failed to allocate hidden state buffer";
+      return false;
+    }
+    std::memset(hidden_alt_buf, 0, hidden_state_size);
+    shared_buffers_.hidden_state_alt = hidden_alt_buf;
+  }
   
-  // 2. ROPE cos/sin: [max_seq_len, head_dim/2] - typically from shard 0 output
-  // Size depends on context_len, allocate generously
-  size_t rope_size = context_len_ * head_dim_ * sizeof(uint16_t);
+  // 2. ROPE cos/sin tables
   void* rope_cos_buf = aligned_alloc(64, rope_size);
   void* rope_sin_buf = aligned_alloc(64, rope_size);
   if (!rope_cos_buf || !rope_sin_buf) {
@@ -377,22 +414,25 @@ bool LLMDecodeRunner::allocate_shared_buffers() {
   }
   std::memset(rope_cos_buf, 0, rope_size);
   std::memset(rope_sin_buf, 0, rope_size);
-  shared_buffer_views_["rope_cos"] = rope_cos_buf;
-  shared_buffer_views_["rope_sin"] = rope_sin_buf;
+  shared_buffers_.rope_cos = rope_cos_buf;
+  shared_buffers_.rope_sin = rope_sin_buf;
+  shared_buffers_.rope_bytes = rope_size;
   
-  // 3. Attention mask: [ar_len, context_len]
-  size_t attn_mask_size = prefill_ar_len_ * context_len_ * sizeof(uint16_t);
+  // 3. Attention mask
   void* attn_mask_buf = aligned_alloc(64, attn_mask_size);
   if (!attn_mask_buf) {
     error_msg_ = "Failed to allocate attention mask buffer";
     return false;
   }
   std::memset(attn_mask_buf, 0, attn_mask_size);
-  shared_buffer_views_["attention_mask"] = attn_mask_buf;
+  shared_buffers_.attention_mask = attn_mask_buf;
+  shared_buffers_.mask_bytes = attn_mask_size;
+  stats_.shared_buffer_bytes = shared_buffer_bytes();
   
   if (config_.log_level >= 1) {
     std::cout << "[Shared Buffers] Allocated:\n";
-    std::cout << "  hidden_state: " << (hidden_state_size / 1024.0) << " KiB\n";
+    std::cout << "  hidden_state: " << (hidden_state_size / 1024.0) << " KiB"
+              << (shared_buffers_.hidden_state_alt ? " x2 (ping-pong)" : "") << "\n";
     std::cout << "  rope_cos/sin: " << (2 * rope_size / 1024.0) << " KiB\n";
     std::cout << "  attention_mask: " << (attn_mask_size / 1024.0) << " KiB\n";
   }
@@ -400,38 +440,490 @@ bool LLMDecodeRunner::allocate_shared_buffers() {
   return true;
 }
 
+bool LLMDecodeRunner::plan_shard_dataflow() {
+  // Bindings mirror the copy path byte for byte:
+  // - hidden state: shard i writes buffer i % 2, shard i + 1 reads it (ping-pong)
+  // - ROPE cos/sin: written by shard 0, read in place by shards 1..N-1
+  // - attention mask: one buffer for every shard (filled once per step)
+  // Any edge that does not line up keeps the whole runner on the copy path.
+  struct Roles {
+    const QnnJsonTensorDesc* in[9] = {};
+    const QnnJsonTensorDesc* out[9] = {};
+  };
+  auto idx = [](ExecutionPlan::Role r) { return static_cast<int>(r); };
+  const int hidden = idx(ExecutionPlan::Role::kHidden);
+  const int rope_cos = idx(ExecutionPlan::Role::kRopeCos);
+  const int rope_sin = idx(ExecutionPlan::Role::kRopeSin);
+  const int mask = idx(ExecutionPlan::Role::kMask);
+  void* hidden_bufs[2] = {shared_buffers_.hidden_state, shared_buffers_.hidden_state_alt};
+  void* rope_bufs[9] = {};
+  rope_bufs[rope_cos] = shared_buffers_.rope_cos;
+  rope_bufs[rope_sin] = shared_buffers_.rope_sin;
+  const int num_shards = config_.num_shards;
+  
+  for (int phase = 0; phase < 2; ++phase) {
+    const bool prefill = phase == 0;
+    std::vector<Roles> roles(num_shards);
+    for (int i = 0; i < num_shards; ++i) {
+      const QnnJsonGraphDesc& graph = prefill ? *shards_[i].prefill_graph : *shards_[i].kv_graph;
+      ExecutionPlan::Layout layout{i * layers_per_shard_, num_layers_, num_heads_, head_dim_,
+                                   prefill ? prefill_ar_len_ : kv_ar_len_};
+      std::set<std::string> kv_names = ExecutionPlan::kv_input_names(graph, layout);
+      // Last match wins, as in ExecutionPlan::build
+      for (const auto& t : graph.inputs) {
+        if (!kv_names.count(t.name)) roles[i].in[idx(ExecutionPlan::input_role(t))] = &t;
+      }
+      for (const auto& t : graph.outputs) {
+        roles[i].out[idx(ExecutionPlan::output_role(t, layout))] = &t;
+      }
+    }
+    
+    std::vector<std::map<std::string, void*>> bound(num_shards);
+    auto fail = [&](int shard, const char* what) {
+      if (config_.log_level >= 1) {
+        std::cout << "[Dataflow] Shard " << shard << " " << (prefill ? "prefill" : "decode") << " "
+                  << what << " does not match, using the copy path\n";
+      }
+      for (auto& shard_info : shards_) {
+        shard_info.prefill_dataflow.clear();
+        shard_info.kv_dataflow.clear();
+      }
+      return false;
+    };
+    
+    for (int i = 0; i < num_shards; ++i) {
+      const Roles& r = roles[i];
+      if (r.in[mask]) {
+        if (r.in[mask]->nbytes > shared_buffers_.mask_bytes) return fail(i, "attention mask");
+        bound[i][r.in[mask]->name] = shared_buffers_.attention_mask;
+      }
+      if (i == 0) continue;
+      
+      if (r.in[hidden]) {
+        const QnnJsonTensorDesc* src = roles[i - 1].out[hidden];
+        if (!src || src->nbytes > shared_buffers_.hidden_bytes ||
+            r.in[hidden]->nbytes > src->nbytes) {
+          return fail(i, "hidden state");
+        }
+        void* buf = hidden_bufs[(i - 1) % 2];
+        bound[i - 1][src->name] = buf;
+        bound[i][r.in[hidden]->name] = buf;
+      }
+      for (int rope : {rope_cos, rope_sin}) {
+        if (!r.in[rope]) continue;
+        const QnnJsonTensorDesc* src = roles[0].out[rope];
+        if (!src || src->nbytes > shared_buffers_.rope_bytes || r.in[rope]->nbytes > src->nbytes) {
+          return fail(i, "ROPE");
+        }
+        bound[0][src->name] = rope_bufs[rope];
+        bound[i][r.in[rope]->name] = rope_bufs[rope];
+      }
+    }
+    
+    for (int i = 0; i < num_shards; ++i) {
+      (prefill ? shards_[i].prefill_dataflow : shards_[i].kv_dataflow) = std::move(bound[i]);
+    }
+  }
+  return true;
+}
+
+bool LLMDecodeRunner::load_shard_contexts(const std::vector<std::string>& context_files) {
+  const size_t n = context_files.size();
+  const uint64_t inflight_limit = static_cast<uint64_t>(std::max(0, config_.load_inflight_mb)) << 20;
+  const int64_t load_start_us = time_in_us();
+  stats_.load_rss_before_kb = read_rss_kb();
+  
+  std::vector<uint64_t> sizes(n);
+  uint64_t total_bytes = 0;
+  for (size_t i = 0; i < n; ++i) {
+    sizes[i] = file_size_of(context_files[i]);
+    total_bytes += sizes[i];
+  }
+  
+  std::vector<Qnn_ProfileHandle_t> profiles(n, nullptr);
+  for (size_t i = 0; i < n; ++i) {
+    profiles[i] = create_profile("shard" + std::to_string(i) + "/context_create", (int)i, "");
+  }
+  
+  stats_.shard_loads.assign(n, ShardLoadStat{});
+  for (size_t i = 0; i < n; ++i) {
+    stats_.shard_loads[i].shard = (int)i;
+    stats_.shard_loads[i].bytes = sizes[i];
+  }
+  
+  // Slots are reserved up front so contexts land in shard order regardless of completion order
+  const size_t first_slot = loader_->reserve_context_slots(n);
+  
+  size_t num_threads = config_.load_threads > 0
+      ? (size_t)config_.load_threads
+      : std::min<size_t>(4, std::max(1u, std::thread::hardware_concurrency()));
+  num_threads = std::max<size_t>(1, std::min(num_threads, n));
+  
+  // mmap mode maps every shard up front (address space only, no I/O) so readahead
+  // can be issued for the shard that comes next; read mode opens inside each task
+  std::vector<ContextBinary> binaries(n);
+  if (config_.use_mmap_load) {
+    for (size_t i = 0; i < n; ++i) {
+      int64_t t0 = time_in_us();
+      if (!binaries[i].open(context_files[i], true)) {
+        error_msg_ = "Failed to open context binary: " + context_files[i];
+        return false;
+      }
+      binaries[i].advise_sequential();
+      stats_.shard_loads[i].read_ms = elapsed_ms(t0);
+    }
+    stats_.load_used_mmap = std::all_of(binaries.begin(), binaries.end(),
+                                        [](const ContextBinary& b) { return b.mapped(); });
+  }
+  
+  ThreadPool pool(num_threads);
+  std::mutex log_mu;
+  std::mutex err_mu;
+  std::atomic<bool> failed{false};
+  
+  auto fail = [&](const std::string& msg) {
+    std::lock_guard<std::mutex> lk(err_mu);
+    if (!failed.exchange(true)) error_msg_ = msg;
+  };
+  
+  auto finish = [&](uint64_t peak_inflight) {
+    stats_.load_peak_inflight_bytes = peak_inflight;
+    stats_.context_load_ms = elapsed_ms(load_start_us);
+    stats_.load_rss_after_kb = read_rss_kb();
+    stats_.load_peak_rss_kb = read_peak_rss_kb();
+    return !failed;
+  };
+  
+  // ListAsync: the backend deserializes all shards in one call, which needs every
+  // binary resident at once, so it is only used when the whole model fits the budget
+  if (config_.use_list_async_load && loader_->supports_list_async() &&
+      (inflight_limit == 0 || total_bytes <= inflight_limit)) {
+    for (size_t i = 0; i < n; ++i) {
+      if (config_.use_mmap_load) {
+        binaries[i].prefetch();
+        continue;
+      }
+      pool.submit([&, i] {
+        int64_t t0 = time_in_us();
+        if (!binaries[i].open(context_files[i], false)) {
+          fail("Failed to read context binary: " + context_files[i]);
+          return;
+        }
+        stats_.shard_loads[i].read_ms = elapsed_ms(t0);
+      });
+    }
+    pool.wait_idle();
+    if (failed) return false;
+    
+    std::vector<std::pair<const void*, size_t>> list;
+    list.reserve(n);
+    for (const auto& b : binaries) list.emplace_back(b.data(), b.size());
+    
+    int64_t t0 = time_in_us();
+    if (loader_->create_contexts_list_async(first_slot, list, profiles)) {
+      double create_ms = elapsed_ms(t0);
+      for (size_t i = 0; i < n; ++i) {
+        stats_.shard_loads[i].create_ms = create_ms;
+        collect_profile(profiles[i], t0);
+        binaries[i].release();
+      }
+      if (config_.log_level >= 1) {
+        std::cout << "[Graphs] " << n << " contexts created via ListAsync ("
+                  << create_ms << " ms)\n";
+      }
+      return finish(total_bytes);
+    }
+    if (config_.log_level >= 1) {
+      std::cout << "[Graphs] ListAsync unavailable for these binaries, falling back to per-shard load\n";
+    }
+    // Binaries already opened are reused below; per-shard creation only
+    for (size_t i = 0; i < n; ++i) {
+      pool.submit([&, i] {
+        if (failed) return;
+        int64_t t0 = time_in_us();
+        if (!loader_->create_context_at(first_slot + i, binaries[i].data(), binaries[i].size(), profiles[i])) {
+          fail("Failed to create context from binary: " + context_files[i]);
+          return;
+        }
+        collect_profile(profiles[i], t0);
+        stats_.shard_loads[i].create_ms = elapsed_ms(t0);
+        binaries[i].release();
+      });
+    }
+    pool.wait_idle();
+    return finish(total_bytes);
+  }
+  
+  // Per-shard path: open → create → release, several shards at once within the byte budget.
+  // The first wave is prefetched here; each task then prefetches the shard that will
+  // take its place once it finishes (i + num_threads).
+  if (config_.use_mmap_load) {
+    for (size_t i = 0; i < std::min(n, num_threads); ++i) binaries[i].prefetch();
+  }
+  ByteBudget budget(inflight_limit);
+  for (size_t i = 0; i < n; ++i) {
+    pool.submit([&, i] {
+      if (failed) return;
+      budget.acquire(sizes[i]);
+      
+      ContextBinary& bin = binaries[i];
+      if (!config_.use_mmap_load) {
+        int64_t t0 = time_in_us();
+        if (!bin.open(context_files[i], false)) {
+          budget.release(sizes[i]);
+          fail("Failed to open context binary: " + context_files[i]);
+          return;
+        }
+        stats_.shard_loads[i].read_ms = elapsed_ms(t0);
+      } else if (i + num_threads < n) {
+        binaries[i + num_threads].prefetch();
+      }
+      
+      int64_t t1 = time_in_us();
+      bool ok = loader_->create_context_at(first_slot + i, bin.data(), bin.size(), profiles[i]);
+      stats_.shard_loads[i].create_ms = elapsed_ms(t1);
+      bin.release();
+      budget.release(sizes[i]);
+      if (!ok) {
+        fail("Failed to create context from binary: " + context_files[i]);
+        return;
+      }
+      collect_profile(profiles[i], t1);
+      
+      if (config_.log_level >= 1) {
+        std::lock_guard<std::mutex> lk(log_mu);
+        std::cout << "[Graphs] Shard " << i << ": context created (read "
+                  << stats_.shard_loads[i].read_ms << " ms, create "
+                  << stats_.shard_loads[i].create_ms << " ms)\n";
+      }
+    });
+  }
+  pool.wait_idle();
+  
+  if (config_.log_level >= 1 && !failed) {
+    std::cout << "[Graphs] Loaded " << n << " shards (" << (stats_.load_used_mmap ? "mmap" : "read")
+              << ") with " << num_threads << " threads, peak "
+              << (budget.peak() >> 20) << " MB in flight\n";
+  }
+  return finish(budget.peak());
+}
+
+bool LLMDecodeRunner::start_streaming_load() {
+  const int n = config_.num_shards;
+  if (loader_->reserve_context_slots(n) != 0) {
+    error_msg_ = "Streaming load requires an empty context table";
+    return false;
+  }
+  shards_loaded_.store(0, std::memory_order_release);
+  stream_failed_ = false;
+  stream_cancel_.store(false);
+  stats_.streaming_load = true;
+  stats_.shard_loads.assign(n, ShardLoadStat{});
+  
+  stream_thread_ = std::thread([this]() { stream_load_shards(); });
+  
+  if (config_.log_level >= 1) {
+    std::cout << "[Streaming] Loading " << n << " shards in the background\n";
+  }
+  return true;
+}
+
+void LLMDecodeRunner::stream_load_shards() {
+  const int n = config_.num_shards;
+  const int64_t start_us = time_in_us();
+  stats_.load_rss_before_kb = read_rss_kb();
+  
+  auto fail = [this](const std::string& msg) {
+    {
+      std::lock_guard<std::mutex> lk(stream_mu_);
+      stream_failed_ = true;
+      stream_error_ = msg;
+    }
+    stream_cv_.notify_all();
+  };
+  
+  // Index order: shard k becomes usable as soon as shards 0..k are ready.
+  // The next shard's pages are prefetched while the current context is created.
+  std::vector<ContextBinary> binaries(n);
+  for (int i = 0; i < n; ++i) {
+    if (stream_cancel_.load()) return fail("Streaming load cancelled");
+    
+    int64_t t0 = time_in_us();
+    ContextBinary& bin = binaries[i];
+    if (!bin.mapped() && !bin.open(shard_context_files_[i], config_.use_mmap_load)) {
+      return fail("Failed to open context binary: " + shard_context_files_[i]);
+    }
+    bin.advise_sequential();
+    if (i + 1 < n && config_.use_mmap_load && binaries[i + 1].open(shard_context_files_[i + 1], true)) {
+      binaries[i + 1].advise_sequential();
+      binaries[i + 1].prefetch();
+    }
+    stats_.shard_loads[i].shard = i;
+    stats_.shard_loads[i].bytes = bin.size();
+    stats_.shard_loads[i].read_ms = (time_in_us() - t0) / 1000.0;
+    
+    Qnn_ProfileHandle_t profile =
+        create_profile("shard" + std::to_string(i) + "/context_create", i, "");
+    int64_t t1 = time_in_us();
+    bool ok = loader_->create_context_at(i, bin.data(), bin.size(), profile);
+    stats_.shard_loads[i].create_ms = (time_in_us() - t1) / 1000.0;
+    bin.release();
+    if (!ok) return fail("Failed to create context from binary: " + shard_context_files_[i]);
+    collect_profile(profile, t1);
+    
+    std::string error;
+    if (!build_shard_plans(i, error)) return fail(error);
+    
+    const bool last = (i == n - 1);
+    if (last && (shards_[i].prefill_plan.logits_out < 0 || shards_[i].kv_plan.logits_out < 0)) {
+      return fail("Logits output not found in final shard");
+    }
+    
+    {
+      std::lock_guard<std::mutex> lk(stream_mu_);
+      // Load stats are complete before the last shard is published, so a caller
+      // that has waited for every shard reads them without racing this thread
+      if (last) {
+        stats_.load_used_mmap = config_.use_mmap_load;
+        stats_.context_load_ms = (time_in_us() - start_us) / 1000.0;
+        stats_.stream_load_ms = stats_.context_load_ms;
+        stats_.load_rss_after_kb = read_rss_kb();
+        stats_.load_peak_rss_kb = read_peak_rss_kb();
+        ready_.store(true, std::memory_order_release);
+      }
+      shards_loaded_.store(i + 1, std::memory_order_release);
+    }
+    stream_cv_.notify_all();
+    
+    if (config_.log_level >= 2) {
+      std::cout << "[Streaming] Shard " << i << " ready ("
+                << (time_in_us() - start_us) / 1000.0 << " ms)\n";
+    }
+  }
+}
+
+bool LLMDecodeRunner::wait_shard_ready(int shard_idx) {
+  if (shard_idx < shards_loaded_.load(std::memory_order_acquire)) return true;
+  
+  int64_t t0 = time_in_us();
+  std::unique_lock<std::mutex> lk(stream_mu_);
+  stream_cv_.wait(lk, [&]() {
+    return stream_failed_ || shard_idx < shards_loaded_.load(std::memory_order_acquire);
+  });
+  stats_.stream_blocked_ms += (time_in_us() - t0) / 1000.0;
+  if (shard_idx < shards_loaded_.load(std::memory_order_acquire)) return true;
+  error_msg_ = "Shard " + std::to_string(shard_idx) + " not available: " + stream_error_;
+  return false;
+}
+
+bool LLMDecodeRunner::build_shard_plans(int i, std::string& error) {
+  // KV cache inputs bind directly to LLMKVCacheManager (by order of appearance per shard)
+  auto kv_resolve = [this](int layer, int head, bool is_v) -> void* {
+    return is_v ? kv_manager_->get_v_cache(layer, head).input_buffer
+                : kv_manager_->get_k_cache(layer, head).input_buffer;
+  };
+  
+  auto& shard = shards_[i];
+  int layer_base = i * layers_per_shard_;
+  
+  // Dataflow-bound tensors (shared buffers) first, then the shard's own allocator
+  auto make_resolve = [](const QNNIOAllocator* alloc, const std::map<std::string, void*>* bound) {
+    return [alloc, bound](const QnnJsonTensorDesc& t) -> void* {
+      auto b = bound->find(t.name);
+      if (b != bound->end()) return b->second;
+      auto it = alloc->bindings().find(t.name);
+      return (it != alloc->bindings().end()) ? it->second : nullptr;
+    };
+  };
+  auto prefill_resolve = make_resolve(shard.prefill_alloc.get(), &shard.prefill_dataflow);
+  auto kv_alloc_resolve = make_resolve(shard.kv_alloc.get(), &shard.kv_dataflow);
+  
+  ExecutionPlan::Layout prefill_layout{layer_base, num_layers_, num_heads_, head_dim_, prefill_ar_len_};
+  ExecutionPlan::Layout kv_layout{layer_base, num_layers_, num_heads_, head_dim_, kv_ar_len_};
+  
+  if (!shard.prefill_plan.build(*loader_, i, *shard.prefill_graph, prefill_layout,
+                                prefill_resolve, kv_resolve) ||
+      !shard.kv_plan.build(*loader_, i, *shard.kv_graph, kv_layout,
+                           kv_alloc_resolve, kv_resolve)) {
+    error = "Failed to build execution plans for shard " + std::to_string(i);
+    return false;
+  }
+  attach_plan_profiles(shard.prefill_plan, shard.kv_plan, i, "shard" + std::to_string(i));
+  
+  if (config_.log_level >= 2) {
+    std::cout << "[Shard " << i << " Plan] Prefill I/O: "
+              << shard.prefill_plan.num_inputs() << "/" << shard.prefill_plan.num_outputs()
+              << " (KV in " << shard.prefill_plan.kv_in.size() << "), KV I/O: "
+              << shard.kv_plan.num_inputs() << "/" << shard.kv_plan.num_outputs()
+              << " (KV in " << shard.kv_plan.kv_in.size() << ")\n";
+  }
+  
+  return true;
+}
+
+bool LLMDecodeRunner::build_multi_context_plans() {
+  for (int i = 0; i < config_.num_shards; ++i) {
+    if (!build_shard_plans(i, error_msg_)) return false;
+  }
+  
+  int final_shard = config_.num_shards - 1;
+  if (shards_[final_shard].prefill_plan.logits_out < 0 ||
+      shards_[final_shard].kv_plan.logits_out < 0) {
+    error_msg_ = "Logits output not found in final shard";
+    return false;
+  }
+  
+  shards_loaded_.store(config_.num_shards, std::memory_order_release);
+  
+  if (config_.log_level >= 1) {
+    std::cout << "[Multi-Context] Execution plans built for " << config_.num_shards << " shards\n";
+  }
+  
+  return true;
+}
+
 bool LLMDecodeRunner::run_multi_context_prefill(const std::vector<int32_t>& tokens,
                                                   int32_t& next_token,
                                                   int32_t& n_update) {
   if (config_.log_level >= 1) {
-    std::cout << "[Multi-Context Prefill] Starting with " << tokens.size() << " tokens\n";
+    LogLine() << "[Multi-Context Prefill] Starting with " << tokens.size() << " tokens\n";
   }
   
-  int32_t n_past = 0;
+  int32_t n_past = 0;     // Occupied cache positions (= position id of the next token)
+  int32_t consumed = 0;   // Prompt tokens ingested (ahead of n_past after a context shift)
   int32_t num_tokens = tokens.size();
-  uint16_t* attn_mask = reinterpret_cast<uint16_t*>(shared_buffer_views_["attention_mask"]);
+  uint16_t* attn_mask = reinterpret_cast<uint16_t*>(shared_buffers_.attention_mask);
+  begin_prefill(num_tokens);
+  
+  // Shared prefix: cached chunks are copied in, prefill resumes at the first uncached chunk
+  n_past = consumed = restore_prefix(tokens);
 
 
   if (config_.log_level >= 1) {
-    std::cout << "[Multi-Context Prefill] Input tokens:\n";
+    LogLine() << "[Multi-Context Prefill] Input tokens:\n";
     for (size_t i = 0; i < tokens.size(); ++i) {
-      std::cout << "  token[" << i << "] = " << tokens[i] << "\n";
+      LogLine() << "  token[" << i << "] = " << tokens[i] << "\n";
     }
   }
   
   // Multiple iteration prefill
-  while (n_past < num_tokens) {
-    int32_t chunk_size = std::min(prefill_ar_len_, num_tokens - n_past);
+  while (consumed < num_tokens) {
+    int32_t chunk_size = std::min(prefill_ar_len_, num_tokens - consumed);
+    
+    // Prompt longer than the prefill cache: shift before the chunk is written
+    if (!shift_context(n_past, chunk_size, false)) {
+      return false;
+    }
     
     if (config_.log_level >= 1) {
-      std::cout << "[Multi-Context Prefill] Iteration: n_past=" << n_past 
+      LogLine() << "[Multi-Context Prefill] Iteration: n_past=" << n_past 
                 << ", chunk_size=" << chunk_size << "\n";
     }
     
     // Extract current chunk of tokens
     std::vector<int32_t> chunk_tokens(
-      tokens.begin() + n_past,
-      tokens.begin() + n_past + chunk_size
+      tokens.begin() + consumed,
+      tokens.begin() + consumed + chunk_size
     );
 
     // Pad chunk to prefill_ar_len if needed
@@ -457,149 +949,35 @@ bool LLMDecodeRunner::run_multi_context_prefill(const std::vector<int32_t>& toke
     }
     
     // Run prefill through all shards sequentially
+    // Shard N-1's KV writeback overlaps with shard N's execution
     for (int shard_idx = 0; shard_idx < config_.num_shards; ++shard_idx) {
-      if (!run_shard_prefill(shard_idx, chunk_tokens, n_past, chunk_size)) {
+      if (!run_shard_prefill(shard_idx, chunk_tokens, n_past, chunk_size, shard_idx - 1)) {
         return false;
       }
     }
-    
-    // Update KV cache: copy prefill outputs to KV inputs for this iteration
-    if (config_.log_level >= 2) {
-      std::cout << "[Multi-Context Prefill] Updating KV cache for iteration at n_past=" 
-                << n_past << ", chunk_size=" << chunk_size << "\n";
-    }
-    
-    int total_v_updated = 0, total_k_updated = 0;
-    
-    for (int shard_idx = 0; shard_idx < config_.num_shards; ++shard_idx) {
-      auto& shard = shards_[shard_idx];
-      auto& bindings = shard.prefill_alloc->bindings();
-      int shard_layer_base = shard_idx * layers_per_shard_;
-      
-      // Collect V and K cache outputs (in original order, no sorting!)
-      std::vector<void*> v_outputs, k_outputs;
-      for (const auto& t : shard.prefill_graph->outputs) {
-        auto bit = bindings.find(t.name);
-        if (bit == bindings.end()) continue;
-        
-        if (t.name.find("output_aten_view_copy_default_") != std::string::npos) {
-          v_outputs.push_back(bit->second);
-        } else if (t.name.find("output_aten_permute_copy_default_") != std::string::npos) {
-          k_outputs.push_back(bit->second);
-        }
-      }
-      
-      // Process V caches
-      for (size_t i = 0; i < v_outputs.size(); ++i) {
-        int local_layer = i / num_heads_;
-        int head = i % num_heads_;
-        int global_layer = shard_layer_base + local_layer;
-        
-        if (global_layer >= num_layers_) continue;
-        
-        const auto& v_buf = kv_manager_->get_v_cache(global_layer, head);
-        uint8_t* src = reinterpret_cast<uint8_t*>(v_outputs[i]);
-        uint8_t* dst = reinterpret_cast<uint8_t*>(v_buf.input_buffer) + n_past * head_dim_;
-        std::memcpy(dst, src, chunk_size * head_dim_);
-        
-        if (config_.log_level >= 2 && shard_idx == 0 && i < 2) {
-          std::cout << "[Prefill KV] Iter: n_past=" << n_past << " Shard " << shard_idx 
-                    << " V-cache " << i << " → Layer " << global_layer << " Head " << head << "\n";
-        }
-        total_v_updated++;
-      }
-      
-      // Process K caches
-      for (size_t i = 0; i < k_outputs.size(); ++i) {
-        int local_layer = i / num_heads_;
-        int head = i % num_heads_;
-        int global_layer = shard_layer_base + local_layer;
-        
-        if (global_layer >= num_layers_) continue;
-        
-        const auto& k_buf = kv_manager_->get_k_cache(global_layer, head);
-        uint8_t* src = reinterpret_cast<uint8_t*>(k_outputs[i]);
-        uint8_t* dst = reinterpret_cast<uint8_t*>(k_buf.input_buffer) + n_past;
-        
-        // K cache: copy with stride (transposed layout)
-        for (int32_t dim = 0; dim < head_dim_; ++dim) {
-          std::memcpy(dst, src, chunk_size);
-          src += prefill_ar_len_;
-          dst += prefill_cache_len_;
-        }
-        total_k_updated++;
-      }
-    }
-    
-    if (config_.log_level >= 2) {
-      std::cout << "[Multi-Context Prefill] KV cache updated: "
-                << total_v_updated << " V-caches, "
-                << total_k_updated << " K-caches\n";
-    }
+    // Overlaps the next chunk's mask/token setup (or the logits argmax after the last chunk)
+    submit_kv_writeback({config_.num_shards - 1, n_past, chunk_size});
     
     // Advance n_past for next iteration
     n_past += chunk_size;
+    consumed += chunk_size;
   }  // End of while loop
   
   if (config_.log_level >= 1) {
-    std::cout << "[Multi-Context Prefill] All iterations completed. Total tokens processed: " 
-              << n_past << "\n";
-  }
-  
-  // Extract logits from final shard
-  int final_shard = config_.num_shards - 1;
-  const QnnJsonTensorDesc* logits_desc = nullptr;
-  
-  // Find logits output
-  for (const auto& t : shards_[final_shard].prefill_graph->outputs) {
-    std::string name_lower = t.name;
-    for (auto& c : name_lower) c = (char)tolower(c);
-    
-    if (name_lower.find("squeeze") != std::string::npos) {
-      logits_desc = &t;
-      break;
-    }
-  }
-  
-  // Fallback: use the largest output tensor
-  if (!logits_desc) { // [spagetti] 이 부분 뭐하는거임? 필요한거임?
-    size_t max_size = 0;
-    for (const auto& t : shards_[final_shard].prefill_graph->outputs) {
-      if (t.dims.size() == 3 && t.name.find("_args_") != std::string::npos) {
-        continue;
-      }
-      if (t.nbytes > max_size) {
-        max_size = t.nbytes;
-        logits_desc = &t;
-      }
-    }
+    LogLine() << "[Multi-Context Prefill] All iterations completed. Total tokens processed: " 
+              << consumed << "\n";
   }
   
-  if (!logits_desc) {
-    error_msg_ = "Logits output not found in final shard";
-    return false;
-  }
+  // Extract logits from final shard (slot resolved at plan build time)
+  const auto& final_plan = shards_[config_.num_shards - 1].prefill_plan;
   
   if (config_.log_level >= 1) {
-    std::cout << "[Multi-Context Prefill] Logits tensor: " << logits_desc->name 
-              << " (" << logits_desc->nbytes << " bytes)\n";
-  }
-  
-  // Get logits buffer
-  auto& bindings = shards_[final_shard].prefill_alloc->bindings();
-  auto it = bindings.find(logits_desc->name);
-  if (it == bindings.end()) {
-    error_msg_ = "Logits buffer not found in bindings";
-    return false;
-  }
-  
-  if (!it->second) {
-    error_msg_ = "Logits buffer is null";
-    return false;
+    LogLine() << "[Multi-Context Prefill] Logits tensor: " << final_plan.output_desc(final_plan.logits_out).name 
+              << " (" << final_plan.output_bytes(final_plan.logits_out) << " bytes)\n";
   }
   
   // Argmax to get next token
-  const uint16_t* logits = reinterpret_cast<const uint16_t*>(it->second);
+  const uint16_t* logits = reinterpret_cast<const uint16_t*>(final_plan.output_data(final_plan.logits_out));
   int32_t vocab_size = model_params_.is_valid() ? model_params_.vocab_size : 128256;
   
   // For prefill, logits are [batch=1, prefill_ar_len, vocab_size]
@@ -612,11 +990,11 @@ bool LLMDecodeRunner::run_multi_context_prefill(const std::vector<int32_t>& toke
   int32_t last_chunk_size = ((num_tokens - 1) % prefill_ar_len_) + 1;
   int32_t last_token_offset = (last_chunk_size - 1) * vocab_size;
   
-  // Calculate n_update: total tokens processed (not just last chunk)
-  n_update = num_tokens;
+  // Calculate n_update: occupied cache positions (all prompt tokens unless shifted)
+  n_update = n_past;
   
   if (config_.log_level >= 1) {
-    std::cout << "[Multi-Context Prefill] Argmax: total_tokens=" << num_tokens
+    LogLine() << "[Multi-Context Prefill] Argmax: total_tokens=" << num_tokens
               << ", last_chunk_size=" << last_chunk_size
               << ", vocab_size=" << vocab_size 
               << ", offset=" << last_token_offset << "\n";
@@ -624,9 +1002,9 @@ bool LLMDecodeRunner::run_multi_context_prefill(const std::vector<int32_t>& toke
   
   if (config_.log_level >= 2) {
     // Debug: check specific token logits
-    std::cout << "[Prefill Logits] Token 12366 (Paris): " << logits[last_token_offset + 12366] << "\n";
-    std::cout << "[Prefill Logits] Token 59405 (gens): " << logits[last_token_offset + 59405] << "\n";
-    std::cout << "[Prefill Logits] Token 23109 (Ka): " << logits[last_token_offset + 23109] << "\n";
+    LogLine() << "[Prefill Logits] Token 12366 (Paris): " << logits[last_token_offset + 12366] << "\n";
+    LogLine() << "[Prefill Logits] Token 59405 (gens): " << logits[last_token_offset + 59405] << "\n";
+    LogLine() << "[Prefill Logits] Token 23109 (Ka): " << logits[last_token_offset + 23109] << "\n";
   }
   
   uint16_t max_val = logits[last_token_offset];
@@ -639,14 +1017,18 @@ bool LLMDecodeRunner::run_multi_context_prefill(const std::vector<int32_t>& toke
   }
   
   if (config_.log_level >= 1) {
-    std::cout << "[Multi-Context Prefill] Next token: " << next_token << "\n";
+    LogLine() << "[Multi-Context Prefill] Next token: " << next_token << "\n";
   }
   
-  // Rearrange cache: 480 → 511
-  kv_manager_->rearrange_cache(prefill_ar_len_, kv_ar_len_);
+  // Rearrange cache: 480 → 511 (already at decode stride on the zero-KV path)
+  sync_kv_writeback(false);
+  if (n_past == consumed) {
+    store_prefix(tokens, n_past);
+  }
+  finish_prefill_layout(n_past);
   
   if (config_.log_level >= 1) {
-    std::cout << "[Multi-Context Prefill] Completed\n";
+    LogLine() << "[Multi-Context Prefill] Completed\n";
   }
   
   return true;
@@ -654,202 +1036,65 @@ bool LLMDecodeRunner::run_multi_context_prefill(const std::vector<int32_t>& toke
 
 bool LLMDecodeRunner::run_multi_context_decode_step(int32_t token_in,
                                                       int32_t n_past,
-                                                      int32_t& token_out) {
+                                                      int32_t& token_out,
+                                                      const std::function<void()>* host_work) {
   if (config_.log_level >= 2) {
-    std::cout << "[Multi-Context Decode] Step: token=" << token_in 
+    LogLine() << "[Multi-Context Decode] Step: token=" << token_in 
               << ", n_past=" << n_past << "\n";
   }
   
-  // Prepare shard 0 inputs: token, position, attention_mask
-  auto& shard0 = shards_[0];
-  auto& bindings0 = shard0.kv_alloc->bindings();
+  // Previous step's last-shard writeback must land before shard 0's inputs are touched
+  sync_kv_writeback(true);
   
-  for (const auto& t : shard0.kv_graph->inputs) {
-    auto it = bindings0.find(t.name);
-    if (it == bindings0.end()) continue;
-    
-    std::string name_lower = t.name;
-    for (auto& c : name_lower) c = (char)tolower(c);
-    
-    // Token
-    if (name_lower.find("token") != std::string::npos && name_lower.find("input") != std::string::npos) {
-      std::memcpy(it->second, &token_in, sizeof(int32_t));
-      if (config_.log_level >= 2) {
-        std::cout << "[Decode Shard 0] Token filled: " << token_in << "\n";
-      }
-    }
-    // Position
-    else if (name_lower.find("pos") != std::string::npos && t.data_type.find("INT_32") != std::string::npos) {
-      std::memcpy(it->second, &n_past, sizeof(int32_t));
-      if (config_.log_level >= 2) {
-        std::cout << "[Decode Shard 0] Position filled: " << n_past << "\n";
-      }
-    }
-    // Attention mask
-    else if (name_lower.find("atten_mask") != std::string::npos) {
-      uint16_t* attn_mask = reinterpret_cast<uint16_t*>(it->second);
-      std::memset(attn_mask, 0, context_len_ * sizeof(uint16_t));
-      
-      // Attend to past tokens [0..n_past-1]
-      for (int32_t i = 0; i < n_past; ++i) {
-        attn_mask[i] = 65535;
-      }
-      // Attend to current token (last position in rearranged cache)
-      attn_mask[context_len_ - 1] = 65535;
-      
-      if (config_.log_level >= 2) {
-        std::cout << "[Decode Shard 0] Attention mask: attend to [0, " << (n_past - 1) << "] and [" << (context_len_ - 1) << "] (" << (n_past + 1) << " tokens)\n";
-      }
-      
-      // Also copy to shared buffer for other shards
-      std::memcpy(shared_buffer_views_["attention_mask"], attn_mask, context_len_ * sizeof(uint16_t));
-    }
-  }
+  // Prepare shard 0 inputs: token, position, attention_mask
+  auto& plan0 = shards_[0].kv_plan;
   
-  // Run decode through all shards sequentially
-  for (int shard_idx = 0; shard_idx < config_.num_shards; ++shard_idx) {
-    if (config_.log_level >= 2) {
-      std::cout << "[Multi-Context Decode] Running shard " << shard_idx << "...\n";
-    }
-    if (!run_shard_decode(shard_idx, n_past)) {
-      return false;
-    }
-    if (config_.log_level >= 2) {
-      std::cout << "[Multi-Context Decode] Shard " << shard_idx << " completed\n";
-    }
+  if (plan0.token_in >= 0) {
+    std::memcpy(plan0.input_data(plan0.token_in), &token_in, sizeof(int32_t));
   }
-  
-  // Update KV cache: copy decode outputs to inputs for next step
-  // Manual memcpy (exactly like single-context)
-  if (config_.log_level >= 2) {
-    std::cout << "[Multi-Context Decode] Updating KV cache at position " << n_past << "...\n";
+  if (plan0.pos_in >= 0) {
+    std::memcpy(plan0.input_data(plan0.pos_in), &n_past, sizeof(int32_t));
   }
-  
-  int total_v_updated = 0, total_k_updated = 0;
-  
-  // Copy KV cache outputs to inputs for all shards
-  for (int shard_idx = 0; shard_idx < config_.num_shards; ++shard_idx) {
-    auto& shard = shards_[shard_idx];
-    auto& bindings = shard.kv_alloc->bindings();
-    int shard_layer_base = shard_idx * layers_per_shard_;
-    
-    // Collect V and K cache outputs (in original order, no sorting!)
-    std::vector<void*> v_outputs, k_outputs;
-    for (const auto& t : shard.kv_graph->outputs) {
-      auto bit = bindings.find(t.name);
-      if (bit == bindings.end()) continue;
-      
-      if (t.name.find("output_aten_view_copy_default_") != std::string::npos) {
-        v_outputs.push_back(bit->second);
-      } else if (t.name.find("output_aten_permute_copy_default_") != std::string::npos) {
-        k_outputs.push_back(bit->second);
-      }
-    }
+  if (plan0.mask_in >= 0) {
+    uint16_t* attn_mask = reinterpret_cast<uint16_t*>(plan0.input_data(plan0.mask_in));
+    std::memset(attn_mask, 0, context_len_ * sizeof(uint16_t));
     
-    // Process V caches (순서대로 layer/head 할당)
-    for (size_t i = 0; i < v_outputs.size(); ++i) {
-      int local_layer = i / num_heads_;
-      int head = i % num_heads_;
-      int global_layer = shard_layer_base + local_layer;
-      
-      if (global_layer >= num_layers_) continue;
-      
-      const auto& v_buf = kv_manager_->get_v_cache(global_layer, head);
-      uint8_t* src = reinterpret_cast<uint8_t*>(v_outputs[i]);
-      uint8_t* dst = reinterpret_cast<uint8_t*>(v_buf.input_buffer) + n_past * head_dim_;
-      std::memcpy(dst, src, 1 * head_dim_);
-      total_v_updated++;
+    // Attend to past tokens [0..n_past-1]
+    for (int32_t i = 0; i < n_past; ++i) {
+      attn_mask[i] = 65535;
     }
+    // Attend to current token (last position in rearranged cache)
+    attn_mask[context_len_ - 1] = 65535;
     
-    // Process K caches (순서대로 layer/head 할당)
-    for (size_t i = 0; i < k_outputs.size(); ++i) {
-      int local_layer = i / num_heads_;
-      int head = i % num_heads_;
-      int global_layer = shard_layer_base + local_layer;
-      
-      if (global_layer >= num_layers_) continue;
-      
-      const auto& k_buf = kv_manager_->get_k_cache(global_layer, head);
-      uint8_t* src = reinterpret_cast<uint8_t*>(k_outputs[i]);
-      uint8_t* dst = reinterpret_cast<uint8_t*>(k_buf.input_buffer) + n_past;
-      
-      // K cache: copy with stride (transposed layout)
-      for (int32_t dim = 0; dim < head_dim_; ++dim) {
-        dst[dim * kv_cache_len_] = src[dim];
-      }
-      total_k_updated++;
+    if (config_.log_level >= 2) {
+      LogLine() << "[Decode Shard 0] Attention mask: attend to [0, " << (n_past - 1) << "] and [" << (context_len_ - 1) << "] (" << (n_past + 1) << " tokens)\n";
     }
-  }
-  
-  if (config_.log_level >= 2) {
-    std::cout << "[Multi-Context Decode] KV cache updated: " 
-              << total_v_updated << " V-caches, " 
-              << total_k_updated << " K-caches\n";
-  }
-  
-  // Extract logits from final shard (kv_forward)
-  int final_shard = config_.num_shards - 1;
-  const QnnJsonTensorDesc* logits_desc = nullptr;
-  
-  for (const auto& t : shards_[final_shard].kv_graph->outputs) {
-    std::string name_lower = t.name;
-    for (auto& c : name_lower) c = (char)tolower(c);
     
-    if (name_lower.find("squeeze") != std::string::npos ||
-        name_lower.find("logit") != std::string::npos ||
-        name_lower.find("lm_head") != std::string::npos) {
-      logits_desc = &t;
-      break;
-    }
-  }
-  
-  // Fallback: use the largest output tensor
-  if (!logits_desc) {
-    size_t max_size = 0;
-    for (const auto& t : shards_[final_shard].kv_graph->outputs) {
-      if (t.dims.size() == 3 && t.name.find("_args_") != std::string::npos) {
-        continue;
-      }
-      if (t.nbytes > max_size) {
-        max_size = t.nbytes;
-        logits_desc = &t;
-      }
+    // Also copy to shared buffer for other shards (already there with zero-copy dataflow)
+    if (attn_mask != shared_buffers_.attention_mask) {
+      std::memcpy(shared_buffers_.attention_mask, attn_mask, context_len_ * sizeof(uint16_t));
     }
   }
   
-  if (!logits_desc) {
-    error_msg_ = "Logits output not found in final shard";
-    return false;
-  }
-  
-  if (config_.log_level >= 2) {
-    std::cout << "[Multi-Context Decode] Using logits from: " << logits_desc->name << "\n";
-  }
-  
-  auto& bindings = shards_[final_shard].kv_alloc->bindings();
-  
-  // Debug: Print first few logits values
-  if (config_.log_level >= 2) {
-    auto it_debug = bindings.find(logits_desc->name);
-    if (it_debug != bindings.end()) {
-      const uint16_t* logits_debug = reinterpret_cast<const uint16_t*>(it_debug->second);
-      std::cout << "[Decode Logits] First 8 values: ";
-      for (int i = 0; i < 8; ++i) {
-        std::cout << logits_debug[i] << " ";
-      }
-      std::cout << "\n";
+  // Run decode through all shards sequentially
+  // - host_work (detokenize/print of the previous token) overlaps with shard 0
+  // - shard N-1's KV writeback overlaps with shard N's execution
+  for (int shard_idx = 0; shard_idx < config_.num_shards; ++shard_idx) {
+    if (!run_shard_decode(shard_idx, n_past, shard_idx - 1,
+                          shard_idx == 0 ? host_work : nullptr)) {
+      return false;
     }
   }
-  auto it = bindings.find(logits_desc->name);
-  if (it == bindings.end()) {
-    error_msg_ = "Logits buffer not found";
-    return false;
-  }
+  // Last shard: overlaps the argmax below (synced at the start of the next step)
+  submit_kv_writeback({config_.num_shards - 1, n_past, 0});
+  stats_.decode_kv_steps++;
   
-  // Argmax
-  const uint16_t* logits = reinterpret_cast<const uint16_t*>(it->second);
+  // Extract logits from final shard (kv_forward)
+  const auto& final_plan = shards_[config_.num_shards - 1].kv_plan;
+  const uint16_t* logits = reinterpret_cast<const uint16_t*>(final_plan.output_data(final_plan.logits_out));
   int32_t vocab_size = model_params_.is_valid() ? model_params_.vocab_size : 128256;
   
+  // Argmax
   uint16_t max_val = logits[0];
   token_out = 0;
   for (int32_t i = 1; i < vocab_size; ++i) {
@@ -860,10 +1105,10 @@ bool LLMDecodeRunner::run_multi_context_decode_step(int32_t token_in,
   }
   
   if (config_.log_level >= 2) {
-    std::cout << "[Decode Logits] Selected token " << token_out << " with value: " << max_val << "\n";
-    std::cout << "[Decode Logits] Token 12366 (Paris): " << logits[12366] << "\n";
-    std::cout << "[Decode Logits] Token 14924 (Question): " << logits[14924] << "\n";
-    std::cout << "[Decode Logits] Token 9822 (France): " << logits[9822] << "\n";
+    LogLine() << "[Decode Logits] Selected token " << token_out << " with value: " << max_val << "\n";
+    LogLine() << "[Decode Logits] Token 12366 (Paris): " << logits[12366] << "\n";
+    LogLine() << "[Decode Logits] Token 14924 (Question): " << logits[14924] << "\n";
+    LogLine() << "[Decode Logits] Token 9822 (France): " << logits[9822] << "\n";
   }
   
   return true;
@@ -872,400 +1117,254 @@ bool LLMDecodeRunner::run_multi_context_decode_step(int32_t token_in,
 bool LLMDecodeRunner::run_shard_prefill(int shard_idx,
                                          const std::vector<int32_t>& tokens,
                                          int32_t n_past,
-                                         int32_t n_update) {
-  if (config_.log_level >= 1) {
-    std::cout << "[Shard " << shard_idx << " Prefill] Running...\n";
-  }
-  
-  auto& shard = shards_[shard_idx];
-  auto& bindings = shard.prefill_alloc->bindings();
+                                         int32_t n_update,
+                                         int writeback_shard) {
+  // Streaming start-up: block only if the loader has not reached this shard yet
+  if (!wait_shard_ready(shard_idx)) return false;
   
-  // Setup KV cache override for this shard's layers
-  std::map<std::string, void*> kv_override;
-  int shard_layer_start = shard_idx * layers_per_shard_;
-  int shard_layer_end = shard_layer_start + layers_per_shard_;
-  
-  if (config_.log_level >= 2) {
-    std::cout << "[Shard " << shard_idx << "] Layer range: " << shard_layer_start 
-              << "-" << (shard_layer_end - 1) << "\n";
-  }
-  
-  // Count KV cache tensors for this shard
-  // Input KV cache: dims[1] tells us if it's V cache (small value like 32, 992, 1023) 
-  // or K cache (larger value like 64)
-  int v_count = 0, k_count = 0;
-  for (const auto& t : shard.prefill_graph->inputs) {
-    if (t.name.find("_args_") != std::string::npos && t.dims.size() == 3) {
-      // V cache: [1, cache_len, head_dim=64]
-      // K cache: [1, head_dim=64, cache_len]
-      bool is_v = (t.dims[2] == head_dim_);  // V: last dim is head_dim
-      bool is_k = (t.dims[1] == head_dim_);  // K: middle dim is head_dim
-      
-      if (is_v || is_k) {
-        // This shard's local index
-        int local_idx = is_v ? v_count++ : k_count++;
-        int local_layer = local_idx / num_heads_;
-        int head = local_idx % num_heads_;
-        
-        // Convert to global layer index
-        int global_layer = shard_layer_start + local_layer;
-        
-        if (global_layer < num_layers_) {
-          const auto& cache_buf = is_v ? 
-            kv_manager_->get_v_cache(global_layer, head) :
-            kv_manager_->get_k_cache(global_layer, head);
-          kv_override[t.name] = cache_buf.input_buffer;
-        } else if (config_.log_level >= 2) {
-          std::cout << "[Shard " << shard_idx << "] WARNING: global_layer " << global_layer 
-                    << " >= num_layers " << num_layers_ << "\n";
-        }
-      }
-    }
+  if (config_.log_level >= 1) {
+    LogLine() << "[Shard " << shard_idx << " Prefill] Running...\n";
   }
   
-  if (config_.log_level >= 2) {
-    std::cout << "[Shard " << shard_idx << "] KV cache bound: " << kv_override.size() << " tensors\n";
-  }
+  auto& plan = shards_[shard_idx].prefill_plan;
+  sync_kv_writeback(false);
+  bind_prefill_kv_inputs(plan);
   
-  // 1. Fill input buffers
+  // 1. Fill input buffers (KV cache inputs are already bound by the plan)
   if (shard_idx == 0) {
     if (config_.log_level >= 2) {
-      std::cout << "[Shard 0] Filling inputs: " << tokens.size() << " tokens\n";
-      std::cout << "[Shard 0] First token: " << tokens[0] << "\n";
+      LogLine() << "[Shard 0] Filling inputs: " << tokens.size() << " tokens\n";
     }
     
-    // Fill tokens and positions (skip attention mask - we manage it manually)
-    InputPreparer::auto_fill_inputs(*shard.prefill_graph,
-      [&](const std::string& name) -> void* {
-        // Check KV override first
-        auto ko = kv_override.find(name);
-        if (ko != kv_override.end()) return ko->second;
-        
-        // Otherwise use normal binding
-        auto it = bindings.find(name);
-        return (it != bindings.end()) ? it->second : nullptr;
-      },
-      tokens,
-      n_past,  // start_pos: use current n_past for position tensor
-      true,    // skip_attention_mask: we manually set it before this call
-      config_.log_level >= 2);
-    
-    // Copy manually-set attention mask to shard 0's input buffer
-    for (const auto& t : shard.prefill_graph->inputs) {
-      std::string name_lower = t.name;
-      for (auto& c : name_lower) c = (char)tolower(c);
-      if (name_lower.find("atten_mask") != std::string::npos) {
-        auto it = bindings.find(t.name);
-        if (it != bindings.end()) {
-          std::memcpy(it->second, shared_buffer_views_["attention_mask"], t.nbytes);
-          if (config_.log_level >= 2) {
-            std::cout << "[Shard 0] Attention mask copied from shared buffer\n";
-          }
-        }
-        break;
-      }
+    // Fill tokens and positions (attention mask is managed manually)
+    if (plan.token_in >= 0) {
+      InputPreparer::fill_tokens(plan.input_data(plan.token_in),
+                                 plan.input_desc(plan.token_in), tokens);
     }
-  } else {
-    // Shard 1-7: hidden_state, ROPE, attention_mask
-    if (config_.log_level >= 2) {
-      std::cout << "[Shard " << shard_idx << "] Copying from shared buffers...\n";
-      if (shard_idx == 1) {
-        std::cout << "[Shard 1] All non-KV input names:\n";
-        for (const auto& t : shard.prefill_graph->inputs) {
-          auto ko = kv_override.find(t.name);
-          if (ko == kv_override.end()) {
-            std::cout << "  - " << t.name << "\n";
-          }
-        }
-      }
+    if (plan.pos_in >= 0) {
+      InputPreparer::fill_positions(plan.input_data(plan.pos_in),
+                                    plan.input_desc(plan.pos_in), tokens.size(), n_past);
     }
-    
-    // Copy inputs from shared buffers
-    for (const auto& t : shard.prefill_graph->inputs) { // [spagetti] 정확하게 어떻게 동작하는건지 확인할 필요 있음
-      auto ko = kv_override.find(t.name);
-      if (ko != kv_override.end()) continue;  // Skip KV cache (already bound)
-      
-      auto it = bindings.find(t.name);
-      if (it == bindings.end()) continue;
-      
-      std::string name_lower = t.name;
-      for (auto& c : name_lower) c = (char)tolower(c);
-      
-      // Hidden state
-      if (name_lower.find("fallback") != std::string::npos) {
-        std::memcpy(it->second, shared_buffer_views_["hidden_state"], t.nbytes);
-        if (config_.log_level >= 2) {
-          std::cout << "[Shard " << shard_idx << "] Hidden state copied: " << t.nbytes << " bytes\n";
-        }
-      }
-      // ROPE cos
-      else if (t.name.find("input_9_aten_view_copy_default_0") != std::string::npos || t.name.find("input_9_aten_select_copy_int_0") != std::string::npos) {
-        std::memcpy(it->second, shared_buffer_views_["rope_cos"], t.nbytes);
-        if (config_.log_level >= 2) {
-          std::cout << "[Shard " << shard_idx << "] ROPE cos copied: " << t.nbytes << " bytes\n";
-        }
-      }
-      // ROPE sin
-      else if (t.name.find("input_10_aten_view_copy_default_1_0") != std::string::npos || t.name.find("input_10_aten_select_copy_int_1_0") != std::string::npos) {
-        std::memcpy(it->second, shared_buffer_views_["rope_sin"], t.nbytes);
-        if (config_.log_level >= 2) {
-          std::cout << "[Shard " << shard_idx << "] ROPE sin copied: " << t.nbytes << " bytes\n";
-        }
-      }
-      // Attention mask
-      else if (name_lower.find("atten_mask") != std::string::npos) {
-        std::memcpy(it->second, shared_buffer_views_["attention_mask"], t.nbytes);
-        if (config_.log_level >= 2) {
-          std::cout << "[Shard " << shard_idx << "] Attention mask copied: " << t.nbytes << " bytes\n";
-        }
-      }
+  } else if (!dataflow_) {
+    // Shard 1-7: hidden_state, ROPE from shared buffers
+    if (plan.hidden_in >= 0) {
+      std::memcpy(plan.input_data(plan.hidden_in), shared_buffers_.hidden_state, plan.input_bytes(plan.hidden_in));
     }
-  }
-  
-  // 2. Build tensor lists and execute
-  std::vector<Qnn_Tensor_t> inputs, outputs;
-  
-  for (size_t i = 0; i < shard.prefill_graph->inputs.size() && i < shard.prefill_input_holders.size(); ++i) { // [spagetti] tensor_t 만드는 방식이 이런식으로 하는게 맞나?
-    const auto& t = shard.prefill_graph->inputs[i];
-    
-    // Check KV override first
-    void* buf = nullptr;
-    auto ko = kv_override.find(t.name);
-    if (ko != kv_override.end()) {
-      buf = ko->second;
-    } else {
-      auto it = bindings.find(t.name);
-      if (it != bindings.end()) buf = it->second;
+    if (plan.rope_cos_in >= 0) {
+      std::memcpy(plan.input_data(plan.rope_cos_in), shared_buffers_.rope_cos, plan.input_bytes(plan.rope_cos_in));
     }
-    
-    if (buf) {
-      shard.prefill_input_holders[i]->update_buffer(buf, t.nbytes);
-      inputs.push_back(shard.prefill_input_holders[i]->tensor());
+    if (plan.rope_sin_in >= 0) {
+      std::memcpy(plan.input_data(plan.rope_sin_in), shared_buffers_.rope_sin, plan.input_bytes(plan.rope_sin_in));
     }
   }
   
-  // Setup outputs (NO KV cache override - we'll copy outputs after execution)
-  for (size_t i = 0; i < shard.prefill_graph->outputs.size() && i < shard.prefill_output_holders.size(); ++i) {
-    const auto& t = shard.prefill_graph->outputs[i];
-    
-    auto it = bindings.find(t.name);
-    if (it == bindings.end()) continue;
-    
-    shard.prefill_output_holders[i]->update_buffer(it->second, t.nbytes);
-    outputs.push_back(shard.prefill_output_holders[i]->tensor());
+  // Attention mask: copy from shared buffer (all shards)
+  if (plan.mask_in >= 0 && !dataflow_) {
+    std::memcpy(plan.input_data(plan.mask_in), shared_buffers_.attention_mask, plan.input_bytes(plan.mask_in));
   }
   
+  // 2. Execute with pre-bound tensors
   if (config_.log_level >= 2) {
-    std::cout << "[Shard " << shard_idx << "] Executing with " << inputs.size() 
-              << " inputs, " << outputs.size() << " outputs...\n";
+    LogLine() << "[Shard " << shard_idx << "] Executing with " << plan.num_inputs() 
+              << " inputs, " << plan.num_outputs() << " outputs...\n";
   }
   
-  if (!loader_->execute_graph(shard_idx, "prefill_forward", inputs, outputs)) {
-    error_msg_ = "Shard " + std::to_string(shard_idx) + " prefill execution failed";
-    return false;
+  int64_t exec_start_us = time_in_us();
+  QnnExecFuture exec = plan.execute_async(*loader_);
+  if (writeback_shard >= 0) {
+    submit_kv_writeback({writeback_shard, n_past, n_update});
   }
-  
-  if (config_.log_level >= 2) {
-    std::cout << "[Shard " << shard_idx << "] Execute completed\n";
+  if (!exec.wait()) {
+    error_msg_ = "Shard " + std::to_string(shard_idx) + " prefill execution failed (QNN error "
+               + std::to_string(exec.error()) + ")";
+    return false;
   }
+  collect_profile(plan.profile(), exec_start_us);
   
-  // Copy outputs to shared buffers for next shard
-  if (config_.log_level >= 2) {
-    std::cout << "[Shard " << shard_idx << "] Copying outputs...\n";
-    if (shard_idx == 7) {
-      std::cout << "[Shard 7] All outputs:\n";
-      for (const auto& t : shard.prefill_graph->outputs) {
-        std::cout << "  - " << t.name << " : " << t.nbytes << " bytes\n";
-      }
+  // 3. Copy outputs to shared buffers for next shard (bound in place with zero-copy dataflow)
+  if (dataflow_) {
+    if (config_.log_level >= 1) {
+      LogLine() << "[Shard " << shard_idx << " Prefill] ✓\n";
     }
+    return true;
   }
-  
-  for (const auto& t : shard.prefill_graph->outputs) {
-    auto it = bindings.find(t.name);
-    if (it == bindings.end()) continue;
-    
+  if (shard_idx == 0) {
     // ROPE outputs (shard 0 only)
-    if (shard_idx == 0) {
-      if (t.name.find("output_quantized_decomposed_dequantize_per_tensor_tensor_0") != std::string::npos &&
-          t.name.find("_1_0") == std::string::npos) {
-        std::memcpy(shared_buffer_views_["rope_cos"], it->second, t.nbytes);
-        if (config_.log_level >= 2) {
-          std::cout << "[Shard 0] ROPE cos copied: " << t.nbytes << " bytes\n";
-        }
-      } else if (t.name.find("output_quantized_decomposed_dequantize_per_tensor_tensor_1_0") != std::string::npos) {
-        std::memcpy(shared_buffer_views_["rope_sin"], it->second, t.nbytes);
-        if (config_.log_level >= 2) {
-          std::cout << "[Shard 0] ROPE sin copied: " << t.nbytes << " bytes\n";
-        }
-      }
+    if (plan.rope_cos_out >= 0) {
+      std::memcpy(shared_buffers_.rope_cos, plan.output_data(plan.rope_cos_out), plan.output_bytes(plan.rope_cos_out));
     }
-    
-    // Hidden state output (all shards) - but NOT logits!
-    // Hidden state is [1, ar_len, dim] = 131072 bytes, logits are much larger
-    if (t.name.find("output_aten_add_tensor") != std::string::npos ||
-        t.name.find("fallback") != std::string::npos) {
-      std::memcpy(shared_buffer_views_["hidden_state"], it->second, t.nbytes);
-      if (config_.log_level >= 2) {
-        std::cout << "[Shard " << shard_idx << "] Hidden state copied: " 
-                  << t.nbytes << " bytes (" << t.name << ")\n";
-        if (shard_idx == 0) {
-          // Print first 8 uint16_t values for debugging
-          uint16_t* data = (uint16_t*)it->second;
-          std::cout << "[Shard 0] Hidden state first 8 values: ";
-          for (int i = 0; i < 8; ++i) {
-            std::cout << data[i] << " ";
-          }
-          std::cout << "\n";
-        }
-      }
+    if (plan.rope_sin_out >= 0) {
+      std::memcpy(shared_buffers_.rope_sin, plan.output_data(plan.rope_sin_out), plan.output_bytes(plan.rope_sin_out));
     }
   }
   
-  if (config_.log_level >= 2) {
-    std::cout << "[Shard " << shard_idx << "] Output copy completed\n";
+  // Hidden state output (all shards) - but NOT logits!
+  if (plan.hidden_out >= 0) {
+    std::memcpy(shared_buffers_.hidden_state, plan.output_data(plan.hidden_out), plan.output_bytes(plan.hidden_out));
+    if (config_.log_level >= 2) {
+      LogLine() << "[Shard " << shard_idx << "] Hidden state copied: " 
+                << plan.output_bytes(plan.hidden_out) << " bytes ("
+                << plan.output_desc(plan.hidden_out).name << ")\n";
+    }
   }
   
   if (config_.log_level >= 1) {
-    std::cout << "[Shard " << shard_idx << " Prefill] ✓\n";
+    LogLine() << "[Shard " << shard_idx << " Prefill] ✓\n";
   }
   
   return true;
 }
 
 bool LLMDecodeRunner::run_shard_decode(int shard_idx,
-                                        int32_t n_past) {
-  if (config_.log_level >= 2) {
-    std::cout << "[Decode Shard " << shard_idx << "] n_past=" << n_past << "\n";
-  }
-  
-  auto& shard = shards_[shard_idx];
-  auto& bindings = shard.kv_alloc->bindings();
-  
-  // Setup KV cache INPUT override only
-  std::map<std::string, void*> kv_override;
-  int shard_layer_start = shard_idx * layers_per_shard_;
-  int shard_layer_end = shard_layer_start + layers_per_shard_;
-  
-  // Input KV cache binding (by dimensions)
-  int v_in = 0, k_in = 0;
-  for (const auto& t : shard.kv_graph->inputs) {
-    if (t.name.find("_args_") != std::string::npos && t.dims.size() == 3) {
-      // V cache: [1, cache_len, head_dim=64]
-      // K cache: [1, head_dim=64, cache_len]
-      bool is_v = (t.dims[2] == head_dim_);
-      bool is_k = (t.dims[1] == head_dim_);
-      
-      if (is_v || is_k) {
-        int local_idx = is_v ? v_in++ : k_in++;
-        int local_layer = local_idx / num_heads_;
-        int head = local_idx % num_heads_;
-        int global_layer = shard_layer_start + local_layer;
-        
-        if (global_layer < num_layers_) {
-          const auto& buf = is_v ? kv_manager_->get_v_cache(global_layer, head) : kv_manager_->get_k_cache(global_layer, head);
-          kv_override[t.name] = buf.input_buffer;
-        }
-      }
-    }
-  }
+                                        int32_t n_past,
+                                        int writeback_shard,
+                                        const std::function<void()>* host_work) {
+  if (!wait_shard_ready(shard_idx)) return false;
+  auto& plan = shards_[shard_idx].kv_plan;
+  sync_kv_writeback(true);
   
   // Fill inputs (shard 0 already filled in run_multi_context_decode_step)
-  if (shard_idx > 0) {
+  if (shard_idx > 0 && !dataflow_) {
     // Shard 1-7: copy from shared buffers
-    for (const auto& t : shard.kv_graph->inputs) {
-      if (kv_override.find(t.name) != kv_override.end()) continue;
-      auto it = bindings.find(t.name);
-      if (it == bindings.end()) continue;
-      
-      std::string name_lower = t.name;
-      for (auto& c : name_lower) c = (char)tolower(c);
-      
-      if (name_lower.find("fallback") != std::string::npos) {
-        std::memcpy(it->second, shared_buffer_views_["hidden_state"], t.nbytes);
-        if (config_.log_level >= 2) {
-          std::cout << "[Decode Shard " << shard_idx << "] Input hidden state copied: " << t.nbytes << " bytes\n";
-        }
-      } else if (t.name.find("input_9_aten_view_copy_default_0") != std::string::npos || t.name.find("input_9_aten_select_copy_int_0") != std::string::npos) {
-        std::memcpy(it->second, shared_buffer_views_["rope_cos"], t.nbytes);
-        if (config_.log_level >= 2) {
-          std::cout << "[Decode Shard " << shard_idx << "] ROPE cos copied: " << t.nbytes << " bytes\n";
-        }
-      } else if (t.name.find("input_10_aten_view_copy_default_1_0") != std::string::npos || t.name.find("input_10_aten_select_copy_int_1_0") != std::string::npos) {
-        std::memcpy(it->second, shared_buffer_views_["rope_sin"], t.nbytes);
-        if (config_.log_level >= 2) {
-          std::cout << "[Decode Shard " << shard_idx << "] ROPE sin copied: " << t.nbytes << " bytes\n";
-        }
-      } else if (name_lower.find("atten_mask") != std::string::npos) {
-        std::memcpy(it->second, shared_buffer_views_["attention_mask"], t.nbytes);
-        if (config_.log_level >= 2) {
-          std::cout << "[Decode Shard " << shard_idx << "] Attention mask copied: " << t.nbytes << " bytes\n";
-        }
-      }
+    if (plan.hidden_in >= 0) {
+      std::memcpy(plan.input_data(plan.hidden_in), shared_buffers_.hidden_state, plan.input_bytes(plan.hidden_in));
+    }
+    if (plan.rope_cos_in >= 0) {
+      std::memcpy(plan.input_data(plan.rope_cos_in), shared_buffers_.rope_cos, plan.input_bytes(plan.rope_cos_in));
+    }
+    if (plan.rope_sin_in >= 0) {
+      std::memcpy(plan.input_data(plan.rope_sin_in), shared_buffers_.rope_sin, plan.input_bytes(plan.rope_sin_in));
+    }
+    if (plan.mask_in >= 0) {
+      std::memcpy(plan.input_data(plan.mask_in), shared_buffers_.attention_mask, plan.input_bytes(plan.mask_in));
     }
   }
   
-  // Build tensors and execute
-  std::vector<Qnn_Tensor_t> inputs, outputs;
-  for (size_t i = 0; i < shard.kv_graph->inputs.size() && i < shard.kv_input_holders.size(); ++i) {
-    const auto& t = shard.kv_graph->inputs[i];
-    void* buf = nullptr;
-    auto ko = kv_override.find(t.name);
-    if (ko != kv_override.end()) buf = ko->second;
-    else { auto it = bindings.find(t.name); if (it != bindings.end()) buf = it->second; }
-    if (buf) { shard.kv_input_holders[i]->update_buffer(buf, t.nbytes); inputs.push_back(shard.kv_input_holders[i]->tensor()); }
+  if (config_.direct_v_binding) {
+    int64_t bind_start_us = time_in_us();
+    bind_decode_v_outputs(plan, n_past);
+    stats_.decode_kv_host_ms += (time_in_us() - bind_start_us) / 1000.0;
   }
   
-  for (size_t i = 0; i < shard.kv_graph->outputs.size() && i < shard.kv_output_holders.size(); ++i) {
-    const auto& t = shard.kv_graph->outputs[i];
-    auto it = bindings.find(t.name);
-    if (it == bindings.end()) continue;
-    shard.kv_output_holders[i]->update_buffer(it->second, t.nbytes);
-    outputs.push_back(shard.kv_output_holders[i]->tensor());
+  int64_t exec_start_us = time_in_us();
+  QnnExecFuture exec = plan.execute_async(*loader_);
+  if (kv_worker_ && writeback_shard >= 0) {
+    submit_kv_writeback({writeback_shard, n_past, 0});
   }
+  if (host_work) (*host_work)();
+  if (!kv_worker_ && writeback_shard >= 0) {
+    run_kv_writeback({writeback_shard, n_past, 0});
+  }
+  if (!exec.wait()) {
+    error_msg_ = "Shard " + std::to_string(shard_idx) + " decode execution failed (QNN error "
+               + std::to_string(exec.error()) + ")";
+    return false;
+  }
+  collect_profile(plan.profile(), exec_start_us);
   
-  if (config_.log_level >= 2) {
-    std::cout << "[Decode Shard " << shard_idx << "] Executing with " << inputs.size() << " inputs, " << outputs.size() << " outputs...\n";
+  // Copy outputs to shared buffers (bound in place with zero-copy dataflow)
+  if (dataflow_) return true;
+  if (shard_idx == 0) {
+    if (plan.rope_cos_out >= 0) {
+      std::memcpy(shared_buffers_.rope_cos, plan.output_data(plan.rope_cos_out), plan.output_bytes(plan.rope_cos_out));
+    }
+    if (plan.rope_sin_out >= 0) {
+      std::memcpy(shared_buffers_.rope_sin, plan.output_data(plan.rope_sin_out), plan.output_bytes(plan.rope_sin_out));
+    }
   }
   
-  if (!loader_->execute_graph(shard_idx, "kv_forward", inputs, outputs)) {
-    error_msg_ = "Shard " + std::to_string(shard_idx) + " decode execution failed";
-    return false;
+  // Hidden state output (NOT logits!)
+  if (plan.hidden_out >= 0) {
+    std::memcpy(shared_buffers_.hidden_state, plan.output_data(plan.hidden_out), plan.output_bytes(plan.hidden_out));
   }
   
-  if (config_.log_level >= 2) {
-    std::cout << "[Decode Shard " << shard_idx << "] Execute completed\n";
+  return true;
+}
+
+void LLMDecodeRunner::writeback_shard_prefill_kv(int shard_idx, int32_t n_past, int32_t chunk_size) {
+  auto& plan = shards_[shard_idx].prefill_plan;
+  
+  // V cache: contiguous rows at [n_past, n_past + chunk_size)
+  for (const auto& kv : plan.v_out) {
+    const auto& v_buf = kv_manager_->get_v_cache(kv.layer, kv.head);
+    uint8_t* src = reinterpret_cast<uint8_t*>(plan.output_data(kv.slot));
+    uint8_t* dst = reinterpret_cast<uint8_t*>(v_buf.input_buffer) + n_past * head_dim_;
+    KVWriteback::write_v(dst, src, head_dim_, chunk_size);
   }
   
-  // Copy outputs to shared buffers
-  for (const auto& t : shard.kv_graph->outputs) {
-    auto it = bindings.find(t.name);
-    if (it == bindings.end()) continue;
-    
-    if (shard_idx == 0) {
-      if (t.name.find("output_quantized_decomposed_dequantize_per_tensor_tensor_0") != std::string::npos && t.name.find("_1_0") == std::string::npos) {
-        std::memcpy(shared_buffer_views_["rope_cos"], it->second, t.nbytes);
-        if (config_.log_level >= 2) {
-          std::cout << "[Decode Shard 0] ROPE cos copied: " << t.nbytes << " bytes\n";
-        }
-      } else if (t.name.find("output_quantized_decomposed_dequantize_per_tensor_tensor_1_0") != std::string::npos) {
-        std::memcpy(shared_buffer_views_["rope_sin"], it->second, t.nbytes);
-        if (config_.log_level >= 2) {
-          std::cout << "[Decode Shard 0] ROPE sin copied: " << t.nbytes << " bytes\n";
-        }
-      }
-    }
-    
-    // Hidden state output (NOT logits!) - size check
-    if (t.name.find("output_aten_add_tensor") != std::string::npos || 
-        t.name.find("fallback") != std::string::npos) {
-      std::memcpy(shared_buffer_views_["hidden_state"], it->second, t.nbytes);
-      if (config_.log_level >= 2) {
-        std::cout << "[Decode Shard " << shard_idx << "] Hidden state copied: " << t.nbytes << " bytes\n";
-      }
+  // K cache: copy with stride (transposed layout)
+  const int32_t k_stride = prefill_k_stride();
+  for (const auto& kv : plan.k_out) {
+    const auto& k_buf = kv_manager_->get_k_cache(kv.layer, kv.head);
+    uint8_t* src = reinterpret_cast<uint8_t*>(plan.output_data(kv.slot));
+    uint8_t* dst = reinterpret_cast<uint8_t*>(k_buf.input_buffer) + n_past;
+    KVWriteback::write_k(dst, k_stride, src, prefill_ar_len_, head_dim_, chunk_size);
+  }
+}
+
+void LLMDecodeRunner::writeback_shard_decode_kv(int shard_idx, int32_t n_past) {
+  auto& plan = shards_[shard_idx].kv_plan;
+  
+  // V cache: one row at n_past (written in place by the graph with direct binding)
+  if (!config_.direct_v_binding) {
+    for (const auto& kv : plan.v_out) {
+      const auto& v_buf = kv_manager_->get_v_cache(kv.layer, kv.head);
+      uint8_t* src = reinterpret_cast<uint8_t*>(plan.output_data(kv.slot));
+      uint8_t* dst = reinterpret_cast<uint8_t*>(v_buf.input_buffer) + n_past * head_dim_;
+      KVWriteback::write_v(dst, src, head_dim_, 1);
     }
   }
   
-  return true;
+  // K cache: one column at n_past (transposed layout)
+  for (const auto& kv : plan.k_out) {
+    const auto& k_buf = kv_manager_->get_k_cache(kv.layer, kv.head);
+    uint8_t* src = reinterpret_cast<uint8_t*>(plan.output_data(kv.slot));
+    uint8_t* dst = reinterpret_cast<uint8_t*>(k_buf.input_buffer) + n_past;
+    KVWriteback::write_k(dst, kv_cache_len_, src, 1, head_dim_, 1);
+  }
+}
+
+void LLMDecodeRunner::submit_kv_writeback(const KVWritebackJob& job) {
+  if (kv_worker_) {
+    kv_worker_->submit(job);
+  } else {
+    run_kv_writeback(job);
+  }
+}
+
+// Runs on the worker thread when async_kv_writeback is on (counters are read after a sync)
+void LLMDecodeRunner::run_kv_writeback(const KVWritebackJob& job) {
+  int64_t start_us = time_in_us();
+  if (job.n_update > 0) {
+    writeback_shard_prefill_kv(job.shard, job.n_past, job.n_update);
+  } else {
+    writeback_shard_decode_kv(job.shard, job.n_past);
+  }
+  kv_writeback_us_[job.n_update > 0 ? 0 : 1] += time_in_us() - start_us;
+}
+
+// Barrier: every submitted writeback has landed in LLMKVCacheManager and its shard's
+// outputs may be reused. Called before a shard's inputs are filled, since the I/O
+// planner may overlay them with the outputs of the shard two steps back.
+void LLMDecodeRunner::sync_kv_writeback(bool decode) {
+  if (!kv_worker_) return;
+  int64_t start_us = time_in_us();
+  kv_worker_->wait_idle();
+  kv_blocked_us_[decode ? 1 : 0] += time_in_us() - start_us;
+}
+
+void LLMDecodeRunner::flush_kv_writeback_stats() {
+  sync_kv_writeback(true);
+  auto hidden_ms = [&](int phase) {
+    if (!kv_worker_) return 0.0;
+    return std::max<int64_t>(0, kv_writeback_us_[phase] - kv_blocked_us_[phase]) / 1000.0;
+  };
+  stats_.async_kv_writeback = kv_worker_ != nullptr;
+  stats_.prefill_kv_hidden_ms += hidden_ms(0);
+  stats_.decode_kv_hidden_ms += hidden_ms(1);
+  stats_.decode_kv_host_ms += kv_writeback_us_[1] / 1000.0;
+  kv_writeback_us_[0] = kv_writeback_us_[1] = 0;
+  kv_blocked_us_[0] = kv_blocked_us_[1] = 0;
 }
 
 } // namespace llm_test
@@ -0,0 +1,251 @@
+#include "llm_execution_plan.h"
+
+#include <cctype>
+#include <map>
+#include <set>
+#include <string>
+
+namespace llm_test {
+
+namespace {
+
+bool contains(const std::string& s, const char* needle) {
+  return s.find(needle) != std::string::npos;
+}
+
+std::string to_lower(const std::string& s) {
+  std::string out = s;
+  for (auto& c : out) c = (char)tolower(c);
+  return out;
+}
+
+// KV cache input classification shared by build() and kv_input_names()
+// - kv_mapping given (single-context): by name
+// - otherwise (multi-context): "_args_" inputs by shape, in order of appearance
+class KVInputClassifier {
+ public:
+  KVInputClassifier(const ExecutionPlan::Layout& layout,
+                    const std::vector<KVCacheTensorInfo>* kv_mapping)
+      : layout_(layout), has_mapping_(kv_mapping != nullptr) {
+    if (kv_mapping) {
+      for (const auto& info : *kv_mapping) mapping_by_name_[info.name] = &info;
+    }
+  }
+
+  bool classify(const QnnJsonTensorDesc& t, bool& is_v, int& layer, int& head) {
+    is_v = false;
+    layer = head = -1;
+    if (has_mapping_) {
+      auto it = mapping_by_name_.find(t.name);
+      if (it == mapping_by_name_.end()) return false;
+      is_v = it->second->is_v_cache;
+      layer = layout_.layer_base + it->second->layer;
+      head = it->second->head;
+      return true;
+    }
+    if (!contains(t.name, "_args_") || t.dims.size() != 3) return false;
+    // V cache: [1, cache_len, head_dim], K cache: [1, head_dim, cache_len]
+    is_v = ((int)t.dims[2] == layout_.head_dim);
+    bool is_k = ((int)t.dims[1] == layout_.head_dim);
+    if (!is_v && !is_k) return false;
+    int local_idx = is_v ? v_count_++ : k_count_++;
+    layer = layout_.layer_base + local_idx / layout_.num_heads;
+    head = local_idx % layout_.num_heads;
+    return true;
+  }
+
+ private:
+  const ExecutionPlan::Layout& layout_;
+  bool has_mapping_;
+  std::map<std::string, const KVCacheTensorInfo*> mapping_by_name_;
+  int v_count_ = 0;
+  int k_count_ = 0;
+};
+
+} // namespace
+
+std::set<std::string> ExecutionPlan::kv_input_names(const QnnJsonGraphDesc& graph,
+                                                    const Layout& layout,
+                                                    const std::vector<KVCacheTensorInfo>* kv_mapping) {
+  std::set<std::string> names;
+  KVInputClassifier classifier(layout, kv_mapping);
+  for (const auto& t : graph.inputs) {
+    bool is_v;
+    int layer, head;
+    if (classifier.classify(t, is_v, layer, head) && layer < layout.num_layers) {
+      names.insert(t.name);
+    }
+  }
+  return names;
+}
+
+ExecutionPlan::Role ExecutionPlan::input_role(const QnnJsonTensorDesc& t) {
+  std::string n = to_lower(t.name);
+  bool is_int32 = contains(t.data_type, "INT_32");
+  if (contains(n, "token") && is_int32) return Role::kToken;
+  if (contains(n, "pos") && is_int32) return Role::kPos;
+  if (contains(n, "atten_mask")) return Role::kMask;
+  if (contains(n, "fallback")) return Role::kHidden;
+  if (contains(t.name, "input_9_aten_view_copy_default_0") ||
+      contains(t.name, "input_9_aten_select_copy_int_0")) {
+    return Role::kRopeCos;
+  }
+  if (contains(t.name, "input_10_aten_view_copy_default_1_0") ||
+      contains(t.name, "input_10_aten_select_copy_int_1_0")) {
+    return Role::kRopeSin;
+  }
+  return Role::kOther;
+}
+
+ExecutionPlan::Role ExecutionPlan::output_role(const QnnJsonTensorDesc& t, const Layout& layout) {
+  const size_t r = t.dims.size();
+  bool is_v = contains(t.name, "view_copy") && r >= 2 &&
+              (int)t.dims[r - 2] == layout.ar_len && (int)t.dims[r - 1] == layout.head_dim;
+  bool is_k = !is_v && contains(t.name, "permute_copy") && r >= 2 &&
+              (int)t.dims[r - 2] == layout.head_dim && (int)t.dims[r - 1] == layout.ar_len;
+  if (is_v || is_k) return Role::kKV;
+
+  std::string n = to_lower(t.name);
+  if (contains(n, "squeeze") || contains(n, "logit") || contains(n, "lm_head")) return Role::kLogits;
+  if (contains(t.name, "output_quantized_decomposed_dequantize_per_tensor_tensor_1_0")) {
+    return Role::kRopeSin;
+  }
+  if (contains(t.name, "output_quantized_decomposed_dequantize_per_tensor_tensor_0") &&
+      !contains(t.name, "_1_0")) {
+    return Role::kRopeCos;
+  }
+  if (contains(t.name, "output_aten_add_tensor") || contains(n, "fallback")) return Role::kHidden;
+  return Role::kOther;
+}
+
+void ExecutionPlan::reset() {
+  graph_ = nullptr;
+  holders_.clear();
+  input_descs_.clear();
+  output_descs_.clear();
+  inputs_.clear();
+  outputs_.clear();
+  token_in = pos_in = mask_in = hidden_in = rope_cos_in = rope_sin_in = -1;
+  hidden_out = rope_cos_out = rope_sin_out = logits_out = -1;
+  kv_in.clear();
+  v_out.clear();
+  k_out.clear();
+}
+
+bool ExecutionPlan::build(QnnLoader& loader,
+                          size_t ctx_index,
+                          const QnnJsonGraphDesc& graph,
+                          const Layout& layout,
+                          const BufferResolver& resolve,
+                          const KVResolver& kv_resolve,
+                          const std::vector<KVCacheTensorInfo>* kv_mapping) {
+  reset();
+
+  graph_ = loader.get_graph_handle(ctx_index, graph.graph_name);
+  if (!graph_) return false;
+  ctx_index_ = ctx_index;
+
+  KVInputClassifier classifier(layout, kv_mapping);
+
+  auto add_tensor = [&](const QnnJsonTensorDesc& t, void* buf, bool is_input) -> int {
+    auto h = std::make_unique<QnnTensorHolder>();
+    h->init_from_json(t, buf, t.nbytes, is_input);
+    auto& tensors = is_input ? inputs_ : outputs_;
+    auto& descs = is_input ? input_descs_ : output_descs_;
+    tensors.push_back(h->tensor());
+    descs.push_back(&t);
+    holders_.push_back(std::move(h));
+    return static_cast<int>(tensors.size() - 1);
+  };
+
+  // Inputs
+  for (const auto& t : graph.inputs) {
+    // KV cache input: bound directly to LLMKVCacheManager
+    bool is_v = false;
+    int layer = -1, head = -1;
+    bool is_kv = classifier.classify(t, is_v, layer, head);
+
+    if (is_kv && layer < layout.num_layers && kv_resolve) {
+      void* buf = kv_resolve(layer, head, is_v);
+      if (buf) {
+        int slot = add_tensor(t, buf, true);
+        kv_in.push_back({slot, layer, head, is_v});
+        continue;
+      }
+    }
+
+    void* buf = resolve(t);
+    if (!buf) continue;
+    int slot = add_tensor(t, buf, true);
+    if (is_kv) continue;
+
+    switch (input_role(t)) {
+      case Role::kToken: token_in = slot; break;
+      case Role::kPos: pos_in = slot; break;
+      case Role::kMask: mask_in = slot; break;
+      case Role::kHidden: hidden_in = slot; break;
+      case Role::kRopeCos: rope_cos_in = slot; break;
+      case Role::kRopeSin: rope_sin_in = slot; break;
+      default: break;
+    }
+  }
+
+  // Outputs
+  int v_idx = 0, k_idx = 0;
+  uint64_t largest_unclassified = 0;
+  int largest_slot = -1;
+  for (const auto& t : graph.outputs) {
+    void* buf = resolve(t);
+    if (!buf) continue;
+    int slot = add_tensor(t, buf, false);
+
+    Role role = output_role(t, layout);
+    if (role == Role::kKV) {
+      const size_t r = t.dims.size();
+      bool is_v = contains(t.name, "view_copy") &&
+                  (int)t.dims[r - 2] == layout.ar_len && (int)t.dims[r - 1] == layout.head_dim;
+      int local_idx = is_v ? v_idx++ : k_idx++;
+      int layer = layout.layer_base + local_idx / layout.num_heads;
+      int head = local_idx % layout.num_heads;
+      if (layer < layout.num_layers) {
+        (is_v ? v_out : k_out).push_back({slot, layer, head, is_v});
+      }
+      continue;
+    }
+
+    switch (role) {
+      case Role::kLogits:
+        if (logits_out < 0) logits_out = slot;
+        break;
+      case Role::kRopeSin: rope_sin_out = slot; break;
+      case Role::kRopeCos: rope_cos_out = slot; break;
+      case Role::kHidden: hidden_out = slot; break;
+      default:
+        if (t.nbytes > largest_unclassified) {
+          largest_unclassified = t.nbytes;
+          largest_slot = slot;
+        }
+        break;
+    }
+  }
+  // Fallback: the largest output that is neither KV, ROPE nor hidden state
+  if (logits_out < 0) logits_out = largest_slot;
+
+  return true;
+}
+
+bool ExecutionPlan::execute(QnnLoader& loader) {
+  return loader.execute_graph(graph_,
+                              inputs_.data(), static_cast<uint32_t>(inputs_.size()),
+                              outputs_.data(), static_cast<uint32_t>(outputs_.size()),
+                              profile_);
+}
+
+QnnExecFuture ExecutionPlan::execute_async(QnnLoader& loader) {
+  return loader.execute_graph_async(ctx_index_, graph_,
+                                    inputs_.data(), static_cast<uint32_t>(inputs_.size()),
+                                    outputs_.data(), static_cast<uint32_t>(outputs_.size()),
+                                    profile_);
+}
+
+} // namespace llm_test
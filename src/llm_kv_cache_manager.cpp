@@ -1,10 +1,26 @@
 #include "llm_kv_cache_manager.h"
+#include "llm_kv_writeback.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
 #include <cstring>
 #include <cstdlib>
 #include <iostream>
+#include <sys/mman.h>
 
 namespace llm_test {
 
+namespace {
+
+// rearrange_cache()/shift_cache(): below this many bytes moved, the calling thread does it alone
+constexpr size_t kParallelRearrangeBytes = 256 * 1024;
+
+size_t align_buffer(size_t bytes) {
+  return (bytes + LLMKVCacheManager::kAlignment - 1) & ~(LLMKVCacheManager::kAlignment - 1);
+}
+
+} // namespace
+
 LLMKVCacheManager::LLMKVCacheManager(const Metadata& metadata)
     : metadata_(metadata), total_cache_size_(0), cur_ar_len_(metadata.max_ar_len) {
   // Resize storage
@@ -16,15 +32,9 @@ LLMKVCacheManager::LLMKVCacheManager(const Metadata& metadata)
     v_cache_[layer].resize(metadata_.num_heads);
   }
 
-  // Calculate total memory requirement (SMART_MASK mode)
-  // Each cache: input_buffer + output_buffer
-  size_t k_in_bytes = metadata_.head_dim * metadata_.max_cache_len;
-  size_t k_out_bytes = metadata_.head_dim * metadata_.max_ar_len;
-  size_t v_in_bytes = metadata_.head_dim * metadata_.max_cache_len;
-  size_t v_out_bytes = metadata_.head_dim * metadata_.max_ar_len;
-  
-  size_t per_head = k_in_bytes + k_out_bytes + v_in_bytes + v_out_bytes;
-  total_cache_size_ = per_head * metadata_.num_layers * metadata_.num_heads;
+  total_cache_size_ = required_bytes(metadata_);
+  key_scale_.assign(static_cast<size_t>(metadata_.num_layers) * metadata_.num_heads, 0.0f);
+  key_offset_.assign(key_scale_.size(), 0);
   
   std::cout << "[LLMKVCacheManager] Metadata:\n"
             << "  context_len: " << metadata_.context_len << "\n"
@@ -36,71 +46,93 @@ LLMKVCacheManager::LLMKVCacheManager(const Metadata& metadata)
             << "  Total cache size: " << (total_cache_size_ / 1024.0 / 1024.0) << " MiB\n";
 }
 
+size_t LLMKVCacheManager::required_bytes(const Metadata& metadata) {
+  // Calculate total memory requirement (SMART_MASK mode)
+  // Each cache: input_buffer + output_buffer, each at a kAlignment offset in the slab
+  size_t in_stride = align_buffer(static_cast<size_t>(metadata.head_dim) * metadata.max_cache_len);
+  size_t out_stride = align_buffer(static_cast<size_t>(metadata.head_dim) * metadata.max_ar_len);
+  
+  size_t per_head = 2 * (in_stride + out_stride);  // K + V
+  return per_head * metadata.num_layers * metadata.num_heads;
+}
+
 LLMKVCacheManager::~LLMKVCacheManager() {
-  // Free all allocated memory
-  for (auto& layer_k : k_cache_) {
-    for (auto& head_k : layer_k) {
-      if (head_k.input_buffer) free(head_k.input_buffer);
-      if (head_k.output_buffer) free(head_k.output_buffer);
-    }
-  }
-  for (auto& layer_v : v_cache_) {
-    for (auto& head_v : layer_v) {
-      if (head_v.input_buffer) free(head_v.input_buffer);
-      if (head_v.output_buffer) free(head_v.output_buffer);
-    }
-  }
+  if (locked_) munlock(slab_.base, slab_.bytes);
+  unmap_io_slab(slab_);
 }
 
 bool LLMKVCacheManager::allocate() {
-  size_t k_in_bytes = metadata_.head_dim * metadata_.max_cache_len;
-  size_t k_out_bytes = metadata_.head_dim * metadata_.max_ar_len;
-  size_t v_in_bytes = metadata_.head_dim * metadata_.max_cache_len;
-  size_t v_out_bytes = metadata_.head_dim * metadata_.max_ar_len;
+  if (locked_) munlock(slab_.base, slab_.bytes);
+  locked_ = false;
+  unmap_io_slab(slab_);
+  
+  size_t in_bytes = static_cast<size_t>(metadata_.head_dim) * metadata_.max_cache_len;
+  size_t out_bytes = static_cast<size_t>(metadata_.head_dim) * metadata_.max_ar_len;
+  size_t in_stride = align_buffer(in_bytes);
+  size_t out_stride = align_buffer(out_bytes);
+  cache_bytes_ = 2 * in_stride * metadata_.num_layers * metadata_.num_heads;
 
   std::cout << "[LLMKVCacheManager] Allocating memory...\n";
   
+  // One anonymous mapping: already zero-filled, no per-buffer malloc/memset
+  if (!map_io_slab(total_cache_size_, options_.huge_pages, slab_)) {
+    std::cerr << "[LLMKVCacheManager] Failed to map KV cache slab ("
+              << total_cache_size_ << " bytes)\n";
+    return false;
+  }
+  
+  uint8_t* cache = static_cast<uint8_t*>(slab_.base);
+  uint8_t* staging = cache + cache_bytes_;
   for (int32_t layer = 0; layer < metadata_.num_layers; ++layer) {
     for (int32_t head = 0; head < metadata_.num_heads; ++head) {
-      // Allocate K cache
-      k_cache_[layer][head].input_buffer = malloc(k_in_bytes);
-      k_cache_[layer][head].output_buffer = malloc(k_out_bytes);
-      k_cache_[layer][head].input_bytes = k_in_bytes;
-      k_cache_[layer][head].output_bytes = k_out_bytes;
-      
-      if (!k_cache_[layer][head].input_buffer || !k_cache_[layer][head].output_buffer) {
-        std::cerr << "[LLMKVCacheManager] Failed to allocate K cache for layer " 
-                  << layer << ", head " << head << "\n";
-        return false;
-      }
-      
-      // Initialize to zero
-      std::memset(k_cache_[layer][head].input_buffer, 0, k_in_bytes);
-      std::memset(k_cache_[layer][head].output_buffer, 0, k_out_bytes);
-      
-      // Allocate V cache
-      v_cache_[layer][head].input_buffer = malloc(v_in_bytes);
-      v_cache_[layer][head].output_buffer = malloc(v_out_bytes);
-      v_cache_[layer][head].input_bytes = v_in_bytes;
-      v_cache_[layer][head].output_bytes = v_out_bytes;
-      
-      if (!v_cache_[layer][head].input_buffer || !v_cache_[layer][head].output_buffer) {
-        std::cerr << "[LLMKVCacheManager] Failed to allocate V cache for layer " 
-                  << layer << ", head " << head << "\n";
-        return false;
-      }
-      
-      // Initialize to zero
-      std::memset(v_cache_[layer][head].input_buffer, 0, v_in_bytes);
-      std::memset(v_cache_[layer][head].output_buffer, 0, v_out_bytes);
+      KVCacheBuffer& k = k_cache_[layer][head];
+      KVCacheBuffer& v = v_cache_[layer][head];
+      k.input_buffer = cache;
+      v.input_buffer = cache + in_stride;
+      cache += 2 * in_stride;
+      k.output_buffer = staging;
+      v.output_buffer = staging + out_stride;
+      staging += 2 * out_stride;
+      k.input_bytes = v.input_bytes = in_bytes;
+      k.output_bytes = v.output_bytes = out_bytes;
+    }
+  }
+  
+  if (options_.rearrange_threads != 1 && metadata_.num_layers > 1) {
+    int threads = options_.rearrange_threads;
+    if (threads <= 0) {
+      threads = static_cast<int>(std::min(4u, std::max(1u, std::thread::hardware_concurrency())));
+    }
+    rearrange_pool_.reset(threads > 1 ? new ThreadPool(static_cast<size_t>(threads)) : nullptr);
+  }
+  
+  if (options_.lock) {
+    locked_ = mlock(slab_.base, slab_.bytes) == 0;
+    if (!locked_) {
+      std::cerr << "[LLMKVCacheManager] Warning: mlock failed (" << std::strerror(errno)
+                << "), KV cache stays pageable\n";
     }
   }
   
   std::cout << "[LLMKVCacheManager] Allocation complete: " 
-            << (total_cache_size_ / 1024.0 / 1024.0) << " MiB\n";
+            << (total_cache_size_ / 1024.0 / 1024.0) << " MiB in one slab"
+            << (slab_.hugetlb ? " (hugetlb)" : "") << (locked_ ? " (locked)" : "") << "\n";
   return true;
 }
 
+void LLMKVCacheManager::clear() {
+  if (slab_.base) std::memset(slab_.base, 0, cache_bytes_);
+}
+
+size_t LLMKVCacheManager::prefault() {
+  // One pass over the slab: cache + staging regions (contents preserved)
+  const size_t page = 4096;
+  if (!slab_.base) return 0;
+  volatile uint8_t* p = reinterpret_cast<volatile uint8_t*>(slab_.base);
+  for (size_t off = 0; off < total_cache_size_; off += page) p[off] = p[off];
+  return total_cache_size_;
+}
+
 void LLMKVCacheManager::update_key_cache(
     const KVCacheBuffer& cache,
     int32_t n_past,
@@ -112,13 +144,10 @@ void LLMKVCacheManager::update_key_cache(
   // Update: For each dimension, copy output[dim][0:n_update] → input[dim][n_past:n_past+n_update]
   
   uint8_t* write_ptr = reinterpret_cast<uint8_t*>(cache.input_buffer) + n_past;
-  uint8_t* read_ptr = reinterpret_cast<uint8_t*>(cache.output_buffer);
+  const uint8_t* read_ptr = reinterpret_cast<const uint8_t*>(cache.output_buffer);
   
-  for (int32_t dim = 0; dim < metadata_.head_dim; ++dim) {
-    std::memcpy(write_ptr, read_ptr, n_update);
-    write_ptr += metadata_.max_cache_len;
-    read_ptr += metadata_.max_ar_len;
-  }
+  KVWriteback::write_k(write_ptr, metadata_.max_cache_len, read_ptr, metadata_.max_ar_len,
+                       metadata_.head_dim, n_update);
 }
 
 void LLMKVCacheManager::update_value_cache(
@@ -134,7 +163,7 @@ void LLMKVCacheManager::update_value_cache(
   uint8_t* write_ptr = reinterpret_cast<uint8_t*>(cache.input_buffer) + n_past * metadata_.head_dim;
   uint8_t* read_ptr = reinterpret_cast<uint8_t*>(cache.output_buffer);
   
-  std::memcpy(write_ptr, read_ptr, n_update * metadata_.head_dim);
+  KVWriteback::write_v(write_ptr, read_ptr, metadata_.head_dim, n_update);
 }
 
 void LLMKVCacheManager::update_cache(int32_t n_past, int32_t n_update) {
@@ -204,64 +233,38 @@ void LLMKVCacheManager::update_attention_mask(
 void LLMKVCacheManager::rearrange_key(
     KVCacheBuffer& cache,
     int32_t src_cache_len,
-    int32_t dst_cache_len) {
-  // ExecutorchReader의 rearrange_key 구현:
+    int32_t dst_cache_len,
+    int32_t n_past) {
+  // ExecutorchReader의 rearrange_key 구현(점유 구간만):
   // 
   // K cache layout: [head_dim, cache_len] - strided
   // Prefill→Decode 전환 시 [64, 480] → [64, 511]로 확장
   // 
-  // 각 dimension 별로 memmove:
-  //   src: [dim][0..479]
-  //   dst: [dim][0..479] (31 positions shifted)
+  // 각 dimension 별로 memmove (앞쪽 n_past 바이트만):
+  //   src: [dim][0..n_past-1] at dim * src_cache_len
+  //   dst: [dim][0..n_past-1] at dim * dst_cache_len
   // 
-  // 예: head_dim=64
-  //   Before: [dim0][0..479][dim1][0..479]...[dim63][0..479]
-  //   After:  [dim0][0..510][dim1][0..510]...[dim63][0..510]
-  //   
-  //   memmove(&cache[dim*511], &cache[dim*480], 480)로 각 dim을 이동
+  // 확장(dst > src)은 뒤 dim부터, 축소(dst < src)는 앞 dim부터 옮겨야
+  // 아직 옮기지 않은 행을 덮어쓰지 않는다 (n_past <= min(src, dst))
   
-  if (src_cache_len == dst_cache_len) {
+  if (src_cache_len == dst_cache_len || n_past <= 0) {
     return;  // No rearrangement needed
   }
   
-  // std::cout << "[LLMKVCacheManager] Rearranging K cache: " 
-  //           << src_cache_len << " → " << dst_cache_len << "\n";
-  
   uint8_t* buffer = reinterpret_cast<uint8_t*>(cache.input_buffer);
+  const size_t bytes = static_cast<size_t>(n_past);
   
-  // // DEBUG: Log BEFORE rearrange (first cache only, Layer 0 Head 0)
-  // static bool first_rearrange = true;
-  // if (first_rearrange && cache.input_buffer == k_cache_[0][0].input_buffer) {
-  //   std::cout << "[DEBUG Rearrange] BEFORE K cache (L0H0):\n";
-  //   std::cout << "  buffer[0]=" << (int)buffer[0] 
-  //             << ", buffer[" << src_cache_len << "]=" << (int)buffer[src_cache_len]
-  //             << ", buffer[" << (src_cache_len*2) << "]=" << (int)buffer[src_cache_len*2] << "\n";
-  //   std::cout << "  Total buffer size allocated: " << cache.input_bytes << " bytes\n";
-  //   std::cout << "  src_cache_len=" << src_cache_len << ", dst_cache_len=" << dst_cache_len << "\n";
-  // }
-  
-  // BACKWARD iteration to avoid overwrite (src_cache_len < dst_cache_len)
-  for (int32_t dim = metadata_.head_dim - 1; dim >= 0; --dim) {
-    uint8_t* src = buffer + dim * src_cache_len;
-    uint8_t* dst = buffer + dim * dst_cache_len;
-    std::memmove(dst, src, src_cache_len);
+  if (dst_cache_len > src_cache_len) {
+    // BACKWARD iteration to avoid overwrite (expand)
+    for (int32_t dim = metadata_.head_dim - 1; dim > 0; --dim) {
+      std::memmove(buffer + dim * dst_cache_len, buffer + dim * src_cache_len, bytes);
+    }
+  } else {
+    // FORWARD iteration (shrink, decode → prefill)
+    for (int32_t dim = 1; dim < metadata_.head_dim; ++dim) {
+      std::memmove(buffer + dim * dst_cache_len, buffer + dim * src_cache_len, bytes);
+    }
   }
-  
-  // // DEBUG: Log AFTER rearrange
-  // if (first_rearrange && cache.input_buffer == k_cache_[0][0].input_buffer) {
-  //   std::cout << "[DEBUG Rearrange] AFTER K cache (L0H0):\n";
-  //   std::cout << "  buffer[0]=" << (int)buffer[0] 
-  //             << ", buffer[" << dst_cache_len << "]=" << (int)buffer[dst_cache_len]
-  //             << ", buffer[" << (dst_cache_len*2) << "]=" << (int)buffer[dst_cache_len*2] << "\n";
-    
-  //   // 전체 non-zero count
-  //   int non_zero = 0;
-  //   for (int i = 0; i < std::min((int)cache.input_bytes, 10000); ++i) {
-  //     if (buffer[i] != 0) non_zero++;
-  //   }
-  //   std::cout << "  Non-zero in first 10000 bytes: " << non_zero << "/10000\n";
-  //   first_rearrange = false;
-  // }
 }
 
 void LLMKVCacheManager::rearrange_value(
@@ -290,37 +293,136 @@ void LLMKVCacheManager::rearrange_value(
   // The first src_cache_len * head_dim bytes are already in correct position
 }
 
-void LLMKVCacheManager::rearrange_cache(int32_t src_ar_len, int32_t dst_ar_len) {
+void LLMKVCacheManager::rearrange_cache(int32_t src_ar_len, int32_t dst_ar_len, int32_t n_past) {
   // ExecutorchReader의 rearrange_cache 구현:
   // 
-  // Prefill (AR=32) → Decode (AR=1) 전환 시 호출
+  // Prefill (AR=32) → Decode (AR=1) 전환 시 호출 (반대 방향도 동일)
   // - Prefill cache_len: context_len - 32 = 512 - 32 = 480
   // - Decode cache_len:  context_len - 1  = 512 - 1  = 511
   // 
-  // 모든 layer/head의 K/V cache를 480→511로 재배치
+  // 모든 layer/head의 K cache 점유 구간을 480↔511 stride로 재배치 (V는 행 단위라 불변)
   
   if (src_ar_len == dst_ar_len) {
-    std::cout << "[LLMKVCacheManager] Rearrange skipped (same AR len: " 
-              << src_ar_len << ")\n";
+    cur_ar_len_ = dst_ar_len;
     return;
   }
   
   int32_t src_cache_len = metadata_.context_len - src_ar_len;
   int32_t dst_cache_len = metadata_.context_len - dst_ar_len;
+  int32_t max_rows = std::min(src_cache_len, dst_cache_len);
+  int32_t rows = n_past < 0 ? max_rows : std::min(n_past, max_rows);
   
-  std::cout << "[LLMKVCacheManager] Rearranging cache: AR " 
-            << src_ar_len << " → " << dst_ar_len 
-            << " (cache " << src_cache_len << " → " << dst_cache_len << ")\n";
-  
-  for (int32_t layer = 0; layer < metadata_.num_layers; ++layer) {
+  const size_t moved = static_cast<size_t>(rows) * metadata_.head_dim *
+                       metadata_.num_heads * metadata_.num_layers;
+  for_each_layer(moved, [&](int32_t layer) {
     for (int32_t head = 0; head < metadata_.num_heads; ++head) {
-      rearrange_key(k_cache_[layer][head], src_cache_len, dst_cache_len);
+      rearrange_key(k_cache_[layer][head], src_cache_len, dst_cache_len, rows);
       rearrange_value(v_cache_[layer][head], src_cache_len, dst_cache_len);
     }
-  }
+  });
   
   cur_ar_len_ = dst_ar_len;  // Update current AR length
-  std::cout << "[LLMKVCacheManager] Rearrange complete\n";
+}
+
+template <typename Fn>
+void LLMKVCacheManager::for_each_layer(size_t moved, Fn&& fn) {
+  // 작은 이동(짧은 프롬프트)은 작업 분배 비용이 더 크므로 호출 스레드에서 처리
+  if (rearrange_pool_ && moved >= kParallelRearrangeBytes && metadata_.num_layers > 1) {
+    for (int32_t layer = 0; layer < metadata_.num_layers; ++layer) {
+      rearrange_pool_->submit([&fn, layer] { fn(layer); });
+    }
+    rearrange_pool_->wait_idle();
+  } else {
+    for (int32_t layer = 0; layer < metadata_.num_layers; ++layer) {
+      fn(layer);
+    }
+  }
+}
+
+void LLMKVCacheManager::set_key_encoding(int32_t layer, int32_t head, float scale, int32_t offset) {
+  if (layer < 0 || layer >= metadata_.num_layers || head < 0 || head >= metadata_.num_heads) return;
+  const size_t idx = static_cast<size_t>(layer) * metadata_.num_heads + head;
+  key_scale_[idx] = scale;
+  key_offset_[idx] = offset;
+}
+
+void LLMKVCacheManager::shift_key(
+    KVCacheBuffer& cache,
+    int32_t cache_len,
+    int32_t n_keep,
+    int32_t n_discard,
+    int32_t n_moved,
+    float scale,
+    int32_t offset,
+    const float* cos,
+    const float* sin) {
+  // K cache layout: [head_dim, cache_len] — dim 행마다 [n_keep + n_discard, n_past)를 n_keep으로
+  uint8_t* buffer = reinterpret_cast<uint8_t*>(cache.input_buffer);
+  for (int32_t dim = 0; dim < metadata_.head_dim; ++dim) {
+    uint8_t* row = buffer + static_cast<size_t>(dim) * cache_len + n_keep;
+    std::memmove(row, row + n_discard, n_moved);
+  }
+  if (!cos || scale <= 0.0f) return;
+  
+  // RoPE는 위치 차이만큼의 회전이므로 모든 위치에 같은 -n_discard 회전을 적용:
+  //   (x, y) → (x cos + y sin, y cos - x sin),  x = dim i, y = dim i + head_dim / 2
+  // 역양자화 → 회전 → 재양자화(반올림, [0, 255] clamp)
+  const int32_t half = metadata_.head_dim / 2;
+  const float inv_scale = 1.0f / scale;
+  const float zero = static_cast<float>(offset);
+  for (int32_t i = 0; i < half; ++i) {
+    uint8_t* a = buffer + static_cast<size_t>(i) * cache_len + n_keep;
+    uint8_t* b = buffer + static_cast<size_t>(i + half) * cache_len + n_keep;
+    const float c = cos[i];
+    const float s = sin[i];
+    for (int32_t p = 0; p < n_moved; ++p) {
+      const float x = (a[p] + zero) * scale;
+      const float y = (b[p] + zero) * scale;
+      const float qx = std::min(255.0f, std::max(0.0f, (x * c + y * s) * inv_scale - zero));
+      const float qy = std::min(255.0f, std::max(0.0f, (y * c - x * s) * inv_scale - zero));
+      a[p] = static_cast<uint8_t>(qx + 0.5f);
+      b[p] = static_cast<uint8_t>(qy + 0.5f);
+    }
+  }
+}
+
+int32_t LLMKVCacheManager::shift_cache(int32_t n_keep, int32_t n_discard, int32_t n_past) {
+  const int32_t cache_len = metadata_.context_len - cur_ar_len_;
+  if (n_keep < 0 || n_discard <= 0 || n_keep + n_discard > n_past || n_past > cache_len) {
+    return n_past;
+  }
+  const int32_t n_moved = n_past - n_keep - n_discard;
+  
+  // 회전각은 위치와 무관(-n_discard * freq): head_dim / 2개만 계산
+  std::vector<float> cos, sin;
+  if (n_moved > 0 && rope_inv_freq_.size() * 2 == static_cast<size_t>(metadata_.head_dim)) {
+    cos.resize(rope_inv_freq_.size());
+    sin.resize(rope_inv_freq_.size());
+    for (size_t i = 0; i < rope_inv_freq_.size(); ++i) {
+      const double angle = static_cast<double>(n_discard) * rope_inv_freq_[i];
+      cos[i] = static_cast<float>(std::cos(angle));
+      sin[i] = static_cast<float>(std::sin(angle));
+    }
+  }
+  const float* cos_ptr = cos.empty() ? nullptr : cos.data();
+  const float* sin_ptr = sin.empty() ? nullptr : sin.data();
+  
+  const size_t v_row = static_cast<size_t>(metadata_.head_dim);
+  const size_t moved = 2 * static_cast<size_t>(n_moved) * metadata_.head_dim *
+                       metadata_.num_heads * metadata_.num_layers;
+  if (n_moved > 0) {
+    for_each_layer(moved, [&](int32_t layer) {
+      for (int32_t head = 0; head < metadata_.num_heads; ++head) {
+        const size_t idx = static_cast<size_t>(layer) * metadata_.num_heads + head;
+        shift_key(k_cache_[layer][head], cache_len, n_keep, n_discard, n_moved,
+                  key_scale_[idx], key_offset_[idx], cos_ptr, sin_ptr);
+        // V cache layout: [cache_len, head_dim] — 행 단위 이동
+        uint8_t* v = reinterpret_cast<uint8_t*>(v_cache_[layer][head].input_buffer);
+        std::memmove(v + n_keep * v_row, v + (n_keep + n_discard) * v_row, n_moved * v_row);
+      }
+    });
+  }
+  return n_past - n_discard;
 }
 
 } // namespace llm_test
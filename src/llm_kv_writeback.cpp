@@ -0,0 +1,125 @@
+#include "llm_kv_writeback.h"
+
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LLM_KV_WRITEBACK_AVX2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LLM_KV_WRITEBACK_NEON 1
+#endif
+
+namespace llm_test {
+
+namespace {
+
+// Column scatter for one block of kLanes dims (32 on AVX2, 16 on NEON/scalar): dst[i * stride] = src[i]
+#if defined(LLM_KV_WRITEBACK_AVX2)
+constexpr int kLanes = 32;
+
+template <size_t... I>
+inline void store_lanes(uint8_t* dst, ptrdiff_t stride, __m128i v, std::index_sequence<I...>) {
+  ((dst[static_cast<ptrdiff_t>(I) * stride] = static_cast<uint8_t>(_mm_extract_epi8(v, I))), ...);
+}
+
+inline void scatter_block(uint8_t* dst, ptrdiff_t stride, const uint8_t* src) {
+  const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+  store_lanes(dst, stride, _mm256_castsi256_si128(v), std::make_index_sequence<16>());
+  store_lanes(dst + 16 * stride, stride, _mm256_extracti128_si256(v, 1),
+              std::make_index_sequence<16>());
+}
+#elif defined(LLM_KV_WRITEBACK_NEON)
+constexpr int kLanes = 16;
+
+template <size_t... I>
+inline void store_lanes(uint8_t* dst, ptrdiff_t stride, uint8x16_t v, std::index_sequence<I...>) {
+  (vst1q_lane_u8(dst + static_cast<ptrdiff_t>(I) * stride, v, I), ...);
+}
+
+inline void scatter_block(uint8_t* dst, ptrdiff_t stride, const uint8_t* src) {
+  store_lanes(dst, stride, vld1q_u8(src), std::make_index_sequence<16>());
+}
+#else
+constexpr int kLanes = 16;
+
+template <size_t... I>
+inline void store_lanes(uint8_t* dst, ptrdiff_t stride, const uint8_t* src,
+                        std::index_sequence<I...>) {
+  ((dst[static_cast<ptrdiff_t>(I) * stride] = src[I]), ...);
+}
+
+inline void scatter_block(uint8_t* dst, ptrdiff_t stride, const uint8_t* src) {
+  store_lanes(dst, stride, src, std::make_index_sequence<16>());
+}
+#endif
+
+// Decode: one token per row (column n_past of every dim)
+template <int HeadDim>
+void scatter_column(uint8_t* dst, ptrdiff_t stride, const uint8_t* src) {
+  static_assert(HeadDim % kLanes == 0, "head_dim must be a multiple of the vector width");
+  for (int d = 0; d < HeadDim; d += kLanes) {
+    scatter_block(dst + d * stride, stride, src + d);
+  }
+}
+
+// Prefill: n contiguous tokens per row
+template <int HeadDim>
+void copy_rows(uint8_t* dst, ptrdiff_t dst_stride, const uint8_t* src, ptrdiff_t src_stride,
+               size_t n) {
+  for (int d = 0; d < HeadDim; ++d) {
+    std::memcpy(dst, src, n);
+    dst += dst_stride;
+    src += src_stride;
+  }
+}
+
+} // namespace
+
+void KVWriteback::write_k(uint8_t* dst, int32_t dst_stride,
+                          const uint8_t* src, int32_t src_stride,
+                          int32_t head_dim, int32_t n) {
+  // Decode outputs ([head_dim, 1]) are contiguous: vector load + column scatter
+  if (n == 1 && src_stride == 1) {
+    switch (head_dim) {
+      case 64: scatter_column<64>(dst, dst_stride, src); return;
+      case 128: scatter_column<128>(dst, dst_stride, src); return;
+      default: break;
+    }
+  } else if (n > 0) {
+    switch (head_dim) {
+      case 64: copy_rows<64>(dst, dst_stride, src, src_stride, n); return;
+      case 128: copy_rows<128>(dst, dst_stride, src, src_stride, n); return;
+      default: break;
+    }
+  }
+  write_k_scalar(dst, dst_stride, src, src_stride, head_dim, n);
+}
+
+void KVWriteback::write_k_scalar(uint8_t* dst, int32_t dst_stride,
+                                 const uint8_t* src, int32_t src_stride,
+                                 int32_t head_dim, int32_t n) {
+  if (n == 1 && src_stride == 1) {
+    for (int32_t dim = 0; dim < head_dim; ++dim) {
+      dst[dim * dst_stride] = src[dim];
+    }
+    return;
+  }
+  for (int32_t dim = 0; dim < head_dim; ++dim) {
+    std::memcpy(dst, src, n);
+    src += src_stride;
+    dst += dst_stride;
+  }
+}
+
+const char* KVWriteback::isa() {
+#if defined(LLM_KV_WRITEBACK_AVX2)
+  return "avx2";
+#elif defined(LLM_KV_WRITEBACK_NEON)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
+
+} // namespace llm_test
@@ -0,0 +1,100 @@
+#include "llm_memory_budget.h"
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+
+namespace llm_test {
+
+namespace {
+
+// Matches the loader's automatic thread count upper bound
+constexpr int kAutoLoadThreads = 4;
+
+std::string mib(uint64_t bytes) {
+  std::ostringstream ss;
+  ss << std::fixed << std::setprecision(1) << (bytes / 1024.0 / 1024.0);
+  return ss.str();
+}
+
+} // namespace
+
+std::string LLMMemoryBudget::Footprint::breakdown() const {
+  return "kv " + mib(kv_cache) + " + io " + mib(io) + " + shared " + mib(shared) +
+         " + prefix " + mib(prefix_cache) + " + load " + mib(load) + " = " + mib(total()) + " MiB";
+}
+
+uint64_t LLMMemoryBudget::load_bytes(const Estimate& estimate, const Strategy& strategy) {
+  // mmap: clean file-backed pages the kernel can drop, released per shard after creation
+  if (strategy.mmap_load || estimate.binaries.empty()) return 0;
+  std::vector<uint64_t> sizes = estimate.binaries;
+  std::sort(sizes.begin(), sizes.end(), std::greater<uint64_t>());
+  if (estimate.serial_load) return sizes.front();
+
+  uint64_t total = 0;
+  for (uint64_t s : sizes) total += s;
+  const uint64_t cap = strategy.load_inflight_bytes;
+  // ListAsync keeps every binary resident and is used whenever they all fit the cap
+  if (cap == 0 || total <= cap) return total;
+
+  // Per-shard path: the largest binaries of one wave, bounded by the cap
+  // (a binary larger than the cap is admitted alone)
+  int threads = strategy.load_threads > 0 ? strategy.load_threads : kAutoLoadThreads;
+  uint64_t wave = 0;
+  for (size_t i = 0; i < sizes.size() && i < static_cast<size_t>(threads); ++i) wave += sizes[i];
+  return std::min(wave, std::max(cap, sizes.front()));
+}
+
+bool LLMMemoryBudget::plan(const Estimate& estimate, Strategy& strategy) {
+  changes_.clear();
+  footprint_ = Footprint();
+  footprint_.kv_cache = estimate.kv_cache;
+  footprint_.shared = estimate.shared;
+  footprint_.prefix_cache = estimate.prefix_cache;
+  footprint_.io = strategy.io_pool ? estimate.io_pooled : estimate.io_separate;
+  if (budget_bytes_ == 0) {
+    footprint_.load = load_bytes(estimate, strategy);
+    return true;
+  }
+
+  // 1. Overlay prefill staging with decode buffers
+  if (!strategy.io_pool && footprint_.reserved() > budget_bytes_ &&
+      estimate.io_pooled < estimate.io_separate) {
+    strategy.io_pool = true;
+    footprint_.io = estimate.io_pooled;
+    changes_.push_back("I/O liveness pool (" + mib(estimate.io_separate) + " -> " +
+                       mib(estimate.io_pooled) + " MiB)");
+  }
+  const uint64_t reserved = footprint_.reserved();
+  const uint64_t headroom = budget_bytes_ > reserved ? budget_bytes_ - reserved : 0;
+
+  if (!estimate.binaries.empty()) {
+    // 2. Page cache instead of heap copies
+    if (!strategy.mmap_load && load_bytes(estimate, strategy) > headroom) {
+      strategy.mmap_load = true;
+      changes_.push_back("mmap context binaries");
+    }
+
+    // 3. Bound concurrent loads by the headroom. Also covers a per-file read fallback
+    //    when mmap fails, and keeps ListAsync to models that fit entirely.
+    if (!estimate.serial_load) {
+      const uint64_t largest = *std::max_element(estimate.binaries.begin(), estimate.binaries.end());
+      if (strategy.load_inflight_bytes == 0 || strategy.load_inflight_bytes > headroom) {
+        strategy.load_inflight_bytes = std::max<uint64_t>(headroom, 1);
+        changes_.push_back("load in-flight cap " + mib(strategy.load_inflight_bytes) + " MiB");
+      }
+      uint64_t fit = largest > 0 ? headroom / largest : kAutoLoadThreads;
+      int limit = static_cast<int>(std::max<uint64_t>(1, std::min<uint64_t>(fit, kAutoLoadThreads)));
+      if (limit < kAutoLoadThreads && (strategy.load_threads == 0 || strategy.load_threads > limit)) {
+        strategy.load_threads = limit;
+        changes_.push_back("load threads " + std::to_string(limit));
+      }
+    }
+    footprint_.load = load_bytes(estimate, strategy);
+  }
+
+  return footprint_.total() <= budget_bytes_;
+}
+
+} // namespace llm_test
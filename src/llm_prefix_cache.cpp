@@ -0,0 +1,168 @@
+#include "llm_prefix_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace llm_test {
+
+LLMPrefixCache::LLMPrefixCache(const LLMKVCacheManager::Metadata& metadata, int32_t chunk_len,
+                               uint64_t max_bytes)
+    : metadata_(metadata),
+      chunk_len_(chunk_len),
+      max_bytes_(max_bytes),
+      chunk_bytes_(chunk_bytes(metadata, chunk_len)) {
+}
+
+LLMPrefixCache::~LLMPrefixCache() = default;
+
+// FNV-1a over the token ids
+uint64_t LLMPrefixCache::hash_chunk(const int32_t* tokens, int32_t n) {
+  uint64_t h = 1469598103934665603ull;
+  for (int32_t i = 0; i < n; ++i) {
+    uint32_t t = static_cast<uint32_t>(tokens[i]);
+    for (int b = 0; b < 4; ++b) {
+      h ^= (t >> (8 * b)) & 0xff;
+      h *= 1099511628211ull;
+    }
+  }
+  return h;
+}
+
+LLMPrefixCache::Node* LLMPrefixCache::find_child(Node* node, const int32_t* tokens) const {
+  auto it = node->children.find(hash_chunk(tokens, chunk_len_));
+  if (it == node->children.end()) return nullptr;
+  Node* child = it->second.get();
+  // A hash collision is a miss, never a wrong prefix
+  if (std::memcmp(child->tokens.data(), tokens, chunk_len_ * sizeof(int32_t)) != 0) return nullptr;
+  return child;
+}
+
+void LLMPrefixCache::copy_in(const Node& node, int32_t start, const LLMKVCacheManager& kv,
+                             int32_t k_stride) const {
+  const size_t rows = static_cast<size_t>(chunk_len_);
+  const size_t v_bytes = rows * metadata_.head_dim;
+  const uint8_t* src = node.data.data();
+  for (int32_t layer = 0; layer < metadata_.num_layers; ++layer) {
+    for (int32_t head = 0; head < metadata_.num_heads; ++head) {
+      uint8_t* k = reinterpret_cast<uint8_t*>(kv.get_k_cache(layer, head).input_buffer) + start;
+      for (int32_t dim = 0; dim < metadata_.head_dim; ++dim) {
+        std::memcpy(k + static_cast<size_t>(dim) * k_stride, src, rows);
+        src += rows;
+      }
+      uint8_t* v = reinterpret_cast<uint8_t*>(kv.get_v_cache(layer, head).input_buffer);
+      std::memcpy(v + static_cast<size_t>(start) * metadata_.head_dim, src, v_bytes);
+      src += v_bytes;
+    }
+  }
+}
+
+void LLMPrefixCache::copy_out(Node& node, int32_t start, const LLMKVCacheManager& kv,
+                              int32_t k_stride) const {
+  const size_t rows = static_cast<size_t>(chunk_len_);
+  const size_t v_bytes = rows * metadata_.head_dim;
+  node.data.resize(chunk_bytes_);
+  uint8_t* dst = node.data.data();
+  for (int32_t layer = 0; layer < metadata_.num_layers; ++layer) {
+    for (int32_t head = 0; head < metadata_.num_heads; ++head) {
+      const uint8_t* k =
+          reinterpret_cast<const uint8_t*>(kv.get_k_cache(layer, head).input_buffer) + start;
+      for (int32_t dim = 0; dim < metadata_.head_dim; ++dim) {
+        std::memcpy(dst, k + static_cast<size_t>(dim) * k_stride, rows);
+        dst += rows;
+      }
+      const uint8_t* v = reinterpret_cast<const uint8_t*>(kv.get_v_cache(layer, head).input_buffer);
+      std::memcpy(dst, v + static_cast<size_t>(start) * metadata_.head_dim, v_bytes);
+      dst += v_bytes;
+    }
+  }
+}
+
+int32_t LLMPrefixCache::restore(const std::vector<int32_t>& tokens, int32_t max_tokens,
+                                const LLMKVCacheManager& kv, int32_t k_stride) {
+  const int32_t limit = std::min<int32_t>(max_tokens, static_cast<int32_t>(tokens.size()));
+  int32_t restored = 0;
+  Node* node = &root_;
+  const uint64_t now = ++clock_;
+  while (restored + chunk_len_ <= limit) {
+    Node* child = find_child(node, tokens.data() + restored);
+    if (!child) break;
+    copy_in(*child, restored, kv, k_stride);
+    child->last_used = now;
+    node = child;
+    restored += chunk_len_;
+  }
+
+  if (restored > 0) {
+    stats_.hits++;
+    stats_.tokens_reused += restored;
+    stats_.bytes_restored += static_cast<uint64_t>(restored / chunk_len_) * chunk_bytes_;
+  } else {
+    stats_.misses++;
+  }
+  return restored;
+}
+
+uint64_t LLMPrefixCache::insert(const std::vector<int32_t>& tokens, int32_t n_tokens,
+                                const LLMKVCacheManager& kv, int32_t k_stride) {
+  const int32_t limit = std::min<int32_t>(n_tokens, static_cast<int32_t>(tokens.size()));
+  uint64_t added = 0;
+  Node* node = &root_;
+  const uint64_t now = ++clock_;
+  for (int32_t start = 0; start + chunk_len_ <= limit; start += chunk_len_) {
+    const int32_t* chunk = tokens.data() + start;
+    Node* child = find_child(node, chunk);
+    if (!child) {
+      const uint64_t hash = hash_chunk(chunk, chunk_len_);
+      // Colliding chunk under the same parent: keep the cached one
+      if (node->children.count(hash)) break;
+      if (!make_room(chunk_bytes_, node)) break;
+      std::unique_ptr<Node> created(new Node());
+      created->parent = node;
+      created->hash = hash;
+      created->tokens.assign(chunk, chunk + chunk_len_);
+      copy_out(*created, start, kv, k_stride);
+      child = created.get();
+      node->children[hash] = std::move(created);
+      bytes_ += chunk_bytes_;
+      added += chunk_bytes_;
+      ++num_nodes_;
+    }
+    child->last_used = now;
+    node = child;
+  }
+  return added;
+}
+
+bool LLMPrefixCache::make_room(uint64_t incoming, const Node* keep) {
+  if (incoming > max_bytes_) return false;
+  while (bytes_ + incoming > max_bytes_) {
+    // Least recently used leaf; keep (the insertion point) stays
+    Node* victim = nullptr;
+    std::vector<Node*> stack{&root_};
+    while (!stack.empty()) {
+      Node* node = stack.back();
+      stack.pop_back();
+      if (node->children.empty()) {
+        if (node != &root_ && node != keep && (!victim || node->last_used < victim->last_used)) {
+          victim = node;
+        }
+        continue;
+      }
+      for (auto& child : node->children) stack.push_back(child.second.get());
+    }
+    if (!victim) return false;
+    bytes_ -= chunk_bytes_;
+    --num_nodes_;
+    stats_.evictions++;
+    victim->parent->children.erase(victim->hash);
+  }
+  return true;
+}
+
+void LLMPrefixCache::clear() {
+  root_.children.clear();
+  bytes_ = 0;
+  num_nodes_ = 0;
+}
+
+} // namespace llm_test
@@ -1,4 +1,5 @@
 #include "model_params.h"
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -89,6 +90,36 @@ static bool parse_json_field(const std::string& json, const std::string& key, bo
   return false;
 }
 
+std::vector<float> rope_inv_frequencies(const ModelParams& params, int32_t head_dim) {
+  std::vector<float> inv_freq;
+  if (head_dim <= 0 || head_dim % 2 != 0) return inv_freq;
+  
+  // Llama 3 scaling (same constants as the ExecuTorch export)
+  const double low_freq_factor = 1.0;
+  const double high_freq_factor = 4.0;
+  const double old_context_len = 8192.0;
+  const double low_freq_wavelen = old_context_len / low_freq_factor;
+  const double high_freq_wavelen = old_context_len / high_freq_factor;
+  const double pi = 3.14159265358979323846;
+  
+  inv_freq.resize(head_dim / 2);
+  for (int32_t i = 0; i < head_dim / 2; ++i) {
+    double freq = 1.0 / std::pow(static_cast<double>(params.rope_theta), 2.0 * i / head_dim);
+    if (params.use_scaled_rope && params.rope_scale_factor > 0) {
+      const double wavelen = 2.0 * pi / freq;
+      if (wavelen > low_freq_wavelen) {
+        freq /= params.rope_scale_factor;
+      } else if (wavelen >= high_freq_wavelen) {
+        double smooth = (old_context_len / wavelen - low_freq_factor) /
+                        (high_freq_factor - low_freq_factor);
+        freq = (1.0 - smooth) * freq / params.rope_scale_factor + smooth * freq;
+      }
+    }
+    inv_freq[i] = static_cast<float>(freq);
+  }
+  return inv_freq;
+}
+
 bool parse_model_params(const std::string& path, ModelParams& params) {
   std::ifstream file(path);
   if (!file.is_open()) {
@@ -112,6 +143,7 @@ bool parse_model_params(const std::string& path, ModelParams& params) {
   parse_json_field(json, "norm_eps", params.norm_eps);
   parse_json_field(json, "rope_theta", params.rope_theta);
   parse_json_field(json, "use_scaled_rope", params.use_scaled_rope);
+  parse_json_field(json, "rope_scale_factor", params.rope_scale_factor);
   
   // Compute derived values
   params.compute_derived();
@@ -0,0 +1,285 @@
+#include "qnn_backend_session.h"
+#include "async_logger.h"
+
+#include <QnnInterface.h>
+#include <QnnLog.h>
+#include "HTP/QnnHtpDevice.h"
+#include "HTP/QnnHtpPerfInfrastructure.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstring>
+#include <dlfcn.h>
+#include <iostream>
+#include <map>
+
+namespace llm_test {
+
+namespace {
+// QNN 로그 콜백: 레벨 확인 후 AsyncLogger 링에 기록(graphExecute 스레드에서 I/O를 하지 않는다)
+static void QnnLogCallback(const char* fmt,
+                           QnnLog_Level_t level,
+                           uint64_t /*timestamp*/,
+                           va_list args) {
+  auto lvl = static_cast<LogLevel>(std::min<int>(std::max<int>(level, 1), 5));
+  AsyncLogger::instance().vlog(lvl, fmt, args, /*append_newline=*/true);
+}
+
+// (backend_so|system_so) → 살아 있는 세션. 생성도 이 mutex 아래에서 직렬화된다
+std::mutex& registry_mutex() {
+  static std::mutex mu;
+  return mu;
+}
+
+std::map<std::string, std::weak_ptr<QnnBackendSession>>& registry() {
+  static std::map<std::string, std::weak_ptr<QnnBackendSession>> sessions;
+  return sessions;
+}
+} // namespace
+
+std::shared_ptr<QnnBackendSession> QnnBackendSession::acquire(const std::string& backend_so_path,
+                                                              const std::string& system_so_path,
+                                                              int log_level,
+                                                              std::string* error,
+                                                              bool* reused) {
+  const std::string key = backend_so_path + "|" + system_so_path;
+  std::lock_guard<std::mutex> lk(registry_mutex());
+  auto& sessions = registry();
+  auto it = sessions.find(key);
+  if (it != sessions.end()) {
+    if (auto existing = it->second.lock()) {
+      if (reused) *reused = true;
+      return existing;
+    }
+  }
+  if (reused) *reused = false;
+
+  std::shared_ptr<QnnBackendSession> session(new QnnBackendSession());
+  std::string err;
+  if (!session->open(backend_so_path, system_so_path, log_level, err)) {
+    if (error) *error = err;
+    return nullptr;
+  }
+  sessions[key] = session;
+  return session;
+}
+
+size_t QnnBackendSession::live_sessions() {
+  std::lock_guard<std::mutex> lk(registry_mutex());
+  size_t n = 0;
+  for (const auto& kv : registry()) {
+    if (!kv.second.expired()) ++n;
+  }
+  return n;
+}
+
+QnnBackendSession::~QnnBackendSession() { close(); }
+
+// Executorch 흐름과 동일: dlopen → QnnInterface_getProviders → logCreate → backendCreate → deviceCreate
+bool QnnBackendSession::open(const std::string& backend_so_path, const std::string& system_so_path,
+                             int log_level, std::string& error) {
+  auto t0 = std::chrono::steady_clock::now();
+
+  handles_.backend_so_handle = dlopen(backend_so_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!handles_.backend_so_handle) {
+    error = std::string("dlopen backend failed: ") + dlerror();
+    return false;
+  }
+  handles_.system_so_handle = dlopen(system_so_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!handles_.system_so_handle) {
+    error = std::string("dlopen system failed: ") + dlerror();
+    return false;
+  }
+
+  get_providers_fn_ = dlsym(handles_.backend_so_handle, "QnnInterface_getProviders");
+  if (!get_providers_fn_) {
+    get_providers_fn_ = dlsym(handles_.system_so_handle, "QnnInterface_getProviders");
+  }
+  if (!get_providers_fn_) {
+    error = std::string("Cannot resolve QnnInterface_getProviders: ") + dlerror();
+    return false;
+  }
+
+  // provider 목록 중 첫 번째 선택
+  using GetProvidersFn = Qnn_ErrorHandle_t (*)(const QnnInterface_t***, uint32_t*);
+  auto get_providers = reinterpret_cast<GetProvidersFn>(get_providers_fn_);
+  const QnnInterface_t** providers = nullptr;
+  uint32_t num = 0;
+  if (get_providers(&providers, &num) != QNN_SUCCESS || num == 0 || providers == nullptr) {
+    error = "QnnInterface_getProviders failed or no providers";
+    return false;
+  }
+  interface_provider_ = providers[0];
+
+  const auto& api = providers[0]->QNN_INTERFACE_VER_NAME;
+  // 로거 생성(콜백 등록) 및 로그 레벨 설정 → AsyncLogger 경유로 출력
+  QnnLog_Level_t lvl = QNN_LOG_LEVEL_DEBUG;
+  if (log_level >= 1 && log_level <= 5) {
+    lvl = static_cast<QnnLog_Level_t>(log_level);
+  }
+  if (api.logCreate) {
+    api.logCreate(QnnLogCallback, lvl, reinterpret_cast<Qnn_LogHandle_t*>(&logger_));
+  }
+  if (logger_ && api.logSetLogLevel) {
+    api.logSetLogLevel(reinterpret_cast<Qnn_LogHandle_t>(logger_), lvl);
+  }
+  const QnnBackend_Config_t* backend_cfgs[] = {nullptr};
+  if (!api.backendCreate ||
+      api.backendCreate(reinterpret_cast<Qnn_LogHandle_t>(logger_), backend_cfgs,
+                        reinterpret_cast<Qnn_BackendHandle_t*>(&backend_)) != QNN_SUCCESS || !backend_) {
+    error = "Failed to create QNN backend";
+    return false;
+  }
+  const QnnDevice_Config_t* dev_cfgs[] = {nullptr};
+  if (!api.deviceCreate ||
+      api.deviceCreate(reinterpret_cast<Qnn_LogHandle_t>(logger_), dev_cfgs,
+                       reinterpret_cast<Qnn_DeviceHandle_t*>(&device_)) != QNN_SUCCESS || !device_) {
+    error = "Failed to create QNN device";
+    return false;
+  }
+
+  // [spagetti] op packages resgister 해야함???
+
+  open_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+  return true;
+}
+
+// 생성 역순으로 리소스 해제 및 dlclose 수행(모든 QnnLoader가 컨텍스트를 해제한 뒤 호출됨)
+void QnnBackendSession::close() {
+  // 공유 전력 정책은 device 해제 전에 power client를 반납
+  if (power_policy_) {
+    power_policy_->shutdown();
+    power_policy_.reset();
+  }
+  if (interface_provider_) {
+    auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_provider_);
+    const auto& api = qnn->QNN_INTERFACE_VER_NAME;
+
+    // HTP Power Config 해제
+    if (power_config_client_id_ != 0) {
+      auto* infra = static_cast<const QnnHtpDevice_PerfInfrastructure_t*>(htp_perf_infrastructure());
+      if (infra && infra->destroyPowerConfigId) infra->destroyPowerConfigId(power_config_client_id_);
+    }
+    power_config_client_id_ = 0;
+
+    if (device_ && api.deviceFree) {
+      api.deviceFree(reinterpret_cast<Qnn_DeviceHandle_t>(device_));
+    }
+    if (backend_ && api.backendFree) {
+      api.backendFree(reinterpret_cast<Qnn_BackendHandle_t>(backend_));
+    }
+    if (logger_ && api.logFree) {
+      api.logFree(reinterpret_cast<Qnn_LogHandle_t>(logger_));
+    }
+  }
+  interface_provider_ = nullptr;
+  device_ = nullptr;
+  backend_ = nullptr;
+  logger_ = nullptr;
+  if (handles_.backend_so_handle) { dlclose(handles_.backend_so_handle); handles_.backend_so_handle = nullptr; }
+  if (handles_.system_so_handle) { dlclose(handles_.system_so_handle); handles_.system_so_handle = nullptr; }
+}
+
+const void* QnnBackendSession::htp_perf_infrastructure() const {
+  if (!interface_provider_ || !device_) return nullptr;
+  auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_provider_);
+  const auto& api = qnn->QNN_INTERFACE_VER_NAME;
+
+  if (!api.deviceGetInfrastructure) {
+      std::cerr << "deviceGetInfrastructure not available\n";
+      return nullptr;
+  }
+
+  QnnDevice_Infrastructure_t device_infra = nullptr;
+  if (api.deviceGetInfrastructure(&device_infra) != QNN_SUCCESS) {
+      std::cerr << "Failed to get device infrastructure\n";
+      return nullptr;
+  }
+
+  auto* htp_infra = static_cast<QnnHtpDevice_Infrastructure_t*>(device_infra);
+  if (htp_infra->infraType != QNN_HTP_DEVICE_INFRASTRUCTURE_TYPE_PERF) {
+      std::cerr << "HTP infra type is not PERF\n";
+      return nullptr;
+  }
+  return &htp_infra->perfInfra;
+}
+
+HtpPowerPolicy* QnnBackendSession::power_policy(const HtpPowerPolicy::Options& options) {
+  std::lock_guard<std::mutex> lk(power_mu_);
+  if (power_policy_ || power_policy_failed_) return power_policy_.get();
+  auto* infra = static_cast<const QnnHtpDevice_PerfInfrastructure_t*>(htp_perf_infrastructure());
+  std::unique_ptr<HtpPowerPolicy> policy(new HtpPowerPolicy());
+  if (!infra || !policy->init(HtpPerfOps::from_infra(*infra), options)) {
+    power_policy_failed_ = true;
+    return nullptr;
+  }
+  power_policy_ = std::move(policy);
+  return power_policy_.get();
+}
+
+bool QnnBackendSession::enable_htp_performance_mode() {
+  std::lock_guard<std::mutex> lk(power_mu_);
+  auto* infra = static_cast<const QnnHtpDevice_PerfInfrastructure_t*>(htp_perf_infrastructure());
+  if (!infra) return false;
+  const auto& perf_infra = *infra;
+
+  if (power_config_client_id_ == 0) {
+      if (perf_infra.createPowerConfigId(0, 0, &power_config_client_id_) != QNN_SUCCESS) {
+          std::cerr << "Failed to create power config ID\n";
+          return false;
+      }
+  }
+
+  // 1. DCVS & Power Mode Config (kHtpBurst)
+  QnnHtpPerfInfrastructure_PowerConfig_t power_config;
+  memset(&power_config, 0, sizeof(power_config));
+  power_config.option = QNN_HTP_PERF_INFRASTRUCTURE_POWER_CONFIGOPTION_DCVS_V3;
+
+  auto& dcvs = power_config.dcvsV3Config;
+  dcvs.contextId = power_config_client_id_;
+
+  // Upvote common settings
+  dcvs.setSleepDisable = 0; // Executorch sets this to 0 for UpVote
+  dcvs.sleepDisable = 0;    // Irrelevant if setSleepDisable is 0
+  dcvs.setDcvsEnable = 1;
+  dcvs.dcvsEnable = 0;      // kDcvsDisable
+  dcvs.powerMode = QNN_HTP_PERF_INFRASTRUCTURE_POWERMODE_PERFORMANCE_MODE;
+
+  // kHtpBurst specific settings
+  dcvs.setSleepLatency = 1;
+  dcvs.sleepLatency = 40; // kSleepMinLatency
+
+  dcvs.setBusParams = 1;
+  dcvs.busVoltageCornerMin = DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER;
+  dcvs.busVoltageCornerTarget = DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER;
+  dcvs.busVoltageCornerMax = DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER;
+
+  dcvs.setCoreParams = 1;
+  dcvs.coreVoltageCornerMin = DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER;
+  dcvs.coreVoltageCornerTarget = DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER;
+  dcvs.coreVoltageCornerMax = DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER;
+
+  // 2. RPC Control Latency Config
+  QnnHtpPerfInfrastructure_PowerConfig_t rpc_latency_config;
+  memset(&rpc_latency_config, 0, sizeof(rpc_latency_config));
+  rpc_latency_config.option = QNN_HTP_PERF_INFRASTRUCTURE_POWER_CONFIGOPTION_RPC_CONTROL_LATENCY;
+  rpc_latency_config.rpcControlLatencyConfig = 100; // kRpcControlLatency
+
+  // 3. RPC Polling Time Config
+  QnnHtpPerfInfrastructure_PowerConfig_t rpc_polling_config;
+  memset(&rpc_polling_config, 0, sizeof(rpc_polling_config));
+  rpc_polling_config.option = QNN_HTP_PERF_INFRASTRUCTURE_POWER_CONFIGOPTION_RPC_POLLING_TIME;
+  rpc_polling_config.rpcPollingTimeConfig = 9999; // kRpcPollingTimeHighPower
+
+  const QnnHtpPerfInfrastructure_PowerConfig_t* configs[] = {&power_config, &rpc_latency_config, &rpc_polling_config, nullptr};
+
+  if (perf_infra.setPowerConfig(power_config_client_id_, configs) != QNN_SUCCESS) {
+      std::cerr << "Failed to set HTP power config (Burst Mode)\n";
+      return false;
+  }
+
+  std::cout << "HTP Performance Mode Enabled (Burst + RPC Polling)\n";
+  return true;
+}
+
+} // namespace llm_test
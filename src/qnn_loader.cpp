@@ -1,54 +1,95 @@
 #include "qnn_loader.h"
+#include "async_logger.h"
 
 #include <QnnInterface.h>
-#include <QnnLog.h>
-#include "HTP/QnnHtpDevice.h"
-#include "HTP/QnnHtpPerfInfrastructure.h"
-#include <cstdarg>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
-#include <dlfcn.h>
 #include <iostream>
+#include <mutex>
 
 namespace llm_test {
 
+// 컨텍스트별 비동기 제출 슬롯 링
+// - 슬롯 배열은 생성 시 고정 크기로 할당되며 제출마다 할당하지 않는다
+// - notify 콜백은 QNN 내부 스레드에서 호출되므로 mutex/condvar로 상태를 보호한다
+struct QnnAsyncQueue {
+  struct Slot {
+    QnnAsyncQueue* owner {nullptr};
+    bool in_use {false};
+    bool done {false};
+    Qnn_ErrorHandle_t error {QNN_SUCCESS};
+  };
+
+  explicit QnnAsyncQueue(uint32_t depth) : slots(depth) {
+    for (auto& s : slots) s.owner = this;
+  }
+
+  std::mutex mu;
+  std::condition_variable cv;
+  std::vector<Slot> slots;
+  uint32_t next {0};
+};
+
 namespace {
-// QNN 로그를 표준출력으로 바로 내보내는 콜백
-static void StdoutLogger(const char* fmt,
-                         QnnLog_Level_t level,
-                         uint64_t /*timestamp*/,
-                         va_list args) {
-  (void)level; // 레벨은 필요 시 필터링에 사용할 수 있음
-  vfprintf(stdout, fmt, args);
-  fputc('\n', stdout);
-  fflush(stdout);
+// graphExecuteAsync 완료 통지 콜백
+static void AsyncExecNotify(void* param, Qnn_NotifyStatus_t status) {
+  auto* slot = static_cast<QnnAsyncQueue::Slot*>(param);
+  QnnAsyncQueue* q = slot->owner;
+  {
+    std::lock_guard<std::mutex> lk(q->mu);
+    slot->error = status.error;
+    slot->done = true;
+  }
+  q->cv.notify_all();
 }
 }
 
-// 소멸자: 생성된 리소스들을 안전하게 해제
-QnnLoader::~QnnLoader() { cleanup(); }
+QnnExecFuture::~QnnExecFuture() { wait(); }
 
-// QNN 공유 라이브러리 로드 및 provider 조회 함수 심볼 확인
-bool QnnLoader::load(const std::string& backend_so_path, const std::string& system_so_path) {
-  handles_.backend_so_handle = dlopen(backend_so_path.c_str(), RTLD_NOW | RTLD_LOCAL);
-  if (!handles_.backend_so_handle) {
-    std::cerr << "dlopen backend failed: " << dlerror() << "\n";
-    return false;
-  }
-  handles_.system_so_handle = dlopen(system_so_path.c_str(), RTLD_NOW | RTLD_LOCAL);
-  if (!handles_.system_so_handle) {
-    std::cerr << "dlopen system failed: " << dlerror() << "\n";
-    return false;
+QnnExecFuture::QnnExecFuture(QnnExecFuture&& other) noexcept
+    : queue_(other.queue_), slot_(other.slot_), error_(other.error_) {
+  other.queue_ = nullptr;
+}
+
+QnnExecFuture& QnnExecFuture::operator=(QnnExecFuture&& other) noexcept {
+  if (this != &other) {
+    wait();
+    queue_ = other.queue_;
+    slot_ = other.slot_;
+    error_ = other.error_;
+    other.queue_ = nullptr;
   }
+  return *this;
+}
 
-  get_providers_fn_ = dlsym(handles_.backend_so_handle, "QnnInterface_getProviders");
-  if (!get_providers_fn_) {
-    get_providers_fn_ = dlsym(handles_.system_so_handle, "QnnInterface_getProviders");
+bool QnnExecFuture::wait() {
+  if (queue_) {
+    std::unique_lock<std::mutex> lk(queue_->mu);
+    auto& slot = queue_->slots[slot_];
+    queue_->cv.wait(lk, [&] { return slot.done; });
+    error_ = slot.error;
+    slot.in_use = false;
+    lk.unlock();
+    queue_->cv.notify_all();
+    queue_ = nullptr;
   }
-  if (!get_providers_fn_) {
-    std::cerr << "Cannot resolve QnnInterface_getProviders: " << dlerror() << "\n";
+  return error_ == QNN_SUCCESS;
+}
+
+// 소멸자: 생성된 리소스들을 안전하게 해제
+QnnLoader::~QnnLoader() { cleanup(); }
+
+// 공유 세션의 핸들을 받아 둔다
+bool QnnLoader::attach(std::shared_ptr<QnnBackendSession> session) {
+  if (!session || !session->interface() || !session->backend_handle() || !session->device_handle()) {
     return false;
   }
+  if (!contexts_.empty()) return false; // 컨텍스트가 생긴 뒤 세션을 바꿀 수 없음
+  session_ = std::move(session);
+  interface_provider_ = session_->interface();
+  backend_ = session_->backend_handle();
+  device_ = session_->device_handle();
   return true;
 }
 
@@ -97,128 +138,162 @@ bool QnnLoader::update_graph_tensors(size_t ctx_index,
   return err == QNN_SUCCESS;
 }
 
-// QnnInterface_getProviders를 호출해 provider 리스트를 받아 적절한 provider를 선택
-const void* QnnLoader::get_interface_provider(const char* provider_name) {
-  if (!get_providers_fn_) return nullptr;
-  using GetProvidersFn = Qnn_ErrorHandle_t (*)(const QnnInterface_t***, uint32_t*);
-  auto get_providers = reinterpret_cast<GetProvidersFn>(get_providers_fn_);
-  const QnnInterface_t** providers = nullptr;
-  uint32_t num = 0;
-  auto err = get_providers(&providers, &num);
-  if (err != QNN_SUCCESS || num == 0 || providers == nullptr) {
-    std::cerr << "QnnInterface_getProviders failed or no providers\n";
-    return nullptr;
-  }
-  if (provider_name == nullptr) {
-    interface_provider_ = providers[0];
-    return interface_provider_;
-  }
-  for (uint32_t i = 0; i < num; ++i) {
-    if (providers[i] && providers[i]->providerName && std::string(providers[i]->providerName) == provider_name) {
-      interface_provider_ = providers[i];
-      return interface_provider_;
-    }
-  }
-  interface_provider_ = providers[0];
-  return interface_provider_;
-}
-
-// Executorch 흐름과 동일: logCreate → backendCreate → deviceCreate
-bool QnnLoader::create_backend_and_device() {
-  if (!interface_provider_) return false;
-  auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_provider_);
-  const auto& api = qnn->QNN_INTERFACE_VER_NAME;
-  // 로거 생성(콜백 등록) 및 로그 레벨 설정 → 쉘 STDOUT로 바로 출력
-  if (api.logCreate) {
-    QnnLog_Level_t lvl = QNN_LOG_LEVEL_DEBUG;
-    if (log_level_ >= 1 && log_level_ <= 5) {
-      lvl = static_cast<QnnLog_Level_t>(log_level_);
-    }
-    api.logCreate(StdoutLogger, lvl,
-                  reinterpret_cast<Qnn_LogHandle_t*>(&logger_));
-  }
-  if (logger_ && api.logSetLogLevel) {
-    QnnLog_Level_t lvl = QNN_LOG_LEVEL_DEBUG;
-    if (log_level_ >= 1 && log_level_ <= 5) {
-      lvl = static_cast<QnnLog_Level_t>(log_level_);
-    }
-    api.logSetLogLevel(reinterpret_cast<Qnn_LogHandle_t>(logger_), lvl);
-  }
-  const QnnBackend_Config_t* backend_cfgs[] = {nullptr};
-  if (!api.backendCreate) return false;
-  if (api.backendCreate(reinterpret_cast<Qnn_LogHandle_t>(logger_), backend_cfgs,
-                         reinterpret_cast<Qnn_BackendHandle_t*>(&backend_)) != QNN_SUCCESS || !backend_) {
-    return false;
-  }
-  const QnnDevice_Config_t* dev_cfgs[] = {nullptr};
-  if (!api.deviceCreate) return false;
-  if (api.deviceCreate(reinterpret_cast<Qnn_LogHandle_t>(logger_), dev_cfgs,
-                        reinterpret_cast<Qnn_DeviceHandle_t*>(&device_)) != QNN_SUCCESS || !device_) {
-    return false;
-  }
-
-  // [spagetti] op packages resgister 해야함???
-
-  return true;
-}
-
-// ListAsync 경로는 제거했습니다
-
-// 생성 역순으로 리소스 해제 및 dlclose 수행
+// 컨텍스트만 해제(백엔드/디바이스는 세션이 마지막 참조 해제 시 정리)
 void QnnLoader::cleanup() {
   if (interface_provider_) {
     auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_provider_);
     const auto& api = qnn->QNN_INTERFACE_VER_NAME;
 
-    // HTP Power Config 해제
-    if (power_config_client_id_ != 0 && device_ && api.deviceGetInfrastructure) {
-        QnnDevice_Infrastructure_t device_infra = nullptr;
-        if (api.deviceGetInfrastructure(&device_infra) == QNN_SUCCESS) {
-            auto* htp_infra = static_cast<QnnHtpDevice_Infrastructure_t*>(device_infra);
-            if (htp_infra->infraType == QNN_HTP_DEVICE_INFRASTRUCTURE_TYPE_PERF) {
-                 htp_infra->perfInfra.destroyPowerConfigId(power_config_client_id_);
-            }
-        }
-    }
-    power_config_client_id_ = 0;
+    // 진행 중인 비동기 실행이 끝난 뒤 컨텍스트 해제
+    drain_async_queues();
 
     for (void* c : contexts_) {
       if (c && api.contextFree) api.contextFree(reinterpret_cast<Qnn_ContextHandle_t>(c), nullptr);
     }
-    contexts_.clear();
-    if (device_ && api.deviceFree) {
-      api.deviceFree(reinterpret_cast<Qnn_DeviceHandle_t>(device_));
-    }
-    if (backend_ && api.backendFree) {
-      api.backendFree(reinterpret_cast<Qnn_BackendHandle_t>(backend_));
-    }
-    if (logger_ && api.logFree) {
-      api.logFree(reinterpret_cast<Qnn_LogHandle_t>(logger_));
-    }
   }
-  device_ = nullptr;
+  contexts_.clear();
+  async_queues_.clear();
+  graphs_.clear();
+  interface_provider_ = nullptr;
   backend_ = nullptr;
-  logger_ = nullptr;
-  if (handles_.backend_so_handle) { dlclose(handles_.backend_so_handle); handles_.backend_so_handle = nullptr; }
-  if (handles_.system_so_handle) { dlclose(handles_.system_so_handle); handles_.system_so_handle = nullptr; }
+  device_ = nullptr;
+  session_.reset();
 }
 
-bool QnnLoader::create_context_from_binary(const void* binary, size_t binary_size) {
-  if (!interface_provider_ || !backend_ || !device_) return false;
+Qnn_ErrorHandle_t QnnLoader::context_create(const void* binary, size_t binary_size,
+                                            Qnn_ProfileHandle_t profile, void** out_ctx) {
+  *out_ctx = nullptr;
+  if (!interface_provider_ || !backend_ || !device_) return QNN_COMMON_ERROR_INVALID_ARGUMENT;
   auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_provider_);
   const auto& api = qnn->QNN_INTERFACE_VER_NAME;
-  if (!api.contextCreateFromBinary) return false;
-  void* ctx = nullptr;
-  auto err = api.contextCreateFromBinary(
+  if (!api.contextCreateFromBinary) return QNN_COMMON_ERROR_NOT_SUPPORTED;
+  return api.contextCreateFromBinary(
       reinterpret_cast<Qnn_BackendHandle_t>(backend_),
       reinterpret_cast<Qnn_DeviceHandle_t>(device_),
       /*config*/nullptr,
       binary,
       static_cast<Qnn_ContextBinarySize_t>(binary_size),
-      reinterpret_cast<Qnn_ContextHandle_t*>(&ctx),
-      /*profile*/nullptr);
-  if (err != QNN_SUCCESS) return false;
-  contexts_.push_back(ctx);
+      reinterpret_cast<Qnn_ContextHandle_t*>(out_ctx),
+      profile);
+}
+
+bool QnnLoader::create_context_from_binary(const void* binary, size_t binary_size,
+                                           Qnn_ProfileHandle_t profile) {
+  void* ctx = nullptr;
+  if (context_create(binary, binary_size, profile, &ctx) != QNN_SUCCESS) return false;
+  add_context(ctx);
+  return true;
+}
+
+size_t QnnLoader::reserve_context_slots(size_t n) {
+  size_t first = contexts_.size();
+  for (size_t i = 0; i < n; ++i) add_context(nullptr);
+  return first;
+}
+
+bool QnnLoader::create_context_at(size_t slot, const void* binary, size_t binary_size,
+                                  Qnn_ProfileHandle_t profile) {
+  if (slot >= contexts_.size() || contexts_[slot]) return false;
+  void* ctx = nullptr;
+  if (context_create(binary, binary_size, profile, &ctx) != QNN_SUCCESS) return false;
+  contexts_[slot] = ctx; // 슬롯별로 독립된 원소라 다른 스레드와 경합하지 않음
+  return true;
+}
+
+bool QnnLoader::supports_list_async() const {
+  if (!interface_provider_) return false;
+  auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_provider_);
+  return qnn->QNN_INTERFACE_VER_NAME.contextCreateFromBinaryListAsync != nullptr;
+}
+
+namespace {
+// ListAsync 완료 통지 상태: 컨텍스트별 CONTEXT_INIT 통지를 모두 받을 때까지 대기
+struct ListAsyncState {
+  std::mutex mu;
+  std::condition_variable cv;
+  std::vector<void*> contexts;
+  std::vector<Qnn_ErrorHandle_t> errors;
+  size_t remaining {0};
+};
+
+struct ListAsyncParam {
+  ListAsyncState* state;
+  size_t index;
+};
+
+static void ListAsyncNotify(Qnn_ContextHandle_t context,
+                            Qnn_GraphHandle_t /*graph*/,
+                            const char* /*graph_name*/,
+                            QnnContext_createFromBinaryAsyncNotifyType_t complete_type,
+                            void* notify_param,
+                            Qnn_ErrorHandle_t status) {
+  if (complete_type != QNN_CONTEXT_NOTIFY_TYPE_CONTEXT_INIT) return;
+  auto* p = static_cast<ListAsyncParam*>(notify_param);
+  ListAsyncState* st = p->state;
+  {
+    std::lock_guard<std::mutex> lk(st->mu);
+    st->contexts[p->index] = context;
+    st->errors[p->index] = status;
+    if (st->remaining > 0) --st->remaining;
+  }
+  st->cv.notify_all();
+}
+}
+
+bool QnnLoader::create_contexts_list_async(size_t first_slot,
+                                           const std::vector<std::pair<const void*, size_t>>& binaries,
+                                           const std::vector<Qnn_ProfileHandle_t>& profiles) {
+  if (!supports_list_async() || !backend_ || !device_) return false;
+  if (first_slot + binaries.size() > contexts_.size()) return false;
+  auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_provider_);
+  const auto& api = qnn->QNN_INTERFACE_VER_NAME;
+
+  const size_t n = binaries.size();
+  ListAsyncState state;
+  state.contexts.assign(n, nullptr);
+  state.errors.assign(n, QNN_SUCCESS);
+  state.remaining = n;
+
+  std::vector<ListAsyncParam> notify_params(n);
+  std::vector<QnnContext_Params_t> params(n);
+  std::vector<const QnnContext_Params_t*> param_ptrs;
+  param_ptrs.reserve(n + 1);
+  for (size_t i = 0; i < n; ++i) {
+    notify_params[i] = ListAsyncParam{&state, i};
+    params[i].version = QNN_CONTEXT_PARAMS_VERSION_1;
+    params[i].v1 = QnnContext_ParamsV1_t{ /*config*/nullptr, binaries[i].first,
+      static_cast<Qnn_ContextBinarySize_t>(binaries[i].second),
+      /*profile*/profiles.empty() ? nullptr : profiles[i],
+      ListAsyncNotify, &notify_params[i] };
+    param_ptrs.push_back(&params[i]);
+  }
+  param_ptrs.push_back(nullptr); // NULL-terminate
+
+  auto err = api.contextCreateFromBinaryListAsync(
+      reinterpret_cast<Qnn_BackendHandle_t>(backend_),
+      reinterpret_cast<Qnn_DeviceHandle_t>(device_),
+      param_ptrs.data(),
+      /*listConfig*/nullptr,
+      /*signal*/nullptr);
+
+  bool ok = (err == QNN_SUCCESS);
+  {
+    std::unique_lock<std::mutex> lk(state.mu);
+    // 제출이 성공했으면 모든 컨텍스트 통지를 기다린다(통지 파라미터 수명 보호)
+    if (ok) state.cv.wait(lk, [&] { return state.remaining == 0; });
+    for (size_t i = 0; i < n; ++i) {
+      if (state.errors[i] != QNN_SUCCESS || !state.contexts[i]) ok = false;
+    }
+  }
+
+  if (!ok) {
+    std::cerr << "contextCreateFromBinaryListAsync failed (err=" << err << ")\n";
+    for (void* c : state.contexts) {
+      if (c && api.contextFree) api.contextFree(reinterpret_cast<Qnn_ContextHandle_t>(c), nullptr);
+    }
+    return false;
+  }
+  for (size_t i = 0; i < n; ++i) contexts_[first_slot + i] = state.contexts[i];
   return true;
 }
 
@@ -243,23 +318,47 @@ bool QnnLoader::create_contexts_from_binaries(const std::vector<std::pair<const
       std::cerr << "Failed to create context from binary (index " << contexts_.size() << ")\n";
       return false;
     }
-    contexts_.push_back(ctx);
+    add_context(ctx);
   }
   return true;
 }
 
-bool QnnLoader::retrieve_graph(size_t ctx_index, const std::string& graph_name) { // [spagetti] blob & cache
-  if (!interface_provider_) return false;
-  if (ctx_index >= contexts_.size()) return false;
+void QnnLoader::add_context(void* ctx) {
+  contexts_.push_back(ctx);
+  async_queues_.push_back(std::make_shared<QnnAsyncQueue>(async_queue_depth_));
+}
+
+void QnnLoader::drain_async_queues() {
+  for (auto& q : async_queues_) {
+    if (!q) continue;
+    std::unique_lock<std::mutex> lk(q->mu);
+    q->cv.wait(lk, [&] {
+      for (const auto& s : q->slots) {
+        if (s.in_use && !s.done) return false;
+      }
+      return true;
+    });
+  }
+}
+
+Qnn_GraphHandle_t QnnLoader::get_graph_handle(size_t ctx_index, const std::string& graph_name) {
+  if (!interface_provider_) return nullptr;
+  if (ctx_index >= contexts_.size()) return nullptr;
   auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_provider_);
   const auto& api = qnn->QNN_INTERFACE_VER_NAME;
-  if (!api.graphRetrieve) return false;
-  void* graph = nullptr;
+  if (!api.graphRetrieve) return nullptr;
+  Qnn_GraphHandle_t graph = nullptr;
   auto err = api.graphRetrieve(
       reinterpret_cast<Qnn_ContextHandle_t>(contexts_[ctx_index]),
       graph_name.c_str(),
-      reinterpret_cast<Qnn_GraphHandle_t*>(&graph));
-  if (err != QNN_SUCCESS || graph == nullptr) return false;
+      &graph);
+  if (err != QNN_SUCCESS) return nullptr;
+  return graph;
+}
+
+bool QnnLoader::retrieve_graph(size_t ctx_index, const std::string& graph_name) { // [spagetti] blob & cache
+  Qnn_GraphHandle_t graph = get_graph_handle(ctx_index, graph_name);
+  if (graph == nullptr) return false;
   graphs_.push_back(graph);
   return true;
 }
@@ -268,107 +367,103 @@ bool QnnLoader::execute_graph(size_t ctx_index,
                               const std::string& graph_name,
                               const std::vector<Qnn_Tensor_t>& inputs,
                               std::vector<Qnn_Tensor_t>& outputs) {
-  if (!interface_provider_) return false;
-  if (ctx_index >= contexts_.size()) return false;
-  auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_provider_);
-  const auto& api = qnn->QNN_INTERFACE_VER_NAME;
-  if (!api.graphRetrieve || !api.graphExecute) return false;
-  void* graph = nullptr;
-  if (api.graphRetrieve(reinterpret_cast<Qnn_ContextHandle_t>(contexts_[ctx_index]),
-                        graph_name.c_str(),
-                        reinterpret_cast<Qnn_GraphHandle_t*>(&graph)) != QNN_SUCCESS || !graph) {
-    return false;
-  }
-  Qnn_ErrorHandle_t err = api.graphExecute(
-      reinterpret_cast<Qnn_GraphHandle_t>(graph),
-      inputs.data(), static_cast<uint32_t>(inputs.size()),
-      outputs.data(), static_cast<uint32_t>(outputs.size()),
-      /*profile*/nullptr,
-      /*signal*/nullptr);
-  return err == QNN_SUCCESS;
+  Qnn_GraphHandle_t graph = get_graph_handle(ctx_index, graph_name);
+  if (graph == nullptr) return false;
+  return execute_graph(graph,
+                       inputs.data(), static_cast<uint32_t>(inputs.size()),
+                       outputs.data(), static_cast<uint32_t>(outputs.size()),
+                       /*profile*/nullptr);
 }
 
-bool QnnLoader::enable_htp_performance_mode() {
-  if (!interface_provider_ || !device_) return false;
+bool QnnLoader::execute_graph(Qnn_GraphHandle_t graph,
+                              const Qnn_Tensor_t* inputs, uint32_t num_inputs,
+                              Qnn_Tensor_t* outputs, uint32_t num_outputs,
+                              Qnn_ProfileHandle_t profile) {
+  return graph_execute(graph, inputs, num_inputs, outputs, num_outputs, profile) == QNN_SUCCESS;
+}
+
+Qnn_ErrorHandle_t QnnLoader::graph_execute(Qnn_GraphHandle_t graph,
+                                           const Qnn_Tensor_t* inputs, uint32_t num_inputs,
+                                           Qnn_Tensor_t* outputs, uint32_t num_outputs,
+                                           Qnn_ProfileHandle_t profile) {
+  if (!interface_provider_ || !graph) return QNN_COMMON_ERROR_INVALID_ARGUMENT;
   auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_provider_);
   const auto& api = qnn->QNN_INTERFACE_VER_NAME;
+  if (!api.graphExecute) return QNN_COMMON_ERROR_NOT_SUPPORTED;
+  return api.graphExecute(
+      graph,
+      inputs, num_inputs,
+      outputs, num_outputs,
+      profile,
+      /*signal*/nullptr);
+}
 
-  if (!api.deviceGetInfrastructure) {
-      std::cerr << "deviceGetInfrastructure not available\n";
-      return false;
-  }
-
-  QnnDevice_Infrastructure_t device_infra = nullptr;
-  if (api.deviceGetInfrastructure(&device_infra) != QNN_SUCCESS) {
-      std::cerr << "Failed to get device infrastructure\n";
-      return false;
+QnnExecFuture QnnLoader::execute_graph_async(size_t ctx_index,
+                                             Qnn_GraphHandle_t graph,
+                                             const Qnn_Tensor_t* inputs, uint32_t num_inputs,
+                                             Qnn_Tensor_t* outputs, uint32_t num_outputs,
+                                             Qnn_ProfileHandle_t profile) {
+  QnnExecFuture fut;
+  const QnnInterface_t* qnn = reinterpret_cast<const QnnInterface_t*>(interface_provider_);
+  bool can_async = async_enabled_ && qnn && graph &&
+                   qnn->QNN_INTERFACE_VER_NAME.graphExecuteAsync &&
+                   ctx_index < async_queues_.size() && async_queues_[ctx_index];
+  if (!can_async) {
+    fut.error_ = graph_execute(graph, inputs, num_inputs, outputs, num_outputs, profile);
+    return fut;
   }
 
-  auto* htp_infra = static_cast<QnnHtpDevice_Infrastructure_t*>(device_infra);
-  if (htp_infra->infraType != QNN_HTP_DEVICE_INFRASTRUCTURE_TYPE_PERF) {
-      std::cerr << "HTP infra type is not PERF\n";
+  // 빈 슬롯 확보(가득 차 있으면 이전 제출이 wait()로 반환될 때까지 대기)
+  QnnAsyncQueue& q = *async_queues_[ctx_index];
+  uint32_t idx = 0;
+  {
+    std::unique_lock<std::mutex> lk(q.mu);
+    const uint32_t n = static_cast<uint32_t>(q.slots.size());
+    auto find_free = [&]() -> bool {
+      for (uint32_t i = 0; i < n; ++i) {
+        uint32_t cand = (q.next + i) % n;
+        if (!q.slots[cand].in_use) { idx = cand; return true; }
+      }
       return false;
+    };
+    q.cv.wait(lk, find_free);
+    q.next = (idx + 1) % n;
+    q.slots[idx].in_use = true;
+    q.slots[idx].done = false;
+    q.slots[idx].error = QNN_SUCCESS;
   }
 
-  auto& perf_infra = htp_infra->perfInfra;
-  
-  if (power_config_client_id_ == 0) {
-      if (perf_infra.createPowerConfigId(0, 0, &power_config_client_id_) != QNN_SUCCESS) {
-          std::cerr << "Failed to create power config ID\n";
-          return false;
-      }
+  Qnn_ErrorHandle_t err = qnn->QNN_INTERFACE_VER_NAME.graphExecuteAsync(
+      graph,
+      inputs, num_inputs,
+      outputs, num_outputs,
+      profile,
+      /*signal*/nullptr,
+      AsyncExecNotify,
+      &q.slots[idx]);
+  if (err != QNN_SUCCESS) {
+    {
+      std::lock_guard<std::mutex> lk(q.mu);
+      q.slots[idx].in_use = false;
+    }
+    q.cv.notify_all();
+    if (err != QNN_GRAPH_ERROR_UNSUPPORTED_FEATURE) {
+      // 일시적/실행 오류: 재실행하지 않고 호출자에게 그대로 보고(비동기 경로는 유지)
+      fut.error_ = err;
+      return fut;
+    }
+    // 백엔드가 비동기 실행을 지원하지 않음: 동기 실행으로 폴백하고 이후 제출도 동기 경로 사용
+    AsyncLogger::instance().log(LogLevel::kWarn,
+                                "graphExecuteAsync unsupported (err=%lu), falling back to graphExecute\n",
+                                static_cast<unsigned long>(err));
+    async_enabled_ = false;
+    fut.error_ = graph_execute(graph, inputs, num_inputs, outputs, num_outputs, profile);
+    return fut;
   }
 
-  // 1. DCVS & Power Mode Config (kHtpBurst)
-  QnnHtpPerfInfrastructure_PowerConfig_t power_config;
-  memset(&power_config, 0, sizeof(power_config));
-  power_config.option = QNN_HTP_PERF_INFRASTRUCTURE_POWER_CONFIGOPTION_DCVS_V3;
-  
-  auto& dcvs = power_config.dcvsV3Config;
-  dcvs.contextId = power_config_client_id_;
-  
-  // Upvote common settings
-  dcvs.setSleepDisable = 0; // Executorch sets this to 0 for UpVote
-  dcvs.sleepDisable = 0;    // Irrelevant if setSleepDisable is 0
-  dcvs.setDcvsEnable = 1;
-  dcvs.dcvsEnable = 0;      // kDcvsDisable
-  dcvs.powerMode = QNN_HTP_PERF_INFRASTRUCTURE_POWERMODE_PERFORMANCE_MODE;
-
-  // kHtpBurst specific settings
-  dcvs.setSleepLatency = 1;
-  dcvs.sleepLatency = 40; // kSleepMinLatency
-
-  dcvs.setBusParams = 1;
-  dcvs.busVoltageCornerMin = DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER;
-  dcvs.busVoltageCornerTarget = DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER;
-  dcvs.busVoltageCornerMax = DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER;
-
-  dcvs.setCoreParams = 1;
-  dcvs.coreVoltageCornerMin = DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER;
-  dcvs.coreVoltageCornerTarget = DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER;
-  dcvs.coreVoltageCornerMax = DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER;
-
-  // 2. RPC Control Latency Config
-  QnnHtpPerfInfrastructure_PowerConfig_t rpc_latency_config;
-  memset(&rpc_latency_config, 0, sizeof(rpc_latency_config));
-  rpc_latency_config.option = QNN_HTP_PERF_INFRASTRUCTURE_POWER_CONFIGOPTION_RPC_CONTROL_LATENCY;
-  rpc_latency_config.rpcControlLatencyConfig = 100; // kRpcControlLatency
-
-  // 3. RPC Polling Time Config
-  QnnHtpPerfInfrastructure_PowerConfig_t rpc_polling_config;
-  memset(&rpc_polling_config, 0, sizeof(rpc_polling_config));
-  rpc_polling_config.option = QNN_HTP_PERF_INFRASTRUCTURE_POWER_CONFIGOPTION_RPC_POLLING_TIME;
-  rpc_polling_config.rpcPollingTimeConfig = 9999; // kRpcPollingTimeHighPower
-
-  const QnnHtpPerfInfrastructure_PowerConfig_t* configs[] = {&power_config, &rpc_latency_config, &rpc_polling_config, nullptr};
-  
-  if (perf_infra.setPowerConfig(power_config_client_id_, configs) != QNN_SUCCESS) {
-      std::cerr << "Failed to set HTP power config (Burst Mode)\n";
-      return false;
-  }
-  
-  std::cout << "HTP Performance Mode Enabled (Burst + RPC Polling)\n";
-  return true;
+  fut.queue_ = &q;
+  fut.slot_ = idx;
+  return fut;
 }
 
 } // namespace llm_test
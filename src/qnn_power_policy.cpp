@@ -0,0 +1,343 @@
+#include "qnn_power_policy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace llm_test {
+
+namespace {
+
+int64_t steady_now_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// 프로파일별 DCVS v3 + RPC 설정(Executorch의 kHtpBurst / kHtpHighPerformance / kHtpPowerSaver 대응)
+struct ProfileConfigs {
+  QnnHtpPerfInfrastructure_PowerConfig_t dcvs;
+  QnnHtpPerfInfrastructure_PowerConfig_t rpc_latency;
+  QnnHtpPerfInfrastructure_PowerConfig_t rpc_polling;
+  const QnnHtpPerfInfrastructure_PowerConfig_t* list[4];
+};
+
+void build_configs(HtpPowerProfile profile, uint32_t client_id, ProfileConfigs& out) {
+  std::memset(&out, 0, sizeof(out));
+
+  out.dcvs.option = QNN_HTP_PERF_INFRASTRUCTURE_POWER_CONFIGOPTION_DCVS_V3;
+  auto& dcvs = out.dcvs.dcvsV3Config;
+  dcvs.contextId = client_id;
+  dcvs.setSleepDisable = 0;
+  dcvs.sleepDisable = 0;
+  dcvs.setDcvsEnable = 1;
+  dcvs.setSleepLatency = 1;
+  dcvs.setBusParams = 1;
+  dcvs.setCoreParams = 1;
+
+  QnnHtpPerfInfrastructure_VoltageCorner_t vmin, vtarget, vmax;
+  uint32_t polling = 0;
+  switch (profile) {
+    case HtpPowerProfile::kBurst:
+      // prefill: 최대 클럭, 최소 sleep latency, RPC polling
+      dcvs.dcvsEnable = 0;
+      dcvs.powerMode = QNN_HTP_PERF_INFRASTRUCTURE_POWERMODE_PERFORMANCE_MODE;
+      dcvs.sleepLatency = 40;
+      vmin = vtarget = vmax = DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER;
+      polling = 9999;
+      break;
+    case HtpPowerProfile::kSustained:
+      // decode: TURBO 고정(발열 여유), RPC polling 유지
+      dcvs.dcvsEnable = 0;
+      dcvs.powerMode = QNN_HTP_PERF_INFRASTRUCTURE_POWERMODE_PERFORMANCE_MODE;
+      dcvs.sleepLatency = 100;
+      vmin = vtarget = vmax = DCVS_VOLTAGE_VCORNER_TURBO;
+      polling = 9999;
+      break;
+    case HtpPowerProfile::kRelaxed:
+    default:
+      // idle: DCVS에 맡기고 polling 해제
+      dcvs.dcvsEnable = 1;
+      dcvs.powerMode = QNN_HTP_PERF_INFRASTRUCTURE_POWERMODE_POWER_SAVER_MODE;
+      dcvs.sleepLatency = 1000;
+      vmin = DCVS_VOLTAGE_VCORNER_MIN_VOLTAGE_CORNER;
+      vtarget = DCVS_VOLTAGE_VCORNER_SVS;
+      vmax = DCVS_VOLTAGE_VCORNER_SVS_PLUS;
+      polling = 0;
+      break;
+  }
+  dcvs.busVoltageCornerMin = vmin;
+  dcvs.busVoltageCornerTarget = vtarget;
+  dcvs.busVoltageCornerMax = vmax;
+  dcvs.coreVoltageCornerMin = vmin;
+  dcvs.coreVoltageCornerTarget = vtarget;
+  dcvs.coreVoltageCornerMax = vmax;
+
+  out.rpc_latency.option = QNN_HTP_PERF_INFRASTRUCTURE_POWER_CONFIGOPTION_RPC_CONTROL_LATENCY;
+  out.rpc_latency.rpcControlLatencyConfig = 100;
+
+  out.rpc_polling.option = QNN_HTP_PERF_INFRASTRUCTURE_POWER_CONFIGOPTION_RPC_POLLING_TIME;
+  out.rpc_polling.rpcPollingTimeConfig = polling;
+
+  out.list[0] = &out.dcvs;
+  out.list[1] = &out.rpc_latency;
+  out.list[2] = &out.rpc_polling;
+  out.list[3] = nullptr;
+}
+
+int phase_rank(RunnerPhase phase) {
+  switch (phase) {
+    case RunnerPhase::kPrefill: return 2;
+    case RunnerPhase::kDecode: return 1;
+    default: return 0;
+  }
+}
+
+HtpPowerProfile profile_for_phase(RunnerPhase phase) {
+  switch (phase) {
+    case RunnerPhase::kPrefill: return HtpPowerProfile::kBurst;
+    case RunnerPhase::kDecode: return HtpPowerProfile::kSustained;
+    case RunnerPhase::kIdle:
+    default: return HtpPowerProfile::kRelaxed;
+  }
+}
+
+} // namespace
+
+HtpPerfOps HtpPerfOps::from_infra(const QnnHtpDevice_PerfInfrastructure_t& infra) {
+  HtpPerfOps ops;
+  auto create_fn = infra.createPowerConfigId;
+  auto destroy_fn = infra.destroyPowerConfigId;
+  auto set_fn = infra.setPowerConfig;
+  if (create_fn) {
+    ops.create_power_config_id = [create_fn](uint32_t device_id, uint32_t core_id, uint32_t* client_id) {
+      return create_fn(device_id, core_id, client_id);
+    };
+  }
+  if (destroy_fn) {
+    ops.destroy_power_config_id = [destroy_fn](uint32_t client_id) { return destroy_fn(client_id); };
+  }
+  if (set_fn) {
+    ops.set_power_config = [set_fn](uint32_t client_id, const QnnHtpPerfInfrastructure_PowerConfig_t** configs) {
+      return set_fn(client_id, configs);
+    };
+  }
+  return ops;
+}
+
+const char* power_profile_name(HtpPowerProfile profile) {
+  switch (profile) {
+    case HtpPowerProfile::kBurst: return "burst";
+    case HtpPowerProfile::kSustained: return "sustained";
+    case HtpPowerProfile::kRelaxed: return "relaxed";
+    default: return "none";
+  }
+}
+
+HtpPowerPolicy::~HtpPowerPolicy() { shutdown(); }
+
+bool HtpPowerPolicy::init(HtpPerfOps ops, const Options& options, Clock clock) {
+  shutdown();
+  if (!ops.valid()) return false;
+  ops_ = std::move(ops);
+  options_ = options;
+  clock_ = clock ? std::move(clock) : Clock(steady_now_us);
+
+  if (ops_.create_power_config_id(0, 0, &client_id_) != QNN_SUCCESS) {
+    std::cerr << "Failed to create power config ID\n";
+    client_id_ = 0;
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lk(mu_);
+  initialized_ = true;
+  current_ = HtpPowerProfile::kNone;
+  pending_ = HtpPowerProfile::kNone;
+  phase_ = RunnerPhase::kIdle;
+  voters_.clear();
+  stats_ = Stats{};
+  int64_t now = clock_();
+  applied_at_us_ = accounted_us_ = idle_since_us_ = now;
+  stop_timer_ = false;
+  if (options_.idle_timer_thread) {
+    timer_ = std::thread([this] { timer_loop(); });
+  }
+  return true;
+}
+
+int HtpPowerPolicy::add_voter() {
+  std::lock_guard<std::mutex> lk(mu_);
+  int voter = next_voter_++;
+  voters_[voter] = RunnerPhase::kIdle;
+  return voter;
+}
+
+void HtpPowerPolicy::remove_voter(int voter) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    voters_.erase(voter);
+    if (initialized_) update_phase_locked(clock_());
+  }
+  timer_cv_.notify_one();  // 타이머가 새 deadline으로 다시 대기
+}
+
+void HtpPowerPolicy::on_phase(RunnerPhase phase, int voter) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    voters_[voter] = phase;
+    if (initialized_) update_phase_locked(clock_());
+  }
+  timer_cv_.notify_one();
+}
+
+void HtpPowerPolicy::update_phase_locked(int64_t now) {
+  RunnerPhase phase = RunnerPhase::kIdle;
+  for (const auto& kv : voters_) {
+    if (phase_rank(kv.second) > phase_rank(phase)) phase = kv.second;
+  }
+  bool was_idle = phase_ == RunnerPhase::kIdle;
+  phase_ = phase;
+  if (phase == RunnerPhase::kIdle) {
+    // idle은 즉시 내리지 않고 idle_timeout 이후 tick()에서 relaxed로 전환
+    if (!was_idle) idle_since_us_ = now;
+    pending_ = HtpPowerProfile::kNone;
+    return;
+  }
+  request_locked(profile_for_phase(phase), now);
+}
+
+void HtpPowerPolicy::tick() {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (!initialized_) return;
+  int64_t now = clock_();
+  if (pending_ != HtpPowerProfile::kNone) {
+    request_locked(pending_, now);
+  }
+  if (phase_ == RunnerPhase::kIdle && current_ != HtpPowerProfile::kRelaxed &&
+      now - idle_since_us_ >= static_cast<int64_t>(options_.idle_timeout_ms) * 1000) {
+    apply_locked(HtpPowerProfile::kRelaxed, now);
+  }
+}
+
+// 올리는 전환은 즉시, 내리는 전환은 debounce 이후
+void HtpPowerPolicy::request_locked(HtpPowerProfile target, int64_t now) {
+  if (target == current_) {
+    pending_ = HtpPowerProfile::kNone;
+    return;
+  }
+  bool upgrade = static_cast<int>(target) > static_cast<int>(current_);
+  bool held_long_enough = now - applied_at_us_ >= static_cast<int64_t>(options_.debounce_ms) * 1000;
+  if (upgrade || held_long_enough) {
+    apply_locked(target, now);
+    pending_ = HtpPowerProfile::kNone;
+  } else {
+    if (pending_ != target) stats_.debounced++;
+    pending_ = target;
+  }
+}
+
+bool HtpPowerPolicy::apply_locked(HtpPowerProfile profile, int64_t now) {
+  ProfileConfigs cfg;
+  build_configs(profile, client_id_, cfg);
+  if (ops_.set_power_config(client_id_, cfg.list) != QNN_SUCCESS) {
+    stats_.failures++;
+    std::cerr << "Failed to set HTP power config (" << power_profile_name(profile) << ")\n";
+    return false;
+  }
+  account_locked(now);
+  current_ = profile;
+  applied_at_us_ = now;
+  stats_.switches++;
+  return true;
+}
+
+void HtpPowerPolicy::account_locked(int64_t now) {
+  double ms = (now - accounted_us_) / 1000.0;
+  switch (current_) {
+    case HtpPowerProfile::kBurst: stats_.burst_ms += ms; break;
+    case HtpPowerProfile::kSustained: stats_.sustained_ms += ms; break;
+    case HtpPowerProfile::kRelaxed: stats_.relaxed_ms += ms; break;
+    default: break;
+  }
+  accounted_us_ = now;
+}
+
+HtpPowerProfile HtpPowerPolicy::current() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return current_;
+}
+
+HtpPowerPolicy::Stats HtpPowerPolicy::stats() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  Stats s = stats_;
+  if (!initialized_) return s;
+  // 현재 프로파일의 진행 중인 구간 포함
+  double ms = (clock_() - accounted_us_) / 1000.0;
+  switch (current_) {
+    case HtpPowerProfile::kBurst: s.burst_ms += ms; break;
+    case HtpPowerProfile::kSustained: s.sustained_ms += ms; break;
+    case HtpPowerProfile::kRelaxed: s.relaxed_ms += ms; break;
+    default: break;
+  }
+  return s;
+}
+
+// 다음 평가 시각: 보류된 내림 전환은 debounce 만료, idle이면 idle_timeout 만료(-1 = 없음)
+int64_t HtpPowerPolicy::next_deadline_locked() const {
+  if (!initialized_) return -1;
+  if (pending_ != HtpPowerProfile::kNone) {
+    return applied_at_us_ + static_cast<int64_t>(options_.debounce_ms) * 1000;
+  }
+  if (phase_ == RunnerPhase::kIdle && current_ != HtpPowerProfile::kRelaxed) {
+    return idle_since_us_ + static_cast<int64_t>(options_.idle_timeout_ms) * 1000;
+  }
+  return -1;
+}
+
+// idle 타이머: 다음 deadline까지만 잠들고, 할 일이 없으면(relaxed + 보류 없음) on_phase()/remove_voter() 통지까지 대기
+// - 적용이 실패해 같은 deadline이 다시 나오면 max(10, debounce_ms) 간격으로 재시도
+void HtpPowerPolicy::timer_loop() {
+  const int64_t retry_us = static_cast<int64_t>(std::max(10, options_.debounce_ms)) * 1000;
+  int64_t ticked_deadline = -1;
+  std::unique_lock<std::mutex> lk(mu_);
+  while (!stop_timer_) {
+    int64_t deadline = next_deadline_locked();
+    if (deadline < 0) {
+      timer_cv_.wait(lk);
+      continue;
+    }
+    int64_t wait_us = deadline - clock_();
+    if (wait_us <= 0 && deadline == ticked_deadline) wait_us = retry_us;
+    if (wait_us > 0) {
+      timer_cv_.wait_for(lk, std::chrono::microseconds(wait_us));
+      ticked_deadline = -1;
+      continue;
+    }
+    ticked_deadline = deadline;
+    lk.unlock();
+    tick();
+    lk.lock();
+  }
+}
+
+void HtpPowerPolicy::shutdown() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stop_timer_ = true;
+  }
+  timer_cv_.notify_all();
+  if (timer_.joinable()) timer_.join();
+
+  std::lock_guard<std::mutex> lk(mu_);
+  if (!initialized_) return;
+  account_locked(clock_());
+  if (client_id_ != 0 && ops_.destroy_power_config_id) {
+    ops_.destroy_power_config_id(client_id_);
+  }
+  client_id_ = 0;
+  initialized_ = false;
+  current_ = HtpPowerProfile::kNone;
+}
+
+} // namespace llm_test
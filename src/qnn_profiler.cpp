@@ -0,0 +1,251 @@
+#include "qnn_profiler.h"
+
+#include <QnnInterface.h>
+#include <QnnProfile.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace llm_test {
+
+namespace {
+
+// JSON 문자열 이스케이프(이벤트 식별자에 특수문자가 섞일 수 있음)
+std::string json_escape(const std::string& s) {
+  std::string out;
+  out.reserve(s.size() + 2);
+  for (char c : s) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) out += ' ';
+        else out += c;
+    }
+  }
+  return out;
+}
+
+const char* unit_name(uint32_t unit) {
+  switch (unit) {
+    case QNN_PROFILE_EVENTUNIT_MICROSEC: return "us";
+    case QNN_PROFILE_EVENTUNIT_BYTES: return "bytes";
+    case QNN_PROFILE_EVENTUNIT_CYCLES: return "cycles";
+    case QNN_PROFILE_EVENTUNIT_COUNT: return "count";
+    case QNN_PROFILE_EVENTUNIT_OBJECT: return "object";
+    default: return "backend";
+  }
+}
+
+} // namespace
+
+QnnProfiler::~QnnProfiler() { release(); }
+
+bool QnnProfiler::init(const void* qnn_interface, void* backend, Level level) {
+  release();
+  interface_ = qnn_interface;
+  backend_ = backend;
+  level_ = level;
+  if (level_ == Level::kOff) return true;
+  if (!interface_ || !backend_) {
+    level_ = Level::kOff;
+    return false;
+  }
+  auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_);
+  const auto& api = qnn->QNN_INTERFACE_VER_NAME;
+  if (!api.profileCreate || !api.profileGetEvents || !api.profileGetEventData) {
+    std::cerr << "QNN profiling API not available\n";
+    level_ = Level::kOff;
+    return false;
+  }
+  return true;
+}
+
+Qnn_ProfileHandle_t QnnProfiler::create_handle(const std::string& scope, int shard, const std::string& graph) {
+  if (!enabled()) return nullptr;
+  auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_);
+  const auto& api = qnn->QNN_INTERFACE_VER_NAME;
+  QnnProfile_Level_t lvl = (level_ == Level::kDetailed) ? QNN_PROFILE_LEVEL_DETAILED
+                                                        : QNN_PROFILE_LEVEL_BASIC;
+  Qnn_ProfileHandle_t handle = nullptr;
+  if (api.profileCreate(reinterpret_cast<Qnn_BackendHandle_t>(backend_), lvl, &handle) != QNN_SUCCESS ||
+      !handle) {
+    std::cerr << "profileCreate failed for scope " << scope << "\n";
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lk(mu_);
+  Scope& s = scopes_[handle];
+  s.name = scope;
+  s.shard = shard;
+  s.graph = graph;
+  order_.push_back(handle);
+  return handle;
+}
+
+void QnnProfiler::read_event(uint64_t event_id, bool is_node, Scope& scope, Invocation& inv) {
+  auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_);
+  const auto& api = qnn->QNN_INTERFACE_VER_NAME;
+
+  QnnProfile_EventData_t data {};
+  if (api.profileGetEventData(event_id, &data) != QNN_SUCCESS) return;
+
+  TraceEvent ev;
+  ev.name = data.identifier ? data.identifier : "unknown";
+  ev.value = data.value;
+  ev.unit = data.unit;
+  ev.is_node = is_node;
+
+  EventStat& st = scope.events[(is_node ? "node:" : "") + ev.name];
+  st.unit = data.unit;
+  st.total += data.value;
+  st.count += 1;
+  inv.events.push_back(std::move(ev));
+
+  // detailed 모드: op 단위 하위 이벤트
+  if (level_ == Level::kDetailed && !is_node && api.profileGetSubEvents) {
+    const QnnProfile_EventId_t* subs = nullptr;
+    uint32_t num_subs = 0;
+    if (api.profileGetSubEvents(event_id, &subs, &num_subs) == QNN_SUCCESS && subs) {
+      for (uint32_t i = 0; i < num_subs; ++i) read_event(subs[i], true, scope, inv);
+    }
+  }
+}
+
+void QnnProfiler::collect(Qnn_ProfileHandle_t handle, int64_t host_start_us, int64_t host_end_us) {
+  if (!enabled() || !handle) return;
+  auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_);
+  const auto& api = qnn->QNN_INTERFACE_VER_NAME;
+
+  std::lock_guard<std::mutex> lk(mu_);
+  auto it = scopes_.find(handle);
+  if (it == scopes_.end()) return;
+  Scope& scope = it->second;
+
+  const QnnProfile_EventId_t* events = nullptr;
+  uint32_t num_events = 0;
+  if (api.profileGetEvents(handle, &events, &num_events) != QNN_SUCCESS) return;
+
+  // 백엔드가 실행마다 이벤트를 누적하면 새 이벤트만, 초기화하면 전부 읽는다
+  uint32_t begin = (num_events >= scope.consumed) ? scope.consumed : 0;
+
+  Invocation inv;
+  inv.host_start_us = host_start_us;
+  inv.host_end_us = host_end_us;
+  for (uint32_t i = begin; i < num_events && events; ++i) {
+    read_event(events[i], false, scope, inv);
+  }
+  scope.consumed = num_events;
+  scope.host_total_us += static_cast<uint64_t>(std::max<int64_t>(0, host_end_us - host_start_us));
+  scope.invocations.push_back(std::move(inv));
+}
+
+bool QnnProfiler::write_summary_json(const std::string& path) const {
+  std::ofstream ofs(path);
+  if (!ofs) return false;
+  std::lock_guard<std::mutex> lk(mu_);
+
+  ofs << "{\n  \"level\": \"" << (level_ == Level::kDetailed ? "detailed" : "basic") << "\",\n";
+  ofs << "  \"scopes\": [\n";
+  for (size_t i = 0; i < order_.size(); ++i) {
+    const Scope& s = scopes_.at(order_[i]);
+    size_t n = s.invocations.size();
+    ofs << "    {\"scope\": \"" << json_escape(s.name) << "\""
+        << ", \"shard\": " << s.shard
+        << ", \"graph\": \"" << json_escape(s.graph) << "\""
+        << ", \"invocations\": " << n
+        << ", \"host_total_us\": " << s.host_total_us
+        << ", \"host_avg_us\": " << (n ? static_cast<double>(s.host_total_us) / n : 0.0)
+        << ", \"events\": {";
+    bool first = true;
+    for (const auto& kv : s.events) {
+      const EventStat& st = kv.second;
+      ofs << (first ? "" : ", ") << "\"" << json_escape(kv.first) << "\": {"
+          << "\"unit\": \"" << unit_name(st.unit) << "\""
+          << ", \"total\": " << st.total
+          << ", \"count\": " << st.count
+          << ", \"avg\": " << (st.count ? static_cast<double>(st.total) / st.count : 0.0)
+          << "}";
+      first = false;
+    }
+    ofs << "}}" << (i + 1 < order_.size() ? "," : "") << "\n";
+  }
+  ofs << "  ]\n}\n";
+  return static_cast<bool>(ofs);
+}
+
+bool QnnProfiler::write_chrome_trace(const std::string& path) const {
+  std::ofstream ofs(path);
+  if (!ofs) return false;
+  std::lock_guard<std::mutex> lk(mu_);
+
+  // 실행 구간은 host 측 제출~완료 시간으로 배치하고(tid=샤드),
+  // 마이크로초 단위 하위 이벤트는 해당 구간 안에 순서대로 쌓는다(QNN은 시작 시각을 주지 않음)
+  ofs << "{\"traceEvents\": [\n";
+  bool first = true;
+  auto emit = [&](const std::string& name, const std::string& cat, int tid,
+                  int64_t ts, int64_t dur, const std::string& args) {
+    ofs << (first ? "" : ",\n")
+        << "{\"name\": \"" << json_escape(name) << "\", \"cat\": \"" << cat << "\""
+        << ", \"ph\": \"X\", \"pid\": 0, \"tid\": " << tid
+        << ", \"ts\": " << ts << ", \"dur\": " << std::max<int64_t>(dur, 0);
+    if (!args.empty()) ofs << ", \"args\": {" << args << "}";
+    ofs << "}";
+    first = false;
+  };
+
+  for (Qnn_ProfileHandle_t h : order_) {
+    const Scope& s = scopes_.at(h);
+    int tid = s.shard >= 0 ? s.shard : 1000;
+    for (const auto& inv : s.invocations) {
+      emit(s.name, "host", tid, inv.host_start_us, inv.host_end_us - inv.host_start_us, "");
+      int64_t cursor = inv.host_start_us;
+      for (const auto& ev : inv.events) {
+        std::string args = "\"value\": " + std::to_string(ev.value) +
+                           ", \"unit\": \"" + unit_name(ev.unit) + "\"";
+        if (ev.unit == QNN_PROFILE_EVENTUNIT_MICROSEC && ev.is_node) {
+          emit(ev.name, "op", tid, cursor, static_cast<int64_t>(ev.value), args);
+          cursor += static_cast<int64_t>(ev.value);
+        } else if (ev.unit == QNN_PROFILE_EVENTUNIT_MICROSEC) {
+          emit(ev.name, "qnn", tid, inv.host_start_us, static_cast<int64_t>(ev.value), args);
+        }
+      }
+    }
+  }
+  ofs << "\n], \"displayTimeUnit\": \"ms\"}\n";
+  return static_cast<bool>(ofs);
+}
+
+void QnnProfiler::print_summary() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  std::cout << "\n========== QNN Profile Summary ==========\n";
+  for (Qnn_ProfileHandle_t h : order_) {
+    const Scope& s = scopes_.at(h);
+    size_t n = s.invocations.size();
+    if (n == 0) continue;
+    std::cout << "  " << std::left << std::setw(28) << s.name << std::right
+              << " calls=" << std::setw(5) << n
+              << " host_avg=" << std::fixed << std::setprecision(3)
+              << (static_cast<double>(s.host_total_us) / n / 1000.0) << " ms\n";
+    std::cout.unsetf(std::ios::floatfield);
+  }
+  std::cout << "=========================================\n";
+}
+
+void QnnProfiler::release() {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (interface_) {
+    auto qnn = reinterpret_cast<const QnnInterface_t*>(interface_);
+    const auto& api = qnn->QNN_INTERFACE_VER_NAME;
+    if (api.profileFree) {
+      for (Qnn_ProfileHandle_t h : order_) api.profileFree(h);
+    }
+  }
+  scopes_.clear();
+  order_.clear();
+}
+
+} // namespace llm_test
@@ -35,6 +35,20 @@ static bool parse_uint(const std::string& s, size_t& pos, uint64_t& v) {
   return true;
 }
 
+// 부호 있는 정수(양자화 offset은 보통 음수, 예: -128)
+static bool parse_int(const std::string& s, size_t& pos, int64_t& v) {
+  size_t p = s.find_first_of("-0123456789", pos);
+  if (p == std::string::npos) return false;
+  bool neg = s[p] == '-';
+  size_t q = neg ? p + 1 : p;
+  if (q >= s.size() || s[q] < '0' || s[q] > '9') return false;
+  uint64_t mag = 0;
+  if (!parse_uint(s, q, mag)) return false;
+  v = neg ? -static_cast<int64_t>(mag) : static_cast<int64_t>(mag);
+  pos = q;
+  return true;
+}
+
 static bool parse_float(const std::string& s, size_t& pos, double& out) {
   size_t p = s.find_first_of("-0123456789", pos);
   if (p == std::string::npos) return false;
@@ -214,7 +228,7 @@ static bool parse_tensor_object(const std::string& obj, QnnJsonTensorDesc& td) {
     }
     size_t po = pq;
     if (find_next(obj, po, "\"offset\"") && find_next(obj, po, ":")) {
-      uint64_t iv = 0; if (parse_uint(obj, po, iv)) td.quant_offset = static_cast<int32_t>(iv);
+      int64_t iv = 0; if (parse_int(obj, po, iv)) td.quant_offset = static_cast<int32_t>(iv);
     }
     // per-axis
     size_t pax = pq;
@@ -237,7 +251,7 @@ static bool parse_tensor_object(const std::string& obj, QnnJsonTensorDesc& td) {
       size_t lb = obj.find('[', pofs); size_t rb = 0; if (match_bracket(obj, lb, rb)) {
         size_t cur = lb + 1;
         while (cur < rb) {
-          uint64_t iv = 0; size_t tmp = cur; if (!parse_uint(obj, tmp, iv)) break; td.quant_offsets.push_back(static_cast<int32_t>(iv));
+          int64_t iv = 0; size_t tmp = cur; if (!parse_int(obj, tmp, iv)) break; td.quant_offsets.push_back(static_cast<int32_t>(iv));
           size_t comma = obj.find(',', tmp); if (comma == std::string::npos || comma > rb) { cur = rb; break; }
           cur = comma + 1;
         }
@@ -0,0 +1,87 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace llm_test {
+
+ThreadPool::ThreadPool(size_t num_threads) {
+  if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+  workers_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back([this] { worker_loop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stop_ = true;
+  }
+  cv_task_.notify_all();
+  for (auto& t : workers_) {
+    if (t.joinable()) t.join();
+  }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    tasks_.push_back(std::move(task));
+  }
+  cv_task_.notify_one();
+}
+
+void ThreadPool::wait_idle() {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_idle_.wait(lk, [&] { return tasks_.empty() && active_ == 0; });
+}
+
+// 작업을 하나씩 꺼내 실행. stop_이어도 남은 작업은 끝까지 처리
+void ThreadPool::worker_loop() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lk(mu_);
+      cv_task_.wait(lk, [&] { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty()) return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+      ++active_;
+    }
+    task();
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      --active_;
+      if (tasks_.empty() && active_ == 0) cv_idle_.notify_all();
+    }
+  }
+}
+
+void ByteBudget::acquire(uint64_t bytes) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (limit_ > 0) {
+    cv_.wait(lk, [&] { return in_use_ == 0 || in_use_ + bytes <= limit_; });
+  }
+  in_use_ += bytes;
+  peak_ = std::max(peak_, in_use_);
+}
+
+void ByteBudget::release(uint64_t bytes) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    in_use_ -= std::min(in_use_, bytes);
+  }
+  cv_.notify_all();
+}
+
+uint64_t ByteBudget::in_use() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return in_use_;
+}
+
+uint64_t ByteBudget::peak() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return peak_;
+}
+
+} // namespace llm_test
@@ -74,6 +74,24 @@ std::string LlamaTokenizer::decode(const std::vector<int32_t>& tokens, bool spec
   return out;
 }
 
+size_t LlamaTokenizer::decode_token(int32_t token, std::string& out, bool special) {
+  std::lock_guard<std::mutex> lk(g_tok_mu);
+  if (!model_) return 0;
+  const llama_vocab* vocab = llama_model_get_vocab(reinterpret_cast<llama_model*>(model_));
+  // piece는 대부분 수~수십 바이트: 스택 버퍼로 충분(넘치면 out에 직접 재시도)
+  char buf[128];
+  int32_t n = llama_token_to_piece(vocab, (llama_token)token, buf, (int32_t)sizeof(buf), 0, special);
+  if (n >= 0) {
+    out.append(buf, (size_t)n);
+    return (size_t)n;
+  }
+  size_t base = out.size();
+  out.resize(base + (size_t)(-n));
+  n = llama_token_to_piece(vocab, (llama_token)token, &out[base], -n, 0, special);
+  out.resize(base + (size_t)std::max(0, n));
+  return out.size() - base;
+}
+
 std::string format_llama32_prompt(const std::string& user, const std::string& system) {
   std::string s;
   if (!system.empty()) {
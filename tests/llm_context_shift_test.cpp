@@ -0,0 +1,137 @@
+/**
+ * @file llm_context_shift_test.cpp
+ * @brief Context shift only runs when every shifted key can be re-rotated
+ *
+ * Generates past the KV capacity and feeds an over-long prompt through a
+ * single-context runner on the stub QNN backend. With params.json and a
+ * per-tensor encoding on every K input the cache is shifted; without
+ * params.json, with per-axis K encodings or with no K encodings at all the
+ * runner must behave as with context_shift = false: decode stops at a full
+ * cache and the long prompt is rejected.
+ *
+ * Usage: llm_context_shift_test <libqnn_stub_backend.so>
+ */
+
+#include "stub_model.h"
+
+#include "llm_decode_runner.h"
+
+#include <cstdio>
+#include <string>
+
+namespace {
+
+using llm_test::LLMDecodeConfig;
+using llm_test::LLMDecodeRunner;
+using llm_test::StubModelSpec;
+
+// Stub model: context 128, prefill chunk 16 (112 prefill positions), decode cache 127
+constexpr int kMaxGenTokens = 200;
+const std::string kShortPrompt = "short prompt";
+const std::string kLongPrompt(150, 'x');
+
+struct Case {
+  const char* name;
+  std::string k_encoding;
+  bool params;
+  bool context_shift;
+  bool expect_shift;
+  const char* long_prompt_error;  // Expected error substring when the shift is not used
+};
+
+bool run_case(const std::string& backend_so, const Case& c) {
+  const std::string dir = llm_test::make_temp_dir("llm_context_shift");
+  if (dir.empty()) {
+    std::fprintf(stderr, "[%s] failed to create a temp dir\n", c.name);
+    return false;
+  }
+  StubModelSpec spec;
+  spec.k_encoding = c.k_encoding;
+  // Without params.json the runner infers heads from the graph assuming 16 layers
+  if (!c.params) spec.n_layers = 16;
+  std::string error;
+  if (!llm_test::write_stub_model(dir, spec, 0, error)) {
+    std::fprintf(stderr, "[%s] %s\n", c.name, error.c_str());
+    llm_test::remove_stub_model(dir);
+    return false;
+  }
+
+  LLMDecodeConfig config;
+  config.ctx_dir = dir;
+  config.backend_so = backend_so;
+  config.system_so = backend_so;
+  if (c.params) config.params_path = dir + "/params.json";
+  config.power_policy = "off";
+  config.context_shift = c.context_shift;
+  config.max_gen_tokens = kMaxGenTokens;
+
+  bool ok = true;
+  LLMDecodeRunner runner(config);
+  if (!runner.initialize()) {
+    std::fprintf(stderr, "[%s] initialize failed: %s\n", c.name, runner.get_error().c_str());
+    ok = false;
+  }
+
+  // Decode past the cache: shift, or stop at the capacity
+  std::string output;
+  if (ok && !runner.generate(kShortPrompt, output)) {
+    std::fprintf(stderr, "[%s] generate failed: %s\n", c.name, runner.get_error().c_str());
+    ok = false;
+  }
+  if (ok) {
+    const auto& stats = runner.get_stats();
+    const bool shifted = stats.context_shifts > 0;
+    if (shifted != c.expect_shift || (shifted && !stats.context_shift_rotated)) {
+      std::fprintf(stderr, "[%s] decode: %lld shifts (rotated %d), expected %s\n", c.name,
+                   static_cast<long long>(stats.context_shifts), stats.context_shift_rotated,
+                   c.expect_shift ? "re-rotated shifts" : "none");
+      ok = false;
+    }
+    if (!c.expect_shift && stats.num_generated_tokens >= kMaxGenTokens) {
+      std::fprintf(stderr, "[%s] decode did not stop at the full cache\n", c.name);
+      ok = false;
+    }
+  }
+
+  // Prompt longer than the prefill cache
+  if (ok) {
+    const bool generated = runner.generate(kLongPrompt, output);
+    if (c.expect_shift && !generated) {
+      std::fprintf(stderr, "[%s] long prompt failed: %s\n", c.name, runner.get_error().c_str());
+      ok = false;
+    } else if (!c.expect_shift &&
+               (generated || runner.get_error().find(c.long_prompt_error) == std::string::npos)) {
+      std::fprintf(stderr, "[%s] long prompt: expected \"%s\", got %s\n", c.name,
+                   c.long_prompt_error, generated ? "success" : runner.get_error().c_str());
+      ok = false;
+    }
+  }
+
+  llm_test::remove_stub_model(dir);
+  std::printf("[%s] %s\n", c.name, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "Usage: %s <libqnn_stub_backend.so>\n", argv[0]);
+    return 2;
+  }
+  const std::string backend_so = argv[1];
+  const char* kUnrotatable = "shifted keys cannot be re-rotated";
+
+  const Case cases[] = {
+      {"per-tensor K", "tensor", true, true, true, ""},
+      {"no params.json", "tensor", false, true, false, kUnrotatable},
+      {"per-axis K", "axis", true, true, false, kUnrotatable},
+      {"no K encoding", "", true, true, false, kUnrotatable},
+      {"shift disabled", "tensor", true, false, false, "context shifting is disabled"},
+  };
+  bool ok = true;
+  for (const Case& c : cases) ok = run_case(backend_so, c) && ok;
+
+  std::printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
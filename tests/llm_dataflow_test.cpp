@@ -0,0 +1,176 @@
+/**
+ * @file llm_dataflow_test.cpp
+ * @brief Zero-copy shard dataflow binds the same bytes as the copy path
+ *
+ * Runs the same prompt and decode steps through a multi-context runner twice,
+ * with zero_copy_dataflow on and off (--copy_dataflow), while the stub QNN
+ * backend records a hash of every graph input and output. Hidden state, ROPE
+ * and mask edges between shards must feed each graph identical bytes, so the
+ * two traces must match entry for entry.
+ *
+ * Usage: llm_dataflow_test <libqnn_stub_backend.so>
+ */
+
+#include "runner_test_access.h"
+#include "stub_model.h"
+#include "stub_qnn_backend.h"
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+using llm_test::LLMDecodeConfig;
+using llm_test::LLMDecodeRunner;
+using llm_test::LLMDecodeRunnerTestAccess;
+
+constexpr int kNumShards = 2;
+constexpr int kPromptTokens = 20;  // Two prefill chunks
+constexpr int kDecodeSteps = 8;
+constexpr size_t kTraceCapacity = 16384;
+
+// Trace API of the stub backend the runner dlopen'ed
+struct StubBackendControl {
+  void (*trace_start)(size_t) = nullptr;
+  void (*trace_stop)() = nullptr;
+  size_t (*trace_size)() = nullptr;
+  bool (*trace_overflow)() = nullptr;
+  const QnnStubTraceEntry* (*trace_data)() = nullptr;
+
+  bool open(const std::string& backend_so) {
+    void* handle = dlopen(backend_so.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) return false;
+    // The handle stays open so the library outlives every runner session
+    trace_start = reinterpret_cast<void (*)(size_t)>(dlsym(handle, "qnn_stub_trace_start"));
+    trace_stop = reinterpret_cast<void (*)()>(dlsym(handle, "qnn_stub_trace_stop"));
+    trace_size = reinterpret_cast<size_t (*)()>(dlsym(handle, "qnn_stub_trace_size"));
+    trace_overflow = reinterpret_cast<bool (*)()>(dlsym(handle, "qnn_stub_trace_overflow"));
+    trace_data = reinterpret_cast<const QnnStubTraceEntry* (*)()>(
+        dlsym(handle, "qnn_stub_trace_data"));
+    return trace_start && trace_stop && trace_size && trace_overflow && trace_data;
+  }
+};
+
+bool run_traced(const StubBackendControl& stub, const std::string& backend_so,
+                const std::string& dir, bool zero_copy, std::vector<QnnStubTraceEntry>& trace) {
+  const char* label = zero_copy ? "dataflow" : "copy";
+  LLMDecodeConfig config;
+  config.ctx_dir = dir;
+  config.backend_so = backend_so;
+  config.system_so = backend_so;
+  config.params_path = dir + "/params.json";
+  config.use_multi_context = true;
+  config.num_shards = kNumShards;
+  config.power_policy = "off";
+  config.zero_copy_dataflow = zero_copy;
+  config.max_gen_tokens = kDecodeSteps + 1;
+
+  LLMDecodeRunner runner(config);
+  if (!runner.initialize()) {
+    std::fprintf(stderr, "[%s] initialize failed: %s\n", label, runner.get_error().c_str());
+    return false;
+  }
+  if (LLMDecodeRunnerTestAccess::dataflow(runner) != zero_copy) {
+    std::fprintf(stderr, "[%s] runner did not %s zero-copy dataflow\n", label,
+                 zero_copy ? "enable" : "disable");
+    return false;
+  }
+
+  std::vector<int32_t> tokens;
+  tokens.push_back(128000);
+  for (int i = 1; i < kPromptTokens; ++i) tokens.push_back(2000 + 7 * i);
+
+  stub.trace_start(kTraceCapacity);
+  int32_t next_token = 0;
+  int32_t n_past = 0;
+  bool ok = LLMDecodeRunnerTestAccess::prefill(runner, tokens, next_token, n_past);
+  for (int i = 0; ok && i < kDecodeSteps; ++i, ++n_past) {
+    int32_t token_out = 0;
+    ok = LLMDecodeRunnerTestAccess::decode_step(runner, next_token, n_past, token_out, nullptr);
+    next_token = token_out;
+  }
+  LLMDecodeRunnerTestAccess::sync_kv_writeback(runner);
+  stub.trace_stop();
+
+  if (!ok) {
+    std::fprintf(stderr, "[%s] run failed: %s\n", label, runner.get_error().c_str());
+    return false;
+  }
+  if (stub.trace_overflow()) {
+    std::fprintf(stderr, "[%s] trace overflow (capacity %zu)\n", label, kTraceCapacity);
+    return false;
+  }
+  trace.assign(stub.trace_data(), stub.trace_data() + stub.trace_size());
+  std::printf("[%s] %zu tensor records\n", label, trace.size());
+  return !trace.empty();
+}
+
+bool same_record(const QnnStubTraceEntry& a, const QnnStubTraceEntry& b, uint64_t a0, uint64_t b0) {
+  return a.exec - a0 == b.exec - b0 && a.context_id == b.context_id &&
+         a.is_output == b.is_output && std::strcmp(a.graph, b.graph) == 0 &&
+         std::strcmp(a.tensor, b.tensor) == 0 && a.nbytes == b.nbytes && a.hash == b.hash;
+}
+
+void print_record(const char* label, const QnnStubTraceEntry& e, uint64_t e0) {
+  std::fprintf(stderr, "  %-8s exec %llu shard %d %s %s %s: %llu bytes, hash %016llx\n", label,
+               static_cast<unsigned long long>(e.exec - e0), e.context_id, e.graph,
+               e.is_output ? "output" : "input", e.tensor,
+               static_cast<unsigned long long>(e.nbytes), static_cast<unsigned long long>(e.hash));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "Usage: %s <libqnn_stub_backend.so>\n", argv[0]);
+    return 2;
+  }
+  const std::string backend_so = argv[1];
+  StubBackendControl stub;
+  if (!stub.open(backend_so)) {
+    std::fprintf(stderr, "Failed to load the stub backend trace API: %s\n", backend_so.c_str());
+    return 1;
+  }
+
+  const std::string dir = llm_test::make_temp_dir("llm_dataflow");
+  if (dir.empty()) {
+    std::fprintf(stderr, "Failed to create a temp dir\n");
+    return 1;
+  }
+  std::string error;
+  bool ok = llm_test::write_stub_model(dir, llm_test::StubModelSpec{}, kNumShards, error);
+  if (!ok) std::fprintf(stderr, "%s\n", error.c_str());
+
+  std::vector<QnnStubTraceEntry> dataflow_trace, copy_trace;
+  ok = ok && run_traced(stub, backend_so, dir, true, dataflow_trace) &&
+       run_traced(stub, backend_so, dir, false, copy_trace);
+  llm_test::remove_stub_model(dir);
+
+  if (ok) {
+    const uint64_t d0 = dataflow_trace.front().exec;
+    const uint64_t c0 = copy_trace.front().exec;
+    const size_t n = std::min(dataflow_trace.size(), copy_trace.size());
+    for (size_t i = 0; i < n; ++i) {
+      if (!same_record(dataflow_trace[i], copy_trace[i], d0, c0)) {
+        std::fprintf(stderr, "Traces diverge at record %zu:\n", i);
+        print_record("dataflow", dataflow_trace[i], d0);
+        print_record("copy", copy_trace[i], c0);
+        ok = false;
+        break;
+      }
+    }
+    if (ok && dataflow_trace.size() != copy_trace.size()) {
+      std::fprintf(stderr, "Trace lengths differ: dataflow %zu, copy %zu\n",
+                   dataflow_trace.size(), copy_trace.size());
+      ok = false;
+    }
+  }
+
+  std::printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,305 @@
+/**
+ * @file llm_decode_alloc_test.cpp
+ * @brief Warm decode steps must not touch the heap
+ *
+ * Runs LLMDecodeRunner against the stub QNN backend (tests/stub_qnn_backend.cpp)
+ * in single- and multi-context mode: prefill, a few warm-up decode steps, then
+ * counts every malloc/calloc/realloc/aligned allocation and operator new (any
+ * thread) over the measured steps. Any allocation fails the test.
+ *
+ * Usage: llm_decode_alloc_test <libqnn_stub_backend.so>
+ */
+
+#include "runner_test_access.h"
+#include "stub_model.h"
+
+#include "stub_qnn_backend.h"
+
+#include <dlfcn.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+// ===== Counting allocator =====
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace {
+
+std::atomic<bool> g_counting{false};
+std::atomic<uint64_t> g_allocs{0};
+std::atomic<uint64_t> g_alloc_bytes{0};
+std::atomic<uint64_t> g_frees{0};
+
+inline void note_alloc(size_t size) {
+  if (g_counting.load(std::memory_order_relaxed)) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+}
+
+inline void note_free(void* ptr) {
+  if (ptr && g_counting.load(std::memory_order_relaxed)) {
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+} // namespace
+
+extern "C" {
+
+void* malloc(size_t size) {
+  note_alloc(size);
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+  note_alloc(n * size);
+  return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+  note_alloc(size);
+  return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+  note_free(ptr);
+  __libc_free(ptr);
+}
+
+void* memalign(size_t alignment, size_t size) {
+  note_alloc(size);
+  return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+  note_alloc(size);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+  if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) return EINVAL;
+  note_alloc(size);
+  void* p = __libc_memalign(alignment, size);
+  if (!p) return ENOMEM;
+  *out = p;
+  return 0;
+}
+
+} // extern "C"
+
+void* operator new(size_t size) {
+  void* p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return malloc(size ? size : 1); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return malloc(size ? size : 1); }
+void* operator new(size_t size, std::align_val_t al) {
+  void* p = aligned_alloc(static_cast<size_t>(al), size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size, std::align_val_t al) { return operator new(size, al); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+  return aligned_alloc(static_cast<size_t>(al), size ? size : 1);
+}
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+  return aligned_alloc(static_cast<size_t>(al), size ? size : 1);
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { free(p); }
+
+// ===== Test =====
+
+namespace {
+
+using llm_test::LLMDecodeConfig;
+using llm_test::LLMDecodeRunner;
+using llm_test::LLMDecodeRunnerTestAccess;
+
+constexpr int kPromptTokens = 20;   // Two prefill chunks: rearrange path, not zero-KV
+constexpr int kWarmupSteps = 8;
+constexpr int kMeasuredSteps = 32;
+constexpr size_t kReservedBytesPerToken = 16;
+
+// Keeps the self-check allocation from being optimized away
+void* volatile g_probe = nullptr;
+
+// The interposer must see allocations made by this binary, or a pass means nothing
+bool interposer_live() {
+  g_allocs.store(0);
+  g_counting.store(true);
+  g_probe = new char[64];
+  delete[] static_cast<char*>(g_probe);
+  g_probe = std::malloc(64);
+  std::free(g_probe);
+  g_counting.store(false);
+  return g_allocs.load() == 2;
+}
+
+// Execution counter of the stub backend the runner dlopen'ed
+uint64_t stub_executions(const std::string& backend_so) {
+  void* handle = dlopen(backend_so.c_str(), RTLD_NOW | RTLD_NOLOAD);
+  if (!handle) return 0;
+  auto fn = reinterpret_cast<uint64_t (*)()>(dlsym(handle, "qnn_stub_executions"));
+  uint64_t n = fn ? fn() : 0;
+  dlclose(handle);
+  return n;
+}
+
+bool run_case(const std::string& backend_so, bool multi_context) {
+  const char* label = multi_context ? "multi-context" : "single-context";
+  const std::string dir = llm_test::make_temp_dir("llm_decode_alloc");
+  if (dir.empty()) {
+    std::fprintf(stderr, "[%s] failed to create a temp dir\n", label);
+    return false;
+  }
+  struct RemoveOnExit {
+    std::string dir;
+    ~RemoveOnExit() { llm_test::remove_stub_model(dir); }
+  } cleanup{dir};
+
+  std::string error;
+  if (!llm_test::write_stub_model(dir, llm_test::StubModelSpec{}, multi_context ? 2 : 0, error)) {
+    std::fprintf(stderr, "[%s] %s\n", label, error.c_str());
+    return false;
+  }
+
+  LLMDecodeConfig config;
+  config.ctx_dir = dir;
+  config.backend_so = backend_so;
+  config.system_so = backend_so;
+  config.params_path = dir + "/params.json";
+  config.use_multi_context = multi_context;
+  config.num_shards = multi_context ? 2 : 0;
+  config.power_policy = "off";
+  config.max_gen_tokens = kWarmupSteps + kMeasuredSteps + 1;
+
+  LLMDecodeRunner runner(config);
+  if (!runner.initialize()) {
+    std::fprintf(stderr, "[%s] initialize failed: %s\n", label, runner.get_error().c_str());
+    return false;
+  }
+
+  std::vector<int32_t> tokens;
+  tokens.push_back(128000);
+  for (int i = 1; i < kPromptTokens; ++i) tokens.push_back(1000 + i);
+  int32_t next_token = 0;
+  int32_t n_past = 0;
+  if (!LLMDecodeRunnerTestAccess::prefill(runner, tokens, next_token, n_past)) {
+    std::fprintf(stderr, "[%s] prefill failed: %s\n", label, runner.get_error().c_str());
+    return false;
+  }
+
+  // Same host work generate() overlaps with each step: detokenize the previous token
+  llm_test::LlamaTokenizer tokenizer;
+  std::string output_text;
+  output_text.reserve(static_cast<size_t>(config.max_gen_tokens) * kReservedBytesPerToken);
+  std::string decoded;
+  decoded.reserve(kReservedBytesPerToken);
+  int32_t pending_token = -1;
+  std::function<void()> emit_pending = [&]() {
+    if (pending_token < 0) return;
+    decoded.clear();
+    tokenizer.decode_token(pending_token, decoded);
+    output_text += decoded;
+    pending_token = -1;
+  };
+
+  auto step = [&]() {
+    int32_t token_out = 0;
+    if (n_past >= LLMDecodeRunnerTestAccess::kv_cache_len(runner)) return false;
+    if (!LLMDecodeRunnerTestAccess::decode_step(runner, next_token, n_past, token_out,
+                                                &emit_pending)) {
+      return false;
+    }
+    pending_token = token_out;
+    next_token = token_out;
+    ++n_past;
+    return true;
+  };
+
+  for (int i = 0; i < kWarmupSteps; ++i) {
+    if (!step()) {
+      std::fprintf(stderr, "[%s] warm-up decode step %d failed: %s\n", label, i,
+                   runner.get_error().c_str());
+      return false;
+    }
+  }
+  LLMDecodeRunnerTestAccess::sync_kv_writeback(runner);
+
+  const uint64_t executions_before = stub_executions(backend_so);
+  g_allocs.store(0);
+  g_alloc_bytes.store(0);
+  g_frees.store(0);
+  g_counting.store(true);
+  bool ok = true;
+  int done = 0;
+  for (; done < kMeasuredSteps && ok; ++done) ok = step();
+  LLMDecodeRunnerTestAccess::sync_kv_writeback(runner);
+  g_counting.store(false);
+
+  if (!ok) {
+    std::fprintf(stderr, "[%s] decode step %d failed: %s\n", label, done - 1,
+                 runner.get_error().c_str());
+    return false;
+  }
+  // One graph execution per shard per step must have reached the stub backend
+  const uint64_t executions = stub_executions(backend_so) - executions_before;
+  const uint64_t expected = static_cast<uint64_t>(kMeasuredSteps) * (multi_context ? 2 : 1);
+  if (executions != expected) {
+    std::fprintf(stderr, "[%s] stub backend ran %llu graphs, expected %llu\n", label,
+                 static_cast<unsigned long long>(executions),
+                 static_cast<unsigned long long>(expected));
+    return false;
+  }
+  const uint64_t allocs = g_allocs.load();
+  std::printf("[%s] %d warm decode steps: %llu allocations (%llu bytes), %llu frees\n", label,
+              kMeasuredSteps, static_cast<unsigned long long>(allocs),
+              static_cast<unsigned long long>(g_alloc_bytes.load()),
+              static_cast<unsigned long long>(g_frees.load()));
+  return allocs == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "Usage: %s <libqnn_stub_backend.so>\n", argv[0]);
+    return 2;
+  }
+  const std::string backend_so = argv[1];
+  if (!interposer_live()) {
+    std::fprintf(stderr, "Allocation interposer is not active\n");
+    return 1;
+  }
+  bool ok = true;
+  ok = run_case(backend_so, false) && ok;
+  ok = run_case(backend_so, true) && ok;
+  std::printf("%s\n", ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,250 @@
+/**
+ * @file qnn_power_policy_test.cpp
+ * @brief HtpPowerPolicy transitions, debounce, idle timeout and accounting
+ *
+ * Drives the policy through a recording HtpPerfOps and a manual clock
+ * (idle_timer_thread = false, tick() called by hand), so no HTP device is
+ * involved. test_timer_thread() alone uses the real timer thread and clock.
+ */
+
+#include "qnn_power_policy.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using llm_test::HtpPerfOps;
+using llm_test::HtpPowerPolicy;
+using llm_test::HtpPowerProfile;
+using llm_test::RunnerPhase;
+
+int g_failures = 0;
+
+#define CHECK(cond)                                                          \
+  do {                                                                       \
+    if (!(cond)) {                                                           \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+      ++g_failures;                                                          \
+    }                                                                        \
+  } while (0)
+
+constexpr int kDebounceMs = 50;
+constexpr int kIdleTimeoutMs = 2000;
+
+// Recording fake of the HTP perf infrastructure
+struct FakePerf {
+  std::vector<uint32_t> dcvs_corners;  // coreVoltageCornerTarget of every setPowerConfig
+  int created = 0;
+  int destroyed = 0;
+  bool fail_next_set = false;
+
+  HtpPerfOps ops() {
+    HtpPerfOps ops;
+    ops.create_power_config_id = [this](uint32_t, uint32_t, uint32_t* client_id) {
+      ++created;
+      *client_id = 7;
+      return static_cast<Qnn_ErrorHandle_t>(QNN_SUCCESS);
+    };
+    ops.destroy_power_config_id = [this](uint32_t) {
+      ++destroyed;
+      return static_cast<Qnn_ErrorHandle_t>(QNN_SUCCESS);
+    };
+    ops.set_power_config = [this](uint32_t, const QnnHtpPerfInfrastructure_PowerConfig_t** configs) {
+      if (fail_next_set) {
+        fail_next_set = false;
+        return static_cast<Qnn_ErrorHandle_t>(QNN_COMMON_ERROR_GENERAL);
+      }
+      dcvs_corners.push_back(configs[0]->dcvsV3Config.coreVoltageCornerTarget);
+      return static_cast<Qnn_ErrorHandle_t>(QNN_SUCCESS);
+    };
+    return ops;
+  }
+};
+
+struct ManualClock {
+  int64_t now_us = 1000000;
+  void advance_ms(int64_t ms) { now_us += ms * 1000; }
+  HtpPowerPolicy::Clock fn() {
+    return [this] { return now_us; };
+  }
+};
+
+HtpPowerPolicy::Options test_options() {
+  HtpPowerPolicy::Options options;
+  options.debounce_ms = kDebounceMs;
+  options.idle_timeout_ms = kIdleTimeoutMs;
+  options.idle_timer_thread = false;
+  return options;
+}
+
+bool near(double a, double b) { return std::fabs(a - b) < 1e-6; }
+
+void test_transitions() {
+  FakePerf perf;
+  ManualClock clock;
+  HtpPowerPolicy policy;
+  CHECK(policy.init(perf.ops(), test_options(), clock.fn()));
+  CHECK(perf.created == 1);
+  CHECK(policy.current() == HtpPowerProfile::kNone);
+  const int64_t start_us = clock.now_us;
+
+  // None → burst: immediate
+  policy.on_phase(RunnerPhase::kPrefill);
+  CHECK(policy.current() == HtpPowerProfile::kBurst);
+  CHECK(perf.dcvs_corners.size() == 1);
+  CHECK(perf.dcvs_corners.back() == DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER);
+
+  // burst → sustained within debounce: held back and counted
+  clock.advance_ms(10);
+  policy.on_phase(RunnerPhase::kDecode);
+  CHECK(policy.current() == HtpPowerProfile::kBurst);
+  CHECK(policy.stats().debounced == 1);
+  clock.advance_ms(kDebounceMs - 20);
+  policy.tick();
+  CHECK(policy.current() == HtpPowerProfile::kBurst);
+  // Re-requesting the same pending target is not a new debounce
+  policy.on_phase(RunnerPhase::kDecode);
+  CHECK(policy.stats().debounced == 1);
+  clock.advance_ms(10);  // burst has now been held for debounce_ms
+  policy.tick();
+  CHECK(policy.current() == HtpPowerProfile::kSustained);
+  CHECK(perf.dcvs_corners.back() == DCVS_VOLTAGE_VCORNER_TURBO);
+
+  // Idle: nothing changes before idle_timeout, relaxed after
+  clock.advance_ms(100);
+  policy.on_phase(RunnerPhase::kIdle);
+  CHECK(policy.current() == HtpPowerProfile::kSustained);
+  clock.advance_ms(kIdleTimeoutMs - 1);
+  policy.tick();
+  CHECK(policy.current() == HtpPowerProfile::kSustained);
+  clock.advance_ms(1);
+  policy.tick();
+  CHECK(policy.current() == HtpPowerProfile::kRelaxed);
+  CHECK(perf.dcvs_corners.back() == DCVS_VOLTAGE_VCORNER_SVS);
+
+  // relaxed → sustained: immediate, even right after the downgrade
+  policy.on_phase(RunnerPhase::kDecode);
+  CHECK(policy.current() == HtpPowerProfile::kSustained);
+
+  clock.advance_ms(30);
+  HtpPowerPolicy::Stats s = policy.stats();
+  CHECK(s.switches == 4);
+  CHECK(s.failures == 0);
+  // Profile times cover the whole clock span since the first vote
+  const double elapsed_ms = (clock.now_us - start_us) / 1000.0;
+  CHECK(near(s.burst_ms, kDebounceMs));
+  CHECK(near(s.sustained_ms, 100 + kIdleTimeoutMs + 30));
+  CHECK(near(s.relaxed_ms, 0.0));
+  CHECK(near(s.burst_ms + s.sustained_ms + s.relaxed_ms, elapsed_ms));
+
+  policy.shutdown();
+  CHECK(perf.destroyed == 1);
+}
+
+void test_voters() {
+  FakePerf perf;
+  ManualClock clock;
+  HtpPowerPolicy policy;
+  CHECK(policy.init(perf.ops(), test_options(), clock.fn()));
+  const int a = policy.add_voter();
+  const int b = policy.add_voter();
+
+  policy.on_phase(RunnerPhase::kDecode, a);
+  CHECK(policy.current() == HtpPowerProfile::kSustained);
+  policy.on_phase(RunnerPhase::kPrefill, b);
+  CHECK(policy.current() == HtpPowerProfile::kBurst);
+
+  // a going idle does not lower b's prefill
+  clock.advance_ms(kDebounceMs * 4);
+  policy.on_phase(RunnerPhase::kIdle, a);
+  policy.tick();
+  CHECK(policy.current() == HtpPowerProfile::kBurst);
+
+  // b drops to decode: sustained wins over a's idle (debounce already satisfied)
+  policy.on_phase(RunnerPhase::kDecode, b);
+  CHECK(policy.current() == HtpPowerProfile::kSustained);
+
+  // Removing b leaves only idle voters: relaxed after the timeout
+  policy.remove_voter(b);
+  clock.advance_ms(kIdleTimeoutMs);
+  policy.tick();
+  CHECK(policy.current() == HtpPowerProfile::kRelaxed);
+}
+
+void test_set_failure() {
+  FakePerf perf;
+  ManualClock clock;
+  HtpPowerPolicy policy;
+  CHECK(policy.init(perf.ops(), test_options(), clock.fn()));
+  policy.on_phase(RunnerPhase::kDecode);
+  CHECK(policy.current() == HtpPowerProfile::kSustained);
+
+  perf.fail_next_set = true;
+  policy.on_phase(RunnerPhase::kPrefill);
+  HtpPowerPolicy::Stats s = policy.stats();
+  CHECK(s.failures == 1);
+  CHECK(s.switches == 1);
+  CHECK(policy.current() == HtpPowerProfile::kSustained);
+
+  // The next request retries and succeeds
+  policy.on_phase(RunnerPhase::kPrefill);
+  CHECK(policy.current() == HtpPowerProfile::kBurst);
+}
+
+// Timer thread: relaxes on its own after idle_timeout, then sleeps until the next vote
+void test_timer_thread() {
+  using std::chrono::steady_clock;
+  FakePerf perf;
+  std::atomic<int> clock_reads{0};
+  HtpPowerPolicy::Clock clock = [&clock_reads] {
+    clock_reads.fetch_add(1);
+    return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                    steady_clock::now().time_since_epoch())
+                                    .count());
+  };
+  HtpPowerPolicy::Options options;
+  options.debounce_ms = 5;
+  options.idle_timeout_ms = 20;
+  HtpPowerPolicy policy;
+  CHECK(policy.init(perf.ops(), options, clock));
+
+  policy.on_phase(RunnerPhase::kDecode);
+  policy.on_phase(RunnerPhase::kIdle);
+  const auto give_up = steady_clock::now() + std::chrono::seconds(5);
+  while (policy.current() != HtpPowerProfile::kRelaxed && steady_clock::now() < give_up) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  CHECK(policy.current() == HtpPowerProfile::kRelaxed);
+
+  // Nothing pending: the timer must not wake up (no clock reads) while idle
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const int reads = clock_reads.load();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  CHECK(clock_reads.load() == reads);
+
+  // A new vote wakes it again: decode, idle, relaxed once more
+  policy.on_phase(RunnerPhase::kDecode);
+  CHECK(policy.current() == HtpPowerProfile::kSustained);
+  policy.on_phase(RunnerPhase::kIdle);
+  while (policy.current() != HtpPowerProfile::kRelaxed && steady_clock::now() < give_up) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  CHECK(policy.current() == HtpPowerProfile::kRelaxed);
+  policy.shutdown();
+}
+
+} // namespace
+
+int main() {
+  test_transitions();
+  test_voters();
+  test_set_failure();
+  test_timer_thread();
+  std::printf("%s\n", g_failures == 0 ? "PASS" : "FAIL");
+  return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "llm_decode_runner.h"
+
+#include <functional>
+#include <vector>
+
+namespace llm_test {
+
+/**
+ * @brief Test-only entry points into LLMDecodeRunner's private steps
+ *
+ * Mirrors what generate() does around the decode loop, without tokenization
+ * or the report, so a test can bracket individual steps.
+ */
+struct LLMDecodeRunnerTestAccess {
+  /** Prefill plus the prefill → decode layout switch; n_past = positions occupied */
+  static bool prefill(LLMDecodeRunner& r, const std::vector<int32_t>& tokens, int32_t& next_token,
+                      int32_t& n_past) {
+    if (r.config_.use_multi_context) {
+      return r.run_multi_context_prefill(tokens, next_token, n_past);
+    }
+    if (!r.run_prefill(tokens, next_token, n_past)) return false;
+    r.finish_prefill_layout(n_past);
+    return true;
+  }
+
+  static bool decode_step(LLMDecodeRunner& r, int32_t token_in, int32_t n_past, int32_t& token_out,
+                          const std::function<void()>* host_work) {
+    if (r.config_.use_multi_context) {
+      return r.run_multi_context_decode_step(token_in, n_past, token_out, host_work);
+    }
+    return r.run_decode_step(token_in, n_past, token_out, host_work);
+  }
+
+  static bool dataflow(const LLMDecodeRunner& r) { return r.dataflow_; }
+  static int32_t kv_cache_len(const LLMDecodeRunner& r) { return r.kv_cache_len_; }
+  static void sync_kv_writeback(LLMDecodeRunner& r) { r.sync_kv_writeback(true); }
+};
+
+} // namespace llm_test
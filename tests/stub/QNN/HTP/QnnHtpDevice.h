@@ -0,0 +1,13 @@
+#pragma once
+
+#include "../QnnDevice.h"
+#include "QnnHtpPerfInfrastructure.h"
+
+typedef enum { QNN_HTP_DEVICE_INFRASTRUCTURE_TYPE_PERF = 0 } QnnHtpDevice_InfrastructureType_t;
+
+typedef struct {
+  QnnHtpDevice_InfrastructureType_t infraType;
+  union {
+    QnnHtpDevice_PerfInfrastructure_t perfInfra;
+  };
+} QnnHtpDevice_Infrastructure_t;
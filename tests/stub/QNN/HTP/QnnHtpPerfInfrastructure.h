@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../QnnCommon.h"
+
+typedef enum {
+  QNN_HTP_PERF_INFRASTRUCTURE_POWER_CONFIGOPTION_DCVS_V3 = 1,
+  QNN_HTP_PERF_INFRASTRUCTURE_POWER_CONFIGOPTION_RPC_CONTROL_LATENCY,
+  QNN_HTP_PERF_INFRASTRUCTURE_POWER_CONFIGOPTION_RPC_POLLING_TIME
+} QnnHtpPerfInfrastructure_PowerConfigOption_t;
+
+typedef enum {
+  QNN_HTP_PERF_INFRASTRUCTURE_POWERMODE_ADJUST_UP_DOWN = 1,
+  QNN_HTP_PERF_INFRASTRUCTURE_POWERMODE_POWER_SAVER_MODE,
+  QNN_HTP_PERF_INFRASTRUCTURE_POWERMODE_PERFORMANCE_MODE
+} QnnHtpPerfInfrastructure_PowerMode_t;
+
+typedef enum {
+  DCVS_VOLTAGE_CORNER_DISABLE = 0,
+  DCVS_VOLTAGE_VCORNER_MIN_VOLTAGE_CORNER,
+  DCVS_VOLTAGE_VCORNER_SVS2,
+  DCVS_VOLTAGE_VCORNER_SVS,
+  DCVS_VOLTAGE_VCORNER_SVS_PLUS,
+  DCVS_VOLTAGE_VCORNER_NOM,
+  DCVS_VOLTAGE_VCORNER_NOM_PLUS,
+  DCVS_VOLTAGE_VCORNER_TURBO,
+  DCVS_VOLTAGE_VCORNER_TURBO_PLUS,
+  DCVS_VOLTAGE_VCORNER_MAX_VOLTAGE_CORNER
+} QnnHtpPerfInfrastructure_VoltageCorner_t;
+
+typedef struct {
+  uint32_t contextId;
+  uint32_t setDcvsEnable;
+  uint32_t dcvsEnable;
+  QnnHtpPerfInfrastructure_PowerMode_t powerMode;
+  uint32_t setSleepLatency;
+  uint32_t sleepLatency;
+  uint32_t setSleepDisable;
+  uint32_t sleepDisable;
+  uint32_t setBusParams;
+  QnnHtpPerfInfrastructure_VoltageCorner_t busVoltageCornerMin;
+  QnnHtpPerfInfrastructure_VoltageCorner_t busVoltageCornerTarget;
+  QnnHtpPerfInfrastructure_VoltageCorner_t busVoltageCornerMax;
+  uint32_t setCoreParams;
+  QnnHtpPerfInfrastructure_VoltageCorner_t coreVoltageCornerMin;
+  QnnHtpPerfInfrastructure_VoltageCorner_t coreVoltageCornerTarget;
+  QnnHtpPerfInfrastructure_VoltageCorner_t coreVoltageCornerMax;
+} QnnHtpPerfInfrastructure_DcvsV3_t;
+
+typedef struct {
+  QnnHtpPerfInfrastructure_PowerConfigOption_t option;
+  union {
+    QnnHtpPerfInfrastructure_DcvsV3_t dcvsV3Config;
+    uint32_t rpcControlLatencyConfig;
+    uint32_t rpcPollingTimeConfig;
+  };
+} QnnHtpPerfInfrastructure_PowerConfig_t;
+
+typedef Qnn_ErrorHandle_t (*QnnHtpPerfInfrastructure_CreatePowerConfigIdFn_t)(
+    uint32_t deviceId, uint32_t coreId, uint32_t* powerConfigId);
+typedef Qnn_ErrorHandle_t (*QnnHtpPerfInfrastructure_DestroyPowerConfigIdFn_t)(
+    uint32_t powerConfigId);
+typedef Qnn_ErrorHandle_t (*QnnHtpPerfInfrastructure_SetPowerConfigFn_t)(
+    uint32_t powerConfigId, const QnnHtpPerfInfrastructure_PowerConfig_t** config);
+
+typedef struct {
+  QnnHtpPerfInfrastructure_CreatePowerConfigIdFn_t createPowerConfigId;
+  QnnHtpPerfInfrastructure_DestroyPowerConfigIdFn_t destroyPowerConfigId;
+  QnnHtpPerfInfrastructure_SetPowerConfigFn_t setPowerConfig;
+} QnnHtpDevice_PerfInfrastructure_t;
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "QnnCommon.h"
+
+typedef struct {
+  int unused;
+} QnnBackend_Config_t;
@@ -0,0 +1,25 @@
+#pragma once
+
+// 호스트 테스트용 최소 QNN SDK 헤더(tests/stub/QNN)
+// - 러너 소스가 쓰는 타입/필드/함수 시그니처만 SDK와 같은 이름으로 선언한다
+// - 구조체 레이아웃과 에러 코드 값은 SDK와 다르다: 같은 헤더로 빌드한 스텁 백엔드
+//   (tests/stub_qnn_backend.cpp)와만 함께 쓴다
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint64_t Qnn_ErrorHandle_t;
+typedef void* Qnn_Handle_t;
+typedef Qnn_Handle_t Qnn_BackendHandle_t;
+typedef Qnn_Handle_t Qnn_ContextHandle_t;
+typedef Qnn_Handle_t Qnn_DeviceHandle_t;
+typedef Qnn_Handle_t Qnn_GraphHandle_t;
+typedef Qnn_Handle_t Qnn_LogHandle_t;
+typedef Qnn_Handle_t Qnn_ProfileHandle_t;
+typedef Qnn_Handle_t Qnn_SignalHandle_t;
+
+#define QNN_SUCCESS 0
+#define QNN_COMMON_ERROR_NOT_SUPPORTED 1000
+#define QNN_COMMON_ERROR_MEM_ALLOC 1001
+#define QNN_COMMON_ERROR_INVALID_ARGUMENT 1002
+#define QNN_COMMON_ERROR_GENERAL 1003
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "QnnCommon.h"
+#include "QnnTypes.h"
+
+typedef uint64_t Qnn_ContextBinarySize_t;
+
+typedef struct {
+  int unused;
+} QnnContext_Config_t;
+
+typedef enum {
+  QNN_CONTEXT_NOTIFY_TYPE_GRAPH_INIT = 1,
+  QNN_CONTEXT_NOTIFY_TYPE_CONTEXT_INIT = 2
+} QnnContext_createFromBinaryAsyncNotifyType_t;
+
+typedef void (*QnnContext_NotifyFn_t)(Qnn_ContextHandle_t context, Qnn_GraphHandle_t graph,
+                                      const char* graph_name,
+                                      QnnContext_createFromBinaryAsyncNotifyType_t completeType,
+                                      void* notifyParam, Qnn_ErrorHandle_t status);
+
+typedef struct {
+  const QnnContext_Config_t** config;
+  const void* binaryBuffer;
+  Qnn_ContextBinarySize_t binaryBufferSize;
+  Qnn_ProfileHandle_t profile;
+  QnnContext_NotifyFn_t notifyFunc;
+  void* notifyParam;
+} QnnContext_ParamsV1_t;
+
+typedef enum { QNN_CONTEXT_PARAMS_VERSION_1 = 1 } QnnContext_ParamsVersion_t;
+
+typedef struct {
+  QnnContext_ParamsVersion_t version;
+  union {
+    QnnContext_ParamsV1_t v1;
+  };
+} QnnContext_Params_t;
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "QnnCommon.h"
+
+typedef struct {
+  int unused;
+} QnnDevice_Config_t;
+
+typedef void* QnnDevice_Infrastructure_t;
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "QnnCommon.h"
+
+// SDK와 같이 UNSUPPORTED_FEATURE는 공통 NOT_SUPPORTED 코드와 같은 값
+#define QNN_GRAPH_ERROR_UNSUPPORTED_FEATURE QNN_COMMON_ERROR_NOT_SUPPORTED
+#define QNN_GRAPH_ERROR_INVALID_HANDLE 6000
+#define QNN_GRAPH_ERROR_GRAPH_DOES_NOT_EXIST 6001
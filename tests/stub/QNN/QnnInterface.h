@@ -0,0 +1,58 @@
+#pragma once
+
+#include "QnnBackend.h"
+#include "QnnCommon.h"
+#include "QnnContext.h"
+#include "QnnDevice.h"
+#include "QnnGraph.h"
+#include "QnnLog.h"
+#include "QnnProfile.h"
+#include "QnnTypes.h"
+
+// 러너가 호출하는 함수 포인터만 담은 인터페이스 테이블(SDK의 v2_x 필드명과 시그니처)
+typedef struct {
+  Qnn_ErrorHandle_t (*logCreate)(QnnLog_Callback_t, QnnLog_Level_t, Qnn_LogHandle_t*);
+  Qnn_ErrorHandle_t (*logSetLogLevel)(Qnn_LogHandle_t, QnnLog_Level_t);
+  Qnn_ErrorHandle_t (*logFree)(Qnn_LogHandle_t);
+  Qnn_ErrorHandle_t (*backendCreate)(Qnn_LogHandle_t, const QnnBackend_Config_t**,
+                                     Qnn_BackendHandle_t*);
+  Qnn_ErrorHandle_t (*backendFree)(Qnn_BackendHandle_t);
+  Qnn_ErrorHandle_t (*deviceCreate)(Qnn_LogHandle_t, const QnnDevice_Config_t**,
+                                    Qnn_DeviceHandle_t*);
+  Qnn_ErrorHandle_t (*deviceFree)(Qnn_DeviceHandle_t);
+  Qnn_ErrorHandle_t (*deviceGetInfrastructure)(const QnnDevice_Infrastructure_t*);
+  Qnn_ErrorHandle_t (*contextCreateFromBinary)(Qnn_BackendHandle_t, Qnn_DeviceHandle_t,
+                                               const QnnContext_Config_t**, const void*,
+                                               Qnn_ContextBinarySize_t, Qnn_ContextHandle_t*,
+                                               Qnn_ProfileHandle_t);
+  Qnn_ErrorHandle_t (*contextCreateFromBinaryListAsync)(Qnn_BackendHandle_t, Qnn_DeviceHandle_t,
+                                                        const QnnContext_Params_t**,
+                                                        const QnnContext_Config_t**,
+                                                        Qnn_SignalHandle_t);
+  Qnn_ErrorHandle_t (*contextFree)(Qnn_ContextHandle_t, Qnn_ProfileHandle_t);
+  Qnn_ErrorHandle_t (*graphRetrieve)(Qnn_ContextHandle_t, const char*, Qnn_GraphHandle_t*);
+  Qnn_ErrorHandle_t (*graphExecute)(Qnn_GraphHandle_t, const Qnn_Tensor_t*, uint32_t,
+                                    Qnn_Tensor_t*, uint32_t, Qnn_ProfileHandle_t,
+                                    Qnn_SignalHandle_t);
+  Qnn_ErrorHandle_t (*graphExecuteAsync)(Qnn_GraphHandle_t, const Qnn_Tensor_t*, uint32_t,
+                                         Qnn_Tensor_t*, uint32_t, Qnn_ProfileHandle_t,
+                                         Qnn_SignalHandle_t, Qnn_NotifyFn_t, void*);
+  Qnn_ErrorHandle_t (*tensorUpdateGraphTensors)(Qnn_GraphHandle_t, const Qnn_Tensor_t**, uint64_t);
+  Qnn_ErrorHandle_t (*profileCreate)(Qnn_BackendHandle_t, QnnProfile_Level_t, Qnn_ProfileHandle_t*);
+  Qnn_ErrorHandle_t (*profileGetEvents)(Qnn_ProfileHandle_t, const QnnProfile_EventId_t**,
+                                        uint32_t*);
+  Qnn_ErrorHandle_t (*profileGetSubEvents)(QnnProfile_EventId_t, const QnnProfile_EventId_t**,
+                                           uint32_t*);
+  Qnn_ErrorHandle_t (*profileGetEventData)(QnnProfile_EventId_t, QnnProfile_EventData_t*);
+  Qnn_ErrorHandle_t (*profileFree)(Qnn_ProfileHandle_t);
+} QnnInterface_ImplementationV2_t;
+
+#define QNN_INTERFACE_VER_NAME v2_x
+
+typedef struct {
+  uint32_t backendId;
+  const char* providerName;
+  union {
+    QnnInterface_ImplementationV2_t QNN_INTERFACE_VER_NAME;
+  };
+} QnnInterface_t;
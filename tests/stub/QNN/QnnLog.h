@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdarg.h>
+
+#include "QnnCommon.h"
+
+typedef enum {
+  QNN_LOG_LEVEL_ERROR = 1,
+  QNN_LOG_LEVEL_WARN,
+  QNN_LOG_LEVEL_INFO,
+  QNN_LOG_LEVEL_VERBOSE,
+  QNN_LOG_LEVEL_DEBUG
+} QnnLog_Level_t;
+
+typedef void (*QnnLog_Callback_t)(const char* fmt, QnnLog_Level_t level, uint64_t timestamp,
+                                  va_list args);
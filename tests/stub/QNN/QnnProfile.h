@@ -0,0 +1,36 @@
+#pragma once
+
+#include "QnnCommon.h"
+
+typedef uint32_t QnnProfile_Level_t;
+#define QNN_PROFILE_LEVEL_BASIC 1
+#define QNN_PROFILE_LEVEL_DETAILED 2
+
+typedef uint64_t QnnProfile_EventId_t;
+typedef uint32_t QnnProfile_EventType_t;
+typedef uint32_t QnnProfile_EventUnit_t;
+
+#define QNN_PROFILE_EVENTTYPE_INIT 100
+#define QNN_PROFILE_EVENTTYPE_FINALIZE 200
+#define QNN_PROFILE_EVENTTYPE_EXECUTE 300
+#define QNN_PROFILE_EVENTTYPE_NODE 400
+#define QNN_PROFILE_EVENTTYPE_EXECUTE_QUEUE_WAIT 500
+#define QNN_PROFILE_EVENTTYPE_EXECUTE_PREPROCESS 600
+#define QNN_PROFILE_EVENTTYPE_EXECUTE_DEVICE 700
+#define QNN_PROFILE_EVENTTYPE_EXECUTE_POSTPROCESS 800
+#define QNN_PROFILE_EVENTTYPE_DEINIT 900
+#define QNN_PROFILE_EVENTTYPE_BACKEND 1000
+
+#define QNN_PROFILE_EVENTUNIT_MICROSEC 1
+#define QNN_PROFILE_EVENTUNIT_BYTES 2
+#define QNN_PROFILE_EVENTUNIT_CYCLES 3
+#define QNN_PROFILE_EVENTUNIT_COUNT 4
+#define QNN_PROFILE_EVENTUNIT_OBJECT 5
+#define QNN_PROFILE_EVENTUNIT_BACKEND 6
+
+typedef struct {
+  QnnProfile_EventType_t type;
+  QnnProfile_EventUnit_t unit;
+  uint64_t value;
+  const char* identifier;
+} QnnProfile_EventData_t;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "QnnCommon.h"
+
+typedef enum {
+  QNN_DATATYPE_INT_8,
+  QNN_DATATYPE_INT_16,
+  QNN_DATATYPE_INT_32,
+  QNN_DATATYPE_INT_64,
+  QNN_DATATYPE_UINT_8,
+  QNN_DATATYPE_UINT_16,
+  QNN_DATATYPE_UINT_32,
+  QNN_DATATYPE_UINT_64,
+  QNN_DATATYPE_FLOAT_16,
+  QNN_DATATYPE_FLOAT_32
+} Qnn_DataType_t;
+
+typedef enum { QNN_TENSORMEMTYPE_RAW, QNN_TENSORMEMTYPE_MEMHANDLE } Qnn_TensorMemType_t;
+typedef enum { QNN_TENSOR_TYPE_APP_WRITE, QNN_TENSOR_TYPE_APP_READ } Qnn_TensorType_t;
+typedef enum { QNN_TENSOR_DATA_FORMAT_FLAT_BUFFER } Qnn_TensorDataFormat_t;
+typedef enum { QNN_DEFINITION_DEFINED } Qnn_Definition_t;
+
+typedef enum {
+  QNN_QUANTIZATION_ENCODING_UNDEFINED,
+  QNN_QUANTIZATION_ENCODING_SCALE_OFFSET,
+  QNN_QUANTIZATION_ENCODING_AXIS_SCALE_OFFSET
+} Qnn_QuantizationEncoding_t;
+
+typedef struct {
+  float scale;
+  int32_t offset;
+} Qnn_ScaleOffset_t;
+
+typedef struct {
+  int32_t axis;
+  uint32_t numScaleOffsets;
+  Qnn_ScaleOffset_t* scaleOffset;
+} Qnn_AxisScaleOffset_t;
+
+typedef struct {
+  Qnn_Definition_t encodingDefinition;
+  Qnn_QuantizationEncoding_t quantizationEncoding;
+  union {
+    Qnn_ScaleOffset_t scaleOffsetEncoding;
+    Qnn_AxisScaleOffset_t axisScaleOffsetEncoding;
+  };
+} Qnn_QuantizeParams_t;
+
+typedef struct {
+  void* data;
+  uint32_t dataSize;
+} Qnn_ClientBuffer_t;
+
+typedef struct {
+  uint32_t id;
+  const char* name;
+  Qnn_TensorType_t type;
+  Qnn_TensorDataFormat_t dataFormat;
+  Qnn_DataType_t dataType;
+  Qnn_QuantizeParams_t quantizeParams;
+  uint32_t rank;
+  uint32_t* dimensions;
+  Qnn_TensorMemType_t memType;
+  union {
+    Qnn_ClientBuffer_t clientBuf;
+    void* memHandle;
+  };
+  uint8_t* isDynamicDimensions;
+} Qnn_TensorV2_t;
+
+typedef enum { QNN_TENSOR_VERSION_1 = 1, QNN_TENSOR_VERSION_2 = 2 } Qnn_TensorVersion_t;
+
+typedef struct {
+  Qnn_TensorVersion_t version;
+  union {
+    Qnn_TensorV2_t v2;
+  };
+} Qnn_Tensor_t;
+
+typedef struct {
+  Qnn_ErrorHandle_t error;
+} Qnn_NotifyStatus_t;
+
+typedef void (*Qnn_NotifyFn_t)(void* notifyParam, Qnn_NotifyStatus_t notifyStatus);
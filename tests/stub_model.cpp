@@ -0,0 +1,190 @@
+#include "stub_model.h"
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace llm_test {
+
+namespace {
+
+struct TensorSpec {
+  std::string name;
+  const char* dtype;
+  std::vector<int> dims;
+  std::string quantization;  // JSON object, empty = none
+};
+
+void write_tensors(std::ostream& os, const std::vector<TensorSpec>& tensors) {
+  os << "[";
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const TensorSpec& t = tensors[i];
+    os << (i ? "," : "") << "\n      {\"id\":" << (i + 1) << ",\"name\":\"" << t.name
+       << "\",\"dataType\":\"" << t.dtype << "\",\"dimensions\":[";
+    for (size_t d = 0; d < t.dims.size(); ++d) os << (d ? "," : "") << t.dims[d];
+    os << "]";
+    if (!t.quantization.empty()) os << ",\"quantization\":" << t.quantization;
+    os << "}";
+  }
+  os << "]";
+}
+
+struct GraphSpec {
+  std::string name;
+  std::vector<TensorSpec> inputs;
+  std::vector<TensorSpec> outputs;
+};
+
+// One graph of one shard (shard < 0: single-context, all layers and logits)
+GraphSpec make_graph(const StubModelSpec& spec, int shard, int num_shards, bool prefill) {
+  const char* kU8 = "QNN_DATATYPE_UFIXED_POINT_8";
+  const char* kU16 = "QNN_DATATYPE_UFIXED_POINT_16";
+  const char* kI32 = "QNN_DATATYPE_INT_32";
+  const int ar = prefill ? spec.prefill_ar : spec.kv_ar;
+  const int cache_len = spec.context_len - ar;
+  const int head_dim = spec.dim / spec.n_heads;
+  const bool single = shard < 0;
+  const bool first = single || shard == 0;
+  const bool last = single || shard == num_shards - 1;
+  const int layers = single ? spec.n_layers : spec.n_layers / num_shards;
+
+  GraphSpec g;
+  g.name = prefill ? "prefill_forward" : "kv_forward";
+  if (first) {
+    g.inputs.push_back({"input_0_tokens_0", kI32, {1, ar}});
+    g.inputs.push_back({"input_1_input_pos_0", kI32, {1, ar}});
+  } else {
+    g.inputs.push_back({"input_0_fallback_0", kU16, {1, ar, spec.dim}});
+  }
+  g.inputs.push_back({"input_2_atten_mask_0", kU16, {1, ar, spec.context_len}});
+  if (!first) {
+    g.inputs.push_back({"input_9_aten_view_copy_default_0", kU16, {1, ar, head_dim / 2}});
+    g.inputs.push_back({"input_10_aten_view_copy_default_1_0", kU16, {1, ar, head_dim / 2}});
+  }
+
+  std::string k_quant;
+  if (spec.k_encoding == "tensor") {
+    k_quant = "{\"quantizationEncoding\":\"QNN_QUANTIZATION_ENCODING_SCALE_OFFSET\","
+              "\"scaleOffset\":{\"scale\":0.0625,\"offset\":-128}}";
+  } else if (spec.k_encoding == "axis") {
+    std::ostringstream q;
+    q << "{\"quantizationEncoding\":\"QNN_QUANTIZATION_ENCODING_AXIS_SCALE_OFFSET\",\"axis\":1,"
+      << "\"scales\":[";
+    for (int d = 0; d < head_dim; ++d) q << (d ? "," : "") << "0.0625";
+    q << "],\"offsets\":[";
+    for (int d = 0; d < head_dim; ++d) q << (d ? "," : "") << "-128";
+    q << "]}";
+    k_quant = q.str();
+  }
+
+  // KV inputs per layer: V heads, then K heads (classified by shape, counted in order)
+  int arg = 0;
+  for (int layer = 0; layer < layers; ++layer) {
+    for (int kv = 0; kv < 2; ++kv) {
+      for (int head = 0; head < spec.n_kv_heads; ++head, ++arg) {
+        std::string name = "input_" + std::to_string(11 + arg) + "_args_" + std::to_string(arg) + "_0";
+        std::vector<int> dims = kv == 0 ? std::vector<int>{1, cache_len, head_dim}
+                                        : std::vector<int>{1, head_dim, cache_len};
+        g.inputs.push_back({name, kU8, dims, kv == 0 ? std::string() : k_quant});
+      }
+    }
+  }
+
+  if (last) {
+    g.outputs.push_back({"output_squeeze_0", kU16, {1, ar, spec.vocab_size}});
+  } else {
+    g.outputs.push_back({"output_aten_add_tensor_0", kU16, {1, ar, spec.dim}});
+  }
+  if (first && !single) {
+    g.outputs.push_back({"output_quantized_decomposed_dequantize_per_tensor_tensor_0", kU16,
+                         {1, ar, head_dim / 2}});
+    g.outputs.push_back({"output_quantized_decomposed_dequantize_per_tensor_tensor_1_0", kU16,
+                         {1, ar, head_dim / 2}});
+  }
+  int out = 0;
+  for (int layer = 0; layer < layers; ++layer) {
+    for (int head = 0; head < spec.n_kv_heads; ++head, ++out) {
+      g.outputs.push_back({"output_aten_view_copy_default_" + std::to_string(out) + "_0", kU8,
+                           {1, ar, head_dim}});
+    }
+    for (int head = 0; head < spec.n_kv_heads; ++head, ++out) {
+      g.outputs.push_back({"output_aten_permute_copy_default_" + std::to_string(out) + "_0", kU8,
+                           {1, head_dim, ar}});
+    }
+  }
+  return g;
+}
+
+bool write_file(const std::string& path, const std::string& content, std::string& error) {
+  std::ofstream ofs(path, std::ios::binary);
+  ofs << content;
+  if (!ofs) {
+    error = "Failed to write " + path;
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+bool write_stub_model(const std::string& dir, const StubModelSpec& spec, int num_shards,
+                      std::string& error) {
+  std::ostringstream params;
+  params << "{\"dim\": " << spec.dim << ", \"n_layers\": " << spec.n_layers
+         << ", \"n_heads\": " << spec.n_heads << ", \"n_kv_heads\": " << spec.n_kv_heads
+         << ", \"vocab_size\": " << spec.vocab_size << ", \"rope_theta\": 500000.0}\n";
+  if (!write_file(dir + "/params.json", params.str(), error)) return false;
+
+  const int files = num_shards > 0 ? num_shards : 1;
+  for (int i = 0; i < files; ++i) {
+    const int shard = num_shards > 0 ? i : -1;
+    std::ostringstream json;
+    json << "{\"graphs\": [";
+    for (int phase = 0; phase < 2; ++phase) {
+      GraphSpec g = make_graph(spec, shard, num_shards, phase == 0);
+      json << (phase ? "," : "") << "\n  {\"graphName\": \"" << g.name << "\",\n    \"graphInputs\": ";
+      write_tensors(json, g.inputs);
+      json << ",\n    \"graphOutputs\": ";
+      write_tensors(json, g.outputs);
+      json << "}";
+    }
+    json << "]}\n";
+
+    const std::string base = dir + "/forward_" + std::to_string(i);
+    // Padded so mmap/read loaders see a non-trivial binary
+    std::string binary = "QNNSTUB " + std::to_string(i) + "\n";
+    binary.resize(4096, '\0');
+    if (!write_file(base + "_json.json", json.str(), error) ||
+        !write_file(base + ".bin", binary, error)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string make_temp_dir(const std::string& tag) {
+  const char* tmp = std::getenv("TMPDIR");
+  std::string templ = std::string(tmp && *tmp ? tmp : "/tmp") + "/" + tag + "_XXXXXX";
+  std::vector<char> buf(templ.begin(), templ.end());
+  buf.push_back('\0');
+  if (!mkdtemp(buf.data())) return std::string();
+  return std::string(buf.data());
+}
+
+void remove_stub_model(const std::string& dir) {
+  if (DIR* d = opendir(dir.c_str())) {
+    while (dirent* e = readdir(d)) {
+      std::string name = e->d_name;
+      if (name == "." || name == "..") continue;
+      unlink((dir + "/" + name).c_str());
+    }
+    closedir(d);
+  }
+  rmdir(dir.c_str());
+}
+
+} // namespace llm_test
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+
+namespace llm_test {
+
+/**
+ * @brief Shape of the synthetic model written for host tests
+ *
+ * The graph JSON follows the tensor naming the runner classifies (tokens, pos,
+ * atten_mask, "_args_" KV inputs, view_copy/permute_copy KV outputs, ROPE and
+ * hidden state edges between shards), so initialize() builds the same plans it
+ * builds for an exported Llama model. Context binaries hold "QNNSTUB <shard>"
+ * for the stub backend.
+ */
+struct StubModelSpec {
+  int context_len = 128;
+  int prefill_ar = 16;
+  int kv_ar = 1;
+  int n_layers = 2;
+  int n_heads = 4;
+  int n_kv_heads = 2;
+  int dim = 128;          // head_dim = dim / n_heads
+  int vocab_size = 128256; // Single-context prefill/decode assume the Llama 3 vocabulary
+  // K cache input encodings: "" = none, "tensor" = per-tensor scale/offset, "axis" = per-axis
+  std::string k_encoding;
+};
+
+/**
+ * @brief Write params.json, forward_<i>.bin and forward_<i>_json.json into dir
+ * @param num_shards 0 = single-context layout (one forward_0 with logits), else multi-context shards
+ */
+bool write_stub_model(const std::string& dir, const StubModelSpec& spec, int num_shards,
+                      std::string& error);
+
+/** Fresh directory under $TMPDIR (or /tmp); empty string on failure */
+std::string make_temp_dir(const std::string& tag);
+
+/** Remove dir and the files write_stub_model put there */
+void remove_stub_model(const std::string& dir);
+
+} // namespace llm_test
@@ -0,0 +1,333 @@
+#include "stub_qnn_backend.h"
+
+#include <QnnInterface.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct StubContext;
+
+struct StubGraph {
+  StubContext* context {nullptr};
+  char name[32] {};
+};
+
+struct StubContext {
+  int32_t id {0};
+  std::mutex mu;
+  std::vector<std::unique_ptr<StubGraph>> graphs;
+};
+
+// 전역 상태: 실행 순번, 트레이스 버퍼
+std::mutex g_exec_mu;
+uint64_t g_executions = 0;
+std::vector<QnnStubTraceEntry> g_trace;
+size_t g_trace_size = 0;
+bool g_trace_on = false;
+bool g_trace_overflow = false;
+
+int g_backend_token = 0;
+int g_device_token = 0;
+int g_log_token = 0;
+
+uint64_t fnv1a(const void* data, size_t n, uint64_t h = 1469598103934665603ull) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < n; ++i) {
+    h ^= p[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+uint64_t splitmix64(uint64_t& state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+void trace(uint64_t exec, const StubGraph& graph, const Qnn_Tensor_t& t, bool is_output, uint64_t hash) {
+  if (!g_trace_on) return;
+  if (g_trace_size >= g_trace.size()) {
+    g_trace_overflow = true;
+    return;
+  }
+  QnnStubTraceEntry& e = g_trace[g_trace_size++];
+  e.exec = exec;
+  e.context_id = graph.context->id;
+  e.is_output = is_output ? 1 : 0;
+  std::strncpy(e.graph, graph.name, sizeof(e.graph) - 1);
+  e.graph[sizeof(e.graph) - 1] = '\0';
+  std::strncpy(e.tensor, t.v2.name ? t.v2.name : "", sizeof(e.tensor) - 1);
+  e.tensor[sizeof(e.tensor) - 1] = '\0';
+  e.nbytes = t.v2.clientBuf.dataSize;
+  e.hash = hash;
+}
+
+// 동기 실행 본체: 입력 해시 → 출력 채움(모든 clientBuf가 바인딩되어 있어야 함)
+Qnn_ErrorHandle_t execute(Qnn_GraphHandle_t handle, const Qnn_Tensor_t* inputs, uint32_t num_inputs,
+                          Qnn_Tensor_t* outputs, uint32_t num_outputs) {
+  auto* graph = static_cast<StubGraph*>(handle);
+  if (!graph || (num_inputs && !inputs) || (num_outputs && !outputs)) {
+    return QNN_COMMON_ERROR_INVALID_ARGUMENT;
+  }
+  std::lock_guard<std::mutex> lk(g_exec_mu);
+  const uint64_t exec = g_executions++;
+
+  uint64_t digest = fnv1a(graph->name, std::strlen(graph->name));
+  for (uint32_t i = 0; i < num_inputs; ++i) {
+    const Qnn_ClientBuffer_t& buf = inputs[i].v2.clientBuf;
+    if (!buf.data || buf.dataSize == 0) return QNN_COMMON_ERROR_INVALID_ARGUMENT;
+    uint64_t h = fnv1a(buf.data, buf.dataSize);
+    trace(exec, *graph, inputs[i], false, h);
+    digest = fnv1a(&h, sizeof(h), digest);
+  }
+  for (uint32_t i = 0; i < num_outputs; ++i) {
+    Qnn_ClientBuffer_t& buf = outputs[i].v2.clientBuf;
+    if (!buf.data || buf.dataSize == 0) return QNN_COMMON_ERROR_INVALID_ARGUMENT;
+    const char* name = outputs[i].v2.name ? outputs[i].v2.name : "";
+    uint64_t state = fnv1a(name, std::strlen(name), digest);
+    uint8_t* dst = static_cast<uint8_t*>(buf.data);
+    size_t n = buf.dataSize;
+    while (n >= sizeof(uint64_t)) {
+      uint64_t v = splitmix64(state);
+      std::memcpy(dst, &v, sizeof(v));
+      dst += sizeof(v);
+      n -= sizeof(v);
+    }
+    if (n) {
+      uint64_t v = splitmix64(state);
+      std::memcpy(dst, &v, n);
+    }
+    if (g_trace_on) trace(exec, *graph, outputs[i], true, fnv1a(buf.data, buf.dataSize));
+  }
+  return QNN_SUCCESS;
+}
+
+// graphExecuteAsync: 고정 크기 링에 제출하고 워커 스레드가 실행 후 notify(실제 백엔드처럼 다른 스레드에서 완료)
+class AsyncWorker {
+public:
+  struct Job {
+    Qnn_GraphHandle_t graph;
+    const Qnn_Tensor_t* inputs;
+    uint32_t num_inputs;
+    Qnn_Tensor_t* outputs;
+    uint32_t num_outputs;
+    Qnn_NotifyFn_t notify;
+    void* param;
+  };
+
+  AsyncWorker() : thread_([this] { run(); }) {}
+  ~AsyncWorker() {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  void submit(const Job& job) {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [&] { return count_ < kCapacity; });
+    ring_[(head_ + count_) % kCapacity] = job;
+    ++count_;
+    lk.unlock();
+    cv_.notify_all();
+  }
+
+private:
+  static constexpr size_t kCapacity = 64;
+
+  void run() {
+    for (;;) {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lk(mu_);
+        cv_.wait(lk, [&] { return stop_ || count_ > 0; });
+        if (count_ == 0) return;
+        job = ring_[head_];
+        head_ = (head_ + 1) % kCapacity;
+        --count_;
+      }
+      cv_.notify_all();
+      Qnn_NotifyStatus_t status;
+      status.error = execute(job.graph, job.inputs, job.num_inputs, job.outputs, job.num_outputs);
+      if (job.notify) job.notify(job.param, status);
+    }
+  }
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  Job ring_[kCapacity] {};
+  size_t head_ {0};
+  size_t count_ {0};
+  bool stop_ {false};
+  std::thread thread_;
+};
+
+std::mutex g_worker_mu;
+std::unique_ptr<AsyncWorker> g_worker;
+
+// ===== QNN 인터페이스 구현 =====
+
+Qnn_ErrorHandle_t stub_log_create(QnnLog_Callback_t, QnnLog_Level_t, Qnn_LogHandle_t* log) {
+  *log = &g_log_token;
+  return QNN_SUCCESS;
+}
+Qnn_ErrorHandle_t stub_log_set_level(Qnn_LogHandle_t, QnnLog_Level_t) { return QNN_SUCCESS; }
+Qnn_ErrorHandle_t stub_log_free(Qnn_LogHandle_t) { return QNN_SUCCESS; }
+
+Qnn_ErrorHandle_t stub_backend_create(Qnn_LogHandle_t, const QnnBackend_Config_t**,
+                                      Qnn_BackendHandle_t* backend) {
+  std::lock_guard<std::mutex> lk(g_worker_mu);
+  if (!g_worker) g_worker.reset(new AsyncWorker());
+  *backend = &g_backend_token;
+  return QNN_SUCCESS;
+}
+
+Qnn_ErrorHandle_t stub_backend_free(Qnn_BackendHandle_t) {
+  std::lock_guard<std::mutex> lk(g_worker_mu);
+  g_worker.reset();
+  return QNN_SUCCESS;
+}
+
+Qnn_ErrorHandle_t stub_device_create(Qnn_LogHandle_t, const QnnDevice_Config_t**,
+                                     Qnn_DeviceHandle_t* device) {
+  *device = &g_device_token;
+  return QNN_SUCCESS;
+}
+Qnn_ErrorHandle_t stub_device_free(Qnn_DeviceHandle_t) { return QNN_SUCCESS; }
+
+Qnn_ErrorHandle_t stub_context_create(Qnn_BackendHandle_t, Qnn_DeviceHandle_t,
+                                      const QnnContext_Config_t**, const void* binary,
+                                      Qnn_ContextBinarySize_t size, Qnn_ContextHandle_t* context,
+                                      Qnn_ProfileHandle_t) {
+  static const char kMagic[] = "QNNSTUB ";
+  const size_t magic_len = sizeof(kMagic) - 1;
+  if (!binary || !context || size <= magic_len || std::memcmp(binary, kMagic, magic_len) != 0) {
+    return QNN_COMMON_ERROR_INVALID_ARGUMENT;
+  }
+  std::string header(static_cast<const char*>(binary) + magic_len,
+                     std::min<size_t>(16, static_cast<size_t>(size) - magic_len));
+  auto* ctx = new StubContext();
+  ctx->id = static_cast<int32_t>(std::strtol(header.c_str(), nullptr, 10));
+  *context = ctx;
+  return QNN_SUCCESS;
+}
+
+Qnn_ErrorHandle_t stub_context_free(Qnn_ContextHandle_t context, Qnn_ProfileHandle_t) {
+  delete static_cast<StubContext*>(context);
+  return QNN_SUCCESS;
+}
+
+Qnn_ErrorHandle_t stub_graph_retrieve(Qnn_ContextHandle_t context, const char* name,
+                                      Qnn_GraphHandle_t* graph) {
+  auto* ctx = static_cast<StubContext*>(context);
+  if (!ctx || !name || !graph) return QNN_COMMON_ERROR_INVALID_ARGUMENT;
+  std::lock_guard<std::mutex> lk(ctx->mu);
+  for (const auto& g : ctx->graphs) {
+    if (std::strcmp(g->name, name) == 0) {
+      *graph = g.get();
+      return QNN_SUCCESS;
+    }
+  }
+  std::unique_ptr<StubGraph> g(new StubGraph());
+  g->context = ctx;
+  std::strncpy(g->name, name, sizeof(g->name) - 1);
+  *graph = g.get();
+  ctx->graphs.push_back(std::move(g));
+  return QNN_SUCCESS;
+}
+
+Qnn_ErrorHandle_t stub_graph_execute(Qnn_GraphHandle_t graph, const Qnn_Tensor_t* inputs,
+                                     uint32_t num_inputs, Qnn_Tensor_t* outputs,
+                                     uint32_t num_outputs, Qnn_ProfileHandle_t, Qnn_SignalHandle_t) {
+  return execute(graph, inputs, num_inputs, outputs, num_outputs);
+}
+
+Qnn_ErrorHandle_t stub_graph_execute_async(Qnn_GraphHandle_t graph, const Qnn_Tensor_t* inputs,
+                                           uint32_t num_inputs, Qnn_Tensor_t* outputs,
+                                           uint32_t num_outputs, Qnn_ProfileHandle_t,
+                                           Qnn_SignalHandle_t, Qnn_NotifyFn_t notify, void* param) {
+  if (!graph) return QNN_COMMON_ERROR_INVALID_ARGUMENT;
+  if (!g_worker) return QNN_GRAPH_ERROR_UNSUPPORTED_FEATURE;
+  g_worker->submit({graph, inputs, num_inputs, outputs, num_outputs, notify, param});
+  return QNN_SUCCESS;
+}
+
+QnnInterface_t make_interface() {
+  QnnInterface_t iface;
+  std::memset(&iface, 0, sizeof(iface));
+  iface.providerName = "qnn_stub_backend";
+  auto& api = iface.QNN_INTERFACE_VER_NAME;
+  api.logCreate = stub_log_create;
+  api.logSetLogLevel = stub_log_set_level;
+  api.logFree = stub_log_free;
+  api.backendCreate = stub_backend_create;
+  api.backendFree = stub_backend_free;
+  api.deviceCreate = stub_device_create;
+  api.deviceFree = stub_device_free;
+  api.contextCreateFromBinary = stub_context_create;
+  api.contextFree = stub_context_free;
+  api.graphRetrieve = stub_graph_retrieve;
+  api.graphExecute = stub_graph_execute;
+  api.graphExecuteAsync = stub_graph_execute_async;
+  return iface;
+}
+
+const QnnInterface_t g_interface = make_interface();
+const QnnInterface_t* g_providers[] = {&g_interface};
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default")))
+Qnn_ErrorHandle_t QnnInterface_getProviders(const QnnInterface_t*** providers, uint32_t* num) {
+  if (!providers || !num) return QNN_COMMON_ERROR_INVALID_ARGUMENT;
+  *providers = g_providers;
+  *num = 1;
+  return QNN_SUCCESS;
+}
+
+void qnn_stub_trace_start(size_t capacity) {
+  std::lock_guard<std::mutex> lk(g_exec_mu);
+  g_trace.assign(capacity, QnnStubTraceEntry{});
+  g_trace_size = 0;
+  g_trace_overflow = false;
+  g_trace_on = true;
+}
+
+void qnn_stub_trace_stop() {
+  std::lock_guard<std::mutex> lk(g_exec_mu);
+  g_trace_on = false;
+}
+
+size_t qnn_stub_trace_size() {
+  std::lock_guard<std::mutex> lk(g_exec_mu);
+  return g_trace_size;
+}
+
+bool qnn_stub_trace_overflow() {
+  std::lock_guard<std::mutex> lk(g_exec_mu);
+  return g_trace_overflow;
+}
+
+const QnnStubTraceEntry* qnn_stub_trace_data() { return g_trace.data(); }
+
+uint64_t qnn_stub_executions() {
+  std::lock_guard<std::mutex> lk(g_exec_mu);
+  return g_executions;
+}
+
+} // extern "C"
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 호스트 테스트용 스텁 QNN 백엔드(libqnn_stub_backend.so) 제어 API
+// - 러너는 실제 백엔드처럼 dlopen → QnnInterface_getProviders로 사용한다
+// - 테스트는 같은 경로를 dlopen해 아래 심볼을 dlsym으로 찾는다(StubBackendControl)
+//
+// 컨텍스트 바이너리: "QNNSTUB <id>"로 시작하는 파일(id = 샤드 번호, tests/stub_model.cpp가 생성)
+// 그래프 실행: 입력 바이트 전체의 해시와 출력 이름으로 시드를 만들어 출력을 결정적으로 채운다.
+//   샤드 간 바인딩이 달라지면 이후 모든 입력/출력 해시가 달라진다
+// 실행 경로는 힙 할당이 없다(트레이스 버퍼는 qnn_stub_trace_start에서 미리 확보)
+
+extern "C" {
+
+struct QnnStubTraceEntry {
+  uint64_t exec;        // 백엔드 전체 실행 순번(0부터)
+  int32_t context_id;   // 컨텍스트 바이너리의 id
+  uint8_t is_output;    // 0: 실행 직전 입력, 1: 실행 직후 출력
+  char graph[32];
+  char tensor[96];
+  uint64_t nbytes;
+  uint64_t hash;        // FNV-1a(텐서 바이트)
+};
+
+// capacity개 엔트리를 미리 확보하고 기록 시작(가득 차면 이후 엔트리는 버리고 overflow 표시)
+void qnn_stub_trace_start(size_t capacity);
+void qnn_stub_trace_stop();
+size_t qnn_stub_trace_size();
+bool qnn_stub_trace_overflow();
+const QnnStubTraceEntry* qnn_stub_trace_data();
+
+// 누적 graphExecute(Async) 호출 수
+uint64_t qnn_stub_executions();
+
+} // extern "C"
@@ -0,0 +1,38 @@
+// Byte-level stand-in for the llama.cpp tokenizer (host tests do not build llama.cpp)
+#include "tokenizer_llama.h"
+
+namespace llm_test {
+
+namespace {
+constexpr int32_t kBosToken = 128000;
+} // namespace
+
+LlamaTokenizer::LlamaTokenizer() : model_(nullptr) {}
+LlamaTokenizer::~LlamaTokenizer() = default;
+
+bool LlamaTokenizer::init(const char*) { return true; }
+void LlamaTokenizer::shutdown() {}
+
+std::vector<int32_t> LlamaTokenizer::encode(const std::string& text, bool add_special, bool) {
+  std::vector<int32_t> tokens;
+  if (add_special) tokens.push_back(kBosToken);
+  for (unsigned char c : text) tokens.push_back(c);
+  return tokens;
+}
+
+std::string LlamaTokenizer::decode(const std::vector<int32_t>& tokens, bool special) {
+  std::string out;
+  for (int32_t t : tokens) decode_token(t, out, special);
+  return out;
+}
+
+size_t LlamaTokenizer::decode_token(int32_t token, std::string& out, bool) {
+  out.push_back(static_cast<char>('a' + static_cast<uint32_t>(token) % 26));
+  return 1;
+}
+
+std::string format_llama32_prompt(const std::string& user, const std::string& system) {
+  return system + "\n" + user;
+}
+
+} // namespace llm_test